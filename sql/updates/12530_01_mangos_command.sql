@@ -0,0 +1,18 @@
+ALTER TABLE db_version CHANGE COLUMN required_12522_01_mangos_db_script_string required_12530_01_mangos_command bit;
+
+DELETE FROM command WHERE name IN ('debug aurabench', 'debug broadcastbench', 'debug eventbench', 'debug lexicsbench', 'debug loginbench', 'debug netstats', 'debug packetalloc', 'debug terrainbench', 'debug valuesbench', 'server dbstats', 'server log stats', 'server mapstats', 'server savestats');
+
+INSERT INTO command VALUES
+('debug aurabench',3,'Syntax: .debug aurabench #spellid [#count]\r\n\r\nTime #count (default 1000, at most 10000) create/delete cycles of aura holders of aura spell #spellid on your character and copies of the holder handle. Show aura pool statistics.'),
+('debug broadcastbench',3,'Syntax: .debug broadcastbench [#recipients [#payloadsize]]\r\n\r\nCompare queueing a #payloadsize (default 1024, at most 16000) bytes packet to #recipients (default 1000, at most 1000) output buffers by copy and by shared payload reference, 100 times each.'),
+('debug eventbench',3,'Syntax: .debug eventbench [#count]\r\n\r\nTime insert, expire and abort of #count (default 100000, at most 1000000) events with random delays up to 10 seconds in an event processor.'),
+('debug lexicsbench',4,'Syntax: .debug lexicsbench $filename [#repeats]\r\n\r\nCheck up to 100000 chat lines from file $filename #repeats (default 1, at most 100) times with the lexics cutter word automaton and with per position word compare, show times and lines with different results.'),
+('debug loginbench',3,'Syntax: .debug loginbench [#count]\r\n\r\nReplay character screen packets of #count (default 100, at most 1000) sessions of your account serially and by session update threads, show times of both.'),
+('debug netstats',3,'Syntax: .debug netstats [$playername]\r\n\r\nShow output queue size, send calls and sent bytes per second and latency of the connection of selected or named player.'),
+('debug packetalloc',3,'Syntax: .debug packetalloc [on|off|reset]\r\n\r\nWithout argument show packet storage pool statistics and the opcodes with most storage allocations. With argument enable, disable or reset per opcode counters.'),
+('debug terrainbench',3,'Syntax: .debug terrainbench [#count]\r\n\r\nCompare single and batched height and line of sight queries for #count (default 1000, at most 10000) random points around your character, show times and results mismatches.'),
+('debug valuesbench',3,'Syntax: .debug valuesbench [#observers [#repeats]]\r\n\r\nCompare building values update blocks of selected unit (or you) per observer and shared between observers, for #observers (default 100, at most 5000) nearby players #repeats (default 100, at most 10000) times, #observers x #repeats at most 1000000. No update is sent to clients.'),
+('server dbstats',3,'Syntax: .server dbstats\r\n\r\nShow async query queue statistics of world, character and login databases.'),
+('server log stats',4,'Syntax: .server log stats\r\n\r\nShow written, dropped and blocked record counts of async log mode.'),
+('server mapstats',3,'Syntax: .server mapstats [#limit]\r\n\r\nShow map update statistics, object update packet sizes and update times of #limit (default 10) maps with most total update time.'),
+('server savestats',3,'Syntax: .server savestats\r\n\r\nShow count of character saves and unchanged data sections skipped at save.');
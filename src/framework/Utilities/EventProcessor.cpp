@@ -18,9 +18,27 @@
 
 #include "EventProcessor.h"
 
+#include <algorithm>
+
+namespace
+{
+    // std heap functions keep the greatest element at front, so "less" means executed later
+    struct EventExecutesLater
+    {
+        bool operator()(BasicEvent const* a, BasicEvent const* b) const
+        {
+            if (a->m_execTime != b->m_execTime)
+                return a->m_execTime > b->m_execTime;
+
+            return a->m_addOrder > b->m_addOrder;
+        }
+    };
+}
+
 EventProcessor::EventProcessor()
 {
     m_time = 0;
+    m_addCounter = 0;
     m_aborting = false;
 }
 
@@ -35,12 +53,12 @@ void EventProcessor::Update(uint32 p_time)
     m_time += p_time;
 
     // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+    while (!m_events.empty() && m_events.front()->m_execTime <= m_time)
     {
         // get and remove event from queue
-        BasicEvent* Event = i->second;
-        m_events.erase(i);
+        BasicEvent* Event = m_events.front();
+        std::pop_heap(m_events.begin(), m_events.end(), EventExecutesLater());
+        m_events.pop_back();
 
         if (!Event->to_Abort)
         {
@@ -63,26 +81,28 @@ void EventProcessor::KillAllEvents(bool force)
     // prevent event insertions
     m_aborting = true;
 
-    // first, abort all existing events
-    for (EventList::iterator i = m_events.begin(); i != m_events.end();)
+    // Abort() and destructors may add events, so work on detached list,
+    // in force case until no event is added anymore
+    do
     {
-        EventList::iterator i_old = i;
-        ++i;
+        EventList events;
+        events.swap(m_events);
 
-        i_old->second->to_Abort = true;
-        i_old->second->Abort(m_time);
-        if (force || i_old->second->IsDeletable())
+        // abort all existing events
+        for (EventList::iterator i = events.begin(); i != events.end(); ++i)
         {
-            delete i_old->second;
-
-            if (!force)                                     // need per-element cleanup
-                m_events.erase(i_old);
+            (*i)->to_Abort = true;
+            (*i)->Abort(m_time);
+            if (force || (*i)->IsDeletable())
+                delete *i;
+            else                                            // deleted at next Update
+            {
+                m_events.push_back(*i);
+                std::push_heap(m_events.begin(), m_events.end(), EventExecutesLater());
+            }
         }
     }
-
-    // fast clear event list (in force case)
-    if (force)
-        m_events.clear();
+    while (force && !m_events.empty());
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
@@ -91,7 +111,14 @@ void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime
         Event->m_addTime = m_time;
 
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+    InsertEvent(Event);
+}
+
+void EventProcessor::InsertEvent(BasicEvent* Event)
+{
+    Event->m_addOrder = m_addCounter++;
+    m_events.push_back(Event);
+    std::push_heap(m_events.begin(), m_events.end(), EventExecutesLater());
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset)
@@ -21,8 +21,8 @@
 
 #include "Platform/Define.h"
 
-#include <map>
 #include <queue>
+#include <vector>
 
 // Note. All times are in milliseconds here.
 
@@ -53,10 +53,13 @@ class BasicEvent
         // these can be used for time offset control
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
+        uint64 m_addOrder;                                  // orders events with same m_execTime, filled by event handler
         uint32 const m_type;                                // Event type (for use in some calculation)
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
+// binary min-heap of events by (m_execTime, m_addOrder), events themselves keep the ordering key
+// so adding and removing events does not allocate
+typedef std::vector<BasicEvent*> EventList;
 
 class MANGOS_DLL_SPEC EventProcessor
 {
@@ -72,7 +75,11 @@ class MANGOS_DLL_SPEC EventProcessor
 
     protected:
 
+        // inserts event with already set m_execTime into m_events
+        void InsertEvent(BasicEvent* Event);
+
         uint64 m_time;
+        uint64 m_addCounter;
         EventList m_events;
         bool m_aborting;
 };
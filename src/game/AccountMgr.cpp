@@ -34,6 +34,7 @@ INSTANTIATE_SINGLETON_1(AccountMgr);
 AccountMgr::AccountMgr()
 {
     mPlayerDataCacheMap.clear();
+    mPlayerNameIndex.clear();
     mRAFLinkedMap.clear();
 }
 
@@ -403,7 +404,17 @@ void AccountMgr::ClearPlayerDataCache(ObjectGuid guid)
         WriteGuard Guard(GetLock());
         PlayerDataCacheMap::iterator itr = mPlayerDataCacheMap.find(guid);
         if (itr != mPlayerDataCacheMap.end())
+        {
+            std::string key;
+            if (Utf8ToLower(itr->second.name, key))
+            {
+                PlayerNameIndexMap::iterator nameItr = mPlayerNameIndex.find(key);
+                if (nameItr != mPlayerNameIndex.end() && nameItr->second == guid)
+                    mPlayerNameIndex.erase(nameItr);
+            }
+
             mPlayerDataCacheMap.erase(itr);
+        }
 
         RafLinkedMap::iterator itr1 = mRAFLinkedMap.find(std::pair<uint32,bool>(accId, true));
         if (itr1 != mRAFLinkedMap.end())
@@ -430,7 +441,17 @@ void AccountMgr::MakePlayerDataCache(Player* player)
     cache.race     = player->getRace();
     cache.name     = player->GetName();
 
-    mPlayerDataCacheMap.insert(PlayerDataCacheMap::value_type(guid, cache));
+    InsertPlayerDataCache(guid, cache);
+}
+
+void AccountMgr::InsertPlayerDataCache(ObjectGuid guid, PlayerDataCache const& cache)
+{
+    if (!mPlayerDataCacheMap.insert(PlayerDataCacheMap::value_type(guid, cache)).second)
+        return;
+
+    std::string key;
+    if (Utf8ToLower(cache.name, key))
+        mPlayerNameIndex[key] = guid;
 }
 
 PlayerDataCache const* AccountMgr::GetPlayerDataCache(ObjectGuid guid, bool force)
@@ -462,7 +483,7 @@ PlayerDataCache const* AccountMgr::GetPlayerDataCache(ObjectGuid guid, bool forc
             cache.race    = (*result)[2].GetUInt8();
 
             WriteGuard Guard(GetLock());
-            mPlayerDataCacheMap.insert(PlayerDataCacheMap::value_type(guid, cache));
+            InsertPlayerDataCache(guid, cache);
             delete result;
         }
     }
@@ -479,28 +500,39 @@ PlayerDataCache const* AccountMgr::GetPlayerDataCache(ObjectGuid guid, bool forc
 
 PlayerDataCache const* AccountMgr::GetPlayerDataCache(const std::string& name)
 {
+    std::string key;
+    if (!Utf8ToLower(name, key))
+        return NULL;
+
     {
         ReadGuard Guard(GetLock());
-        for (PlayerDataCacheMap::const_iterator itr = mPlayerDataCacheMap.begin(); itr != mPlayerDataCacheMap.end(); ++itr)
-            if (itr->second.name == name)
+        PlayerNameIndexMap::const_iterator nameItr = mPlayerNameIndex.find(key);
+        if (nameItr != mPlayerNameIndex.end())
+        {
+            PlayerDataCacheMap::const_iterator itr = mPlayerDataCacheMap.find(nameItr->second);
+            if (itr != mPlayerDataCacheMap.end())
                 return &itr->second;
+        }
     }
 
     ObjectGuid guid;
 
-    QueryResult* result = CharacterDatabase.PQuery("SELECT account, guid, race FROM characters WHERE name = '%s'", name.c_str());
+    std::string escapedName = name;
+    CharacterDatabase.escape_string(escapedName);
+
+    QueryResult* result = CharacterDatabase.PQuery("SELECT account, guid, race, name FROM characters WHERE name = '%s'", escapedName.c_str());
     if (result)
     {
         PlayerDataCache cache;
         cache.account  = (*result)[0].GetUInt32();
         cache.lowguid  = (*result)[1].GetUInt32();
         cache.race     = (*result)[2].GetUInt8();
-        cache.name     = name;
+        cache.name     = (*result)[3].GetCppString();
 
         guid = ObjectGuid(HIGHGUID_PLAYER, cache.lowguid);
 
         WriteGuard Guard(GetLock());
-        mPlayerDataCacheMap.insert(PlayerDataCacheMap::value_type(guid, cache));
+        InsertPlayerDataCache(guid, cache);
         delete result;
     }
 
@@ -48,6 +48,7 @@ struct PlayerDataCache
 #define MAX_ACCOUNT_STR 16
 
 typedef std::map<ObjectGuid, PlayerDataCache> PlayerDataCacheMap;
+typedef UNORDERED_MAP<std::string, ObjectGuid> PlayerNameIndexMap;
 typedef std::vector<uint32> RafLinkedList;
 typedef std::map<std::pair<uint32, bool>, RafLinkedList > RafLinkedMap;
 
@@ -98,8 +99,12 @@ class AccountMgr
         LockType& GetLock() { return i_lock; }
 
         private:
+        // i_lock must be write locked
+        void InsertPlayerDataCache(ObjectGuid guid, PlayerDataCache const& cache);
+
         LockType            i_lock;
         PlayerDataCacheMap  mPlayerDataCacheMap;
+        PlayerNameIndexMap  mPlayerNameIndex;               // lower case name -> guid of cached players
         RafLinkedMap        mRAFLinkedMap;
 };
 
@@ -428,6 +428,7 @@ void AchievementMgr::Reset()
 
     m_completedAchievements.clear();
     m_criteriaProgress.clear();
+    m_completedCriteriaCache.clear();
     DeleteFromDB(m_player->GetObjectGuid());
 
     // re-fill data
@@ -663,6 +664,7 @@ void AchievementMgr::LoadFromDB(QueryResult* achievementResult, QueryResult* cri
                 {
                     progress.counter = maxcounter;
                     progress.changed = true;
+                    GetPlayer()->MarkSaveSectionDirty(PLAYER_SAVE_ACHIEVEMENTS);
                 }
             }
         }
@@ -813,7 +815,9 @@ void AchievementMgr::StartTimedAchievementCriteria(AchievementCriteriaTypes type
             progress = &iter->second;
 
         progress->changed = true;
+        GetPlayer()->MarkSaveSectionDirty(PLAYER_SAVE_ACHIEVEMENTS);
         progress->counter = 0;
+        ClearCompletedCriteriaCache(achievementCriteria->ID);
 
         // Start with given startTime or now
         progress->date = startTime ? startTime : time(NULL);
@@ -864,6 +868,7 @@ void AchievementMgr::DoFailedTimedAchievementCriterias()
 
             // Remove failed progress
             m_criteriaProgress.erase(pro_iter);
+            ClearCompletedCriteriaCache(criteria->ID);
         }
 
         m_criteriaFailTimes.erase(iter++);
@@ -880,7 +885,10 @@ void AchievementMgr::UpdateAchievementCriteria(AchievementCriteriaTypes type, ui
     if (!sWorld.getConfig(CONFIG_BOOL_GM_ALLOW_ACHIEVEMENT_GAINS) && m_player->GetSession()->GetSecurity() > SEC_PLAYER)
         return;
 
-    AchievementCriteriaEntryList const& achievementCriteriaList = sAchievementMgr.GetAchievementCriteriaByType(type);
+    // criteria not matching non-zero miscvalue1 are skipped first thing for some types, only look at matching ones
+    AchievementCriteriaEntryList const& achievementCriteriaList = miscvalue1 && AchievementGlobalMgr::IsCriteriaTypeKeyedByValue(type)
+            ? sAchievementMgr.GetAchievementCriteriaByTypeAndValue(type, miscvalue1, GetTeamIndex(GetPlayer()->GetTeam()))
+            : sAchievementMgr.GetAchievementCriteriaByType(type);
     for (AchievementCriteriaEntryList::const_iterator itr = achievementCriteriaList.begin(); itr != achievementCriteriaList.end(); ++itr)
     {
         AchievementCriteriaEntry const* achievementCriteria = *itr;
@@ -2681,6 +2689,11 @@ bool AchievementMgr::IsCompletedCriteria(AchievementCriteriaEntry const* achieve
             return false;
     }
 
+    // cached result is only valid for the criteria own achievement, referencing achievements may have other flags
+    bool ownAchievement = achievementCriteria->referredAchievement == achievement->ID;
+    if (ownAchievement && achievementCriteria->ID < m_completedCriteriaCache.size() && m_completedCriteriaCache[achievementCriteria->ID])
+        return true;
+
     CriteriaProgressMap::const_iterator itr = m_criteriaProgress.find(achievementCriteria->ID);
     if (itr == m_criteriaProgress.end())
         return false;
@@ -2689,7 +2702,17 @@ bool AchievementMgr::IsCompletedCriteria(AchievementCriteriaEntry const* achieve
 
     uint32 maxcounter = GetCriteriaProgressMaxCounter(achievementCriteria, achievement);
 
-    return progress->counter >= maxcounter || ((achievement->flags & ACHIEVEMENT_FLAG_REQ_COUNT) && progress->counter);
+    if (progress->counter < maxcounter && !((achievement->flags & ACHIEVEMENT_FLAG_REQ_COUNT) && progress->counter))
+        return false;
+
+    // remember until progress of the criteria changes
+    if (ownAchievement)
+    {
+        if (m_completedCriteriaCache.size() <= achievementCriteria->ID)
+            m_completedCriteriaCache.resize(sAchievementCriteriaStore.GetNumRows(), false);
+        m_completedCriteriaCache[achievementCriteria->ID] = true;
+    }
+    return true;
 }
 
 void AchievementMgr::CompletedCriteriaFor(AchievementEntry const* achievement)
@@ -2837,6 +2860,8 @@ void AchievementMgr::SetCriteriaProgress(AchievementCriteriaEntry const* criteri
 
     progress->counter = newValue;
     progress->changed = true;
+    GetPlayer()->MarkSaveSectionDirty(PLAYER_SAVE_ACHIEVEMENTS);
+    ClearCompletedCriteriaCache(criteria->ID);
 
     // update client side value
     SendCriteriaUpdate(criteria->ID, progress);
@@ -2898,6 +2923,7 @@ void AchievementMgr::CompletedAchievement(AchievementEntry const* achievement)
     CompletedAchievementData& ca =  m_completedAchievements[achievement->ID];
     ca.date = time(NULL);
     ca.changed = true;
+    GetPlayer()->MarkSaveSectionDirty(PLAYER_SAVE_ACHIEVEMENTS);
 
     sAchievementMgr.SetRealmCompleted(achievement);
 
@@ -3044,6 +3070,43 @@ AchievementCriteriaEntryList const& AchievementGlobalMgr::GetAchievementCriteria
     return m_AchievementCriteriasByType[type];
 }
 
+AchievementCriteriaEntryList const& AchievementGlobalMgr::GetAchievementCriteriaByTypeAndValue(AchievementCriteriaTypes type, uint32 value, TeamIndex team)
+{
+    if (team >= PVP_TEAM_COUNT)
+        return m_AchievementCriteriasByType[type];
+
+    AchievementCriteriaListByValue const& byValue = m_AchievementCriteriasByValue[type][team];
+    AchievementCriteriaListByValue::const_iterator itr = byValue.find(value);
+
+    static AchievementCriteriaEntryList const emptyList;
+    return itr != byValue.end() ? itr->second : emptyList;
+}
+
+// types where UpdateAchievementCriteria skips criteria with raw.value != miscvalue1 when miscvalue1 is set
+bool AchievementGlobalMgr::IsCriteriaTypeKeyedByValue(AchievementCriteriaTypes type)
+{
+    switch (type)
+    {
+        case ACHIEVEMENT_CRITERIA_TYPE_KILL_CREATURE:
+        case ACHIEVEMENT_CRITERIA_TYPE_KILLED_BY_CREATURE:
+        case ACHIEVEMENT_CRITERIA_TYPE_COMPLETE_QUEST:
+        case ACHIEVEMENT_CRITERIA_TYPE_BE_SPELL_TARGET:
+        case ACHIEVEMENT_CRITERIA_TYPE_BE_SPELL_TARGET2:
+        case ACHIEVEMENT_CRITERIA_TYPE_CAST_SPELL:
+        case ACHIEVEMENT_CRITERIA_TYPE_CAST_SPELL2:
+        case ACHIEVEMENT_CRITERIA_TYPE_LEARN_SPELL:
+        case ACHIEVEMENT_CRITERIA_TYPE_OWN_ITEM:
+        case ACHIEVEMENT_CRITERIA_TYPE_USE_ITEM:
+        case ACHIEVEMENT_CRITERIA_TYPE_LOOT_ITEM:
+        case ACHIEVEMENT_CRITERIA_TYPE_EQUIP_ITEM:
+        case ACHIEVEMENT_CRITERIA_TYPE_USE_GAMEOBJECT:
+        case ACHIEVEMENT_CRITERIA_TYPE_FISH_IN_GAMEOBJECT:
+            return true;
+        default:
+            return false;
+    }
+}
+
 AchievementCriteriaEntryList const* AchievementGlobalMgr::GetAchievementCriteriaByAchievement(uint32 id)
 {
     AchievementCriteriaListByAchievement::const_iterator itr = m_AchievementCriteriaListByAchievement.find(id);
@@ -3129,6 +3192,14 @@ void AchievementGlobalMgr::LoadAchievementCriteriaList()
 
         m_AchievementCriteriasByType[criteria->requiredType].push_back(criteria);
         m_AchievementCriteriaListByAchievement[criteria->referredAchievement].push_back(criteria);
+
+        if (IsCriteriaTypeKeyedByValue(AchievementCriteriaTypes(criteria->requiredType)))
+        {
+            if (achiev->factionFlag != ACHIEVEMENT_FACTION_FLAG_HORDE)
+                m_AchievementCriteriasByValue[criteria->requiredType][TEAM_INDEX_ALLIANCE][criteria->raw.value].push_back(criteria);
+            if (achiev->factionFlag != ACHIEVEMENT_FACTION_FLAG_ALLIANCE)
+                m_AchievementCriteriasByValue[criteria->requiredType][TEAM_INDEX_HORDE][criteria->raw.value].push_back(criteria);
+        }
         ++count;
     }
 
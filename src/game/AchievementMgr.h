@@ -35,6 +35,7 @@ typedef std::list<AchievementCriteriaEntry const*> AchievementCriteriaEntryList;
 typedef std::list<AchievementEntry const*>         AchievementEntryList;
 
 typedef std::map<uint32, AchievementCriteriaEntryList> AchievementCriteriaListByAchievement;
+typedef UNORDERED_MAP<uint32, AchievementCriteriaEntryList> AchievementCriteriaListByValue;
 typedef std::map<uint32, AchievementEntryList>         AchievementListByReferencedId;
 typedef std::map<uint32, time_t>                       AchievementCriteriaFailTimeMap;
 
@@ -299,9 +300,15 @@ class AchievementMgr
         void IncompletedAchievement(AchievementEntry const* entry);
         void CompleteAchievementsWithRefs(AchievementEntry const* entry);
         void BuildAllDataPacket(WorldPacket* data);
+        void ClearCompletedCriteriaCache(uint32 criteriaId)
+        {
+            if (criteriaId < m_completedCriteriaCache.size())
+                m_completedCriteriaCache[criteriaId] = false;
+        }
 
         Player* m_player;
         CriteriaProgressMap m_criteriaProgress;
+        mutable std::vector<bool> m_completedCriteriaCache; // criteria id -> progress known to be at max counter
         CompletedAchievementMap m_completedAchievements;
         AchievementCriteriaFailTimeMap m_criteriaFailTimes;
 };
@@ -310,6 +317,9 @@ class AchievementGlobalMgr
 {
     public:
         AchievementCriteriaEntryList const& GetAchievementCriteriaByType(AchievementCriteriaTypes type);
+        // criteria of type with given first value (creature, item, spell, quest, gameobject), only of achievements available for team
+        AchievementCriteriaEntryList const& GetAchievementCriteriaByTypeAndValue(AchievementCriteriaTypes type, uint32 value, TeamIndex team);
+        static bool IsCriteriaTypeKeyedByValue(AchievementCriteriaTypes type);
         AchievementCriteriaEntryList const* GetAchievementCriteriaByAchievement(uint32 id);
         AchievementEntryList const* GetAchievementByReferencedId(uint32 id) const;
         AchievementReward const* GetAchievementReward(AchievementEntry const* achievement, uint8 gender) const;
@@ -331,6 +341,8 @@ class AchievementGlobalMgr
 
         // store achievement criterias by type to speed up lookup
         AchievementCriteriaEntryList m_AchievementCriteriasByType[ACHIEVEMENT_CRITERIA_TYPE_TOTAL];
+        // store achievement criterias of types matched by first value by type, team and value
+        AchievementCriteriaListByValue m_AchievementCriteriasByValue[ACHIEVEMENT_CRITERIA_TYPE_TOTAL][PVP_TEAM_COUNT];
         // store achievement criterias by achievement to speed up lookup
         AchievementCriteriaListByAchievement m_AchievementCriteriaListByAchievement;
         // store achievements by referenced achievement id to speed up lookup
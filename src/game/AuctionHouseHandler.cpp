@@ -516,7 +516,7 @@ void WorldSession::HandleAuctionRemoveItem(WorldPacket& recv_data)
     // inform player, that auction is removed
     SendAuctionCommandResult(auction, AUCTION_REMOVED, AUCTION_OK);
     // Now remove the auction
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);  // auction rows are shared with other players
     auction->DeleteFromDB();
     pl->SaveInventoryAndGoldToDB();
     CharacterDatabase.CommitTransaction();
@@ -658,17 +658,6 @@ void WorldSession::HandleAuctionListItems(WorldPacket& recv_data)
     // always return pointer
     AuctionHouseObject* auctionHouse = sAuctionMgr.GetAuctionsMap(auctionHouseEntry);
 
-    // Sort
-    AuctionHouseObject::AuctionEntryMap const& aucs = auctionHouse->GetAuctions();
-    std::vector<AuctionEntry*> auctions;
-    auctions.reserve(aucs.size());
-
-    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = aucs.begin(); itr != aucs.end(); ++itr)
-        auctions.push_back(itr->second);
-
-    AuctionSorter sorter(Sort, GetPlayer());
-    std::sort(auctions.begin(), auctions.end(), sorter);
-
     // remove fake death
     if (GetPlayer()->hasUnitState(UNIT_STAT_DIED))
         GetPlayer()->RemoveSpellsCausingAura(SPELL_AURA_FEIGN_DEATH);
@@ -676,20 +665,35 @@ void WorldSession::HandleAuctionListItems(WorldPacket& recv_data)
     // DEBUG_LOG("Auctionhouse search %s list from: %u, searchedname: %s, levelmin: %u, levelmax: %u, auctionSlotID: %u, auctionMainCategory: %u, auctionSubCategory: %u, quality: %u, usable: %u",
     //  auctioneerGuid.GetString().c_str(), listfrom, searchedname.c_str(), levelmin, levelmax, auctionSlotID, auctionMainCategory, auctionSubCategory, quality, usable);
 
+    AuctionSearchFilter filter;
+
+    // full list request ignore all filters
+    if (!isFull)
+    {
+        // converting string that we try to find to lower case
+        if (!Utf8toWStr(searchedname, filter.wsearchedname))
+            return;
+
+        wstrToLower(filter.wsearchedname);
+
+        filter.levelmin = levelmin;
+        filter.levelmax = levelmax;
+        filter.inventoryType = auctionSlotID;
+        filter.itemClass = auctionMainCategory;
+        filter.itemSubClass = auctionSubCategory;
+        filter.quality = quality;
+        filter.locale = GetSessionDbLocaleIndex();
+    }
+
+    std::vector<AuctionEntry*> auctions;
+    auctionHouse->SelectAuctions(filter, Sort, GetPlayer(), auctions);
+
     WorldPacket data(SMSG_AUCTION_LIST_RESULT, (4 + 4 + 4));
     uint32 count = 0;
     uint32 totalcount = 0;
     data << uint32(0);
 
-    // converting string that we try to find to lower case
-    std::wstring wsearchedname;
-    if (!Utf8toWStr(searchedname, wsearchedname))
-        return;
-
-    wstrToLower(wsearchedname);
-
-    BuildListAuctionItems(auctions, data, wsearchedname, listfrom, levelmin, levelmax, usable,
-                          auctionSlotID, auctionMainCategory, auctionSubCategory, quality, count, totalcount, isFull);
+    BuildListAuctionItems(auctions, data, listfrom, usable, count, totalcount, isFull);
 
     data.put<uint32>(0, count);
     data << uint32(totalcount);
@@ -490,6 +490,35 @@ void AuctionHouseMgr::Update()
         mAuctions[i].Update();
 }
 
+bool AuctionHouseMgr::IsItemNameFit(uint32 itemTemplate, int32 locale, std::wstring const& wsearchedname)
+{
+    if (locale + 1 < 0)
+        return false;
+
+    if (mItemNames.size() <= size_t(locale + 1))
+        mItemNames.resize(locale + 2);
+
+    ItemNameMap& names = mItemNames[locale + 1];
+    ItemNameMap::const_iterator itr = names.find(itemTemplate);
+    if (itr == names.end())
+    {
+        ItemPrototype const* proto = ObjectMgr::GetItemPrototype(itemTemplate);
+        if (!proto)
+            return false;
+
+        std::string name = proto->Name1;
+        sObjectMgr.GetItemLocaleStrings(itemTemplate, locale, &name);
+
+        std::wstring wname;
+        Utf8toWStr(name, wname);
+        wstrToLower(wname);
+
+        itr = names.insert(ItemNameMap::value_type(itemTemplate, wname)).first;
+    }
+
+    return itr->second.find(wsearchedname) != std::wstring::npos;
+}
+
 uint32 AuctionHouseMgr::GetAuctionHouseTeam(AuctionHouseEntry const* house)
 {
     // auction houses have faction field pointing to PLAYER,* factions,
@@ -568,6 +597,245 @@ AuctionHouseEntry const* AuctionHouseMgr::GetAuctionHouseEntry(Unit* unit)
     return sAuctionHouseStore.LookupEntry(houseid);
 }
 
+void AuctionHouseObject::AddAuction(AuctionEntry* ah)
+{
+    MANGOS_ASSERT(ah);
+
+    AuctionEntryMap::iterator itr = AuctionsMap.find(ah->Id);
+    if (itr != AuctionsMap.end())
+    {
+        RemoveFromIndex(itr->second);
+        itr->second = ah;
+    }
+    else
+        AuctionsMap[ah->Id] = ah;
+
+    AddToIndex(ah);
+}
+
+bool AuctionHouseObject::RemoveAuction(uint32 id)
+{
+    AuctionEntryMap::iterator itr = AuctionsMap.find(id);
+    if (itr == AuctionsMap.end())
+        return false;
+
+    RemoveFromIndex(itr->second);
+    AuctionsMap.erase(itr);
+    return true;
+}
+
+void AuctionHouseObject::AddToIndex(AuctionEntry* ah)
+{
+    AuctionEntryMap& templateAuctions = m_templateIndex[ah->itemTemplate];
+    if (templateAuctions.empty())
+    {
+        if (ItemPrototype const* proto = ObjectMgr::GetItemPrototype(ah->itemTemplate))
+            m_classIndex[proto->Class].insert(ah->itemTemplate);
+    }
+
+    templateAuctions[ah->Id] = ah;
+    ++m_generation;
+}
+
+void AuctionHouseObject::RemoveFromIndex(AuctionEntry* ah)
+{
+    AuctionTemplateIndex::iterator tItr = m_templateIndex.find(ah->itemTemplate);
+    if (tItr != m_templateIndex.end())
+    {
+        tItr->second.erase(ah->Id);
+        if (tItr->second.empty())
+        {
+            m_templateIndex.erase(tItr);
+
+            if (ItemPrototype const* proto = ObjectMgr::GetItemPrototype(ah->itemTemplate))
+            {
+                AuctionClassIndex::iterator cItr = m_classIndex.find(proto->Class);
+                if (cItr != m_classIndex.end())
+                {
+                    cItr->second.erase(ah->itemTemplate);
+                    if (cItr->second.empty())
+                        m_classIndex.erase(cItr);
+                }
+            }
+        }
+    }
+
+    ++m_generation;
+}
+
+bool AuctionHouseObject::IsMatchingTemplate(uint32 itemTemplate, AuctionSearchFilter const& filter) const
+{
+    ItemPrototype const* proto = ObjectMgr::GetItemPrototype(itemTemplate);
+    if (!proto)
+        return false;
+
+    if (filter.itemClass != 0xffffffff && proto->Class != filter.itemClass)
+        return false;
+
+    if (filter.itemSubClass != 0xffffffff && proto->SubClass != filter.itemSubClass)
+        return false;
+
+    if (filter.inventoryType != 0xffffffff && proto->InventoryType != filter.inventoryType)
+        return false;
+
+    if (filter.quality != 0xffffffff && proto->Quality < filter.quality)
+        return false;
+
+    if (filter.levelmin != 0x00 && (proto->RequiredLevel < filter.levelmin || (filter.levelmax != 0x00 && proto->RequiredLevel > filter.levelmax)))
+        return false;
+
+    if (!filter.wsearchedname.empty() && !sAuctionMgr.IsItemNameFit(itemTemplate, filter.locale, filter.wsearchedname))
+        return false;
+
+    return true;
+}
+
+struct AuctionIdOrder
+{
+    bool operator()(AuctionEntry const* auc1, AuctionEntry const* auc2) const { return auc1->Id < auc2->Id; }
+};
+
+static bool IsAuctionSortByName(uint8 const* sort)
+{
+    for (uint32 i = 0; i < MAX_AUCTION_SORT && sort[i] != MAX_AUCTION_SORT; ++i)
+        if ((sort[i] & ~AUCTION_SORT_REVERSED) == 5)
+            return true;
+
+    return false;
+}
+
+AuctionHouseObject::SortedView const& AuctionHouseObject::GetSortedView(uint8* sort, Player* viewPlayer)
+{
+    // name order depends on viewer locale, all other columns not
+    int32 locale = IsAuctionSortByName(sort) ? viewPlayer->GetSession()->GetSessionDbLocaleIndex() : -1;
+
+    SortedView* view = NULL;
+    for (SortedViewList::iterator itr = m_sortedViews.begin(); itr != m_sortedViews.end(); ++itr)
+    {
+        if (itr->locale == locale && memcmp(itr->sort, sort, MAX_AUCTION_SORT) == 0)
+        {
+            view = &*itr;
+            break;
+        }
+    }
+
+    if (!view)
+    {
+        if (m_sortedViews.size() < AUCTION_SORTED_VIEWS_MAX)
+            m_sortedViews.resize(m_sortedViews.size() + 1);
+        else
+        {
+            // replace least recently used
+            SortedViewList::iterator oldest = m_sortedViews.begin();
+            for (SortedViewList::iterator itr = m_sortedViews.begin(); itr != m_sortedViews.end(); ++itr)
+                if (itr->lastUse < oldest->lastUse)
+                    oldest = itr;
+
+            std::swap(*oldest, m_sortedViews.back());
+        }
+
+        view = &m_sortedViews.back();
+        memcpy(view->sort, sort, MAX_AUCTION_SORT);
+        view->locale = locale;
+        view->generation = m_generation - 1;                // force build
+    }
+
+    view->lastUse = ++m_viewUseCounter;
+
+    if (view->generation != m_generation)
+    {
+        view->auctions.clear();
+        view->auctions.reserve(AuctionsMap.size());
+
+        for (AuctionEntryMap::const_iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end(); ++itr)
+            if (!itr->second->moneyDeliveryTime)
+                view->auctions.push_back(itr->second);
+
+        std::sort(view->auctions.begin(), view->auctions.end(), AuctionSorter(view->sort, viewPlayer));
+        view->generation = m_generation;
+    }
+
+    return *view;
+}
+
+void AuctionHouseObject::SelectAuctions(AuctionSearchFilter const& filter, uint8* sort, Player* viewPlayer, std::vector<AuctionEntry*>& auctions)
+{
+    bool sorted = sort[0] != MAX_AUCTION_SORT;
+
+    if (filter.IsEmpty())
+    {
+        if (sorted)
+            auctions = GetSortedView(sort, viewPlayer).auctions;
+        else
+        {
+            auctions.reserve(AuctionsMap.size());
+            for (AuctionEntryMap::const_iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end(); ++itr)
+                auctions.push_back(itr->second);
+        }
+        return;
+    }
+
+    // template level filters are checked once per item entry instead of once per auction
+    std::set<uint32> templates;
+    size_t matched = 0;
+
+    if (filter.itemClass != 0xffffffff)
+    {
+        AuctionClassIndex::const_iterator cItr = m_classIndex.find(filter.itemClass);
+        if (cItr == m_classIndex.end())
+            return;
+
+        for (std::set<uint32>::const_iterator itr = cItr->second.begin(); itr != cItr->second.end(); ++itr)
+        {
+            if (IsMatchingTemplate(*itr, filter))
+            {
+                templates.insert(*itr);
+                matched += m_templateIndex[*itr].size();
+            }
+        }
+    }
+    else
+    {
+        for (AuctionTemplateIndex::const_iterator itr = m_templateIndex.begin(); itr != m_templateIndex.end(); ++itr)
+        {
+            if (IsMatchingTemplate(itr->first, filter))
+            {
+                templates.insert(itr->first);
+                matched += itr->second.size();
+            }
+        }
+    }
+
+    if (!matched)
+        return;
+
+    // big part of auction house, walk cached full order instead of sorting again
+    if (sorted && matched * 4 >= AuctionsMap.size())
+    {
+        std::vector<AuctionEntry*> const& view = GetSortedView(sort, viewPlayer).auctions;
+
+        auctions.reserve(matched);
+        for (std::vector<AuctionEntry*>::const_iterator itr = view.begin(); itr != view.end(); ++itr)
+            if (templates.find((*itr)->itemTemplate) != templates.end())
+                auctions.push_back(*itr);
+
+        return;
+    }
+
+    auctions.reserve(matched);
+    for (std::set<uint32>::const_iterator itr = templates.begin(); itr != templates.end(); ++itr)
+    {
+        AuctionEntryMap const& templateAuctions = m_templateIndex[*itr];
+        for (AuctionEntryMap::const_iterator aItr = templateAuctions.begin(); aItr != templateAuctions.end(); ++aItr)
+            auctions.push_back(aItr->second);
+    }
+
+    if (sorted)
+        std::sort(auctions.begin(), auctions.end(), AuctionSorter(sort, viewPlayer));
+    else
+        std::sort(auctions.begin(), auctions.end(), AuctionIdOrder());
+}
+
 void AuctionHouseObject::Update()
 {
     time_t curTime = sWorld.GetGameTime();
@@ -582,6 +850,7 @@ void AuctionHouseObject::Update()
 
                 itr->second->DeleteFromDB();
                 MANGOS_ASSERT(!itr->second->itemGuidLow);   // already removed or send in mail at won
+                RemoveFromIndex(itr->second);
                 delete itr->second;
                 AuctionsMap.erase(itr++);
                 continue;
@@ -600,6 +869,7 @@ void AuctionHouseObject::Update()
                     sAuctionMgr.SendAuctionExpiredMail(itr->second);
 
                     itr->second->DeleteFromDB();
+                    RemoveFromIndex(itr->second);
                     delete itr->second;
                     AuctionsMap.erase(itr++);
                     continue;
@@ -797,11 +1067,8 @@ bool AuctionSorter::operator()(const AuctionEntry* auc1, const AuctionEntry* auc
     return false;                                           // "equal" by all sorts
 }
 
-void WorldSession::BuildListAuctionItems(std::vector<AuctionEntry*> const& auctions, WorldPacket& data, std::wstring const& wsearchedname, uint32 listfrom, uint32 levelmin,
-        uint32 levelmax, uint32 usable, uint32 inventoryType, uint32 itemClass, uint32 itemSubClass, uint32 quality, uint32& count, uint32& totalcount, bool isFull)
+void WorldSession::BuildListAuctionItems(std::vector<AuctionEntry*> const& auctions, WorldPacket& data, uint32 listfrom, uint32 usable, uint32& count, uint32& totalcount, bool isFull)
 {
-    int loc_idx = _player->GetSession()->GetSessionDbLocaleIndex();
-
     for (std::vector<AuctionEntry*>::const_iterator itr = auctions.begin(); itr != auctions.end(); ++itr)
     {
         AuctionEntry* Aentry = *itr;
@@ -818,32 +1085,10 @@ void WorldSession::BuildListAuctionItems(std::vector<AuctionEntry*> const& aucti
         }
         else
         {
-            ItemPrototype const* proto = item->GetProto();
-
-            if (itemClass != 0xffffffff && proto->Class != itemClass)
-                continue;
-
-            if (itemSubClass != 0xffffffff && proto->SubClass != itemSubClass)
-                continue;
-
-            if (inventoryType != 0xffffffff && proto->InventoryType != inventoryType)
-                continue;
-
-            if (quality != 0xffffffff && proto->Quality < quality)
-                continue;
-
-            if (levelmin != 0x00 && (proto->RequiredLevel < levelmin || (levelmax != 0x00 && proto->RequiredLevel > levelmax)))
-                continue;
-
+            // item template filters already applied by AuctionHouseObject::SelectAuctions
             if (usable != 0x00 && _player->CanUseItem(item) != EQUIP_ERR_OK)
                 continue;
 
-            std::string name = proto->Name1;
-            sObjectMgr.GetItemLocaleStrings(proto->ItemId, loc_idx, &name);
-
-            if (!wsearchedname.empty() && !Utf8FitTo(name, wsearchedname))
-                continue;
-
             if (count < 50 && totalcount >= listfrom)
             {
                 ++count;
@@ -911,7 +1156,7 @@ AuctionEntry* AuctionHouseObject::AddAuction(AuctionHouseEntry const* auctionHou
 
     sAuctionMgr.AddAItem(newItem);
 
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);  // auction rows are shared with other players
 
     newItem->SaveToDB();
     AH->SaveToDB();
@@ -990,7 +1235,7 @@ void AuctionEntry::AuctionBidWinning(Player* newbidder)
 {
     moneyDeliveryTime = time(NULL) + HOUR;
 
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);
     CharacterDatabase.PExecute("UPDATE auction SET itemguid = 0, moneyTime = '" UI64FMTD "', buyguid = '%u', lastbid = '%u' WHERE id = '%u'", (uint64)moneyDeliveryTime, bidder, bid, Id);
     if (newbidder)
         newbidder->SaveInventoryAndGoldToDB();
@@ -1023,13 +1268,15 @@ bool AuctionEntry::UpdateBid(uint32 newbid, Player* newbidder /*=NULL*/)
     bidder = newbidder ? newbidder->GetGUIDLow() : 0;
     bid = newbid;
 
+    sAuctionMgr.GetAuctionsMap(auctionHouseEntry)->MarkChanged();
+
     if ((newbid < buyout) || (buyout == 0))                 // bid
     {
         if (auction_owner)
             auction_owner->GetSession()->SendAuctionOwnerNotification(this);
 
         // after this update we should save player's money ...
-        CharacterDatabase.BeginTransaction();
+        CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);
         CharacterDatabase.PExecute("UPDATE auction SET buyguid = '%u', lastbid = '%u' WHERE id = '%u'", bidder, bid, Id);
         if (newbidder)
             newbidder->SaveInventoryAndGoldToDB();
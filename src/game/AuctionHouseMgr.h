@@ -95,11 +95,35 @@ struct AuctionEntry
     bool UpdateBid(uint32 newbid, Player* newbidder = NULL);// true if normal bid, false if buyout, bidder==NULL for generated bid
 };
 
+// template level part of CMSG_AUCTION_LIST_ITEMS search, 0xFFFFFFFF / 0 fields mean "any"
+struct AuctionSearchFilter
+{
+    AuctionSearchFilter() : levelmin(0), levelmax(0), inventoryType(0xFFFFFFFF), itemClass(0xFFFFFFFF),
+        itemSubClass(0xFFFFFFFF), quality(0xFFFFFFFF), locale(-1) {}
+
+    bool IsEmpty() const
+    {
+        return wsearchedname.empty() && levelmin == 0 && inventoryType == 0xFFFFFFFF && itemClass == 0xFFFFFFFF &&
+               itemSubClass == 0xFFFFFFFF && quality == 0xFFFFFFFF;
+    }
+
+    std::wstring wsearchedname;                             // lower case
+    uint32 levelmin;
+    uint32 levelmax;
+    uint32 inventoryType;
+    uint32 itemClass;
+    uint32 itemSubClass;
+    uint32 quality;
+    int32 locale;                                           // for name search
+};
+
+#define AUCTION_SORTED_VIEWS_MAX 8                          // cached sort orders per auction house
+
 // this class is used as auctionhouse instance
 class AuctionHouseObject
 {
     public:
-        AuctionHouseObject() {}
+        AuctionHouseObject() : m_generation(0), m_viewUseCounter(0) {}
         ~AuctionHouseObject()
         {
             for (AuctionEntryMap::const_iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end(); ++itr)
@@ -114,11 +138,7 @@ class AuctionHouseObject
         AuctionEntryMap const& GetAuctions() const { return AuctionsMap; }
         AuctionEntryMapBounds GetAuctionsBounds() const {return AuctionEntryMapBounds(AuctionsMap.begin(), AuctionsMap.end()); }
 
-        void AddAuction(AuctionEntry* ah)
-        {
-            MANGOS_ASSERT(ah);
-            AuctionsMap[ah->Id] = ah;
-        }
+        void AddAuction(AuctionEntry* ah);
 
         AuctionEntry* GetAuction(uint32 id) const
         {
@@ -126,10 +146,10 @@ class AuctionHouseObject
             return itr != AuctionsMap.end() ? itr->second : NULL;
         }
 
-        bool RemoveAuction(uint32 id)
-        {
-            return AuctionsMap.erase(id);
-        }
+        bool RemoveAuction(uint32 id);
+
+        // must be called after changing sort relevant fields (bid, bidder, expireTime, ...) of a listed auction
+        void MarkChanged() { ++m_generation; }
 
         void Update();
 
@@ -137,9 +157,37 @@ class AuctionHouseObject
         void BuildListOwnerItems(WorldPacket& data, Player* player, uint32& count, uint32& totalcount);
         void BuildListPendingSales(WorldPacket& data, Player* player, uint32& count);
 
+        // auctions matching filter in requested order, sort as in AuctionSorter
+        void SelectAuctions(AuctionSearchFilter const& filter, uint8* sort, Player* viewPlayer, std::vector<AuctionEntry*>& auctions);
+
         AuctionEntry* AddAuction(AuctionHouseEntry const* auctionHouseEntry, Item* newItem, uint32 etime, uint32 bid, uint32 buyout = 0, uint32 deposit = 0, Player* pl = NULL);
     private:
+        typedef std::map<uint32, AuctionEntryMap> AuctionTemplateIndex;     // item entry -> auctions
+        typedef std::map<uint32, std::set<uint32> > AuctionClassIndex;      // item class -> item entries with auctions
+
+        struct SortedView
+        {
+            uint8 sort[MAX_AUCTION_SORT];
+            int32 locale;                                   // only set for sorts by name
+            uint32 generation;
+            uint32 lastUse;
+            std::vector<AuctionEntry*> auctions;
+        };
+        typedef std::vector<SortedView> SortedViewList;
+
+        void AddToIndex(AuctionEntry* ah);
+        void RemoveFromIndex(AuctionEntry* ah);
+        bool IsMatchingTemplate(uint32 itemTemplate, AuctionSearchFilter const& filter) const;
+        SortedView const& GetSortedView(uint8* sort, Player* viewPlayer);
+
         AuctionEntryMap AuctionsMap;
+
+        AuctionTemplateIndex m_templateIndex;
+        AuctionClassIndex m_classIndex;
+
+        uint32 m_generation;                                // changed at any add/remove/change of listed auctions
+        uint32 m_viewUseCounter;
+        SortedViewList m_sortedViews;
 };
 
 class AuctionSorter
@@ -209,9 +257,18 @@ class AuctionHouseMgr
 
         void Update();
 
+        // case insensitive search of searched name (lower case) in item name of locale
+        bool IsItemNameFit(uint32 itemTemplate, int32 locale, std::wstring const& wsearchedname);
+        void ClearItemNameCache() { mItemNames.clear(); }
+
     private:
+        typedef UNORDERED_MAP<uint32, std::wstring> ItemNameMap;
+        typedef std::vector<ItemNameMap> ItemNameLocaleList;
+
         AuctionHouseObject  mAuctions[MAX_AUCTION_HOUSE_TYPE];
 
+        ItemNameLocaleList  mItemNames;                     // lower case item names by locale index + 1, world thread only
+
         ItemMap             mAitems;
 
         LockType            i_lock;
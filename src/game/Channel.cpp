@@ -21,6 +21,7 @@
 #include "ObjectMgr.h"
 #include "World.h"
 #include "SocialMgr.h"
+#include "SharedPayloadPacket.h"
 
 Channel::Channel(const std::string& name, uint32 channel_id)
     : m_announce(true), m_moderate(false), m_name(name), m_flags(0), m_channelId(channel_id)
@@ -663,12 +664,14 @@ void Channel::SetOwner(ObjectGuid guid, bool exclaim)
 
 void Channel::SendToAll(WorldPacket* data, ObjectGuid p)
 {
+    SharedPayloadPacket broadcast(*data);
+
     for(PlayerList::const_iterator i = m_players.begin(); i != m_players.end(); ++i)
     {
         Player* plr = sObjectMgr.GetPlayer(i->first);
         if (plr)
             if (!p || !plr->GetSocial()->HasIgnore(p))
-                plr->GetSession()->SendPacket(data);
+                plr->GetSession()->SendPacket(broadcast);
     }
 }
 
@@ -219,6 +219,15 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleDebugSpellCoefsCommand(char* args);
         bool HandleDebugSpellModsCommand(char* args);
         bool HandleDebugEnterVehicleCommand(char* args);
+        bool HandleDebugTerrainBenchCommand(char* args);
+        bool HandleDebugAuraBenchCommand(char* args);
+        bool HandleDebugNetStatsCommand(char* args);
+        bool HandleDebugPacketAllocCommand(char* args);
+        bool HandleDebugLoginBenchCommand(char* args);
+        bool HandleDebugLexicsBenchCommand(char* args);
+        bool HandleDebugEventBenchCommand(char* args);
+        bool HandleDebugBroadcastBenchCommand(char* args);
+        bool HandleDebugValuesBenchCommand(char* args);
         bool HandleDebugSendCalendarResultCommand(char* args);
 
         bool HandleDebugPlayCinematicCommand(char* args);
@@ -511,15 +520,19 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleSendMassMoneyCommand(char* args);
 
         bool HandleServerCorpsesCommand(char* args);
+        bool HandleServerDbStatsCommand(char* args);
         bool HandleServerExitCommand(char* args);
         bool HandleServerIdleRestartCommand(char* args);
         bool HandleServerIdleShutDownCommand(char* args);
         bool HandleServerInfoCommand(char* args);
         bool HandleServerLogFilterCommand(char* args);
         bool HandleServerLogLevelCommand(char* args);
+        bool HandleServerLogStatsCommand(char* args);
+        bool HandleServerMapStatsCommand(char* args);
         bool HandleServerMotdCommand(char* args);
         bool HandleServerPLimitCommand(char* args);
         bool HandleServerRestartCommand(char* args);
+        bool HandleServerSaveStatsCommand(char* args);
         bool HandleServerSetMotdCommand(char* args);
         bool HandleServerShutDownCommand(char* args);
         bool HandleServerShutDownCancelCommand(char* args);
@@ -31,9 +31,38 @@ static const uint8 trailingBytesForUTF8[256] = {
     2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2, 3,3,3,3,3,3,3,3,4,4,4,4,5,5,5,5
 };
 
-LexicsCutter::LexicsCutter()
+// UTF-8 letter packed with its length, letters are at most 6 bytes long
+static inline uint64 ReadLetterKey(std::string const& in, uint32& pos)
+{
+    uint8 c = uint8(in[pos++]);
+    uint8 toread = trailingBytesForUTF8[c];
+    uint64 key = c;
+    uint64 len = 1;
+    while ((pos < in.length()) && (toread > 0))
+    {
+        key = (key << 8) | uint8(in[pos++]);
+        ++len;
+        --toread;
+    }
+
+    return key | (len << 56);
+}
+
+static inline uint64 LetterKey(std::string const& letter)
+{
+    uint32 pos = 0;
+    return letter.empty() ? 0 : ReadLetterKey(letter, pos);
+}
+
+static const uint64 SpaceLetterKey = uint64(' ') | (uint64(1) << 56);
+
+LexicsCutter::LexicsCutter() : IgnoreMiddleSpaces(false), IgnoreLetterRepeat(false)
 {
     InvalidChars = "~`!@#$%^&*()-_+=[{]}|\\;:'\",<.>/?";
+
+    memset(InvalidChar, 0, sizeof(InvalidChar));
+    for (uint32 i = 0; i < InvalidChars.size(); ++i)
+        InvalidChar[uint8(InvalidChars[i])] = true;
 }
 
 bool LexicsCutter::ReadUTF8(std::string& in, std::string& out, uint32& pos)
@@ -220,9 +249,80 @@ void LexicsCutter::Map_Innormative_Words()
             WordMap.insert(std::pair< std::string, uint32 >(*itr, i));
         }
     }
+
+    Build_Automaton();
 }
 
-bool LexicsCutter::Compare_Word(std::string& str, uint32 pos, LC_WordVector word)
+void LexicsCutter::Build_Automaton()
+{
+    LetterIds.clear();
+    LetterSets.clear();
+    Nodes.clear();
+    RootNext.clear();
+
+    // number all letters used by words and their analogs, 0 is left for any other letter
+    uint32 letterCount = 1;
+    std::map< LC_LetterSet, uint32 > setIds;
+    for (LC_WordList::const_iterator wItr = WordList.begin(); wItr != WordList.end(); ++wItr)
+    {
+        for (LC_WordVector::const_iterator lItr = wItr->begin(); lItr != wItr->end(); ++lItr)
+        {
+            for (LC_LetterSet::const_iterator itr = lItr->begin(); itr != lItr->end(); ++itr)
+                if (LetterIds.insert(LC_LetterIdMap::value_type(LetterKey(*itr), letterCount)).second)
+                    ++letterCount;
+
+            setIds.insert(std::map< LC_LetterSet, uint32 >::value_type(*lItr, uint32(setIds.size())));
+        }
+    }
+
+    LetterSets.resize(setIds.size(), std::vector< bool >(letterCount, false));
+    for (std::map< LC_LetterSet, uint32 >::const_iterator sItr = setIds.begin(); sItr != setIds.end(); ++sItr)
+        for (LC_LetterSet::const_iterator itr = sItr->first.begin(); itr != sItr->first.end(); ++itr)
+            LetterSets[sItr->second][LetterIds[LetterKey(*itr)]] = true;
+
+    // words as paths of letter sets
+    Nodes.resize(1);
+    for (LC_WordList::const_iterator wItr = WordList.begin(); wItr != WordList.end(); ++wItr)
+    {
+        uint32 node = 0;
+        for (LC_WordVector::const_iterator lItr = wItr->begin(); lItr != wItr->end(); ++lItr)
+        {
+            uint32 setId = setIds[*lItr];
+            uint32 next = 0;
+            for (uint32 i = 0; i < Nodes[node].Children.size(); ++i)
+            {
+                if (Nodes[node].Children[i].first == setId)
+                {
+                    next = Nodes[node].Children[i].second;
+                    break;
+                }
+            }
+
+            if (!next)
+            {
+                next = Nodes.size();
+                Nodes.push_back(LC_Node());
+                Nodes[node].Children.push_back(std::pair< uint32, uint32 >(setId, next));
+            }
+
+            node = next;
+        }
+
+        if (node)
+            Nodes[node].Terminal = true;
+    }
+
+    RootNext.resize(letterCount);
+    for (uint32 i = 0; i < Nodes[0].Children.size(); ++i)
+    {
+        std::vector< bool > const& letters = LetterSets[Nodes[0].Children[i].first];
+        for (uint32 letter = 0; letter < letterCount; ++letter)
+            if (letters[letter])
+                RootNext[letter].push_back(Nodes[0].Children[i].second);
+    }
+}
+
+bool LexicsCutter::Compare_Word(std::string& str, uint32 pos, LC_WordVector const& word) const
 {
     std::string lchar_prev;
     std::string lchar;
@@ -232,7 +332,7 @@ bool LexicsCutter::Compare_Word(std::string& str, uint32 pos, LC_WordVector word
 
     // okay, here we go, comparing word
     // first letter is already okay, we do begin from second and go on
-    LC_WordVector::iterator i = word.begin();
+    LC_WordVector::const_iterator i = word.begin();
     i++;
     while (i != word.end())
     {
@@ -240,8 +340,7 @@ bool LexicsCutter::Compare_Word(std::string& str, uint32 pos, LC_WordVector word
         if (!ReadUTF8(str, lchar, pos))
             return false;
         // check, if the letter is in the set
-        LC_LetterSet ls = *i;
-        if (ls.count(lchar) == 0)
+        if (i->count(lchar) == 0)
         {
             // letter is not in set, but we must check, if it is not space or repeat
             if ( (!(IgnoreMiddleSpaces && (lchar == " "))) &&
@@ -264,11 +363,113 @@ bool LexicsCutter::Compare_Word(std::string& str, uint32 pos, LC_WordVector word
     return true;
 }
 
-bool LexicsCutter::Check_Lexics(std::string& Phrase)
+namespace
+{
+    // partially matched word(s) while scanning a phrase
+    struct LC_State
+    {
+        LC_State(uint32 node_, uint64 skipped_, bool first_) : node(node_), skipped(skipped_), first(first_) {}
+
+        bool operator==(LC_State const& s) const { return node == s.node && skipped == s.skipped && first == s.first; }
+
+        uint32 node;
+        uint64 skipped;                                     // children (first 64) whose letter set contained a letter ignored at this node
+        bool first;                                         // only first word letter read, no previous letter for repeat check
+    };
+
+    inline void AddState(std::vector< LC_State >& states, LC_State const& state)
+    {
+        if (std::find(states.begin(), states.end(), state) == states.end())
+            states.push_back(state);
+    }
+}
+
+bool LexicsCutter::Check_Lexics(std::string& Phrase) const
+{
+    if (Phrase.size() == 0 || Nodes.empty())
+        return false;
+
+    // same rules as Compare_Word for all words at once: a letter of the phrase moves a word to its next letter
+    // if it is in the letter set, otherwise a space or repeated letter may be ignored
+    std::vector< LC_State > states;
+    std::vector< LC_State > next;
+
+    uint64 prevKey = 0;
+    bool leadingSpace = true;                               // phrase is checked with a space added at the start
+    uint32 pos = 0;
+
+    while (leadingSpace || pos < Phrase.length())
+    {
+        uint64 key;
+        if (leadingSpace)
+        {
+            key = SpaceLetterKey;
+            leadingSpace = false;
+        }
+        else
+        {
+            uint32 start = pos;
+            key = ReadLetterKey(Phrase, pos);
+            if (pos - start == 1 && InvalidChar[uint8(Phrase[start])])
+                continue;
+        }
+
+        LC_LetterIdMap::const_iterator idItr = LetterIds.find(key);
+        uint32 letter = idItr != LetterIds.end() ? idItr->second : 0;
+
+        next.clear();
+
+        for (std::vector< LC_State >::const_iterator itr = states.begin(); itr != states.end(); ++itr)
+        {
+            LC_Node const& node = Nodes[itr->node];
+            uint64 matched = 0;
+            bool unmatched = false;
+
+            for (uint32 i = 0; i < node.Children.size(); ++i)
+            {
+                if (i < 64 && (itr->skipped & (uint64(1) << i)))
+                    continue;
+
+                if (LetterSets[node.Children[i].first][letter])
+                {
+                    if (Nodes[node.Children[i].second].Terminal)
+                        return true;
+
+                    AddState(next, LC_State(node.Children[i].second, 0, false));
+                    if (i < 64)
+                        matched |= uint64(1) << i;
+                }
+                else
+                    unmatched = true;
+            }
+
+            // words that did not take the letter may ignore it, words that did stop here
+            if (unmatched && ((IgnoreMiddleSpaces && key == SpaceLetterKey) || (IgnoreLetterRepeat && !itr->first && key == prevKey)))
+                AddState(next, LC_State(itr->node, itr->skipped | matched, false));
+        }
+
+        // words starting at this letter
+        std::vector< uint32 > const& starts = RootNext[letter];
+        for (std::vector< uint32 >::const_iterator itr = starts.begin(); itr != starts.end(); ++itr)
+        {
+            if (Nodes[*itr].Terminal)
+                return true;
+
+            AddState(next, LC_State(*itr, 0, true));
+        }
+
+        states.swap(next);
+        prevKey = key;
+    }
+
+    return false;
+}
+
+bool LexicsCutter::Check_Lexics_Simple(std::string& Phrase) const
 {
     std::string lchar;
-    LC_WordMap::iterator i;
-    std::pair< LC_WordMap::iterator, LC_WordMap::iterator > ii;
+    LC_WordMap::const_iterator i;
+    std::pair< LC_WordMap::const_iterator, LC_WordMap::const_iterator > ii;
 
     if (Phrase.size() == 0)
         return false;
@@ -26,6 +26,19 @@ typedef std::vector< LC_LetterSet > LC_WordVector;
 typedef std::vector< LC_WordVector > LC_WordList;
 typedef std::multimap< std::string, uint32 > LC_WordMap;
 
+// node of the word automaton, words sharing letter sets at their start share the path
+struct LC_Node
+{
+    LC_Node() : Terminal(false) {}
+
+    std::vector< std::pair< uint32, uint32 > > Children;    // letter set id, node index
+    bool Terminal;                                          // end of word
+};
+
+typedef std::vector< LC_Node > LC_NodeList;
+typedef std::vector< std::vector< bool > > LC_LetterSetList;// letter set id -> letter id membership
+typedef UNORDERED_MAP< uint64, uint32 > LC_LetterIdMap;      // packed UTF-8 letter -> letter id, 0 for letters not in any word
+
 class LexicsCutter
 {
     protected:
@@ -33,7 +46,15 @@ class LexicsCutter
         LC_WordList WordList;
         LC_WordMap WordMap;
 
+        LC_LetterIdMap LetterIds;
+        LC_LetterSetList LetterSets;
+        LC_NodeList Nodes;                                  // [0] is root
+        std::vector< std::vector< uint32 > > RootNext;      // letter id -> nodes of words starting with it
+
         std::string InvalidChars;
+        bool InvalidChar[256];
+
+        void Build_Automaton();
 
     public:
         LexicsCutter();
@@ -44,8 +65,11 @@ class LexicsCutter
         bool Read_Letter_Analogs(std::string& FileName);
         bool Read_Innormative_Words(std::string& FileName);
         void Map_Innormative_Words();
-        bool Compare_Word(std::string& str, uint32 pos, LC_WordVector word);
-        bool Check_Lexics(std::string& Phrase);
+        bool Compare_Word(std::string& str, uint32 pos, LC_WordVector const& word) const;
+        // single pass over the phrase using the word automaton
+        bool Check_Lexics(std::string& Phrase) const;
+        // compares every word at every phrase position, reference for .debug lexicsbench
+        bool Check_Lexics_Simple(std::string& Phrase) const;
 
         std::vector< std::pair< uint32, uint32 > > Found;
         bool IgnoreMiddleSpaces;
@@ -75,6 +75,8 @@ class ChatLog : public MaNGOS::Singleton<ChatLog, MaNGOS::ClassLevelLockable<Cha
 
         void ChatBadLexicsAction(Player* player, std::string& msg);
 
+        LexicsCutter const* GetLexicsCutter() const { return Lexics; }
+
         std::string m_sLogsDir;
 
         ChatLogMethod m_uiChatLogMethod;
@@ -68,8 +68,35 @@ inline bool IsEventFlagsFitForNormalMap(uint8 eFlags)
                 (eFlags & EFLAG_DIFFICULTY_0);
 }
 
+inline EventAIUpdateKind GetEventUpdateKind(EventAI_Type type)
+{
+    switch (type)
+    {
+        case EVENT_T_TIMER_OOC:
+        case EVENT_T_TIMER_GENERIC:
+            return EVENT_UPDATE_TIMER;
+        case EVENT_T_TIMER_IN_COMBAT:
+        case EVENT_T_MANA:
+        case EVENT_T_HP:
+        case EVENT_T_TARGET_HP:
+        case EVENT_T_TARGET_CASTING:
+        case EVENT_T_FRIENDLY_HP:
+        case EVENT_T_AURA:
+        case EVENT_T_TARGET_AURA:
+        case EVENT_T_MISSING_AURA:
+        case EVENT_T_TARGET_MISSING_AURA:
+        case EVENT_T_RANGE:
+            return EVENT_UPDATE_COMBAT;
+        default:
+            return EVENT_UPDATE_NONE;
+    }
+}
+
 CreatureEventAI::CreatureEventAI(Creature* c) : CreatureAI(c),
     m_EventUpdateTime(EVENT_UPDATE_TIME),
+    m_eventTypeMask(0),
+    m_nextTimerEventDue(0),
+    m_timerEventsChanged(true),
     m_Phase(0),
     m_MeleeEnabled(true),
     m_InvinceabilityHpLevel(0),
@@ -128,6 +155,23 @@ CreatureEventAI::CreatureEventAI(Creature* c) : CreatureAI(c),
     else
         sLog.outErrorEventAI("EventMap for Creature %u is empty but creature is using CreatureEventAI.", m_creature->GetEntry());
 
+    for (uint32 kind = 0; kind < MAX_EVENT_UPDATE_KIND; ++kind)
+    {
+        m_deferredEventDiff[kind] = 0;
+        m_deferredEventMaxDiff[kind] = 0;
+    }
+
+    for (uint32 i = 0; i < m_CreatureEventAIList.size(); ++i)
+    {
+        uint32 eventType = m_CreatureEventAIList[i].Event.event_type;
+        m_eventTypeMask |= 1 << eventType;
+
+        EventAIUpdateKind kind = GetEventUpdateKind(EventAI_Type(eventType));
+        m_updateEvents[kind].push_back(i);
+        if (kind != EVENT_UPDATE_NONE)
+            m_combatUpdateEvents.push_back(i);
+    }
+
     // Handle Spawned Events, also calls Reset()
     JustRespawned();
 }
@@ -161,6 +205,8 @@ inline bool IsTimerBasedEvent(EventAI_Type type)
 
 bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pActionInvoker, Creature* pAIEventSender /*=NULL*/)
 {
+    UpdateDeferredEventTimers(GetEventUpdateKind(EventAI_Type(pHolder.Event.event_type)));
+
     if (!pHolder.Enabled || pHolder.Time)
         return false;
 
@@ -727,11 +773,13 @@ void CreatureEventAI::ProcessAction(CreatureEventAI_Action const& action, uint32
                 m_creature->SendMeleeAttackStop(m_creature->getVictim());
             break;
         case ACTION_T_SET_PHASE:
+            UpdateDeferredEventTimers();                    // deferred timers count down in phase they were deferred in
             m_Phase = action.set_phase.phase;
             DEBUG_FILTER_LOG(LOG_FILTER_EVENT_AI_DEV, "CreatureEventAI: ACTION_T_SET_PHASE - script %u for %s, phase is now %u", EventId, m_creature->GetGuidStr().c_str(), m_Phase);
             break;
         case ACTION_T_INC_PHASE:
         {
+            UpdateDeferredEventTimers();
             int32 new_phase = int32(m_Phase) + action.set_inc_phase.step;
             if (new_phase < 0)
             {
@@ -786,10 +834,12 @@ void CreatureEventAI::ProcessAction(CreatureEventAI_Action const& action, uint32
             }
             break;
         case ACTION_T_RANDOM_PHASE:
+            UpdateDeferredEventTimers();
             m_Phase = GetRandActionParam(rnd, action.random_phase.phase1, action.random_phase.phase2, action.random_phase.phase3);
             DEBUG_FILTER_LOG(LOG_FILTER_EVENT_AI_DEV, "CreatureEventAI: ACTION_T_RANDOM_PHASE - script %u for %s, phase is now %u", EventId, m_creature->GetGuidStr().c_str(), m_Phase);
             break;
         case ACTION_T_RANDOM_PHASE_RANGE:
+            UpdateDeferredEventTimers();
             if (action.random_phase_range.phaseMax > action.random_phase_range.phaseMin)
                 m_Phase = action.random_phase_range.phaseMin + (rnd % (action.random_phase_range.phaseMax - action.random_phase_range.phaseMin));
             else
@@ -973,6 +1023,8 @@ void CreatureEventAI::JustRespawned()                       // NOTE that this is
 
 void CreatureEventAI::Reset()
 {
+    UpdateDeferredEventTimers();
+
     m_EventUpdateTime = EVENT_UPDATE_TIME;
     m_EventDiff = 0;
     m_MeleeEnabled = true;
@@ -1002,10 +1054,13 @@ void CreatureEventAI::Reset()
 
 void CreatureEventAI::JustReachedHome()
 {
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+    if (HasEventType(EVENT_T_REACHED_HOME))
     {
-        if ((*i).Event.event_type == EVENT_T_REACHED_HOME)
-            ProcessEvent(*i);
+        for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+        {
+            if ((*i).Event.event_type == EVENT_T_REACHED_HOME)
+                ProcessEvent(*i);
+        }
     }
 
     Reset();
@@ -1024,10 +1079,13 @@ void CreatureEventAI::EnterEvadeMode()
     m_creature->SetLootRecipient(NULL);
 
     // Handle Evade events
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+    if (HasEventType(EVENT_T_EVADE))
     {
-        if ((*i).Event.event_type == EVENT_T_EVADE)
-            ProcessEvent(*i);
+        for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+        {
+            if ((*i).Event.event_type == EVENT_T_EVADE)
+                ProcessEvent(*i);
+        }
     }
 }
 
@@ -1046,13 +1104,17 @@ void CreatureEventAI::JustDied(Unit* killer)
         SendAIEvent(AI_EVENT_JUST_DIED, killer, 0, AIEVENT_DEFAULT_THROW_RADIUS);
 
     // Handle On Death events
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+    if (HasEventType(EVENT_T_DEATH))
     {
-        if ((*i).Event.event_type == EVENT_T_DEATH)
-            ProcessEvent(*i, killer);
+        for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+        {
+            if ((*i).Event.event_type == EVENT_T_DEATH)
+                ProcessEvent(*i, killer);
+        }
     }
 
     // reset phase after any death state events
+    UpdateDeferredEventTimers();
     m_Phase = 0;
 }
 
@@ -1061,37 +1123,49 @@ void CreatureEventAI::KilledUnit(Unit* victim)
     if (victim->GetTypeId() != TYPEID_PLAYER)
         return;
 
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+    if (HasEventType(EVENT_T_KILL))
     {
-        if ((*i).Event.event_type == EVENT_T_KILL)
-            ProcessEvent(*i, victim);
+        for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+        {
+            if ((*i).Event.event_type == EVENT_T_KILL)
+                ProcessEvent(*i, victim);
+        }
     }
 }
 
 void CreatureEventAI::JustSummoned(Creature* pUnit)
 {
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+    if (HasEventType(EVENT_T_SUMMONED_UNIT))
     {
-        if ((*i).Event.event_type == EVENT_T_SUMMONED_UNIT)
-            ProcessEvent(*i, pUnit);
+        for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+        {
+            if ((*i).Event.event_type == EVENT_T_SUMMONED_UNIT)
+                ProcessEvent(*i, pUnit);
+        }
     }
 }
 
 void CreatureEventAI::SummonedCreatureJustDied(Creature* pUnit)
 {
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+    if (HasEventType(EVENT_T_SUMMONED_JUST_DIED))
     {
-        if ((*i).Event.event_type == EVENT_T_SUMMONED_JUST_DIED)
-            ProcessEvent(*i, pUnit);
+        for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+        {
+            if ((*i).Event.event_type == EVENT_T_SUMMONED_JUST_DIED)
+                ProcessEvent(*i, pUnit);
+        }
     }
 }
 
 void CreatureEventAI::SummonedCreatureDespawn(Creature* pUnit)
 {
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+    if (HasEventType(EVENT_T_SUMMONED_JUST_DESPAWN))
     {
-        if ((*i).Event.event_type == EVENT_T_SUMMONED_JUST_DESPAWN)
-            ProcessEvent(*i, pUnit);
+        for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+        {
+            if ((*i).Event.event_type == EVENT_T_SUMMONED_JUST_DESPAWN)
+                ProcessEvent(*i, pUnit);
+        }
     }
 }
 
@@ -1099,6 +1173,9 @@ void CreatureEventAI::ReceiveAIEvent(AIEventType eventType, Creature* pSender, U
 {
     MANGOS_ASSERT(pSender);
 
+    if (!HasEventType(EVENT_T_RECEIVE_AI_EVENT))
+        return;
+
     for (CreatureEventAIList::iterator itr = m_CreatureEventAIList.begin(); itr != m_CreatureEventAIList.end(); ++itr)
     {
         if (itr->Event.event_type == EVENT_T_RECEIVE_AI_EVENT &&
@@ -1109,6 +1186,8 @@ void CreatureEventAI::ReceiveAIEvent(AIEventType eventType, Creature* pSender, U
 
 void CreatureEventAI::EnterCombat(Unit* enemy)
 {
+    UpdateDeferredEventTimers();
+
     // Check for on combat start events
     for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
     {
@@ -1157,7 +1236,7 @@ void CreatureEventAI::MoveInLineOfSight(Unit* who)
         return;
 
     // Check for OOC LOS Event
-    if (!m_creature->getVictim())
+    if (HasEventType(EVENT_T_OOC_LOS) && !m_creature->getVictim())
     {
         for (CreatureEventAIList::iterator itr = m_CreatureEventAIList.begin(); itr != m_CreatureEventAIList.end(); ++itr)
         {
@@ -1206,6 +1285,9 @@ void CreatureEventAI::MoveInLineOfSight(Unit* who)
 
 void CreatureEventAI::SpellHit(Unit* pUnit, const SpellEntry* pSpell)
 {
+    if (!HasEventType(EVENT_T_SPELLHIT))
+        return;
+
     for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
         if ((*i).Event.event_type == EVENT_T_SPELLHIT)
             // If spell id matches (or no spell id) & if spell school matches (or no spell school)
@@ -1224,30 +1306,59 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
     {
         m_EventDiff += diff;
 
+        // Out of combat only expired timer events can be processed, so the update can be deferred until one of them is due
+        if (!Combat)
+        {
+            if (m_timerEventsChanged)
+            {
+                m_nextTimerEventDue = GetNextTimerEventDue();
+                m_timerEventsChanged = false;
+            }
+
+            if (m_deferredEventDiff[EVENT_UPDATE_TIMER] + m_EventDiff < m_nextTimerEventDue)
+            {
+                for (uint32 kind = 0; kind < MAX_EVENT_UPDATE_KIND; ++kind)
+                    DeferEventTimers(EventAIUpdateKind(kind), m_EventDiff);
+
+                m_EventDiff = 0;
+                m_EventUpdateTime = EVENT_UPDATE_TIME;
+                return;
+            }
+        }
+
+        // Only events processed by this update are walked, in list order, the other timers are deferred
+        UpdateDeferredEventTimers(EVENT_UPDATE_TIMER);
+        if (Combat)
+            UpdateDeferredEventTimers(EVENT_UPDATE_COMBAT);
+
+        std::vector<uint32> const& updateEvents = Combat ? m_combatUpdateEvents : m_updateEvents[EVENT_UPDATE_TIMER];
+
         // Check for time based events
-        for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+        for (std::vector<uint32>::const_iterator itr = updateEvents.begin(); itr != updateEvents.end(); ++itr)
         {
+            CreatureEventAIHolder& holder = m_CreatureEventAIList[*itr];
+
             // Decrement Timers
-            if ((*i).Time)
+            if (holder.Time)
             {
-                if ((*i).Time > m_EventDiff)
+                if (holder.Time > m_EventDiff)
                 {
                     // Do not decrement timers if event cannot trigger in this phase
-                    if (!((*i).Event.event_inverse_phase_mask & (1 << m_Phase)))
-                        (*i).Time -= m_EventDiff;
+                    if (!(holder.Event.event_inverse_phase_mask & (1 << m_Phase)))
+                        holder.Time -= m_EventDiff;
 
                     // Skip processing of events that have time remaining
                     continue;
                 }
-                else (*i).Time = 0;
+                else holder.Time = 0;
             }
 
             // Events that are updated every EVENT_UPDATE_TIME
-            switch ((*i).Event.event_type)
+            switch (holder.Event.event_type)
             {
                 case EVENT_T_TIMER_OOC:
                 case EVENT_T_TIMER_GENERIC:
-                    ProcessEvent(*i);
+                    ProcessEvent(holder);
                     break;
                 case EVENT_T_TIMER_IN_COMBAT:
                 case EVENT_T_MANA:
@@ -1259,22 +1370,23 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
                 case EVENT_T_TARGET_AURA:
                 case EVENT_T_MISSING_AURA:
                 case EVENT_T_TARGET_MISSING_AURA:
-                    if (Combat)
-                        ProcessEvent(*i);
+                    ProcessEvent(holder);
                     break;
                 case EVENT_T_RANGE:
-                    if (Combat)
-                    {
-                        if (m_creature->getVictim() && m_creature->IsInMap(m_creature->getVictim()))
-                            if (m_creature->IsInRange(m_creature->getVictim(), (float)(*i).Event.range.minDist, (float)(*i).Event.range.maxDist))
-                                ProcessEvent(*i);
-                    }
+                    if (m_creature->getVictim() && m_creature->IsInMap(m_creature->getVictim()))
+                        if (m_creature->IsInRange(m_creature->getVictim(), (float)holder.Event.range.minDist, (float)holder.Event.range.maxDist))
+                            ProcessEvent(holder);
                     break;
             }
         }
 
+        if (!Combat)
+            DeferEventTimers(EVENT_UPDATE_COMBAT, m_EventDiff);
+        DeferEventTimers(EVENT_UPDATE_NONE, m_EventDiff);
+
         m_EventDiff = 0;
         m_EventUpdateTime = EVENT_UPDATE_TIME;
+        m_timerEventsChanged = true;
     }
     else
     {
@@ -1287,6 +1399,72 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
         DoMeleeAttackIfReady();
 }
 
+/// Applies the event updates skipped by UpdateAI() to all event timers, as if each had been done in time
+void CreatureEventAI::UpdateDeferredEventTimers()
+{
+    for (uint32 kind = 0; kind < MAX_EVENT_UPDATE_KIND; ++kind)
+        UpdateDeferredEventTimers(EventAIUpdateKind(kind));
+}
+
+/// Applies the event updates skipped by UpdateAI() to the timers of one kind of events
+void CreatureEventAI::UpdateDeferredEventTimers(EventAIUpdateKind kind)
+{
+    m_timerEventsChanged = true;
+
+    uint32 deferredDiff = m_deferredEventDiff[kind];
+    if (!deferredDiff)
+        return;
+
+    uint32 deferredMaxDiff = m_deferredEventMaxDiff[kind];
+    for (std::vector<uint32>::const_iterator itr = m_updateEvents[kind].begin(); itr != m_updateEvents[kind].end(); ++itr)
+    {
+        CreatureEventAIHolder& holder = m_CreatureEventAIList[*itr];
+        if (!holder.Time)
+            continue;
+
+        // Timers of events that cannot trigger in this phase are not decremented, but still expire if below one update diff
+        if (holder.Event.event_inverse_phase_mask & (1 << m_Phase))
+        {
+            if (holder.Time <= deferredMaxDiff)
+                holder.Time = 0;
+        }
+        else if (holder.Time > deferredDiff)
+            holder.Time -= deferredDiff;
+        else
+            holder.Time = 0;
+    }
+
+    m_deferredEventDiff[kind] = 0;
+    m_deferredEventMaxDiff[kind] = 0;
+}
+
+void CreatureEventAI::DeferEventTimers(EventAIUpdateKind kind, uint32 diff)
+{
+    m_deferredEventDiff[kind] += diff;
+    if (diff > m_deferredEventMaxDiff[kind])
+        m_deferredEventMaxDiff[kind] = diff;
+}
+
+/// Returns the deferred diff after which an out of combat event update would process a timer event
+uint32 CreatureEventAI::GetNextTimerEventDue() const
+{
+    uint32 nextDue = std::numeric_limits<uint32>::max();
+
+    for (std::vector<uint32>::const_iterator itr = m_updateEvents[EVENT_UPDATE_TIMER].begin(); itr != m_updateEvents[EVENT_UPDATE_TIMER].end(); ++itr)
+    {
+        CreatureEventAIHolder const& holder = m_CreatureEventAIList[*itr];
+
+        // Disabled or phase masked events are rejected by ProcessEvent() and only need their timers updated
+        if (!holder.Enabled || (holder.Event.event_inverse_phase_mask & (1 << m_Phase)))
+            continue;
+
+        if (holder.Time < nextDue)
+            nextDue = holder.Time;
+    }
+
+    return nextDue;
+}
+
 bool CreatureEventAI::IsVisible(Unit* pl) const
 {
     return m_creature->IsWithinDist(pl, sWorld.getConfig(CONFIG_FLOAT_SIGHT_MONSTER))
@@ -1454,6 +1632,9 @@ void CreatureEventAI::DoFindFriendlyMissingBuff(std::list<Creature*>& _list, flo
 
 void CreatureEventAI::ReceiveEmote(Player* pPlayer, uint32 text_emote)
 {
+    if (!HasEventType(EVENT_T_RECEIVE_EMOTE))
+        return;
+
     for (CreatureEventAIList::iterator itr = m_CreatureEventAIList.begin(); itr != m_CreatureEventAIList.end(); ++itr)
     {
         if ((*itr).Event.event_type == EVENT_T_RECEIVE_EMOTE)
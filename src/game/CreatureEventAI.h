@@ -600,6 +600,15 @@ struct CreatureEventAI_Summon
 // EventSummon_Map
 typedef UNORDERED_MAP<uint32, CreatureEventAI_Summon> CreatureEventAI_Summon_Map;
 
+// Kinds of events by how UpdateAI() handles them, each kind has its own index list and deferred timer update
+enum EventAIUpdateKind
+{
+    EVENT_UPDATE_TIMER      = 0,                            // EVENT_T_TIMER_OOC and EVENT_T_TIMER_GENERIC, processed in and out of combat
+    EVENT_UPDATE_COMBAT     = 1,                            // In combat timer, HP, mana, aura, casting and range events, processed in combat
+    EVENT_UPDATE_NONE       = 2,                            // Events processed by notifications, UpdateAI() only counts down their timers
+    MAX_EVENT_UPDATE_KIND
+};
+
 struct CreatureEventAIHolder
 {
     CreatureEventAIHolder(CreatureEventAI_Event p) : Event(p), Time(0), Enabled(true) {}
@@ -659,12 +668,27 @@ class MANGOS_DLL_SPEC CreatureEventAI : public CreatureAI
         void DoFindFriendlyCC(std::list<Creature*>& _list, float range);
 
     protected:
+        bool HasEventType(EventAI_Type type) const { return m_eventTypeMask & (1 << type); }
+        void UpdateDeferredEventTimers();
+        void UpdateDeferredEventTimers(EventAIUpdateKind kind);
+        void DeferEventTimers(EventAIUpdateKind kind, uint32 diff);
+        uint32 GetNextTimerEventDue() const;
+
         uint32 m_EventUpdateTime;                           // Time between event updates
         uint32 m_EventDiff;                                 // Time between the last event call
 
         // Variables used by Events themselves
         typedef std::vector<CreatureEventAIHolder> CreatureEventAIList;
         CreatureEventAIList m_CreatureEventAIList;          // Holder for events (stores enabled, time, and eventid)
+        uint32 m_eventTypeMask;                             // Bitmask of EventAI_Type present in m_CreatureEventAIList
+        std::vector<uint32> m_updateEvents[MAX_EVENT_UPDATE_KIND];  // Indexes of events of each EventAIUpdateKind, in list order
+        std::vector<uint32> m_combatUpdateEvents;           // Indexes of EVENT_UPDATE_TIMER and EVENT_UPDATE_COMBAT events, in list order
+
+        // Timer updates of events not handled by an event update are deferred, see UpdateAI()
+        uint32 m_deferredEventDiff[MAX_EVENT_UPDATE_KIND];  // Sum of event update diffs not applied to the timers yet
+        uint32 m_deferredEventMaxDiff[MAX_EVENT_UPDATE_KIND];   // Largest single event update diff of them
+        uint32 m_nextTimerEventDue;                         // Deferred diff at which the first timer event must be processed
+        bool m_timerEventsChanged;                          // Events were touched since m_nextTimerEventDue was calculated
 
         uint8  m_Phase;                                     // Current phase, max 32 phases
         bool   m_MeleeEnabled;                              // If we allow melee auto attack
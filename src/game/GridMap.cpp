@@ -32,6 +32,9 @@
 #include "Policies/Singleton.h"
 #include "Util.h"
 
+#include <ace/Mem_Map.h>
+#include <ace/OS_NS_sys_mman.h>
+
 char const* MAP_MAGIC         = "MAPS";
 char const* MAP_VERSION_MAGIC = "v1.3";
 char const* MAP_AREA_MAGIC    = "AREA";
@@ -42,6 +45,10 @@ GridMap::GridMap()
 {
     m_flags = 0;
 
+    m_mappedFile = NULL;
+    m_fileData = NULL;
+    m_fileSize = 0;
+
     // Area data
     m_gridArea = 0;
     m_area_map = NULL;
@@ -69,74 +76,158 @@ GridMap::~GridMap()
     unloadData();
 }
 
+bool GridMap::openFileData(char const* filename, bool useMapping)
+{
+    if (useMapping)
+    {
+        // read-only private mapping, pages are shared by all processes using same map files
+        m_mappedFile = new ACE_Mem_Map();
+        if (m_mappedFile->map(filename, static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ, ACE_MAP_PRIVATE) == 0 &&
+            m_mappedFile->addr() != MAP_FAILED && m_mappedFile->size() > 0)
+        {
+            m_fileData = static_cast<uint8*>(m_mappedFile->addr());
+            m_fileSize = uint32(m_mappedFile->size());
+            // mapping stays valid without the descriptor, don't keep one open per loaded grid
+            m_mappedFile->close_handle();
+            return true;
+        }
+
+        // fall back to read file at mapping failure
+        delete m_mappedFile;
+        m_mappedFile = NULL;
+    }
+
+    FILE* in = fopen(filename, "rb");
+    if (!in)
+        return false;
+
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+
+    if (size <= 0)
+    {
+        fclose(in);
+        return false;
+    }
+
+    m_fileData = new uint8[size];
+    m_fileSize = uint32(size);
+
+    if (fread(m_fileData, 1, m_fileSize, in) != m_fileSize)
+    {
+        fclose(in);
+        closeFileData();
+        return false;
+    }
+
+    fclose(in);
+    return true;
+}
+
+void GridMap::closeFileData()
+{
+    if (m_mappedFile)
+    {
+        m_mappedFile->close();
+        delete m_mappedFile;
+        m_mappedFile = NULL;
+    }
+    else
+        delete[] m_fileData;
+
+    m_fileData = NULL;
+    m_fileSize = 0;
+}
+
+bool GridMap::readFileHeader(void* header, uint32 offset, uint32 size) const
+{
+    if (offset > m_fileSize || size > m_fileSize - offset)
+        return false;
+
+    memcpy(header, m_fileData + offset, size);
+    return true;
+}
+
+void* GridMap::getFileArray(uint32 offset, uint32 size, uint32 alignment)
+{
+    if (offset > m_fileSize || size > m_fileSize - offset)
+        return NULL;
+
+    // arrays are used in place if aligned for element access, else copied
+    uint8* data = m_fileData + offset;
+    if ((reinterpret_cast<size_t>(data) & (alignment - 1)) == 0)
+        return data;
+
+    uint8* copy = new uint8[size];
+    memcpy(copy, data, size);
+    return copy;
+}
+
+void GridMap::freeFileArray(void* data)
+{
+    // only copied arrays are owned, others are part of file data
+    if (data && (static_cast<uint8*>(data) < m_fileData || static_cast<uint8*>(data) >= m_fileData + m_fileSize))
+        delete[] static_cast<uint8*>(data);
+}
+
 bool GridMap::loadData(char* filename)
 {
     // Unload old data if exist
     unloadData();
 
-    GridMapFileHeader header;
     // Not return error if file not found
-    FILE* in = fopen(filename, "rb");
-    if (!in)
+    if (!openFileData(filename, sWorld.getConfig(CONFIG_BOOL_GRID_MAP_MEMORY_MAPPED)))
         return true;
 
-    fread(&header, sizeof(header), 1, in);
-    if (header.mapMagic     == *((uint32 const*)(MAP_MAGIC)) &&
+    GridMapFileHeader header;
+    if (readFileHeader(&header, 0, sizeof(header)) &&
+            header.mapMagic     == *((uint32 const*)(MAP_MAGIC)) &&
             header.versionMagic == *((uint32 const*)(MAP_VERSION_MAGIC)) &&
             IsAcceptableClientBuild(header.buildMagic))
     {
         // loadup area data
-        if (header.areaMapOffset && !loadAreaData(in, header.areaMapOffset, header.areaMapSize))
+        if (header.areaMapOffset && !loadAreaData(header.areaMapOffset, header.areaMapSize))
         {
             sLog.outError("Error loading map area data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
 
         // loadup height data
-        if (header.heightMapOffset && !loadHeightData(in, header.heightMapOffset, header.heightMapSize))
+        if (header.heightMapOffset && !loadHeightData(header.heightMapOffset, header.heightMapSize))
         {
             sLog.outError("Error loading map height data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
 
         // loadup liquid data
-        if (header.liquidMapOffset && !loadGridMapLiquidData(in, header.liquidMapOffset, header.liquidMapSize))
+        if (header.liquidMapOffset && !loadGridMapLiquidData(header.liquidMapOffset, header.liquidMapSize))
         {
             sLog.outError("Error loading map liquids data\n");
-            fclose(in);
+            unloadData();
             return false;
         }
 
-        fclose(in);
         return true;
     }
 
     sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.", filename);
-    fclose(in);
+    unloadData();
     return false;
 }
 
 void GridMap::unloadData()
 {
-    if (m_area_map)
-        delete[] m_area_map;
-
-    if (m_V9)
-        delete[] m_V9;
-
-    if (m_V8)
-        delete[] m_V8;
+    freeFileArray(m_area_map);
+    freeFileArray(m_V9);
+    freeFileArray(m_V8);
+    freeFileArray(m_liquidEntry);
+    freeFileArray(m_liquidFlags);
+    freeFileArray(m_liquid_map);
 
-    if (m_liquidEntry)
-        delete[] m_liquidEntry;
-
-    if (m_liquidFlags)
-        delete[] m_liquidFlags;
-
-    if (m_liquid_map)
-        delete[] m_liquid_map;
+    closeFileData();
 
     m_area_map = NULL;
     m_V9 = NULL;
@@ -147,61 +238,59 @@ void GridMap::unloadData()
     m_gridGetHeight = &GridMap::getHeightFromFlat;
 }
 
-bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadAreaData(uint32 offset, uint32 /*size*/)
 {
     GridMapAreaHeader header;
-    fseek(in, offset, SEEK_SET);
-    fread(&header, sizeof(header), 1, in);
-    if (header.fourcc != *((uint32 const*)(MAP_AREA_MAGIC)))
+    if (!readFileHeader(&header, offset, sizeof(header)) ||
+        header.fourcc != *((uint32 const*)(MAP_AREA_MAGIC)))
         return false;
 
     m_gridArea = header.gridArea;
     if (!(header.flags & MAP_AREA_NO_AREA))
     {
-        m_area_map = new uint16 [16 * 16];
-        fread(m_area_map, sizeof(uint16), 16 * 16, in);
+        m_area_map = (uint16*)getFileArray(offset + sizeof(header), sizeof(uint16) * 16 * 16, sizeof(uint16));
+        if (!m_area_map)
+            return false;
     }
 
     return true;
 }
 
-bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadHeightData(uint32 offset, uint32 /*size*/)
 {
     GridMapHeightHeader header;
-    fseek(in, offset, SEEK_SET);
-    fread(&header, sizeof(header), 1, in);
-    if (header.fourcc != *((uint32 const*)(MAP_HEIGHT_MAGIC)))
+    if (!readFileHeader(&header, offset, sizeof(header)) ||
+        header.fourcc != *((uint32 const*)(MAP_HEIGHT_MAGIC)))
         return false;
 
+    offset += sizeof(header);
+
     m_gridHeight = header.gridHeight;
     if (!(header.flags & MAP_HEIGHT_NO_HEIGHT))
     {
         if ((header.flags & MAP_HEIGHT_AS_INT16))
         {
-            m_uint16_V9 = new uint16 [129 * 129];
-            m_uint16_V8 = new uint16 [128 * 128];
-            fread(m_uint16_V9, sizeof(uint16), 129 * 129, in);
-            fread(m_uint16_V8, sizeof(uint16), 128 * 128, in);
+            m_uint16_V9 = (uint16*)getFileArray(offset, sizeof(uint16) * 129 * 129, sizeof(uint16));
+            m_uint16_V8 = (uint16*)getFileArray(offset + sizeof(uint16) * 129 * 129, sizeof(uint16) * 128 * 128, sizeof(uint16));
             m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
             m_gridGetHeight = &GridMap::getHeightFromUint16;
         }
         else if ((header.flags & MAP_HEIGHT_AS_INT8))
         {
-            m_uint8_V9 = new uint8 [129 * 129];
-            m_uint8_V8 = new uint8 [128 * 128];
-            fread(m_uint8_V9, sizeof(uint8), 129 * 129, in);
-            fread(m_uint8_V8, sizeof(uint8), 128 * 128, in);
+            m_uint8_V9 = (uint8*)getFileArray(offset, sizeof(uint8) * 129 * 129, sizeof(uint8));
+            m_uint8_V8 = (uint8*)getFileArray(offset + sizeof(uint8) * 129 * 129, sizeof(uint8) * 128 * 128, sizeof(uint8));
             m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
             m_gridGetHeight = &GridMap::getHeightFromUint8;
         }
         else
         {
-            m_V9 = new float [129 * 129];
-            m_V8 = new float [128 * 128];
-            fread(m_V9, sizeof(float), 129 * 129, in);
-            fread(m_V8, sizeof(float), 128 * 128, in);
+            m_V9 = (float*)getFileArray(offset, sizeof(float) * 129 * 129, sizeof(float));
+            m_V8 = (float*)getFileArray(offset + sizeof(float) * 129 * 129, sizeof(float) * 128 * 128, sizeof(float));
             m_gridGetHeight = &GridMap::getHeightFromFloat;
         }
+
+        if (!m_V9 || !m_V8)
+            return false;
     }
     else
         m_gridGetHeight = &GridMap::getHeightFromFlat;
@@ -209,14 +298,15 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     return true;
 }
 
-bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
+bool GridMap::loadGridMapLiquidData(uint32 offset, uint32 /*size*/)
 {
     GridMapLiquidHeader header;
-    fseek(in, offset, SEEK_SET);
-    fread(&header, sizeof(header), 1, in);
-    if (header.fourcc != *((uint32 const*)(MAP_LIQUID_MAGIC)))
+    if (!readFileHeader(&header, offset, sizeof(header)) ||
+        header.fourcc != *((uint32 const*)(MAP_LIQUID_MAGIC)))
         return false;
 
+    offset += sizeof(header);
+
     m_liquidType    = header.liquidType;
     m_liquid_offX   = header.offsetX;
     m_liquid_offY   = header.offsetY;
@@ -226,17 +316,21 @@ bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
 
     if (!(header.flags & MAP_LIQUID_NO_TYPE))
     {
-        m_liquidEntry = new uint16[16*16];
-        fread(m_liquidEntry, sizeof(uint16), 16*16, in);
+        m_liquidEntry = (uint16*)getFileArray(offset, sizeof(uint16) * 16 * 16, sizeof(uint16));
+        offset += sizeof(uint16) * 16 * 16;
+
+        m_liquidFlags = (uint8*)getFileArray(offset, sizeof(uint8) * 16 * 16, sizeof(uint8));
+        offset += sizeof(uint8) * 16 * 16;
 
-        m_liquidFlags = new uint8[16*16];
-        fread(m_liquidFlags, sizeof(uint8), 16*16, in);
+        if (!m_liquidEntry || !m_liquidFlags)
+            return false;
     }
 
     if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
     {
-        m_liquid_map = new float [m_liquid_width * m_liquid_height];
-        fread(m_liquid_map, sizeof(float), m_liquid_width * m_liquid_height, in);
+        m_liquid_map = (float*)getFileArray(offset, sizeof(float) * m_liquid_width * m_liquid_height, sizeof(float));
+        if (!m_liquid_map)
+            return false;
     }
 
     return true;
@@ -783,6 +877,29 @@ int TerrainInfo::UnrefGrid(const uint32& x, const uint32& y)
     return 0;
 }
 
+// mapHeight set for any above raw ground Z or <= INVALID_HEIGHT
+// vmapheight set for any under Z value or <= INVALID_HEIGHT
+inline float SelectStaticHeight(float z, float mapHeight, float vmapHeight)
+{
+    if (vmapHeight > INVALID_HEIGHT)
+    {
+        if (mapHeight > INVALID_HEIGHT)
+        {
+            // we have mapheight and vmapheight and must select more appropriate
+
+            // we are already under the surface or vmap height above map heigt
+            if (z < mapHeight || vmapHeight > mapHeight)
+                return vmapHeight;
+            else
+                return mapHeight;                           // better use .map surface height
+        }
+        else
+            return vmapHeight;                              // we have only vmapHeight (if have)
+    }
+
+    return mapHeight;
+}
+
 float TerrainInfo::GetHeightStatic(float x, float y, float z, bool useVmaps/*=true*/, float maxSearchDist/*=DEFAULT_HEIGHT_SEARCH*/) const
 {
     float mapHeight = VMAP_INVALID_HEIGHT_VALUE;            // Store Height obtained by maps
@@ -818,25 +935,97 @@ float TerrainInfo::GetHeightStatic(float x, float y, float z, bool useVmaps/*=tr
         }
     }
 
-    // mapHeight set for any above raw ground Z or <= INVALID_HEIGHT
-    // vmapheight set for any under Z value or <= INVALID_HEIGHT
-    if (vmapHeight > INVALID_HEIGHT)
+    return SelectStaticHeight(z, mapHeight, vmapHeight);
+}
+
+void TerrainInfo::GetHeightStatic(VMAP::HeightQuery const* points, uint32 count, float* heights, bool useVmaps/*=true*/) const
+{
+    // find raw .map surface, points are usually close to each other so remember last grid
+    int lastGx = -1, lastGy = -1;
+    GridMap* gmap = NULL;
+    for (uint32 i = 0; i < count; ++i)
     {
-        if (mapHeight > INVALID_HEIGHT)
+        int gx = (int)(32 - points[i].x / SIZE_OF_GRIDS);
+        int gy = (int)(32 - points[i].y / SIZE_OF_GRIDS);
+        if (gx != lastGx || gy != lastGy)
         {
-            // we have mapheight and vmapheight and must select more appropriate
+            gmap = const_cast<TerrainInfo*>(this)->GetGrid(points[i].x, points[i].y);
+            lastGx = gx;
+            lastGy = gy;
+        }
 
-            // we are already under the surface or vmap height above map heigt
-            if (z < mapHeight || vmapHeight > mapHeight)
-                return vmapHeight;
-            else
-                return mapHeight;                           // better use .map surface height
+        heights[i] = gmap ? gmap->getHeight(points[i].x, points[i].y) : VMAP_INVALID_HEIGHT_VALUE;
+    }
+
+    if (!useVmaps || !count)
+        return;
+
+    VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
+    if (!vmgr || !vmgr->isHeightCalcEnabled())
+        return;
+
+    // same search stages as single point version, each stage is one batched vmap call for all points still without height
+    std::vector<VMAP::HeightQuery> queries(count);
+    std::vector<float> vmapHeights(count, VMAP_INVALID_HEIGHT_VALUE);
+    std::vector<uint32> pending;
+    pending.reserve(count);
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        VMAP::HeightQuery& query = queries[i];
+        query.x = points[i].x;
+        query.y = points[i].y;
+        query.z = points[i].z + 2.0f;
+        query.maxSearchDist = points[i].maxSearchDist;
+        if (heights[i] > INVALID_HEIGHT && query.z - heights[i] > query.maxSearchDist)
+            query.maxSearchDist = query.z - heights[i] + 1.0f;
+    }
+    vmgr->getHeight(GetMapId(), &queries[0], count, &vmapHeights[0]);
+
+    // not found in expected range, look for infinity range
+    std::vector<VMAP::HeightQuery> retry;
+    retry.reserve(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (vmapHeights[i] > INVALID_HEIGHT)
+            continue;
+
+        pending.push_back(i);
+        retry.push_back(queries[i]);
+        retry.back().maxSearchDist = 10000.0f;
+    }
+
+    if (!pending.empty())
+    {
+        std::vector<float> retryHeights(pending.size());
+        vmgr->getHeight(GetMapId(), &retry[0], retry.size(), &retryHeights[0]);
+
+        // still not found, look near terrain height
+        retry.clear();
+        std::vector<uint32> nearTerrain;
+        for (uint32 j = 0; j < pending.size(); ++j)
+        {
+            uint32 i = pending[j];
+            vmapHeights[i] = retryHeights[j];
+            if (vmapHeights[i] <= INVALID_HEIGHT && heights[i] > INVALID_HEIGHT && queries[i].z < heights[i])
+            {
+                nearTerrain.push_back(i);
+                retry.push_back(queries[i]);
+                retry.back().z = heights[i] + 2.0f;
+                retry.back().maxSearchDist = DEFAULT_HEIGHT_SEARCH;
+            }
+        }
+
+        if (!nearTerrain.empty())
+        {
+            vmgr->getHeight(GetMapId(), &retry[0], retry.size(), &retryHeights[0]);
+            for (uint32 j = 0; j < nearTerrain.size(); ++j)
+                vmapHeights[nearTerrain[j]] = retryHeights[j];
         }
-        else
-            return vmapHeight;                              // we have only vmapHeight (if have)
     }
 
-    return mapHeight;
+    for (uint32 i = 0; i < count; ++i)
+        heights[i] = SelectStaticHeight(points[i].z, heights[i], vmapHeights[i]);
 }
 
 inline bool IsOutdoorWMO(uint32 mogpFlags, int32 adtId, int32 rootId, int32 groupId,
@@ -36,6 +36,12 @@ class InstanceData;
 class Group;
 class BattleGround;
 class Map;
+class ACE_Mem_Map;
+
+namespace VMAP
+{
+    struct HeightQuery;
+}
 
 struct GridMapFileHeader
 {
@@ -153,9 +159,20 @@ class GridMap
         uint8* m_liquidFlags;
         float *m_liquid_map;
 
-        bool loadAreaData(FILE *in, uint32 offset, uint32 size);
-        bool loadHeightData(FILE *in, uint32 offset, uint32 size);
-        bool loadGridMapLiquidData(FILE *in, uint32 offset, uint32 size);
+        // Whole .map file, mapped read-only or read to heap; data arrays point into it when aligned
+        ACE_Mem_Map* m_mappedFile;
+        uint8* m_fileData;
+        uint32 m_fileSize;
+
+        bool openFileData(char const* filename, bool useMapping);
+        void closeFileData();
+        bool readFileHeader(void* header, uint32 offset, uint32 size) const;
+        void* getFileArray(uint32 offset, uint32 size, uint32 alignment);
+        void freeFileArray(void* data);
+
+        bool loadAreaData(uint32 offset, uint32 size);
+        bool loadHeightData(uint32 offset, uint32 size);
+        bool loadGridMapLiquidData(uint32 offset, uint32 size);
 
         // Get height functions and pointers
         typedef float (GridMap::*pGetHeightPtr) (float x, float y) const;
@@ -214,6 +231,8 @@ public:
     // TODO: move all terrain/vmaps data info query functions
     // from 'Map' class into this class
     float GetHeightStatic(float x, float y, float z, bool pCheckVMap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
+    // same as above for a set of points, grid and vmap tree are resolved once per set
+    void GetHeightStatic(VMAP::HeightQuery const* points, uint32 count, float* heights, bool pCheckVMap = true) const;
     float GetWaterLevel(float x, float y, float z, float* pGround = NULL) const;
     float GetWaterOrGroundLevel(float x, float y, float z, float* pGround = NULL, bool swim = false) const;
     bool IsInWater(float x, float y, float z, GridMapLiquidData* data = 0, float min_depth = 2.0f) const;
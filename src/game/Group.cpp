@@ -36,6 +36,7 @@
 #include "LootMgr.h"
 #include "LFGMgr.h"
 #include "UpdateFieldFlags.h"
+#include "SharedPayloadPacket.h"
 
 // Playerbot
 #include "playerbot/PlayerbotMgr.h"
@@ -1198,6 +1199,8 @@ void Group::UpdatePlayerOutOfRange(Player* pPlayer)
 
 void Group::BroadcastPacket(WorldPacket *packet, bool ignorePlayersInBGRaid, int group, ObjectGuid ignore)
 {
+    SharedPayloadPacket broadcast(*packet);
+
     for(GroupReference *itr = GetFirstMember(); itr != NULL; itr = itr->next())
     {
         Player *pl = itr->getSource();
@@ -1205,7 +1208,7 @@ void Group::BroadcastPacket(WorldPacket *packet, bool ignorePlayersInBGRaid, int
             continue;
 
         if (pl->GetSession() && (group == -1 || itr->getSubGroup() == group))
-            pl->GetSession()->SendPacket(packet);
+            pl->GetSession()->SendPacket(broadcast);
     }
 }
 
@@ -30,6 +30,7 @@
 #include "Language.h"
 #include "World.h"
 #include "Calendar.h"
+#include "SharedPayloadPacket.h"
 
 //// MemberSlot ////////////////////////////////////////////
 void MemberSlot::SetMemberStats(Player* player)
@@ -568,13 +569,14 @@ void Guild::BroadcastToGuild(WorldSession* session, const std::string& msg, uint
     {
         WorldPacket data;
         ChatHandler::FillMessageData(&data, session, CHAT_MSG_GUILD, language, msg.c_str());
+        SharedPayloadPacket broadcast(data);
 
         for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
         {
             Player* pl = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
 
             if (pl && pl->GetSession() && HasRankRight(pl->GetRank(), GR_RIGHT_GCHATLISTEN) && !pl->GetSocial()->HasIgnore(session->GetPlayer()->GetObjectGuid()))
-                pl->GetSession()->SendPacket(&data);
+                pl->GetSession()->SendPacket(broadcast);
         }
     }
 }
@@ -598,23 +600,27 @@ void Guild::BroadcastToOfficers(WorldSession* session, const std::string& msg, u
 
 void Guild::BroadcastPacket(WorldPacket* packet)
 {
+    SharedPayloadPacket broadcast(*packet);
+
     for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
     {
         Player* player = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
         if (player)
-            player->GetSession()->SendPacket(packet);
+            player->GetSession()->SendPacket(broadcast);
     }
 }
 
 void Guild::BroadcastPacketToRank(WorldPacket* packet, uint32 rankId)
 {
+    SharedPayloadPacket broadcast(*packet);
+
     for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
     {
         if (itr->second.RankId == rankId)
         {
             Player* player = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
             if (player)
-                player->GetSession()->SendPacket(packet);
+                player->GetSession()->SendPacket(broadcast);
         }
     }
 }
@@ -2142,7 +2148,7 @@ void Guild::MoveFromBankToChar(Player* pl, uint8 BankTab, uint8 BankTabSlot, uin
             return;
         }
 
-        CharacterDatabase.BeginTransaction();
+        CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);  // guild bank is shared with other players
         LogBankEvent(GUILD_BANK_LOG_WITHDRAW_ITEM, BankTab, pl->GetGUIDLow(), pItemBank->GetEntry(), SplitedAmount);
 
         pItemBank->SetCount(pItemBank->GetCount() - SplitedAmount);
@@ -2165,7 +2171,7 @@ void Guild::MoveFromBankToChar(Player* pl, uint8 BankTab, uint8 BankTabSlot, uin
             if (remRight <= 0)
                 return;
 
-            CharacterDatabase.BeginTransaction();
+            CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);
             LogBankEvent(GUILD_BANK_LOG_WITHDRAW_ITEM, BankTab, pl->GetGUIDLow(), pItemBank->GetEntry(), pItemBank->GetCount());
 
             RemoveItem(BankTab, BankTabSlot);
@@ -2226,7 +2232,7 @@ void Guild::MoveFromBankToChar(Player* pl, uint8 BankTab, uint8 BankTabSlot, uin
                 }
             }
 
-            CharacterDatabase.BeginTransaction();
+            CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);
             LogBankEvent(GUILD_BANK_LOG_WITHDRAW_ITEM, BankTab, pl->GetGUIDLow(), pItemBank->GetEntry(), pItemBank->GetCount());
             if (pItemChar)
                 LogBankEvent(GUILD_BANK_LOG_DEPOSIT_ITEM, BankTab, pl->GetGUIDLow(), pItemChar->GetEntry(), pItemChar->GetCount());
@@ -2300,7 +2306,7 @@ void Guild::MoveFromCharToBank(Player* pl, uint8 PlayerBag, uint8 PlayerSlot, ui
                             pItemChar->GetProto()->Name1, pItemChar->GetEntry(), SplitedAmount, m_Id);
         }
 
-        CharacterDatabase.BeginTransaction();
+        CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);  // guild bank is shared with other players
         LogBankEvent(GUILD_BANK_LOG_DEPOSIT_ITEM, BankTab, pl->GetGUIDLow(), pItemChar->GetEntry(), SplitedAmount);
 
         pl->ItemRemovedQuestCheck(pItemChar->GetEntry(), SplitedAmount);
@@ -2327,7 +2333,7 @@ void Guild::MoveFromCharToBank(Player* pl, uint8 PlayerBag, uint8 PlayerSlot, ui
                                 m_Id);
             }
 
-            CharacterDatabase.BeginTransaction();
+            CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);
             LogBankEvent(GUILD_BANK_LOG_DEPOSIT_ITEM, BankTab, pl->GetGUIDLow(), pItemChar->GetEntry(), pItemChar->GetCount());
 
             pl->MoveItemFromInventory(PlayerBag, PlayerSlot, true);
@@ -2377,7 +2383,7 @@ void Guild::MoveFromCharToBank(Player* pl, uint8 PlayerBag, uint8 PlayerSlot, ui
                                 m_Id);
             }
 
-            CharacterDatabase.BeginTransaction();
+            CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);
             if (pItemBank)
                 LogBankEvent(GUILD_BANK_LOG_WITHDRAW_ITEM, BankTab, pl->GetGUIDLow(), pItemBank->GetEntry(), pItemBank->GetCount());
             LogBankEvent(GUILD_BANK_LOG_DEPOSIT_ITEM, BankTab, pl->GetGUIDLow(), pItemChar->GetEntry(), pItemChar->GetCount());
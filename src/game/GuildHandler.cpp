@@ -911,7 +911,7 @@ void WorldSession::HandleGuildBankDepositMoney(WorldPacket& recv_data)
     if (!pGuild->GetPurchasedTabs())
         return;
 
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);  // guild bank is shared with other players
 
     pGuild->SetBankMoney(pGuild->GetGuildBankMoney() + money);
     GetPlayer()->ModifyMoney(-int(money));
@@ -965,7 +965,7 @@ void WorldSession::HandleGuildBankWithdrawMoney(WorldPacket& recv_data)
     if (!pGuild->HasRankRight(GetPlayer()->GetRank(), GR_RIGHT_WITHDRAW_GOLD))
         return;
 
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);  // guild bank is shared with other players
 
     if (!pGuild->MemberMoneyWithdraw(money, GetPlayer()->GetGUIDLow()))
     {
@@ -847,6 +847,7 @@ void Item::AddToUpdateQueueOf(Player* player)
 
     player->m_itemUpdateQueue.push_back(this);
     m_queuePos = player->m_itemUpdateQueue.size() - 1;
+    player->MarkSaveSectionDirty(PLAYER_SAVE_ITEMS);
 }
 
 void Item::RemoveFromUpdateQueueOf(Player* player)
@@ -5624,6 +5624,11 @@ bool ChatHandler::HandleMmapStatsCommand(char* /*args*/)
 
     MMAP::MMapManager* manager = MMAP::MMapFactory::createOrGetMMapManager();
     PSendSysMessage(" %u maps loaded with %u tiles overall", manager->getLoadedMapsCount(), manager->getLoadedTilesCount());
+    PSendSysMessage(" path cache: %u hits, %u misses", manager->getPathCacheHits(), manager->getPathCacheMisses());
+    if (sPathFinderWorkers.activated())
+        PSendSysMessage(" path workers: %u paths calculated, %u queued", sPathFinderWorkers.GetCalculatedCount(), sPathFinderWorkers.GetQueuedCount());
+    else
+        PSendSysMessage(" path workers disabled");
 
     const dtNavMesh* navmesh = manager->GetNavMesh(m_session->GetPlayer()->GetMapId());
     if (!navmesh)
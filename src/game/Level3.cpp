@@ -1087,6 +1087,7 @@ bool ChatHandler::HandleReloadLocalesItemCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Locales Item ... ");
     sObjectMgr.LoadItemLocales();
+    sAuctionMgr.ClearItemNameCache();
     SendGlobalSysMessage("DB table `locales_item` reloaded.");
     return true;
 }
@@ -5295,6 +5296,106 @@ bool ChatHandler::HandleResetAllCommand(char* args)
     return true;
 }
 
+static void ShowDatabaseAsyncStats(ChatHandler* handler, char const* name, Database& db)
+{
+    SqlDelayStats stats;
+    db.GetAsyncStats(stats);
+
+    handler->PSendSysMessage("%s: async connections %u, queued %u (max %u), executed " UI64FMTD ", coalesced rows " UI64FMTD,
+        name, db.GetAsyncConnectionsCount(), stats.queueDepth, stats.maxQueueDepth, stats.executed, db.GetCoalescedRows());
+    handler->PSendSysMessage("%s: queue wait avg %u ms (max %u ms), execution avg %u ms",
+        name, stats.executed ? uint32(stats.totalWaitTime / stats.executed) : 0, stats.maxWaitTime,
+        stats.executed ? uint32(stats.totalExecTime / stats.executed) : 0);
+}
+
+bool ChatHandler::HandleServerDbStatsCommand(char* /*args*/)
+{
+    ShowDatabaseAsyncStats(this, "World", WorldDatabase);
+    ShowDatabaseAsyncStats(this, "Character", CharacterDatabase);
+    ShowDatabaseAsyncStats(this, "Login", LoginDatabase);
+    return true;
+}
+
+struct MapUpdateTimeTotalOrder
+{
+    bool operator()(MapUpdateTimeMap::const_iterator const& a, MapUpdateTimeMap::const_iterator const& b) const
+    {
+        return a->second.totalTime > b->second.totalTime;
+    }
+};
+
+bool ChatHandler::HandleServerMapStatsCommand(char* args)
+{
+    uint32 limit;
+    if (!ExtractOptUInt32(&args, limit, 10))
+        return false;
+
+    MapUpdateTimeMap data;
+    sMapMgr.GetMapUpdateTimeData(data);
+
+    PSendSysMessage("Map updates: %u maps measured, %u requests stolen by idle threads", uint32(data.size()), sMapMgr.GetMapUpdateStealCount());
+
+    uint64 ticks = sMapMgr.GetUpdateTicks();
+    uint64 rawTotal = sMapMgr.GetTotalUpdatePacketRawBytes();
+    uint64 sentTotal = sMapMgr.GetTotalUpdatePacketSentBytes();
+    PSendSysMessage("Object update packets last tick: " UI64FMTD " bytes, " UI64FMTD " bytes sent after compression",
+        sMapMgr.GetLastTickUpdatePacketRawBytes(), sMapMgr.GetLastTickUpdatePacketSentBytes());
+    PSendSysMessage("Object update packets per tick: avg " UI64FMTD " bytes, " UI64FMTD " bytes sent (%.1f%%) over " UI64FMTD " ticks",
+        ticks ? rawTotal / ticks : 0, ticks ? sentTotal / ticks : 0, rawTotal ? float(sentTotal) * 100.0f / rawTotal : 100.0f, ticks);
+
+    // maps with most total update time first
+    std::vector<MapUpdateTimeMap::const_iterator> order;
+    order.reserve(data.size());
+    for (MapUpdateTimeMap::const_iterator itr = data.begin(); itr != data.end(); ++itr)
+        order.push_back(itr);
+    std::sort(order.begin(), order.end(), MapUpdateTimeTotalOrder());
+
+    if (order.size() > limit)
+        order.resize(limit);
+
+    for (std::vector<MapUpdateTimeMap::const_iterator>::const_iterator itr = order.begin(); itr != order.end(); ++itr)
+    {
+        MapUpdateTimeData const& time = (*itr)->second;
+
+        PSendSysMessage("Map %u instance %u: last %u ms, max %u ms, avg %u ms over %u updates",
+            (*itr)->first.nMapId, (*itr)->first.nInstanceId, time.lastTime, time.maxTime,
+            time.count ? uint32(time.totalTime / time.count) : 0, time.count);
+
+        std::ostringstream ss;
+        for (uint32 i = 0; i < MAP_UPDATE_HISTOGRAM_BUCKETS; ++i)
+        {
+            if (uint32 bound = MapUpdateTimeData::GetBucketBound(i))
+                ss << " <" << bound << ":" << time.histogram[i];
+            else
+                ss << " >=" << MapUpdateTimeData::GetBucketBound(i - 1) << ":" << time.histogram[i];
+        }
+
+        PSendSysMessage("  histogram (ms):%s", ss.str().c_str());
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleServerSaveStatsCommand(char* /*args*/)
+{
+    static char const* sectionNames[MAX_PLAYER_SAVE_SECTIONS] =
+    {
+        "items", "spells", "quests", "reputation", "achievements", "auras", "cooldowns"
+    };
+
+    PlayerSaveStatistics& stats = Player::GetSaveStatistics();
+    long saves = stats.saves.value();
+    long avoided = stats.statementsAvoided.value();
+
+    PSendSysMessage("Character saves: %li, statements avoided: %li (%.2f per save)",
+        saves, avoided, saves ? float(avoided) / saves : 0.0f);
+
+    for (uint32 i = 0; i < MAX_PLAYER_SAVE_SECTIONS; ++i)
+        PSendSysMessage("  %s: unchanged in %li saves", sectionNames[i], stats.sectionsSkipped[i].value());
+
+    return true;
+}
+
 bool ChatHandler::HandleServerShutDownCancelCommand(char* /*args*/)
 {
     sWorld.ShutdownCancel();
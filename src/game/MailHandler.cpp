@@ -324,7 +324,7 @@ void WorldSession::HandleSendMail(WorldPacket& recv_data)
     .SetCOD(COD)
     .SendMailTo(MailReceiver(receive, rc), pl, body.empty() ? MAIL_CHECK_MASK_COPIED : MAIL_CHECK_MASK_HAS_BODY, deliver_delay);
 
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(pl->GetGUIDLow());
     pl->SaveInventoryAndGoldToDB();
     CharacterDatabase.CommitTransaction();
 }
@@ -548,7 +548,7 @@ void WorldSession::HandleMailTakeItem(WorldPacket& recv_data)
         uint32 count = it->GetCount();                      // save counts before store and possible merge with deleting
         pl->MoveItemToInventory(dest, it, true);
 
-        CharacterDatabase.BeginTransaction();
+        CharacterDatabase.BeginTransaction(pl->GetGUIDLow());
         pl->SaveInventoryAndGoldToDB();
         pl->_SaveMail();
         CharacterDatabase.CommitTransaction();
@@ -589,7 +589,7 @@ void WorldSession::HandleMailTakeMoney(WorldPacket& recv_data)
     pl->m_mailsUpdated = true;
 
     // save money and mail to prevent cheating
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(pl->GetGUIDLow());
     pl->SaveGoldToDB();
     pl->_SaveMail();
     CharacterDatabase.CommitTransaction();
@@ -38,6 +38,173 @@
 #include "MoveMap.h"
 #include "BattleGround/BattleGroundMgr.h"
 #include "Calendar.h"
+#include <ace/TSS_T.h>
+
+enum MapDeferredBroadcastType
+{
+    MAP_BROADCAST_PLAYER,
+    MAP_BROADCAST_OBJECT,
+    MAP_BROADCAST_PLAYER_DIST,
+    MAP_BROADCAST_OBJECT_DIST,
+};
+
+struct MapDeferredBroadcast
+{
+    MapDeferredBroadcast(MapDeferredBroadcastType _type, WorldObject const* _source, WorldPacket const* _packet, float _dist = 0.0f, bool _toSelf = false, bool _ownTeamOnly = false)
+        : type(_type), source(_source), packet(*_packet), dist(_dist), toSelf(_toSelf), ownTeamOnly(_ownTeamOnly)
+    {}
+
+    MapDeferredBroadcastType type;
+    WorldObject const* source;
+    WorldPacket packet;
+    float dist;
+    bool toSelf;
+    bool ownTeamOnly;
+};
+
+typedef std::list<MapDeferredBroadcast> MapDeferredBroadcastList;
+
+// ScriptsStart (scriptMap set) or ScriptCommandStart (command set) call of an island
+struct MapDeferredScript
+{
+    MapDeferredScript(ScriptMapMapName const* _scripts, ScriptMap const* _scriptMap, uint32 _id, ScriptInfo const* _command, uint32 _delay,
+        ObjectGuid _sourceGuid, ObjectGuid _targetGuid, ObjectGuid _ownerGuid, Map::ScriptExecutionParam _execParams)
+        : scripts(_scripts), scriptMap(_scriptMap), id(_id), command(_command), delay(_delay),
+        sourceGuid(_sourceGuid), targetGuid(_targetGuid), ownerGuid(_ownerGuid), execParams(_execParams)
+    {}
+
+    ScriptMapMapName const* scripts;
+    ScriptMap const* scriptMap;
+    uint32 id;
+    ScriptInfo const* command;
+    uint32 delay;
+    ObjectGuid sourceGuid;
+    ObjectGuid targetGuid;
+    ObjectGuid ownerGuid;
+    Map::ScriptExecutionParam execParams;
+};
+
+typedef std::vector<MapDeferredScript> MapDeferredScriptList;
+typedef std::vector<std::pair<Creature*, Position> > MapDeferredRelocationList;
+
+#define MAP_ISLAND_NONE 0xFFFF
+
+/**
+ * Part of the marked cells set that can be updated in parallel with other islands of the same map.
+ *
+ * Islands are built from players and active objects whose visibility areas, extended by one more
+ * visibility distance, share no grid. Changes that can reach out of the island grids (creature
+ * relocation to foreign or not loaded grid, object removal, packet broadcasts) and changes of the
+ * map script schedule are collected and applied by Merge() after all islands are done.
+ */
+class MapUpdateIsland : public MapUpdateTask
+{
+    public:
+
+        MapUpdateIsland(Map& map, uint16 index, uint32 diff) : m_map(map), m_index(index), m_diff(diff) {}
+
+        virtual int call();
+
+        Map& GetMap() const { return m_map; }
+        uint16 GetIndex() const { return m_index; }
+
+        void AddCell(CellPair const& cell) { m_cells.push_back(cell); }
+        size_t GetCellsCount() const { return m_cells.size(); }
+
+        bool IsOwnedGrid(uint32 x, uint32 y) const
+        {
+            return x < MAX_NUMBER_OF_GRIDS && y < MAX_NUMBER_OF_GRIDS && m_map.m_islandGridOwner[x * MAX_NUMBER_OF_GRIDS + y] == m_index;
+        }
+
+        void DeferRelocation(Creature* creature, Position const& pos) { m_relocations.push_back(std::make_pair(creature, pos)); }
+        void DeferRemove(WorldObject* obj) { m_removes.push_back(obj); }
+        void DeferBroadcast(MapDeferredBroadcast const& broadcast) { m_broadcasts.push_back(broadcast); }
+        void DeferScript(MapDeferredScript const& script) { m_scripts.push_back(script); }
+
+        void Merge();
+
+    private:
+
+        Map& m_map;
+        uint16 m_index;
+        uint32 m_diff;
+
+        std::vector<CellPair> m_cells;
+        MapDeferredRelocationList m_relocations;
+        std::vector<WorldObject*> m_removes;
+        MapDeferredBroadcastList m_broadcasts;
+        MapDeferredScriptList m_scripts;
+};
+
+struct MapUpdateIslandContext
+{
+    MapUpdateIslandContext() : island(NULL) {}
+    MapUpdateIsland* island;
+};
+
+typedef ACE_TSS<MapUpdateIslandContext> MapUpdateIslandTSS;
+static MapUpdateIslandTSS s_islandContext;
+
+int MapUpdateIsland::call()
+{
+    s_islandContext->island = this;
+
+    MaNGOS::ObjectUpdater updater(m_diff);
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
+
+    for (std::vector<CellPair>::const_iterator itr = m_cells.begin(); itr != m_cells.end(); ++itr)
+    {
+        Cell cell(*itr);
+        cell.SetNoCreate();
+        m_map.Visit(cell, grid_object_update);
+        m_map.Visit(cell, world_object_update);
+    }
+
+    s_islandContext->island = NULL;
+    return 0;
+}
+
+// Serializes changes of map-wide containers (grids creation and loading, objects add/remove) made by parallel islands
+class MapIslandGuard
+{
+    public:
+
+        explicit MapIslandGuard(Map& map) : m_lock(map.GetCurrentIsland() ? &map.m_islandLock : NULL)
+        {
+            if (m_lock)
+                m_lock->acquire();
+        }
+
+        ~MapIslandGuard()
+        {
+            if (m_lock)
+                m_lock->release();
+        }
+
+    private:
+
+        ACE_Recursive_Thread_Mutex* m_lock;
+};
+
+// larger islands first, to be started before small ones
+struct MapUpdateIslandSizeOrder
+{
+    bool operator()(MapUpdateTask const* left, MapUpdateTask const* right) const
+    {
+        return ((MapUpdateIsland const*)left)->GetCellsCount() > ((MapUpdateIsland const*)right)->GetCellsCount();
+    }
+};
+
+static uint32 FindIslandRoot(std::vector<uint32>& parent, uint32 index)
+{
+    while (parent[index] != index)
+    {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+    return index;
+}
 
 Map::~Map()
 {
@@ -80,7 +247,8 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
   m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
   m_activeNonPlayersIter(m_activeNonPlayers.end()),
   i_gridExpiry(expiry), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
-  i_data(NULL), i_script_id(0)
+  i_data(NULL), i_script_id(0),
+  m_updatePacketRawBytes(0), m_updatePacketSentBytes(0)
 {
     m_CreatureGuids.Set(sObjectMgr.GetFirstTemporaryCreatureLowGuid());
     m_GameObjectGuids.Set(sObjectMgr.GetFirstTemporaryGameObjectLowGuid());
@@ -263,6 +431,10 @@ Map::EnsureGridCreated(const GridPair &p)
 {
     if (!getNGrid(p.x_coord, p.y_coord))
     {
+        MapIslandGuard islandGuard(*this);
+        if (getNGrid(p.x_coord, p.y_coord))
+            return;
+
         {
             WriteGuard Guard(GetLock(MAP_LOCK_TYPE_MAPOBJECTS));
             setNGrid(new NGridType(p.x_coord*MAX_NUMBER_OF_GRIDS + p.y_coord, p.x_coord, p.y_coord, i_gridExpiry, sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD)),
@@ -318,6 +490,10 @@ bool Map::EnsureGridLoaded(const Cell &cell)
     MANGOS_ASSERT(grid != NULL);
     if (!IsGridObjectDataLoaded(grid))
     {
+        MapIslandGuard islandGuard(*this);
+        if (IsGridObjectDataLoaded(grid))
+            return false;
+
         //it's important to set it loaded before loading!
         //otherwise there is a possibility of infinity chain (grid loading will be called many times for the same grid)
         //possible scenario:
@@ -329,7 +505,10 @@ bool Map::EnsureGridLoaded(const Cell &cell)
 
         // Add resurrectable corpses to world object list in grid
         sObjectAccessor.AddCorpsesToGrid(GridPair(cell.GridX(),cell.GridY()),(*grid)(cell.CellX(), cell.CellY()), this);
-        m_dyn_tree.balance();
+        {
+            WriteGuard Guard(GetLock(MAP_LOCK_TYPE_DYNTREE));
+            m_dyn_tree.balance();
+        }
         return true;
     }
 
@@ -418,6 +597,8 @@ Map::Add(T *obj)
 {
     MANGOS_ASSERT(obj);
 
+    MapIslandGuard islandGuard(*this);
+
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
     if(p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP )
     {
@@ -452,6 +633,12 @@ Map::Add(T *obj)
 
 void Map::MessageBroadcast(Player const* player, WorldPacket* msg, bool to_self)
 {
+    if (MapUpdateIsland* island = GetCurrentIsland())
+    {
+        island->DeferBroadcast(MapDeferredBroadcast(MAP_BROADCAST_PLAYER, player, msg, 0.0f, to_self));
+        return;
+    }
+
     CellPair p = MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY());
 
     if(p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP )
@@ -475,6 +662,12 @@ void Map::MessageBroadcast(Player const* player, WorldPacket* msg, bool to_self)
 
 void Map::MessageBroadcast(WorldObject const* obj, WorldPacket* msg)
 {
+    if (MapUpdateIsland* island = GetCurrentIsland())
+    {
+        island->DeferBroadcast(MapDeferredBroadcast(MAP_BROADCAST_OBJECT, obj, msg));
+        return;
+    }
+
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
 
     if(p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP )
@@ -498,6 +691,12 @@ void Map::MessageBroadcast(WorldObject const* obj, WorldPacket* msg)
 
 void Map::MessageDistBroadcast(Player const* player, WorldPacket* msg, float dist, bool to_self, bool own_team_only)
 {
+    if (MapUpdateIsland* island = GetCurrentIsland())
+    {
+        island->DeferBroadcast(MapDeferredBroadcast(MAP_BROADCAST_PLAYER_DIST, player, msg, dist, to_self, own_team_only));
+        return;
+    }
+
     CellPair p = MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY());
 
     if(p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP )
@@ -521,6 +720,12 @@ void Map::MessageDistBroadcast(Player const* player, WorldPacket* msg, float dis
 
 void Map::MessageDistBroadcast(WorldObject const* obj, WorldPacket* msg, float dist)
 {
+    if (MapUpdateIsland* island = GetCurrentIsland())
+    {
+        island->DeferBroadcast(MapDeferredBroadcast(MAP_BROADCAST_OBJECT_DIST, obj, msg, dist));
+        return;
+    }
+
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
 
     if(p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP )
@@ -548,7 +753,10 @@ bool Map::loaded(GridPair const& p) const
 
 void Map::Update(const uint32 &t_diff)
 {
-    m_dyn_tree.update(t_diff);
+    {
+        WriteGuard Guard(GetLock(MAP_LOCK_TYPE_DYNTREE));
+        m_dyn_tree.update(t_diff);
+    }
 
     // Load all objects in begin of update diff (loading objects count limited by time)
     uint32 loadingObjectToGridUpdateTime = WorldTimer::getMSTime();
@@ -610,7 +818,40 @@ void Map::Update(const uint32 &t_diff)
     /// update active cells around players and active objects
     resetMarkedCells();
 
-    MaNGOS::ObjectUpdater updater(t_diff);
+    if (!UpdateCellIslands(t_diff))
+        UpdateMarkedCells(t_diff);
+
+    // Send world objects and item update field changes
+    SendObjectUpdates();
+
+    // Calculate and send map-related WorldState updates
+    sWorldStateMgr.MapUpdate(this);
+
+    // Don't unload grids if it's battleground, since we may have manually added GOs,creatures, those doesn't load from DB at grid re-load !
+    // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
+    if (!IsBattleGroundOrArena())
+    {
+        for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end(); )
+        {
+            NGridType *grid = i->getSource();
+            GridInfo *info = i->getSource()->getGridInfoRef();
+            ++i;                                                // The update might delete the map and we need the next map before the iterator gets invalid
+            MANGOS_ASSERT(grid->GetGridState() >= 0 && grid->GetGridState() < MAX_GRID_STATE);
+            sMapMgr.UpdateGridState(grid->GetGridState(), *this, *grid, *info, grid->getX(), grid->getY(), t_diff);
+        }
+    }
+
+    ///- Process necessary scripts
+    if (!m_scriptSchedule.empty())
+        ScriptsProcess();
+
+    if(i_data)
+        i_data->Update(t_diff);
+}
+
+void Map::UpdateMarkedCells(uint32 diff)
+{
+    MaNGOS::ObjectUpdater updater(diff);
     // for creature
     TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
     // for pets
@@ -667,7 +908,7 @@ void Map::Update(const uint32 &t_diff)
             if (obj->GetObjectGuid().IsMOTransport())
             {
                 WorldObject::UpdateHelper helper(obj);
-                helper.Update(t_diff);
+                helper.Update(diff);
             }
 
             //lets update mobs/objects in ALL visible cells around player!
@@ -693,33 +934,139 @@ void Map::Update(const uint32 &t_diff)
             }
         }
     }
+}
 
-    // Send world objects and item update field changes
-    SendObjectUpdates();
+MapUpdateIsland* Map::GetCurrentIsland() const
+{
+    if (m_islandGridOwner.empty())
+        return NULL;
 
-    // Calculate and send map-related WorldState updates
-    sWorldStateMgr.MapUpdate(this);
+    MapUpdateIsland* island = s_islandContext->island;
+    return island && &island->GetMap() == this ? island : NULL;
+}
 
-    // Don't unload grids if it's battleground, since we may have manually added GOs,creatures, those doesn't load from DB at grid re-load !
-    // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
-    if (!IsBattleGroundOrArena())
+bool Map::UpdateCellIslands(uint32 diff)
+{
+#ifdef MANGOSR2_SINGLE_THREAD
+    return false;
+#else
+    if (!sWorld.getConfig(CONFIG_BOOL_MAPUPDATE_PARALLEL_ISLANDS) || !sMapMgr.GetMapUpdater()->activated())
+        return false;
+
+    std::vector<WorldObject*> sources;
+    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
-        for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end(); )
+        Player* plr = m_mapRefIter->getSource();
+        if (plr && plr->IsInWorld() && plr->IsPositionValid())
+            sources.push_back(plr);
+    }
+
+    std::vector<WorldObject*> transports;
+    for (ActiveNonPlayers::const_iterator itr = m_activeNonPlayers.begin(); itr != m_activeNonPlayers.end(); ++itr)
+    {
+        WorldObject* obj = *itr;
+        if (!obj->IsInWorld() || !obj->IsPositionValid())
+            continue;
+
+        sources.push_back(obj);
+        if (obj->GetObjectGuid().IsMOTransport())
+            transports.push_back(obj);
+    }
+
+    if (sources.size() < 2)
+        return false;
+
+    // instance script state is shared by the whole map and reached from any AI without locking
+    if (i_data)
+        return false;
+
+    // sources with intersecting extended visibility areas (at grid precision) are merged into one island
+    uint32 const gridsCount = MAX_NUMBER_OF_GRIDS * MAX_NUMBER_OF_GRIDS;
+    uint32 const noSource = uint32(-1);
+    std::vector<uint32> gridSource(gridsCount, noSource);
+    std::vector<uint32> parent(sources.size());
+
+    for (uint32 i = 0; i < sources.size(); ++i)
+    {
+        parent[i] = i;
+
+        CellArea area = Cell::CalculateCellArea(sources[i]->GetPositionX(), sources[i]->GetPositionY(), 2 * GetVisibilityDistance());
+        for (uint32 x = area.low_bound.x_coord / MAX_NUMBER_OF_CELLS; x <= area.high_bound.x_coord / MAX_NUMBER_OF_CELLS; ++x)
         {
-            NGridType *grid = i->getSource();
-            GridInfo *info = i->getSource()->getGridInfoRef();
-            ++i;                                                // The update might delete the map and we need the next map before the iterator gets invalid
-            MANGOS_ASSERT(grid->GetGridState() >= 0 && grid->GetGridState() < MAX_GRID_STATE);
-            sMapMgr.UpdateGridState(grid->GetGridState(), *this, *grid, *info, grid->getX(), grid->getY(), t_diff);
+            for (uint32 y = area.low_bound.y_coord / MAX_NUMBER_OF_CELLS; y <= area.high_bound.y_coord / MAX_NUMBER_OF_CELLS; ++y)
+            {
+                uint32& owner = gridSource[x * MAX_NUMBER_OF_GRIDS + y];
+                if (owner == noSource)
+                    owner = i;
+                else
+                    parent[FindIslandRoot(parent, i)] = FindIslandRoot(parent, owner);
+            }
         }
     }
 
-    ///- Process necessary scripts
-    if (!m_scriptSchedule.empty())
-        ScriptsProcess();
+    std::vector<uint32> rootIsland(sources.size(), noSource);
+    uint32 islandsCount = 0;
+    for (uint32 i = 0; i < sources.size(); ++i)
+    {
+        uint32 root = FindIslandRoot(parent, i);
+        if (rootIsland[root] == noSource)
+            rootIsland[root] = islandsCount++;
+    }
 
-    if(i_data)
-        i_data->Update(t_diff);
+    if (islandsCount < 2 || islandsCount >= MAP_ISLAND_NONE)
+        return false;
+
+    m_islandGridOwner.assign(gridsCount, MAP_ISLAND_NONE);
+    for (uint32 i = 0; i < gridsCount; ++i)
+        if (gridSource[i] != noSource)
+            m_islandGridOwner[i] = uint16(rootIsland[FindIslandRoot(parent, gridSource[i])]);
+
+    MapUpdateTaskList islands;
+    islands.reserve(islandsCount);
+    for (uint32 i = 0; i < islandsCount; ++i)
+        islands.push_back(new MapUpdateIsland(*this, uint16(i), diff));
+
+    for (uint32 i = 0; i < sources.size(); ++i)
+    {
+        MapUpdateIsland* island = (MapUpdateIsland*)islands[rootIsland[FindIslandRoot(parent, i)]];
+
+        CellArea area = Cell::CalculateCellArea(sources[i]->GetPositionX(), sources[i]->GetPositionY(), GetVisibilityDistance());
+        for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+        {
+            for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+            {
+                uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+                if (!isCellMarked(cell_id))
+                {
+                    markCell(cell_id);
+                    island->AddCell(CellPair(x, y));
+                }
+            }
+        }
+    }
+
+    // FIXME - temphack for update active MO_TRANSPORT objects
+    for (std::vector<WorldObject*>::const_iterator itr = transports.begin(); itr != transports.end(); ++itr)
+    {
+        WorldObject::UpdateHelper helper(*itr);
+        helper.Update(diff);
+    }
+
+    MapUpdateTaskList ordered(islands);
+    std::sort(ordered.begin(), ordered.end(), MapUpdateIslandSizeOrder());
+    sMapMgr.GetMapUpdater()->execute_parallel(ordered);
+
+    m_islandGridOwner.clear();
+
+    // merge in island creation order, so results not depend from thread scheduling
+    for (MapUpdateTaskList::iterator itr = islands.begin(); itr != islands.end(); ++itr)
+    {
+        ((MapUpdateIsland*)*itr)->Merge();
+        delete *itr;
+    }
+
+    return true;
+#endif
 }
 
 void Map::Remove(Player* player, bool remove)
@@ -783,6 +1130,8 @@ template<class T>
 void
 Map::Remove(T* obj, bool remove)
 {
+    MapIslandGuard islandGuard(*this);
+
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
     if(p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP )
     {
@@ -876,6 +1225,16 @@ void Map::Relocation(Player* player, Position const& pos)
 template<>
 void Map::Relocation(Creature* creature, Position const& pos)
 {
+    if (MapUpdateIsland* island = GetCurrentIsland())
+    {
+        Cell new_cell(MaNGOS::ComputeCellPair(pos.x, pos.y));
+        if (!island->IsOwnedGrid(new_cell.GridX(), new_cell.GridY()) || !loaded(new_cell.gridPair()))
+        {
+            island->DeferRelocation(creature, pos);
+            return;
+        }
+    }
+
     MANGOS_ASSERT(CheckGridIntegrity(creature,false));
 
 //    Cell old_cell = creature->GetCurrentCell();
@@ -939,6 +1298,43 @@ void Map::CreatureRelocation(Creature* object, float x, float y, float z, float
     Relocation(object, Position(x, y, z, orientation, object->GetPhaseMask()));
 };
 
+void MapUpdateIsland::Merge()
+{
+    for (MapDeferredRelocationList::iterator itr = m_relocations.begin(); itr != m_relocations.end(); ++itr)
+        if (itr->first->IsInWorld())
+            m_map.Relocation(itr->first, itr->second);
+
+    for (MapDeferredBroadcastList::iterator itr = m_broadcasts.begin(); itr != m_broadcasts.end(); ++itr)
+    {
+        switch (itr->type)
+        {
+            case MAP_BROADCAST_PLAYER:
+                m_map.MessageBroadcast((Player const*)itr->source, &itr->packet, itr->toSelf);
+                break;
+            case MAP_BROADCAST_OBJECT:
+                m_map.MessageBroadcast(itr->source, &itr->packet);
+                break;
+            case MAP_BROADCAST_PLAYER_DIST:
+                m_map.MessageDistBroadcast((Player const*)itr->source, &itr->packet, itr->dist, itr->toSelf, itr->ownTeamOnly);
+                break;
+            case MAP_BROADCAST_OBJECT_DIST:
+                m_map.MessageDistBroadcast(itr->source, &itr->packet, itr->dist);
+                break;
+        }
+    }
+
+    for (std::vector<WorldObject*>::iterator itr = m_removes.begin(); itr != m_removes.end(); ++itr)
+        m_map.AddObjectToRemoveList(*itr);
+
+    for (MapDeferredScriptList::const_iterator itr = m_scripts.begin(); itr != m_scripts.end(); ++itr)
+    {
+        if (itr->scriptMap)
+            m_map.ScheduleScripts(*itr->scripts, *itr->scriptMap, itr->id, itr->sourceGuid, itr->targetGuid, itr->ownerGuid, itr->execParams);
+        else
+            m_map.ScheduleScriptCommand(*itr->command, itr->delay, itr->sourceGuid, itr->targetGuid, itr->ownerGuid);
+    }
+}
+
 bool Map::CreatureCellRelocation(Creature* c, Cell new_cell)
 {
     Cell const& old_cell = c->GetCurrentCell();
@@ -1237,6 +1633,12 @@ void Map::AddObjectToRemoveList(WorldObject* obj, bool immediateCleanup)
 {
     MANGOS_ASSERT(obj && obj->GetMap() == this);
 
+    if (MapUpdateIsland* island = GetCurrentIsland())
+    {
+        island->DeferRemove(obj);
+        return;
+    }
+
     obj->CleanupsBeforeDelete();                                // remove or simplify at least cross referenced links
 
     i_objectsToRemove.insert(obj);
@@ -1342,6 +1744,8 @@ bool Map::ActiveObjectsNearGrid(uint32 x, uint32 y) const
 
 void Map::AddToActive(WorldObject* obj)
 {
+    MapIslandGuard islandGuard(*this);
+
     m_activeNonPlayers.insert(obj);
     Cell cell = Cell(MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY()));
     EnsureGridLoaded(cell);
@@ -1393,6 +1797,8 @@ void Map::AddToActive(WorldObject* obj)
 
 void Map::RemoveFromActive( WorldObject* obj )
 {
+    MapIslandGuard islandGuard(*this);
+
     // Map::Update for active object in proccess
     if(m_activeNonPlayersIter != m_activeNonPlayers.end())
     {
@@ -1910,6 +2316,19 @@ bool Map::ScriptsStart(ScriptMapMapName const& scripts, uint32 id, Object* sourc
     ObjectGuid targetGuid = target ? target->GetObjectGuid() : ObjectGuid();
     ObjectGuid ownerGuid  = source->isType(TYPEMASK_ITEM) ? ((Item*)source)->GetOwnerGuid() : ObjectGuid();
 
+    // schedule is shared by all islands, uniqueness is checked when the call is replayed
+    if (MapUpdateIsland* island = GetCurrentIsland())
+    {
+        island->DeferScript(MapDeferredScript(&scripts, &s->second, id, NULL, 0, sourceGuid, targetGuid, ownerGuid, execParams));
+        return true;
+    }
+
+    ScheduleScripts(scripts, s->second, id, sourceGuid, targetGuid, ownerGuid, execParams);
+    return true;
+}
+
+void Map::ScheduleScripts(ScriptMapMapName const& scripts, ScriptMap const& scriptMap, uint32 id, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid, ScriptExecutionParam execParams)
+{
     if (execParams)                                         // Check if the execution should be uniquely
     {
         for (ScriptScheduleMap::const_iterator searchItr = m_scriptSchedule.begin(); searchItr != m_scriptSchedule.end(); ++searchItr)
@@ -1919,14 +2338,13 @@ bool Map::ScriptsStart(ScriptMapMapName const& scripts, uint32 id, Object* sourc
                     execParams & SCRIPT_EXEC_PARAM_UNIQUE_BY_TARGET ? targetGuid : ObjectGuid(), ownerGuid))
             {
                 DEBUG_LOG("DB-SCRIPTS: Process table `%s` id %u. Skip script as script already started for source %s, target %s - ScriptsStartParams %u", scripts.first, id, sourceGuid.GetString().c_str(), targetGuid.GetString().c_str(), execParams);
-                return true;
+                return;
             }
         }
     }
 
     ///- Schedule script execution for all scripts in the script map
-    ScriptMap const *s2 = &(s->second);
-    for (ScriptMap::const_iterator iter = s2->begin(); iter != s2->end(); ++iter)
+    for (ScriptMap::const_iterator iter = scriptMap.begin(); iter != scriptMap.end(); ++iter)
     {
         ScriptAction sa(scripts.first, this, sourceGuid, targetGuid, ownerGuid, &iter->second);
 
@@ -1934,8 +2352,6 @@ bool Map::ScriptsStart(ScriptMapMapName const& scripts, uint32 id, Object* sourc
 
         sScriptMgr.IncreaseScheduledScriptsCount();
     }
-
-    return true;
 }
 
 void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* source, Object* target)
@@ -1947,6 +2363,17 @@ void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* sou
     ObjectGuid targetGuid = target ? target->GetObjectGuid() : ObjectGuid();
     ObjectGuid ownerGuid  = source->isType(TYPEMASK_ITEM) ? ((Item*)source)->GetOwnerGuid() : ObjectGuid();
 
+    if (MapUpdateIsland* island = GetCurrentIsland())
+    {
+        island->DeferScript(MapDeferredScript(NULL, NULL, 0, &script, delay, sourceGuid, targetGuid, ownerGuid, SCRIPT_EXEC_PARAM_NONE));
+        return;
+    }
+
+    ScheduleScriptCommand(script, delay, sourceGuid, targetGuid, ownerGuid);
+}
+
+void Map::ScheduleScriptCommand(ScriptInfo const& script, uint32 delay, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid)
+{
     ScriptAction sa("Internal Activate Command used for spell", this, sourceGuid, targetGuid, ownerGuid, &script);
 
     m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld.GetGameTime() + delay), sa));
@@ -2196,26 +2623,29 @@ void Map::RemoveUpdateObject(ObjectGuid const& guid)
 
 void Map::SendObjectUpdates()
 {
-    UpdateDataMapType update_players;
-
-    while (!GetObjectsUpdateQueue()->empty())
+    // take whole pending set at once, objects queued while building are handled in next pass
+    while (true)
     {
-        ObjectGuid guid;
         {
             WriteGuard Guard(GetLock(MAP_LOCK_TYPE_DEFAULT));
-            guid = *i_objectsToClientUpdate.begin();
-            i_objectsToClientUpdate.erase(i_objectsToClientUpdate.begin());
+            if (i_objectsToClientUpdate.empty())
+                break;
+            m_clientUpdateBatch.swap(i_objectsToClientUpdate);
         }
 
-        if (guid.IsEmpty())
-            continue;
-
-        WorldObject* obj = GetWorldObject(guid);
-        if (obj && obj->IsInWorld())
+        for (GuidSet::const_iterator itr = m_clientUpdateBatch.begin(); itr != m_clientUpdateBatch.end(); ++itr)
         {
+            if (itr->IsEmpty())
+                continue;
+
+            WorldObject* obj = GetWorldObject(*itr);
+            if (!obj || !obj->IsInWorld())
+                continue;
+
             if (obj->IsMarkedForClientUpdate())
-                obj->BuildUpdateData(update_players);
-            if (obj->GetObjectsUpdateQueue() && !obj->GetObjectsUpdateQueue()->empty())
+                obj->BuildUpdateData(m_clientUpdateData);
+
+            if (obj->GetObjectsUpdateQueue())
             {
                 while (!obj->GetObjectsUpdateQueue()->empty())
                 {
@@ -2223,34 +2653,58 @@ void Map::SendObjectUpdates()
                     obj->RemoveUpdateObject(dependentGuid);
                     Object* dependentObj = obj->GetDependentObject(dependentGuid);
                     if (dependentObj && dependentObj->IsMarkedForClientUpdate())
-                        dependentObj->BuildUpdateData(update_players);
+                        dependentObj->BuildUpdateData(m_clientUpdateData);
                 }
             }
         }
+
+        m_clientUpdateBatch.clear();
     }
 
-    if (!update_players.empty())
+    m_updatePacketRawBytes = 0;
+    m_updatePacketSentBytes = 0;
+
+    if (m_clientUpdateData.empty())
+        return;
+
+    WorldPacket packet;
+
+    for (UpdateDataMapType::iterator iter = m_clientUpdateData.begin(); iter != m_clientUpdateData.end();)
     {
-        for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
-        {
-            if (!iter->first || !iter->first.IsPlayer())
-                continue;
+        Player* pPlayer = iter->first.IsPlayer() ? GetPlayer(iter->first) : NULL;
 
-            Player* pPlayer = GetPlayer(iter->first);
-            if (!pPlayer)
-                continue;
+        // buffer (and its storage) of a receiver stays reserved until it leaves the map or stays idle too long
+        if (!iter->second.HasData())
+        {
+            if (!pPlayer || iter->second.IncreaseIdleCount() > UPDATE_DATA_MAX_IDLE_SENDS)
+                m_clientUpdateData.erase(iter++);
+            else
+                ++iter;
+            continue;
+        }
 
-            WorldPacket packet;
+        iter->second.ResetIdleCount();
 
-            if (pPlayer->GetSession())
-                if (iter->second.BuildPacket(&packet))
-                    pPlayer->GetSession()->SendPacket(&packet);
+        if (pPlayer && pPlayer->GetSession())
+        {
+            packet.clear();
+            if (iter->second.BuildPacket(&packet, pPlayer->GetSession()->GetUpdateDataCompressor()))
+            {
+                m_updatePacketSentBytes += packet.size();
+                m_updatePacketRawBytes += packet.GetOpcode() == SMSG_COMPRESSED_UPDATE_OBJECT ? packet.read<uint32>(0) : packet.size();
+                pPlayer->GetSession()->SendPacket(&packet);
+            }
         }
+
+        iter->second.Clear();
+        ++iter;
     }
 }
 
 uint32 Map::GenerateLocalLowGuid(HighGuid guidhigh)
 {
+    MapIslandGuard islandGuard(*this);
+
     // TODO: for map local guid counters possible force reload map instead shutdown server at guid counter overflow
     switch(guidhigh)
     {
@@ -2509,6 +2963,7 @@ void Map::ForcedUnload()
 
     // Immediately cleanup update queue
     i_objectsToClientUpdate.clear();
+    m_clientUpdateData.clear();
 
     Map::PlayerList const pList = GetPlayers();
     for (PlayerList::const_iterator itr = pList.begin(); itr != pList.end(); ++itr)
@@ -2585,10 +3040,27 @@ float Map::GetVisibilityDistance(WorldObject const* obj) const
 
 bool Map::IsInLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, uint32 phasemask) const
 {
+    ReadGuard Guard(const_cast<Map*>(this)->GetLock(MAP_LOCK_TYPE_DYNTREE));
     return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ)
         && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, phasemask);
 }
 
+void Map::IsInLineOfSight(VMAP::LineOfSightQuery const* queries, uint32 count, uint32 phasemask, uint8* results) const
+{
+    ReadGuard Guard(const_cast<Map*>(this)->GetLock(MAP_LOCK_TYPE_DYNTREE));
+    VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), queries, count, results);
+
+    // dynamic objects only matter for segments not already blocked by static ones
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (!results[i])
+            continue;
+
+        VMAP::LineOfSightQuery const& query = queries[i];
+        results[i] = m_dyn_tree.isInLineOfSight(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2, phasemask);
+    }
+}
+
 /**
 test if we hit an object. return true if we hit one. the dest position will hold the orginal dest position or the possible hit position
 return true if we hit something
@@ -2607,6 +3079,7 @@ bool Map::GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float
         destZ = tempZ;
     }
     // at second all dynamic objects, if static check has an hit, then we can calculate only to this point and NOT to end, because we need closely hit point
+    ReadGuard Guard(const_cast<Map*>(this)->GetLock(MAP_LOCK_TYPE_DYNTREE));
     bool result1 = m_dyn_tree.getObjectHitPos(phasemask, srcX, srcY, srcZ, destX, destY, destZ, tempX, tempY, tempZ, modifyDist);
     if (result1)
     {
@@ -2624,21 +3097,38 @@ float Map::GetHeight(uint32 phasemask, float x, float y, float z) const
 
     // Get Dynamic Height around static Height (if valid)
     float dynSearchHeight = 2.0f + (z < staticHeight ? staticHeight : z);
+    ReadGuard Guard(const_cast<Map*>(this)->GetLock(MAP_LOCK_TYPE_DYNTREE));
     return std::max<float>(staticHeight, m_dyn_tree.getHeight(x, y, dynSearchHeight, dynSearchHeight - staticHeight, phasemask));
 }
 
+void Map::GetHeight(uint32 phasemask, VMAP::HeightQuery const* points, uint32 count, float* heights) const
+{
+    m_TerrainData->GetHeightStatic(points, count, heights);
+
+    ReadGuard Guard(const_cast<Map*>(this)->GetLock(MAP_LOCK_TYPE_DYNTREE));
+    for (uint32 i = 0; i < count; ++i)
+    {
+        float staticHeight = heights[i];
+        float dynSearchHeight = 2.0f + (points[i].z < staticHeight ? staticHeight : points[i].z);
+        heights[i] = std::max<float>(staticHeight, m_dyn_tree.getHeight(points[i].x, points[i].y, dynSearchHeight, dynSearchHeight - staticHeight, phasemask));
+    }
+}
+
 void Map::InsertGameObjectModel(const GameObjectModel& mdl)
 {
+    WriteGuard Guard(GetLock(MAP_LOCK_TYPE_DYNTREE));
     m_dyn_tree.insert(mdl);
 }
 
 void Map::RemoveGameObjectModel(const GameObjectModel& mdl)
 {
+    WriteGuard Guard(GetLock(MAP_LOCK_TYPE_DYNTREE));
     m_dyn_tree.remove(mdl);
 }
 
 bool Map::ContainsGameObjectModel(const GameObjectModel& mdl) const
 {
+    ReadGuard Guard(const_cast<Map*>(this)->GetLock(MAP_LOCK_TYPE_DYNTREE));
     return m_dyn_tree.contains(mdl);
 }
 
@@ -40,6 +40,7 @@
 #include "ObjectLock.h"
 #include "vmap/DynamicTree.h"
 #include "WorldObjectEvents.h"
+#include "ace/Recursive_Thread_Mutex.h"
 
 #include <bitset>
 #include <list>
@@ -60,6 +61,13 @@ class BattleGround;
 class GridMap;
 class GameObjectModel;
 class TerrainInfo;
+class MapUpdateIsland;
+
+namespace VMAP
+{
+    struct HeightQuery;
+    struct LineOfSightQuery;
+}
 
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some platform
 #if defined( __GNUC__ )
@@ -128,6 +136,8 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
     friend class MapReference;
     friend class ObjectGridLoader;
     friend class ObjectWorldLoader;
+    friend class MapUpdateIsland;
+    friend class MapIslandGuard;
 
     protected:
         Map(uint32 id, time_t, uint32 InstanceId, uint8 SpawnMode);
@@ -301,6 +311,10 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         void RemoveUpdateObject(ObjectGuid const& guid);
         GuidSet const* GetObjectsUpdateQueue() { return &i_objectsToClientUpdate; };
 
+        // object update packet sizes of last SendObjectUpdates call, before and after compression
+        uint32 GetLastUpdatePacketRawBytes() const { return m_updatePacketRawBytes; }
+        uint32 GetLastUpdatePacketSentBytes() const { return m_updatePacketSentBytes; }
+
         // DynObjects currently
         uint32 GenerateLocalLowGuid(HighGuid guidhigh);
 
@@ -344,6 +358,9 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         // Dynamic VMaps
         float GetHeight(uint32 phasemask, float x, float y, float z) const;
         bool IsInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const;
+        // batched variants of the above, results arrays must hold count entries
+        void GetHeight(uint32 phasemask, VMAP::HeightQuery const* points, uint32 count, float* heights) const;
+        void IsInLineOfSight(VMAP::LineOfSightQuery const* queries, uint32 count, uint32 phasemask, uint8* results) const;
         bool GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float& destY, float& destZ, uint32 phasemask, float modifyDist) const;
 
         void InsertGameObjectModel(const GameObjectModel& mdl);
@@ -404,9 +421,21 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         void setNGrid(NGridType* grid, uint32 x, uint32 y);
         void ScriptsProcess();
 
+        // schedule part of ScriptsStart/ScriptCommandStart, also used for calls deferred by islands
+        void ScheduleScripts(ScriptMapMapName const& scripts, ScriptMap const& scriptMap, uint32 id, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid, ScriptExecutionParam execParams);
+        void ScheduleScriptCommand(ScriptInfo const& script, uint32 delay, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid);
+
         void SendObjectUpdates();
 
+        void UpdateMarkedCells(uint32 diff);
+        bool UpdateCellIslands(uint32 diff);
+        MapUpdateIsland* GetCurrentIsland() const;
+
         GuidSet i_objectsToClientUpdate;
+        GuidSet m_clientUpdateBatch;                        // swapped with i_objectsToClientUpdate in SendObjectUpdates
+        UpdateDataMapType m_clientUpdateData;               // per player buffers, kept between ticks while receiver is on map
+        uint32 m_updatePacketRawBytes;
+        uint32 m_updatePacketSentBytes;
 
         LoadingObjectsQueue i_loadingObjectQueue;
 
@@ -468,6 +497,9 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 
         WorldObjectEventProcessor m_Events;
 
+        // parallel update of independent cell islands
+        std::vector<uint16> m_islandGridOwner;              // island index per grid, valid while islands are updated, empty otherwise
+        ACE_Recursive_Thread_Mutex m_islandLock;            // serializes map-wide container changes made by islands
 };
 
 class MANGOS_DLL_SPEC WorldMap : public Map
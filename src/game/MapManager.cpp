@@ -26,6 +26,7 @@
 #include "CellImpl.h"
 #include "Corpse.h"
 #include "ObjectMgr.h"
+#include "PathFinder.h"
 
 #define CLASS_LOCK MaNGOS::ClassLevelLockable<MapManager, ACE_Recursive_Thread_Mutex>
 INSTANTIATE_SINGLETON_2(MapManager, CLASS_LOCK);
@@ -55,13 +56,26 @@ MapManager::Initialize()
     if (m_threadsCount > 0 && m_updater.activate(m_threadsCount) == -1)
         abort();
 
+    if (uint32 pathThreads = sWorld.getConfig(CONFIG_UINT32_MMAP_ASYNC_THREADS))
+    {
+        if (sPathFinderWorkers.activate(pathThreads) == -1)
+            sLog.outError("MapManager::Initialize: failed to start %u path worker threads, paths are calculated in map threads", pathThreads);
+    }
+
     InitStateMachine();
 
     i_balanceTimer.SetInterval(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE)*100);
     m_previewTimeStamp = WorldTimer::getMSTime();
     m_workTimeStorage = 0;
     m_sleepTimeStorage = 0;
+    m_busyTimeStorage = 0;
+    m_criticalTimeStorage = 0;
     m_tickCount = 0;
+    m_updatePacketRawBytes = 0;
+    m_updatePacketSentBytes = 0;
+    m_updatePacketRawTotal = 0;
+    m_updatePacketSentTotal = 0;
+    m_updateTicks = 0;
 }
 
 void MapManager::InitStateMachine()
@@ -182,6 +196,7 @@ void MapManager::DeleteInstance(uint32 mapid, uint32 instanceId)
         if (pMap->Instanceable())
         {
             i_maps.erase(iter);
+            m_updater.RemoveMapUpdateTime(MapID(mapid, instanceId));
 
             pMap->UnloadAll(true);
             delete pMap;
@@ -197,6 +212,8 @@ void MapManager::Update(uint32 diff)
 
     UpdateLoadBalancer(true);
 
+    m_updater.ResetTickTime();
+
     for (MapMapType::iterator iter=i_maps.begin(); iter != i_maps.end(); ++iter)
     {
         if (m_updater.activated())
@@ -204,12 +221,29 @@ void MapManager::Update(uint32 diff)
             m_updater.schedule_update(*iter->second, (uint32)i_timer.GetCurrent());
         }
         else
+        {
+            uint32 startTime = WorldTimer::getMSTime();
             iter->second->Update((uint32)i_timer.GetCurrent());
+            m_updater.AddMapUpdateTime(iter->first, WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime()));
+        }
     }
 
+    // requests are dispatched to the threads here, ordered by the update time of previous tick
     if (m_updater.activated())
         m_updater.wait();
 
+    m_updatePacketRawBytes = 0;
+    m_updatePacketSentBytes = 0;
+    for (MapMapType::const_iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
+    {
+        m_updatePacketRawBytes += iter->second->GetLastUpdatePacketRawBytes();
+        m_updatePacketSentBytes += iter->second->GetLastUpdatePacketSentBytes();
+    }
+
+    m_updatePacketRawTotal += m_updatePacketRawBytes;
+    m_updatePacketSentTotal += m_updatePacketSentBytes;
+    ++m_updateTicks;
+
     UpdateLoadBalancer(false);
 
     if (m_updater.IsBroken() || m_threadsCountPreferred != m_threadsCount)
@@ -227,6 +261,7 @@ void MapManager::Update(uint32 diff)
         //check if map can be unloaded
         if(pMap->CanUnload((uint32)i_timer.GetCurrent()))
         {
+            m_updater.RemoveMapUpdateTime(iter->first);
             pMap->UnloadAll(true);
             delete pMap;
 
@@ -264,6 +299,10 @@ bool MapManager::IsValidMAP(uint32 mapid)
 
 void MapManager::UnloadAll()
 {
+    // queued paths hold references to terrain data
+    if (sPathFinderWorkers.activated())
+        sPathFinderWorkers.deactivate();
+
     for(MapMapType::iterator iter=i_maps.begin(); iter != i_maps.end(); ++iter)
         iter->second->UnloadAll(true);
 
@@ -423,7 +462,11 @@ void MapManager::UpdateLoadBalancer(bool b_start)
         ++m_tickCount;
     }
     else
+    {
         m_workTimeStorage += timeDiff;
+        m_busyTimeStorage += m_updater.GetLastTickBusyTime();
+        m_criticalTimeStorage += m_updater.GetLastTickCriticalTime();
+    }
 
 
     i_balanceTimer.Update(timeDiff);
@@ -433,18 +476,26 @@ void MapManager::UpdateLoadBalancer(bool b_start)
 
     float loadValue = float((m_workTimeStorage)/m_tickCount)/float((m_workTimeStorage + m_sleepTimeStorage)/ m_tickCount);
 
-    if (loadValue >= sWorld.getConfig(CONFIG_FLOAT_LOADBALANCE_HIGHVALUE))
+    // tick can't be shorter than the slowest map update, so threads above busy/critical time ratio only idle
+    int32 usefulThreads = m_criticalTimeStorage ? int32((m_busyTimeStorage + m_criticalTimeStorage - 1) / m_criticalTimeStorage) : 1;
+    if (usefulThreads < 1)
+        usefulThreads = 1;
+
+    if (loadValue >= sWorld.getConfig(CONFIG_FLOAT_LOADBALANCE_HIGHVALUE) && m_threadsCount < usefulThreads)
         m_threadsCountPreferred = (m_threadsCountPreferred < (int32)sWorld.getConfig(CONFIG_UINT32_NUMTHREADS)) ? (m_threadsCountPreferred + 1) : sWorld.getConfig(CONFIG_UINT32_NUMTHREADS);
-    else if (loadValue <= sWorld.getConfig(CONFIG_FLOAT_LOADBALANCE_LOWVALUE))
+    else if (loadValue <= sWorld.getConfig(CONFIG_FLOAT_LOADBALANCE_LOWVALUE) || m_threadsCount > usefulThreads)
         m_threadsCountPreferred = (m_threadsCountPreferred > 1) ? (m_threadsCountPreferred - 1) : 1;
     else
         m_threadsCountPreferred = m_threadsCount;
 
     if (m_threadsCountPreferred != m_threadsCount)
-        sLog.outDetail("MapManager::UpdateLoadBalancer load balance %f (tick count %u), threads %u, new %u", loadValue, m_tickCount, m_threadsCount, m_threadsCountPreferred);
+        sLog.outDetail("MapManager::UpdateLoadBalancer load balance %f (tick count %u, busy " UI64FMTD " ms, critical " UI64FMTD " ms, steals %u, update packets " UI64FMTD "/" UI64FMTD " bytes), threads %u, new %u",
+            loadValue, m_tickCount, m_busyTimeStorage, m_criticalTimeStorage, m_updater.GetStealCount(), m_updatePacketSentBytes, m_updatePacketRawBytes, m_threadsCount, m_threadsCountPreferred);
 
     m_workTimeStorage = 0;
     m_sleepTimeStorage = 0;
+    m_busyTimeStorage = 0;
+    m_criticalTimeStorage = 0;
     m_tickCount = 0;
 
     i_balanceTimer.SetCurrent(0);
@@ -156,6 +156,16 @@ class MANGOS_DLL_DECL MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::
         void DoForAllMapsWithMapId(uint32 mapId, Do& _do);
 
         MapUpdater* GetMapUpdater() { return &m_updater; };
+        void GetMapUpdateTimeData(MapUpdateTimeMap& data) { m_updater.GetMapUpdateTimeData(data); }
+        uint32 GetMapUpdateStealCount() const { return m_updater.GetStealCount(); }
+
+        // object update packet bytes of all maps in last tick, before and after compression
+        uint64 GetLastTickUpdatePacketRawBytes() const { return m_updatePacketRawBytes; }
+        uint64 GetLastTickUpdatePacketSentBytes() const { return m_updatePacketSentBytes; }
+        // same summed over all ticks since startup
+        uint64 GetTotalUpdatePacketRawBytes() const { return m_updatePacketRawTotal; }
+        uint64 GetTotalUpdatePacketSentBytes() const { return m_updatePacketSentTotal; }
+        uint64 GetUpdateTicks() const { return m_updateTicks; }
 
         void UpdateLoadBalancer(bool b_start);
 
@@ -190,7 +200,14 @@ class MANGOS_DLL_DECL MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::
         uint32 m_previewTimeStamp;
         uint64 m_workTimeStorage;
         uint64 m_sleepTimeStorage;
+        uint64 m_busyTimeStorage;                           // sum of measured map update times
+        uint64 m_criticalTimeStorage;                       // sum of longest map update time per tick
         uint32 m_tickCount;
+        uint64 m_updatePacketRawBytes;
+        uint64 m_updatePacketSentBytes;
+        uint64 m_updatePacketRawTotal;
+        uint64 m_updatePacketSentTotal;
+        uint64 m_updateTicks;
 
         IntervalTimer i_timer;
 };
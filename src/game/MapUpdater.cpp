@@ -17,33 +17,38 @@
  */
 
 #include "MapUpdater.h"
-#include "DelayExecutor.h"
 #include "Map.h"
 #include "MapManager.h"
 #include "World.h"
 #include "Database/DatabaseEnv.h"
 #include <ace/Guard_T.h>
-#include <ace/Method_Request.h>
 
-class MapUpdateRequest : public ACE_Method_Request
+class MapUpdateRequest : public MapUpdateTask
 {
     private:
 
         Map& m_map;
         MapUpdater& m_updater;
         ACE_UINT32 m_diff;
+        uint32 m_cost;
 
     public:
 
         MapUpdateRequest(Map& m, MapUpdater& u, ACE_UINT32 d)
-            : m_map(m), m_updater(u), m_diff(d)
+            : m_map(m), m_updater(u), m_diff(d), m_cost(0)
         {
         }
 
+        Map& GetMap() const { return m_map; }
+
+        uint32 GetCost() const { return m_cost; }
+        void SetCost(uint32 cost) { m_cost = cost; }
+
         virtual int call()
         {
             ACE_thread_t const threadId = ACE_OS::thr_self();
             m_updater.register_thread(threadId, m_map.GetId(),m_map.GetInstanceId());
+            uint32 startTime = WorldTimer::getMSTime();
             if (m_map.IsBroken())
             {
                 m_map.ForcedUnload();
@@ -52,14 +57,163 @@ class MapUpdateRequest : public ACE_Method_Request
             {
                 m_map.Update(m_diff);
             }
+            m_updater.AddMapUpdateTime(MapID(m_map.GetId(), m_map.GetInstanceId()), WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime()));
             m_updater.unregister_thread(threadId);
             m_updater.update_finished ();
             return 0;
         }
 };
 
+// larger maps first, continents first on equal (or not yet measured) cost
+struct MapUpdateRequestCostOrder
+{
+    bool operator()(MapUpdateRequest const* left, MapUpdateRequest const* right) const
+    {
+        if (left->GetCost() != right->GetCost())
+            return left->GetCost() > right->GetCost();
+
+        // continents have most players, not instanceable maps are them and a few other world maps
+        bool leftContinent = !left->GetMap().Instanceable();
+        bool rightContinent = !right->GetMap().Instanceable();
+        if (leftContinent != rightContinent)
+            return leftContinent;
+
+        return MapID(left->GetMap().GetId(), left->GetMap().GetInstanceId()) < MapID(right->GetMap().GetId(), right->GetMap().GetInstanceId());
+    }
+};
+
+class MapUpdateQueue
+{
+    public:
+
+        void push(MapUpdateTask* rq)
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+            m_requests.push_back(rq);
+        }
+
+        // owner thread takes the most expensive request
+        MapUpdateTask* pop_front()
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, NULL);
+            if (m_requests.empty())
+                return NULL;
+
+            MapUpdateTask* rq = m_requests.front();
+            m_requests.pop_front();
+            return rq;
+        }
+
+        // other threads steal the cheapest one, leaving the owner its planned work
+        MapUpdateTask* pop_back()
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, NULL);
+            if (m_requests.empty())
+                return NULL;
+
+            MapUpdateTask* rq = m_requests.back();
+            m_requests.pop_back();
+            return rq;
+        }
+
+    private:
+
+        ACE_Thread_Mutex m_lock;
+        std::deque<MapUpdateTask*> m_requests;
+};
+
+// Set of tasks shared between the thread calling execute_parallel and pool threads helping it
+class MapUpdateTaskGroup
+{
+    public:
+
+        explicit MapUpdateTaskGroup(MapUpdateTaskList const& tasks)
+            : m_tasks(tasks), m_next(0), m_done(0), m_refs(1), m_condition(m_lock)
+        {
+        }
+
+        void AddRef() { ++m_refs; }
+        void Release()
+        {
+            if (--m_refs == 0)
+                delete this;
+        }
+
+        // claims and executes next not started task, false if all already claimed
+        bool ExecuteNext()
+        {
+            long index = ++m_next - 1;
+            if (index >= long(m_tasks.size()))
+                return false;
+
+            m_tasks[index]->call();
+
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, true);
+            if (++m_done == m_tasks.size())
+                m_condition.broadcast();
+            return true;
+        }
+
+        void WaitFinished()
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+            while (m_done < m_tasks.size())
+                m_condition.wait();
+        }
+
+    private:
+
+        MapUpdateTaskList m_tasks;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_next;
+        size_t m_done;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_refs;
+        ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_condition;
+};
+
+// Queued in place of group tasks, so idle pool threads pick up group work while its owner is busy
+class MapUpdateTaskGroupHelper : public MapUpdateTask
+{
+    public:
+
+        explicit MapUpdateTaskGroupHelper(MapUpdateTaskGroup* group) : m_group(group) { m_group->AddRef(); }
+        virtual ~MapUpdateTaskGroupHelper() { m_group->Release(); }
+
+        virtual int call()
+        {
+            while (m_group->ExecuteNext()) {}
+            return 0;
+        }
+
+    private:
+
+        MapUpdateTaskGroup* m_group;
+};
+
+static uint32 const MapUpdateHistogramBounds[MAP_UPDATE_HISTOGRAM_BUCKETS - 1] = { 1, 2, 5, 10, 20, 50, 100, 200, 500 };
+
+void MapUpdateTimeData::AddSample(uint32 time)
+{
+    lastTime = time;
+    if (time > maxTime)
+        maxTime = time;
+    totalTime += time;
+    ++count;
+
+    uint32 bucket = 0;
+    while (bucket < MAP_UPDATE_HISTOGRAM_BUCKETS - 1 && time >= MapUpdateHistogramBounds[bucket])
+        ++bucket;
+    ++histogram[bucket];
+}
+
+uint32 MapUpdateTimeData::GetBucketBound(uint32 bucket)
+{
+    return bucket < MAP_UPDATE_HISTOGRAM_BUCKETS - 1 ? MapUpdateHistogramBounds[bucket] : 0;
+}
+
 MapUpdater::MapUpdater()
-    : m_mutex(), m_condition(m_mutex), m_executor(), pending_requests(0), m_broken(false)
+    : m_mutex(), m_condition(m_mutex), m_workCondition(m_mutex), pending_requests(0), m_queuedRequests(0), m_workerIndex(0),
+    m_activated(false), m_stopping(false), m_tickBusyTime(0), m_tickCriticalTime(0), m_stealCount(0), m_broken(false)
 {
 }
 
@@ -70,14 +224,49 @@ MapUpdater::~MapUpdater()
 
 int MapUpdater::activate(size_t num_threads)
 {
-    return m_executor.activate((int)num_threads);
+    if (activated() || num_threads < 1)
+        return -1;
+
+    for (size_t i = 0; i < num_threads; ++i)
+        m_queues.push_back(new MapUpdateQueue);
+
+    m_workerIndex = 0;
+    m_queuedRequests = 0;
+    m_stopping = false;
+
+    if (ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, (int)num_threads) == -1)
+    {
+        for (MapUpdateQueueList::iterator itr = m_queues.begin(); itr != m_queues.end(); ++itr)
+            delete *itr;
+        m_queues.clear();
+        return -1;
+    }
+
+    m_activated = true;
+    return 0;
 }
 
 int MapUpdater::deactivate()
 {
+    if (!activated())
+        return -1;
+
     wait();
 
-    return m_executor.deactivate();
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+        m_stopping = true;
+        m_workCondition.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+
+    for (MapUpdateQueueList::iterator itr = m_queues.begin(); itr != m_queues.end(); ++itr)
+        delete *itr;
+    m_queues.clear();
+
+    m_activated = false;
+    return 0;
 }
 
 void MapUpdater::ReActivate(uint32 threads)
@@ -87,8 +276,125 @@ void MapUpdater::ReActivate(uint32 threads)
     SetBroken(false);
 }
 
+int MapUpdater::svc()
+{
+    size_t const index = size_t(m_workerIndex++) % m_queues.size();
+    MapUpdateQueue* queue = m_queues[index];
+
+    for (;;)
+    {
+        MapUpdateTask* rq = queue->pop_front();
+        if (!rq)
+            rq = steal(index);
+
+        if (!rq)
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+
+            while (m_queuedRequests.value() <= 0 && !m_stopping)
+                m_workCondition.wait();
+
+            if (m_stopping && m_queuedRequests.value() <= 0)
+                break;
+
+            continue;
+        }
+
+        --m_queuedRequests;
+
+        rq->call();
+        delete rq;
+    }
+
+    return 0;
+}
+
+MapUpdateTask* MapUpdater::steal(size_t thiefIndex)
+{
+    for (size_t i = 1; i < m_queues.size(); ++i)
+    {
+        if (MapUpdateTask* rq = m_queues[(thiefIndex + i) % m_queues.size()]->pop_back())
+        {
+            ++m_stealCount;
+            return rq;
+        }
+    }
+
+    return NULL;
+}
+
+void MapUpdater::dispatch()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+
+    if (m_scheduled.empty())
+        return;
+
+    for (MapUpdateRequestList::iterator itr = m_scheduled.begin(); itr != m_scheduled.end(); ++itr)
+    {
+        MapUpdateTimeMap::const_iterator data = m_timeData.find(MapID((*itr)->GetMap().GetId(), (*itr)->GetMap().GetInstanceId()));
+        // +1 for maps updated faster than timer resolution, still must be distributed between threads
+        (*itr)->SetCost(data != m_timeData.end() ? data->second.lastTime + 1 : 1);
+    }
+
+    std::sort(m_scheduled.begin(), m_scheduled.end(), MapUpdateRequestCostOrder());
+
+    // longest processing time first: every request goes to the worker with smallest planned load
+    std::vector<uint64> plannedLoad(m_queues.size(), 0);
+    for (MapUpdateRequestList::iterator itr = m_scheduled.begin(); itr != m_scheduled.end(); ++itr)
+    {
+        size_t target = 0;
+        for (size_t i = 1; i < plannedLoad.size(); ++i)
+            if (plannedLoad[i] < plannedLoad[target])
+                target = i;
+
+        plannedLoad[target] += (*itr)->GetCost();
+        m_queues[target]->push(*itr);
+        ++m_queuedRequests;
+    }
+
+    m_scheduled.clear();
+    m_workCondition.broadcast();
+}
+
+void MapUpdater::execute_parallel(MapUpdateTaskList const& tasks)
+{
+    if (tasks.empty())
+        return;
+
+    if (!activated() || tasks.size() == 1)
+    {
+        for (MapUpdateTaskList::const_iterator itr = tasks.begin(); itr != tasks.end(); ++itr)
+            (*itr)->call();
+        return;
+    }
+
+    MapUpdateTaskGroup* group = new MapUpdateTaskGroup(tasks);
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+
+        // one helper less than tasks, the calling thread executes group tasks itself
+        size_t helpers = std::min(tasks.size() - 1, m_queues.size());
+        for (size_t i = 0; i < helpers; ++i)
+        {
+            m_queues[i]->push(new MapUpdateTaskGroupHelper(group));
+            ++m_queuedRequests;
+        }
+
+        m_workCondition.broadcast();
+    }
+
+    while (group->ExecuteNext()) {}
+
+    group->WaitFinished();
+    group->Release();
+}
+
 int MapUpdater::wait()
 {
+    dispatch();
+
     ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
 
     while (pending_requests > 0)
@@ -101,22 +407,21 @@ int MapUpdater::schedule_update(Map& map, ACE_UINT32 diff)
 {
     ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
 
-    ++pending_requests;
-
-    if (m_executor.execute(new MapUpdateRequest(map, *this, diff)) == -1)
+    if (!activated())
     {
         ACE_DEBUG((LM_ERROR, ACE_TEXT("(%t) \n"), ACE_TEXT("Failed to schedule Map Update")));
-
-        --pending_requests;
         return -1;
     }
 
+    ++pending_requests;
+    m_scheduled.push_back(new MapUpdateRequest(map, *this, diff));
+
     return 0;
 }
 
 bool MapUpdater::activated()
 {
-    return m_executor.activated();
+    return m_activated;
 }
 
 void MapUpdater::update_finished()
@@ -134,6 +439,36 @@ void MapUpdater::update_finished()
     m_condition.broadcast();
 }
 
+void MapUpdater::AddMapUpdateTime(MapID const& mapPair, uint32 time)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+
+    m_timeData[mapPair].AddSample(time);
+
+    m_tickBusyTime += time;
+    if (time > m_tickCriticalTime)
+        m_tickCriticalTime = time;
+}
+
+void MapUpdater::RemoveMapUpdateTime(MapID const& mapPair)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+    m_timeData.erase(mapPair);
+}
+
+void MapUpdater::ResetTickTime()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+    m_tickBusyTime = 0;
+    m_tickCriticalTime = 0;
+}
+
+void MapUpdater::GetMapUpdateTimeData(MapUpdateTimeMap& data)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+    data = m_timeData;
+}
+
 void MapUpdater::register_thread(ACE_thread_t const threadId, uint32 mapId, uint32 instanceId)
 {
     ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
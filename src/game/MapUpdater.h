@@ -19,15 +19,26 @@
 #ifndef _MAP_UPDATER_H_INCLUDED
 #define _MAP_UPDATER_H_INCLUDED
 
+#include <ace/Task.h>
 #include <ace/Thread_Mutex.h>
 #include <ace/Condition_Thread_Mutex.h>
+#include <ace/Atomic_Op.h>
 
-#include "DelayExecutor.h"
 #include "Common.h"
 
 class Map;
+class MapUpdateRequest;
+class MapUpdateQueue;
 struct MapID;
 
+// Unit of work executed by MapUpdater threads
+class MapUpdateTask
+{
+    public:
+        virtual ~MapUpdateTask() {}
+        virtual int call() = 0;
+};
+
 struct MapBrokenData
 {
     explicit MapBrokenData()
@@ -46,11 +57,45 @@ struct MapBrokenData
     time_t lastErrorTime;
 };
 
+#define MAP_UPDATE_HISTOGRAM_BUCKETS 10
+
+// Measured update time of a single map, used for cost ordered dispatch and load balancing
+struct MapUpdateTimeData
+{
+    MapUpdateTimeData() : lastTime(0), maxTime(0), totalTime(0), count(0)
+    {
+        memset(histogram, 0, sizeof(histogram));
+    }
+
+    void AddSample(uint32 time);
+
+    // upper bound (in ms) of histogram bucket, last bucket is unbounded
+    static uint32 GetBucketBound(uint32 bucket);
+
+    uint32 lastTime;
+    uint32 maxTime;
+    uint64 totalTime;
+    uint32 count;
+    uint32 histogram[MAP_UPDATE_HISTOGRAM_BUCKETS];
+};
+
 typedef std::map<ACE_thread_t const, MapID> ThreadMapMap;
 typedef std::map<ACE_thread_t const, uint32/*MSTime*/>  ThreadStartTimeMap;
 typedef std::map<MapID,MapBrokenData> MapBrokenDataMap;
+typedef std::map<MapID,MapUpdateTimeData> MapUpdateTimeMap;
+typedef std::vector<MapUpdateQueue*> MapUpdateQueueList;
+typedef std::vector<MapUpdateRequest*> MapUpdateRequestList;
+typedef std::vector<MapUpdateTask*> MapUpdateTaskList;
 
-class MapUpdater
+/**
+ * Thread pool updating maps in parallel.
+ *
+ * Every worker owns a request deque; requests scheduled for a tick are collected first and dispatched
+ * in wait(), ordered by the update time each map took at the previous tick (largest first) and
+ * distributed to the least loaded worker. A worker that drains its own deque steals from the tail of
+ * the other ones, so a single slow map does not leave the rest of the pool idle behind it.
+ */
+class MapUpdater : protected ACE_Task_Base
 {
     public:
 
@@ -63,6 +108,9 @@ class MapUpdater
 
         int wait();
 
+        // executes all tasks on the pool, calling thread takes part and returns when all are done (tasks stay owned by caller)
+        void execute_parallel(MapUpdateTaskList const& tasks);
+
         int activate(size_t num_threads);
 
         int deactivate();
@@ -71,6 +119,8 @@ class MapUpdater
 
         void update_finished();
 
+        virtual int svc();
+
         void register_thread(ACE_thread_t const threadId, uint32 mapId, uint32 instanceId);
         void unregister_thread(ACE_thread_t const threadId);
 
@@ -84,13 +134,37 @@ class MapUpdater
         void MapBrokenEvent(MapID const* mapPair);
         MapBrokenData const* GetMapBrokenData(MapID const* mapPair);
 
+        // statistics
+        void AddMapUpdateTime(MapID const& mapPair, uint32 time);
+        void RemoveMapUpdateTime(MapID const& mapPair);
+        void GetMapUpdateTimeData(MapUpdateTimeMap& data);
+        void ResetTickTime();
+        uint32 GetLastTickBusyTime() const { return m_tickBusyTime; }
+        uint32 GetLastTickCriticalTime() const { return m_tickCriticalTime; }
+        uint32 GetStealCount() const { return uint32(m_stealCount.value()); }
+
     private:
 
+        void dispatch();
+        MapUpdateTask* steal(size_t thiefIndex);
+
         ACE_Thread_Mutex m_mutex;
-        ACE_Condition_Thread_Mutex m_condition;
-        DelayExecutor m_executor;
+        ACE_Condition_Thread_Mutex m_condition;             // signaled at request finish
+        ACE_Condition_Thread_Mutex m_workCondition;         // signaled at dispatch and deactivate
         size_t pending_requests;
 
+        MapUpdateQueueList m_queues;
+        MapUpdateRequestList m_scheduled;                   // collected by schedule_update, not yet dispatched
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_queuedRequests;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_workerIndex;
+        bool m_activated;
+        bool m_stopping;
+
+        MapUpdateTimeMap m_timeData;
+        uint32 m_tickBusyTime;                              // sum of map update times at last tick
+        uint32 m_tickCriticalTime;                          // longest map update time at last tick
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_stealCount; // incremented by worker threads
+
         ThreadMapMap m_threads;
         ThreadStartTimeMap m_starttime;
         MapBrokenDataMap   m_brokendata;
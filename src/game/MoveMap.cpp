@@ -80,6 +80,104 @@ namespace MMAP
         }
     }
 
+    // ######################## PathCache ########################
+    bool PathCache::Find(PathCacheKey const& key, dtPolyRef* path, uint32& pathLength, uint32 maxPathLength)
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+
+        EntryIndex::iterator itr = m_index.find(key);
+        if (itr == m_index.end() || itr->second->path.size() > maxPathLength)
+            return false;
+
+        // move to front of use order
+        m_entries.splice(m_entries.begin(), m_entries, itr->second);
+
+        std::vector<dtPolyRef> const& cached = itr->second->path;
+        pathLength = cached.size();
+        std::copy(cached.begin(), cached.end(), path);
+        return true;
+    }
+
+    void PathCache::Insert(PathCacheKey const& key, dtPolyRef const* path, uint32 pathLength)
+    {
+        uint32 maxEntries = sWorld.getConfig(CONFIG_UINT32_MMAP_PATH_CACHE_SIZE);
+        if (!maxEntries)
+            return;
+
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+        EntryIndex::iterator itr = m_index.find(key);
+        if (itr != m_index.end())
+        {
+            m_entries.splice(m_entries.begin(), m_entries, itr->second);
+            itr->second->path.assign(path, path + pathLength);
+            return;
+        }
+
+        while (m_entries.size() >= maxEntries)
+        {
+            m_index.erase(m_entries.back().key);
+            m_entries.pop_back();
+        }
+
+        m_entries.push_front(Entry(key));
+        m_entries.front().path.assign(path, path + pathLength);
+        m_index.insert(EntryIndex::value_type(key, m_entries.begin()));
+    }
+
+    void PathCache::InvalidateTile(dtNavMesh const* navMesh, dtTileRef tileRef)
+    {
+        uint32 tileIndex = navMesh->decodePolyIdTile(tileRef);
+
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+        for (EntryList::iterator itr = m_entries.begin(); itr != m_entries.end();)
+        {
+            std::vector<dtPolyRef>::const_iterator poly = itr->path.begin();
+            for (; poly != itr->path.end(); ++poly)
+                if (navMesh->decodePolyIdTile(*poly) == tileIndex)
+                    break;
+
+            if (poly == itr->path.end())
+            {
+                ++itr;
+                continue;
+            }
+
+            m_index.erase(itr->key);
+            itr = m_entries.erase(itr);
+        }
+    }
+
+    void PathCache::InvalidateNeighbours(dtNavMesh const* navMesh, int tileX, int tileY)
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+        for (EntryList::iterator itr = m_entries.begin(); itr != m_entries.end();)
+        {
+            bool drop = false;
+            dtPolyRef ends[2] = { itr->key.startPoly, itr->key.endPoly };
+            for (int i = 0; i < 2 && !drop; ++i)
+            {
+                dtMeshTile const* tile = NULL;
+                dtPoly const* poly = NULL;
+                if (dtStatusFailed(navMesh->getTileAndPolyByRef(ends[i], &tile, &poly)))
+                    drop = true;                            // polygon no longer exists
+                else
+                    drop = abs(tile->header->x - tileX) <= 1 && abs(tile->header->y - tileY) <= 1;
+            }
+
+            if (!drop)
+            {
+                ++itr;
+                continue;
+            }
+
+            m_index.erase(itr->key);
+            itr = m_entries.erase(itr);
+        }
+    }
+
     // ######################## MMapManager ########################
     MMapManager::~MMapManager()
     {
@@ -93,8 +191,11 @@ namespace MMAP
     bool MMapManager::loadMapData(uint32 mapId)
     {
         // we already have this map loaded?
-        if (loadedMMaps.find(mapId) != loadedMMaps.end())
-            return true;
+        {
+            ReadGuard Guard(GetLock(mapId));
+            if (loadedMMaps.find(mapId) != loadedMMaps.end())
+                return true;
+        }
 
         // load and init dtNavMesh - read parameters from file
         uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i.mmap") + 1;
@@ -129,8 +230,15 @@ namespace MMAP
 
         DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMapData: Loaded %03i.mmap", mapId);
 
-        // store inside our map list
-        MMapData* mmap_data = new MMapData(mesh);
+        // store inside our map list, unless other map thread was faster
+        WriteGuard Guard(GetLock(mapId));
+        if (loadedMMaps.find(mapId) != loadedMMaps.end())
+        {
+            dtFreeNavMesh(mesh);
+            return true;
+        }
+
+        MMapData* mmap_data = new MMapData(mesh, ++loadCounter);
         mmap_data->mmapLoadedTiles.clear();
 
         loadedMMaps.insert(std::pair<uint32, MMapData*>(mapId, mmap_data));
@@ -149,7 +257,11 @@ namespace MMAP
             return false;
 
         // get this mmap data
-        MMapData* mmap = loadedMMaps[mapId];
+        MMapData* mmap;
+        {
+            ReadGuard Guard(GetLock(mapId));
+            mmap = loadedMMaps[mapId];
+        }
         MANGOS_ASSERT(mmap->navMesh);
 
         // check if we already have this tile loaded
@@ -210,8 +322,13 @@ namespace MMAP
 
         dtStatus dtResult;
         {
-            ReadGuard Guard(GetLock(mapId));
+            // links of neighbour tiles are changed, so no path search may run meanwhile
+            WriteGuard Guard(GetLock(mapId));
             dtResult = mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef);
+
+            // new tile may give shorter paths than cached ones around it
+            if (dtStatusSucceed(dtResult))
+                mmap->pathCache.InvalidateNeighbours(mmap->navMesh, header->x, header->y);
         }
 
         // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
@@ -259,6 +376,10 @@ namespace MMAP
         {
             WriteGuard Guard(GetLock(mapId));
             dtResult = mmap->navMesh->removeTile(tileRef, NULL, NULL);
+
+            // cached paths may reference polygons of removed tile, drop them before path searches can continue
+            if (dtStatusSucceed(dtResult))
+                mmap->pathCache.InvalidateTile(mmap->navMesh, tileRef);
         }
         // unload, and mark as non loaded
         if (dtStatusFailed(dtResult))
@@ -289,6 +410,9 @@ namespace MMAP
             return false;
         }
 
+        // path workers may search on this navmesh until it is removed from the list
+        WriteGuard Guard(GetLock(mapId));
+
         // unload all tiles from given map
         MMapData* mmap = loadedMMaps[mapId];
         for (MMapTileSet::iterator i = mmap->mmapLoadedTiles.begin(); i != mmap->mmapLoadedTiles.end(); ++i)
@@ -338,12 +462,25 @@ namespace MMAP
         return true;
     }
 
-    dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
+    dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId, uint32* loadId /*= NULL*/)
     {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
+            return NULL;
+
+        if (loadId)
+            *loadId = itr->second->loadId;
+
+        return itr->second->navMesh;
+    }
+
+    PathCache* MMapManager::GetPathCache(uint32 mapId)
+    {
+        MMapDataSet::iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
             return NULL;
 
-        return loadedMMaps[mapId]->navMesh;
+        return &itr->second->pathCache;
     }
 
     dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
@@ -28,6 +28,9 @@
 #include "ObjectLock.h"
 #include "MapManager.h"
 
+#include <ace/Thread_Mutex.h>
+#include <ace/Atomic_Op.h>
+
 //  memory management
 inline void* dtCustomAlloc(int size, dtAllocHint /*hint*/)
 {
@@ -45,10 +48,62 @@ namespace MMAP
     typedef UNORDERED_MAP<uint32, dtTileRef> MMapTileSet;
     typedef UNORDERED_MAP<uint32, dtNavMeshQuery*> NavMeshQuerySet;
 
+    struct PathCacheKey
+    {
+        PathCacheKey(dtPolyRef start, dtPolyRef end, uint16 include, uint16 exclude) :
+            startPoly(start), endPoly(end), includeFlags(include), excludeFlags(exclude) {}
+
+        bool operator<(PathCacheKey const& other) const
+        {
+            if (startPoly != other.startPoly)
+                return startPoly < other.startPoly;
+            if (endPoly != other.endPoly)
+                return endPoly < other.endPoly;
+            if (includeFlags != other.includeFlags)
+                return includeFlags < other.includeFlags;
+            return excludeFlags < other.excludeFlags;
+        }
+
+        dtPolyRef startPoly;
+        dtPolyRef endPoly;
+        uint16 includeFlags;
+        uint16 excludeFlags;
+    };
+
+    // polygon paths found on a map, shared by all its instances since polyrefs are navmesh wide
+    // least recently used paths are dropped when cache is full, paths crossing a tile are dropped at its unload,
+    // paths starting or ending next to a tile are dropped at its load since it may give shorter ones
+    class PathCache
+    {
+        public:
+            bool Find(PathCacheKey const& key, dtPolyRef* path, uint32& pathLength, uint32 maxPathLength);
+            void Insert(PathCacheKey const& key, dtPolyRef const* path, uint32 pathLength);
+            // drop paths with any polygon of the tile, must be called under map's write lock
+            void InvalidateTile(dtNavMesh const* navMesh, dtTileRef tileRef);
+            // drop paths with start or end polygon in tile (x,y) or next to it, must be called under map's write lock
+            void InvalidateNeighbours(dtNavMesh const* navMesh, int tileX, int tileY);
+
+        private:
+            struct Entry
+            {
+                Entry(PathCacheKey const& k) : key(k) {}
+
+                PathCacheKey key;
+                std::vector<dtPolyRef> path;
+            };
+
+            typedef std::list<Entry> EntryList;                         // most recently used first
+            typedef std::map<PathCacheKey, EntryList::iterator> EntryIndex;
+
+            ACE_Thread_Mutex m_lock;
+            EntryList m_entries;
+            EntryIndex m_index;
+    };
+
     // dummy struct to hold map's mmap data
     struct MMapData
     {
-        MMapData(dtNavMesh* mesh) : navMesh(mesh) {}
+        MMapData(dtNavMesh* mesh, uint32 id) : navMesh(mesh), loadId(id) {}
         ~MMapData()
         {
             for (NavMeshQuerySet::iterator i = navMeshQueries.begin(); i != navMeshQueries.end(); ++i)
@@ -59,10 +114,12 @@ namespace MMAP
         }
 
         dtNavMesh* navMesh;
+        uint32 loadId;                      // unique per loaded navmesh, its address may be reused after unload
 
         // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
         NavMeshQuerySet navMeshQueries;     // instanceId to query
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
+        PathCache pathCache;
     };
 
 
@@ -73,7 +130,7 @@ namespace MMAP
     class MMapManager
     {
         public:
-            MMapManager() : loadedTiles(0) {}
+            MMapManager() : loadedTiles(0), loadCounter(0), pathCacheHits(0), pathCacheMisses(0) {}
             ~MMapManager();
 
             bool loadMap(uint32 mapId, int32 x, int32 y);
@@ -83,11 +140,19 @@ namespace MMAP
 
             // the returned [dtNavMeshQuery const*] is NOT threadsafe
             dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
-            dtNavMesh const* GetNavMesh(uint32 mapId);
+            // maps are loaded and unloaded under write lock of GetLock(), lookups outside
+            // map update threads (path workers) must hold its read lock while using the result
+            dtNavMesh const* GetNavMesh(uint32 mapId, uint32* loadId = NULL);
+            // NULL if map has no mmap data loaded
+            PathCache* GetPathCache(uint32 mapId);
 
             uint32 getLoadedTilesCount() const { return loadedTiles; }
             uint32 getLoadedMapsCount() const { return loadedMMaps.size(); }
 
+            void addPathCacheResult(bool hit) { if (hit) ++pathCacheHits; else ++pathCacheMisses; }
+            uint32 getPathCacheHits() const { return uint32(pathCacheHits.value()); }
+            uint32 getPathCacheMisses() const { return uint32(pathCacheMisses.value()); }
+
             ObjectLockType& GetLock(uint32 mapId, MapLockType _lockType = MAP_LOCK_TYPE_MOVEMENT);
 
         private:
@@ -96,6 +161,10 @@ namespace MMAP
 
             MMapDataSet loadedMMaps;
             uint32 loadedTiles;
+            uint32 loadCounter;
+
+            ACE_Atomic_Op<ACE_Thread_Mutex, long> pathCacheHits;
+            ACE_Atomic_Op<ACE_Thread_Mutex, long> pathCacheMisses;
     };
 
     // static class
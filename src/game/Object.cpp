@@ -51,6 +51,36 @@
 
 #define TERRAIN_LOS_STEP_DISTANCE   3.0f        // sample distance for terrain LoS
 
+#define UF_FLAG_BITS 9                                      // UF_FLAG_DYNAMIC is highest flag
+
+// fields of object type having each update field flag, built from *UpdateFieldFlags tables at static init
+struct UpdateFieldFlagMasks
+{
+    UpdateFieldFlagMasks(uint32 const* flags, uint32 count)
+    {
+        for (uint32 bit = 0; bit < UF_FLAG_BITS; ++bit)
+            masks[bit].SetCount(count);
+
+        for (uint32 index = 0; index < count; ++index)
+            for (uint32 bit = 0; bit < UF_FLAG_BITS; ++bit)
+                if (flags[index] & (1 << bit))
+                    masks[bit].SetBit(index);
+    }
+
+    UpdateMask masks[UF_FLAG_BITS];
+};
+
+static UpdateFieldFlagMasks const s_itemFieldFlagMasks(ItemUpdateFieldFlags, CONTAINER_END);
+static UpdateFieldFlagMasks const s_unitFieldFlagMasks(UnitUpdateFieldFlags, PLAYER_END);
+static UpdateFieldFlagMasks const s_gameObjectFieldFlagMasks(GameObjectUpdateFieldFlags, GAMEOBJECT_END);
+static UpdateFieldFlagMasks const s_dynamicObjectFieldFlagMasks(DynamicObjectUpdateFieldFlags, DYNAMICOBJECT_END);
+static UpdateFieldFlagMasks const s_corpseFieldFlagMasks(CorpseUpdateFieldFlags, CORPSE_END);
+
+static inline uint32 UpdateFieldFlagBit(uint32 flag)
+{
+    return UpdateMaskLowestBit(flag);
+}
+
 UpdateFieldData::UpdateFieldData(Object const* object, Player* target)
 {
     m_isSelf = object == target;
@@ -63,12 +93,14 @@ UpdateFieldData::UpdateFieldData(Object const* object, Player* target)
         case TYPEID_ITEM:
         case TYPEID_CONTAINER:
             m_flags = ItemUpdateFieldFlags;
+            m_flagMasks = s_itemFieldFlagMasks.masks;
             m_isOwner = m_isItemOwner = ((Item*)object)->GetOwnerGuid() == target->GetObjectGuid();
             break;
         case TYPEID_UNIT:
         case TYPEID_PLAYER:
         {
             m_flags = UnitUpdateFieldFlags;
+            m_flagMasks = s_unitFieldFlagMasks.masks;
             m_isOwner = ((Unit*)object)->GetOwnerGuid() == target->GetObjectGuid();
             m_hasSpecialInfo = ((Unit*)object)->HasAuraTypeWithCaster(SPELL_AURA_EMPATHY, target->GetObjectGuid());
             if (Player* pPlayer = ((Unit*)object)->GetCharmerOrOwnerPlayerOrPlayerItself())
@@ -77,14 +109,17 @@ UpdateFieldData::UpdateFieldData(Object const* object, Player* target)
         }
         case TYPEID_GAMEOBJECT:
             m_flags = GameObjectUpdateFieldFlags;
+            m_flagMasks = s_gameObjectFieldFlagMasks.masks;
             m_isOwner = ((GameObject*)object)->GetOwnerGuid() == target->GetObjectGuid();
             break;
         case TYPEID_DYNAMICOBJECT:
             m_flags = DynamicObjectUpdateFieldFlags;
+            m_flagMasks = s_dynamicObjectFieldFlagMasks.masks;
             m_isOwner = ((DynamicObject*)object)->GetCasterGuid() == target->GetObjectGuid();
             break;
         case TYPEID_CORPSE:
             m_flags = CorpseUpdateFieldFlags;
+            m_flagMasks = s_corpseFieldFlagMasks.masks;
             m_isOwner = ((Corpse*)object)->GetOwnerGuid() == target->GetObjectGuid();
             break;
     }
@@ -105,6 +140,30 @@ bool UpdateFieldData::IsUpdateFieldVisible(uint16 fieldIndex) const
     return false;
 }
 
+void UpdateFieldData::AddUpdateNeededFields(UpdateMask& mask, uint32 fieldNotifyFlags) const
+{
+    if (m_hasSpecialInfo)
+        fieldNotifyFlags |= UF_FLAG_SPECIAL_INFO;
+
+    for (uint32 bit = 0; bit < UF_FLAG_BITS; ++bit)
+        if (fieldNotifyFlags & (1 << bit))
+            mask |= m_flagMasks[bit];
+}
+
+void UpdateFieldData::AddVisibleFields(UpdateMask& mask) const
+{
+    mask |= m_flagMasks[UpdateFieldFlagBit(UF_FLAG_PUBLIC)];
+
+    if (m_isSelf)
+        mask |= m_flagMasks[UpdateFieldFlagBit(UF_FLAG_PRIVATE)];
+    if (m_isOwner)
+        mask |= m_flagMasks[UpdateFieldFlagBit(UF_FLAG_OWNER)];
+    if (m_isItemOwner)
+        mask |= m_flagMasks[UpdateFieldFlagBit(UF_FLAG_ITEM_OWNER)];
+    if (m_isPartyMember)
+        mask |= m_flagMasks[UpdateFieldFlagBit(UF_FLAG_PARTY_MEMBER)];
+}
+
 Object::Object()
 {
     m_objectTypeId        = TYPEID_OBJECT;
@@ -141,7 +200,7 @@ void Object::_InitValues()
     m_uint32Values = new uint32[m_valuesCount];
     memset(m_uint32Values, 0, m_valuesCount * sizeof(uint32));
 
-    m_changedValues.resize(m_valuesCount, false);
+    m_changedValues.resize((m_valuesCount + 31) / 32, 0);
 
     m_objectUpdated = false;
 }
@@ -181,7 +240,7 @@ void Object::SendForcedObjectUpdate()
         if (!pPlayer)
             continue;
 
-        iter->second.BuildPacket(&packet);
+        iter->second.BuildPacket(&packet, pPlayer->GetSession()->GetUpdateDataCompressor());
         pPlayer->GetSession()->SendPacket(&packet);
         packet.clear();                                     // clean the string
     }
@@ -274,8 +333,53 @@ void Object::SendCreateUpdateToPlayer(Player* player)
     player->GetSession()->SendPacket(&packet);
 }
 
-void Object::BuildValuesUpdateBlockForPlayer(UpdateData *data, Player *target) const
+void Object::BuildValuesUpdateBlockForPlayer(UpdateData *data, Player *target, UpdateValuesBlockCache* cache /*= NULL*/) const
 {
+    if (cache && target)
+    {
+        UpdateValuesBlockCache::Entry& entry = cache->GetEntry(UpdateFieldData(this, target).GetVisibilityKey());
+
+        if (!entry.target)
+        {
+            entry.target = target;
+            entry.block.reserve(500);
+
+            entry.block << uint8(UPDATETYPE_VALUES);
+            entry.block << GetPackGUID();
+
+            UpdateMask updateMask;
+            updateMask.SetCount(m_valuesCount);
+
+            _SetUpdateBits(&updateMask, target);
+
+            size_t valuesPos = entry.block.wpos() + 1 + updateMask.GetLength();
+            BuildValuesUpdate(UPDATETYPE_VALUES, &entry.block, &updateMask, target);
+
+            // every field value is sent as 4 bytes, remember where target dependent ones are
+            for (uint32 index = updateMask.GetNextSetBit(0); index < m_valuesCount; index = updateMask.GetNextSetBit(index + 1))
+            {
+                if (IsTargetDependentUpdateField(index))
+                    entry.patches.push_back(std::pair<uint16, uint32>(index, uint32(valuesPos)));
+
+                valuesPos += sizeof(uint32);
+            }
+        }
+
+        size_t blockPos = data->AddSharedUpdateBlock(entry.block);
+
+        if (entry.target == target || entry.patches.empty())
+            return;
+
+        bool isActivateToQuest = isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsDynTransport() &&
+            (((GameObject*)this)->ActivateToQuest(target) || target->isGameMaster());
+        bool isPerCasterAuraState = isType(TYPEMASK_UNIT) && ((Unit*)this)->HasAuraState(AURA_STATE_CONFLAGRATE);
+
+        for (std::vector<std::pair<uint16, uint32> >::const_iterator itr = entry.patches.begin(); itr != entry.patches.end(); ++itr)
+            data->PutUpdateBlockValue(blockPos + itr->second, GetUpdateFieldValueForTarget(itr->first, target, isActivateToQuest, isPerCasterAuraState));
+
+        return;
+    }
+
     ByteBuffer buf(500);
 
     buf << uint8(UPDATETYPE_VALUES);
@@ -530,213 +634,211 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer * data, UpdateMask *
     MANGOS_ASSERT(updateMask && updateMask->GetCount() == m_valuesCount);
 
     *data << (uint8)updateMask->GetBlockCount();
-    data->append(updateMask->GetMask(), updateMask->GetLength());
+    for (uint32 block = 0; block < updateMask->GetBlockCount(); ++block)
+        *data << updateMask->GetBlock(block);
 
-    // 2 specialized loops for speed optimization in non-unit case
-    if (isType(TYPEMASK_UNIT))                              // unit (creature/player) case
+    // 2 specialized loops for speed optimization in non-unit/gameobject case, both walk set bits only
+    if (isType(TYPEMASK_UNIT | TYPEMASK_GAMEOBJECT))
     {
-        for(uint16 index = 0; index < m_valuesCount; ++index)
+        for (uint32 index = updateMask->GetNextSetBit(0); index < m_valuesCount; index = updateMask->GetNextSetBit(index + 1))
         {
-            if (updateMask->GetBit(index))
+            if (IsTargetDependentUpdateField(index))
+                *data << GetUpdateFieldValueForTarget(index, target, IsActivateToQuest, IsPerCasterAuraState);
+            // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
+            else if (isType(TYPEMASK_UNIT) && index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
             {
-                if (index == UNIT_NPC_FLAGS)
-                {
-                    uint32 appendValue = m_uint32Values[index];
+                // convert from float to uint32 and send
+                *data << uint32(m_floatValues[index] < 0 ? 0 : m_floatValues[index]);
+            }
 
-                    if (GetTypeId() == TYPEID_UNIT)
-                    {
-                        if (!target->canSeeSpellClickOn((Creature*)this))
-                            appendValue &= ~UNIT_NPC_FLAG_SPELLCLICK;
-
-                        if (appendValue & UNIT_NPC_FLAG_TRAINER)
-                        {
-                            if (!((Creature*)this)->IsTrainerOf(target, false))
-                                appendValue &= ~(UNIT_NPC_FLAG_TRAINER | UNIT_NPC_FLAG_TRAINER_CLASS | UNIT_NPC_FLAG_TRAINER_PROFESSION);
-                        }
-
-                        if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
-                        {
-                            if (target->getClass() != CLASS_HUNTER)
-                                appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
-                        }
-                    }
+            // there are some float values which may be negative or can't get negative due to other checks
+            else if (isType(TYPEMASK_UNIT) && ((index >= UNIT_FIELD_NEGSTAT0 && index <= UNIT_FIELD_NEGSTAT4) ||
+                (index >= UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
+                (index >= UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
+                (index >= UNIT_FIELD_POSSTAT0 && index <= UNIT_FIELD_POSSTAT4)))
+            {
+                *data << uint32(m_floatValues[index]);
+            }
+            else
+            {
+                // send in current format (float as float, uint32 as uint32)
+                *data << m_uint32Values[index];
+            }
+        }
+    }
+    else                                                    // other objects case (no special index checks)
+    {
+        // send in current format (float as float, uint32 as uint32)
+        for (uint32 index = updateMask->GetNextSetBit(0); index < m_valuesCount; index = updateMask->GetNextSetBit(index + 1))
+            *data << m_uint32Values[index];
+    }
+}
 
-                    *data << uint32(appendValue);
-                }
-                else if (index == UNIT_FIELD_AURASTATE)
-                {
-                    if (IsPerCasterAuraState)
-                    {
-                        // IsPerCasterAuraState set if related pet caster aura state set already
-                        if (((Unit*)this)->HasAuraStateForCaster(AURA_STATE_CONFLAGRATE, target->GetObjectGuid()))
-                            *data << m_uint32Values[index];
-                        else
-                            *data << (m_uint32Values[index] & ~(1 << (AURA_STATE_CONFLAGRATE-1)));
-                    }
-                    else
-                        *data << m_uint32Values[index];
-                }
-                // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
-                else if (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
-                {
-                    // convert from float to uint32 and send
-                    *data << uint32(m_floatValues[index] < 0 ? 0 : m_floatValues[index]);
-                }
+bool Object::IsTargetDependentUpdateField(uint16 index) const
+{
+    if (isType(TYPEMASK_UNIT))
+        return index == UNIT_NPC_FLAGS || index == UNIT_FIELD_AURASTATE || index == UNIT_FIELD_FLAGS ||
+            index == UNIT_DYNAMIC_FLAGS || index == UNIT_FIELD_BYTES_2 || index == UNIT_FIELD_FACTIONTEMPLATE;
 
-                // there are some float values which may be negative or can't get negative due to other checks
-                else if ((index >= UNIT_FIELD_NEGSTAT0 && index <= UNIT_FIELD_NEGSTAT4) ||
-                    (index >= UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
-                    (index >= UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
-                    (index >= UNIT_FIELD_POSSTAT0 && index <= UNIT_FIELD_POSSTAT4))
-                {
-                    *data << uint32(m_floatValues[index]);
-                }
+    if (isType(TYPEMASK_GAMEOBJECT))
+        return index == GAMEOBJECT_DYNAMIC;
 
-                // Gamemasters should be always able to select units - remove not selectable flag
-                else if (index == UNIT_FIELD_FLAGS && target->isGameMaster())
-                {
-                    *data << (m_uint32Values[index] & ~UNIT_FLAG_NOT_SELECTABLE);
-                }
-                // hide lootable animation for unallowed players
-                else if (index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_UNIT)
-                {
-                    if (!target->isAllowedToLoot((Creature*)this))
-                        *data << (m_uint32Values[index] & ~(UNIT_DYNFLAG_LOOTABLE | UNIT_DYNFLAG_TAPPED_BY_PLAYER));
-                    else
-                    {
-                        // flag only for original loot recipent
-                        if (target->GetObjectGuid() == ((Creature*)this)->GetLootRecipientGuid())
-                            *data << m_uint32Values[index];
-                        else
-                            *data << (m_uint32Values[index] & ~(UNIT_DYNFLAG_TAPPED | UNIT_DYNFLAG_TAPPED_BY_PLAYER));
-                    }
-                }
-                // hide RAF flag if need
-                else if (index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_PLAYER)
-                {
-                    if (!((Player*)this)->IsReferAFriendLinked(target))
-                        *data << (m_uint32Values[index] & ~UNIT_DYNFLAG_REFER_A_FRIEND);
-                    else
-                        *data << m_uint32Values[index];
-                }
-                // Frozen Mod
-                else if (index == UNIT_FIELD_BYTES_2 || index == UNIT_FIELD_FACTIONTEMPLATE)
-                {
-                    bool ch = false;
+    return false;
+}
 
-                    if((GetTypeId() == TYPEID_PLAYER || GetTypeId() == TYPEID_UNIT) && target != this)
-                    {
-                        bool forcefriendly = false; // bool for pets/totems to offload more code from the big if below
-
-                        if (GetTypeId() == TYPEID_UNIT && ((Creature*)this)->GetOwner())
-                        {
-                            forcefriendly = (((Creature*)this)->IsTotem() || ((Creature*)this)->IsPet())
-                            && (((Creature*)this)->GetOwner()->GetTypeId() == TYPEID_PLAYER
-                                && ((Creature*)this)->GetOwner()->IsFriendlyTo(target)
-                                && ((Creature*)this)->GetOwner() != target
-                                && (target->IsInSameGroupWith((Player*)((Creature*)this)->GetOwner()) || target->IsInSameRaidWith((Player*)((Creature*)this)->GetOwner())));
-                        }
-
-                        if(((Unit*)this)->IsSpoofSamePlayerFaction() || forcefriendly || (target->GetTypeId() == TYPEID_PLAYER && GetTypeId() == TYPEID_PLAYER && (target->IsInSameGroupWith((Player*)this) || target->IsInSameRaidWith((Player*)this))))
-                        {
-                            if (index == UNIT_FIELD_BYTES_2)
-                            {
-                                DEBUG_LOG("-- VALUES_UPDATE: Sending '%s' the blue-group-fix from '%s' (flag)", target->GetName(), ((Unit*)this)->GetName());
-                                *data << ( m_uint32Values[ index ] & (UNIT_BYTE2_FLAG_SANCTUARY << 8) ); // this flag is at uint8 offset 1 !!
-                                ch = true;
-                            }
-                            else if (index == UNIT_FIELD_FACTIONTEMPLATE)
-                            {
-                                FactionTemplateEntry const *ft1, *ft2;
-                                ft1 = ((Unit*)this)->getFactionTemplateEntry();
-                                ft2 = ((Unit*)target)->getFactionTemplateEntry();
-
-                                if (ft1 && ft2 && (!ft1->IsFriendlyTo(*ft2) || ((Unit*)this)->IsSpoofSamePlayerFaction()))
-                                {
-                                    uint32 faction = ((Player*)target)->getFaction(); // pretend that all other HOSTILE players have own faction, to allow follow, heal, rezz (trade wont work)
-                                    DEBUG_LOG("-- VALUES_UPDATE: Sending '%s' the blue-group-fix from '%s' (faction %u)", target->GetName(), ((Unit*)this)->GetName(), faction);
-                                    *data << uint32(faction);
-                                    ch = true;
-                                }
-                            }
-                        }
-                    }
+uint32 Object::GetUpdateFieldValueForTarget(uint16 index, Player* target, bool isActivateToQuest, bool isPerCasterAuraState) const
+{
+    if (isType(TYPEMASK_GAMEOBJECT))
+    {
+        if (index != GAMEOBJECT_DYNAMIC)
+            return m_uint32Values[index];
 
-                    if(!ch)
-                        *data << m_uint32Values[ index ];
-                }
-                // Frozen Mod
-                else
-                {
-                    // send in current format (float as float, uint32 as uint32)
-                    *data << m_uint32Values[index];
-                }
-            }
+        // GAMEOBJECT_TYPE_DUNGEON_DIFFICULTY can have lo flag = 2
+        //      most likely related to "can enter map" and then should be 0 if can not enter
+        // hi part always uint16(-1)
+        uint16 loFlags;
+        switch(((GameObject*)this)->GetGoType())
+        {
+            case GAMEOBJECT_TYPE_QUESTGIVER:
+                // GO also seen with GO_DYNFLAG_LO_SPARKLE explicit, relation/reason unclear (192861)
+                loFlags = isActivateToQuest ? GO_DYNFLAG_LO_ACTIVATE : GO_DYNFLAG_LO_NONE;
+                break;
+            case GAMEOBJECT_TYPE_CHEST:
+            case GAMEOBJECT_TYPE_GENERIC:
+            case GAMEOBJECT_TYPE_SPELL_FOCUS:
+            case GAMEOBJECT_TYPE_GOOBER:
+                loFlags = isActivateToQuest ? (GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE) : GO_DYNFLAG_LO_NONE;
+                break;
+            case GAMEOBJECT_TYPE_TRANSPORT:
+            case GAMEOBJECT_TYPE_MO_TRANSPORT:
+                loFlags = ((GameObject*)this)->GetGoState() != GO_STATE_ACTIVE ? GO_DYNFLAG_LO_TRANSPORT_STOP : GO_DYNFLAG_LO_NONE;
+                break;
+            default:
+                // unknown, not happen.
+                loFlags = GO_DYNFLAG_LO_NONE;
+                break;
         }
+
+        return uint32(loFlags) | (uint32(uint16(-1)) << 16);
     }
-    else if (isType(TYPEMASK_GAMEOBJECT))                   // gameobject case
+
+    if (!isType(TYPEMASK_UNIT))
+        return m_uint32Values[index];
+
+    if (index == UNIT_NPC_FLAGS)
     {
-        for(uint16 index = 0; index < m_valuesCount; ++index)
+        uint32 appendValue = m_uint32Values[index];
+
+        if (GetTypeId() == TYPEID_UNIT)
         {
-            if (updateMask->GetBit(index))
+            if (!target->canSeeSpellClickOn((Creature*)this))
+                appendValue &= ~UNIT_NPC_FLAG_SPELLCLICK;
+
+            if (appendValue & UNIT_NPC_FLAG_TRAINER)
             {
-                // send in current format (float as float, uint32 as uint32)
-                if (index == GAMEOBJECT_DYNAMIC)
-                {
-                    // GAMEOBJECT_TYPE_DUNGEON_DIFFICULTY can have lo flag = 2
-                    //      most likely related to "can enter map" and then should be 0 if can not enter
+                if (!((Creature*)this)->IsTrainerOf(target, false))
+                    appendValue &= ~(UNIT_NPC_FLAG_TRAINER | UNIT_NPC_FLAG_TRAINER_CLASS | UNIT_NPC_FLAG_TRAINER_PROFESSION);
+            }
 
-                    switch(((GameObject*)this)->GetGoType())
-                    {
-                        case GAMEOBJECT_TYPE_QUESTGIVER:
-                            // GO also seen with GO_DYNFLAG_LO_SPARKLE explicit, relation/reason unclear (192861)
-                            *data << uint16(IsActivateToQuest ? GO_DYNFLAG_LO_ACTIVATE : GO_DYNFLAG_LO_NONE);
-                            *data << uint16(-1);
-                            break;
-                        case GAMEOBJECT_TYPE_CHEST:
-                        case GAMEOBJECT_TYPE_GENERIC:
-                        case GAMEOBJECT_TYPE_SPELL_FOCUS:
-                        case GAMEOBJECT_TYPE_GOOBER:
-                            *data << uint16(IsActivateToQuest ? (GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE) : GO_DYNFLAG_LO_NONE);
-                            *data << uint16(-1);
-                            break;
-                        case GAMEOBJECT_TYPE_TRANSPORT:
-                        case GAMEOBJECT_TYPE_MO_TRANSPORT:
-                            *data << uint16(((GameObject*)this)->GetGoState() != GO_STATE_ACTIVE ? GO_DYNFLAG_LO_TRANSPORT_STOP : GO_DYNFLAG_LO_NONE);
-                            *data << uint16(-1);
-                            break;
-                        default:
-                            // unknown, not happen.
-                            *data << uint16(GO_DYNFLAG_LO_NONE);
-                            *data << uint16(-1);
-                            break;
-                    }
-                }
-                else
-                    *data << m_uint32Values[index];         // other cases
+            if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
+            {
+                if (target->getClass() != CLASS_HUNTER)
+                    appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
             }
         }
+
+        return appendValue;
     }
-    else                                                    // other objects case (no special index checks)
+    else if (index == UNIT_FIELD_AURASTATE)
     {
-        for(uint16 index = 0; index < m_valuesCount; ++index)
+        if (isPerCasterAuraState)
         {
-            if (updateMask->GetBit(index))
+            // IsPerCasterAuraState set if related pet caster aura state set already
+            if (((Unit*)this)->HasAuraStateForCaster(AURA_STATE_CONFLAGRATE, target->GetObjectGuid()))
+                return m_uint32Values[index];
+            else
+                return m_uint32Values[index] & ~(1 << (AURA_STATE_CONFLAGRATE-1));
+        }
+        else
+            return m_uint32Values[index];
+    }
+    // Gamemasters should be always able to select units - remove not selectable flag
+    else if (index == UNIT_FIELD_FLAGS && target->isGameMaster())
+    {
+        return m_uint32Values[index] & ~UNIT_FLAG_NOT_SELECTABLE;
+    }
+    // hide lootable animation for unallowed players
+    else if (index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_UNIT)
+    {
+        if (!target->isAllowedToLoot((Creature*)this))
+            return m_uint32Values[index] & ~(UNIT_DYNFLAG_LOOTABLE | UNIT_DYNFLAG_TAPPED_BY_PLAYER);
+        else
+        {
+            // flag only for original loot recipent
+            if (target->GetObjectGuid() == ((Creature*)this)->GetLootRecipientGuid())
+                return m_uint32Values[index];
+            else
+                return m_uint32Values[index] & ~(UNIT_DYNFLAG_TAPPED | UNIT_DYNFLAG_TAPPED_BY_PLAYER);
+        }
+    }
+    // hide RAF flag if need
+    else if (index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_PLAYER)
+    {
+        if (!((Player*)this)->IsReferAFriendLinked(target))
+            return m_uint32Values[index] & ~UNIT_DYNFLAG_REFER_A_FRIEND;
+        else
+            return m_uint32Values[index];
+    }
+    // Frozen Mod
+    else if (index == UNIT_FIELD_BYTES_2 || index == UNIT_FIELD_FACTIONTEMPLATE)
+    {
+        if((GetTypeId() == TYPEID_PLAYER || GetTypeId() == TYPEID_UNIT) && target != this)
+        {
+            bool forcefriendly = false; // bool for pets/totems to offload more code from the big if below
+
+            if (GetTypeId() == TYPEID_UNIT && ((Creature*)this)->GetOwner())
             {
-                // send in current format (float as float, uint32 as uint32)
-                *data << m_uint32Values[index];
+                forcefriendly = (((Creature*)this)->IsTotem() || ((Creature*)this)->IsPet())
+                && (((Creature*)this)->GetOwner()->GetTypeId() == TYPEID_PLAYER
+                    && ((Creature*)this)->GetOwner()->IsFriendlyTo(target)
+                    && ((Creature*)this)->GetOwner() != target
+                    && (target->IsInSameGroupWith((Player*)((Creature*)this)->GetOwner()) || target->IsInSameRaidWith((Player*)((Creature*)this)->GetOwner())));
+            }
+
+            if(((Unit*)this)->IsSpoofSamePlayerFaction() || forcefriendly || (target->GetTypeId() == TYPEID_PLAYER && GetTypeId() == TYPEID_PLAYER && (target->IsInSameGroupWith((Player*)this) || target->IsInSameRaidWith((Player*)this))))
+            {
+                if (index == UNIT_FIELD_BYTES_2)
+                {
+                    DEBUG_LOG("-- VALUES_UPDATE: Sending '%s' the blue-group-fix from '%s' (flag)", target->GetName(), ((Unit*)this)->GetName());
+                    return m_uint32Values[ index ] & (UNIT_BYTE2_FLAG_SANCTUARY << 8); // this flag is at uint8 offset 1 !!
+                }
+                else if (index == UNIT_FIELD_FACTIONTEMPLATE)
+                {
+                    FactionTemplateEntry const *ft1, *ft2;
+                    ft1 = ((Unit*)this)->getFactionTemplateEntry();
+                    ft2 = ((Unit*)target)->getFactionTemplateEntry();
+
+                    if (ft1 && ft2 && (!ft1->IsFriendlyTo(*ft2) || ((Unit*)this)->IsSpoofSamePlayerFaction()))
+                    {
+                        uint32 faction = ((Player*)target)->getFaction(); // pretend that all other HOSTILE players have own faction, to allow follow, heal, rezz (trade wont work)
+                        DEBUG_LOG("-- VALUES_UPDATE: Sending '%s' the blue-group-fix from '%s' (faction %u)", target->GetName(), ((Unit*)this)->GetName(), faction);
+                        return faction;
+                    }
+                }
             }
         }
+
+        return m_uint32Values[ index ];
     }
+    // Frozen Mod
+
+    return m_uint32Values[index];
 }
 
 void Object::ClearUpdateMask(bool remove)
 {
     if (m_uint32Values)
-    {
-        for (uint16 index = 0; index < m_valuesCount; ++index)
-            m_changedValues[index] = false;
-    }
+        std::fill(m_changedValues.begin(), m_changedValues.end(), 0);
 
     if (m_objectUpdated)
     {
@@ -768,24 +870,27 @@ void Object::_SetUpdateBits(UpdateMask* updateMask, Player* target) const
 {
     UpdateFieldData ufd(this, target);
 
-    for (uint16 index = 0; index < m_valuesCount; ++index)
-    {
-        if (ufd.IsUpdateNeeded(index, m_fieldNotifyFlags) ||
-            (m_changedValues[index] && ufd.IsUpdateFieldVisible(index)))
-            updateMask->SetBit(index);
-    }
+    UpdateMask visibleMask;
+    visibleMask.SetCount(m_valuesCount);
+    ufd.AddVisibleFields(visibleMask);
+
+    ufd.AddUpdateNeededFields(*updateMask, m_fieldNotifyFlags);
+    updateMask->OrMasked(&m_changedValues[0], visibleMask);
 }
 
 void Object::_SetCreateBits(UpdateMask* updateMask, Player* target) const
 {
     UpdateFieldData ufd(this, target);
 
-    for (uint16 index = 0; index < m_valuesCount; ++index)
-    {
-        if (ufd.IsUpdateNeeded(index, m_fieldNotifyFlags) ||
-            ((GetUInt32Value(index) != 0) && ufd.IsUpdateFieldVisible(index)))
+    UpdateMask visibleMask;
+    visibleMask.SetCount(m_valuesCount);
+    ufd.AddVisibleFields(visibleMask);
+
+    ufd.AddUpdateNeededFields(*updateMask, m_fieldNotifyFlags);
+
+    for (uint32 index = visibleMask.GetNextSetBit(0); index < m_valuesCount; index = visibleMask.GetNextSetBit(index + 1))
+        if (GetUInt32Value(index) != 0)
             updateMask->SetBit(index);
-    }
 }
 
 void Object::SetInt32Value( uint16 index, int32 value )
@@ -795,7 +900,7 @@ void Object::SetInt32Value( uint16 index, int32 value )
     if (m_int32Values[index] != value)
     {
         m_int32Values[index] = value;
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -807,7 +912,7 @@ void Object::SetUInt32Value( uint16 index, uint32 value )
     if (m_uint32Values[index] != value)
     {
         m_uint32Values[index] = value;
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -819,8 +924,8 @@ void Object::SetUInt64Value( uint16 index, const uint64 &value )
     {
         m_uint32Values[index] = *((uint32*)&value);
         m_uint32Values[index + 1] = *(((uint32*)&value) + 1);
-        m_changedValues[index] = true;
-        m_changedValues[index + 1] = true;
+        MarkChangedValue(index);
+        MarkChangedValue(index + 1);
         MarkForClientUpdate();
     }
 }
@@ -832,7 +937,7 @@ void Object::SetFloatValue( uint16 index, float value )
     if (m_floatValues[index] != value)
     {
         m_floatValues[index] = value;
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -851,7 +956,7 @@ void Object::SetByteValue( uint16 index, uint8 offset, uint8 value )
     {
         m_uint32Values[index] &= ~uint32(uint32(0xFF) << (offset * 8));
         m_uint32Values[index] |= uint32(uint32(value) << (offset * 8));
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -870,7 +975,7 @@ void Object::SetUInt16Value( uint16 index, uint8 offset, uint16 value )
     {
         m_uint32Values[index] &= ~uint32(uint32(0xFFFF) << (offset * 16));
         m_uint32Values[index] |= uint32(uint32(value) << (offset * 16));
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -932,7 +1037,7 @@ void Object::SetFlag( uint16 index, uint32 newFlag )
     if (oldval != newval)
     {
         m_uint32Values[index] = newval;
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -946,7 +1051,7 @@ void Object::RemoveFlag( uint16 index, uint32 oldFlag )
     if (oldval != newval)
     {
         m_uint32Values[index] = newval;
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -964,7 +1069,7 @@ void Object::SetByteFlag( uint16 index, uint8 offset, uint8 newFlag )
     if (!(uint8(m_uint32Values[index] >> (offset * 8)) & newFlag))
     {
         m_uint32Values[index] |= uint32(uint32(newFlag) << (offset * 8));
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -982,7 +1087,7 @@ void Object::RemoveByteFlag( uint16 index, uint8 offset, uint8 oldFlag )
     if (uint8(m_uint32Values[index] >> (offset * 8)) & oldFlag)
     {
         m_uint32Values[index] &= ~uint32(uint32(oldFlag) << (offset * 8));
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -994,7 +1099,7 @@ void Object::SetShortFlag(uint16 index, bool highpart, uint16 newFlag)
     if (!(uint16(m_uint32Values[index] >> (highpart ? 16 : 0)) & newFlag))
     {
         m_uint32Values[index] |= uint32(uint32(newFlag) << (highpart ? 16 : 0));
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -1006,7 +1111,7 @@ void Object::RemoveShortFlag(uint16 index, bool highpart, uint16 oldFlag)
     if (uint16(m_uint32Values[index] >> (highpart ? 16 : 0)) & oldFlag)
     {
         m_uint32Values[index] &= ~uint32(uint32(oldFlag) << (highpart ? 16 : 0));
-        m_changedValues[index] = true;
+        MarkChangedValue(index);
         MarkForClientUpdate();
     }
 }
@@ -1028,14 +1133,14 @@ bool Object::PrintEntryError(char const* descr) const
 }
 
 
-void Object::BuildUpdateDataForPlayer(Player* player, UpdateDataMapType& update_players)
+void Object::BuildUpdateDataForPlayer(Player* player, UpdateDataMapType& update_players, UpdateValuesBlockCache* cache /*= NULL*/)
 {
     if (!player)
         return;
 
     UpdateData& data = update_players[player->GetObjectGuid()];
 
-    BuildValuesUpdateBlockForPlayer(&data, player);
+    BuildValuesUpdateBlockForPlayer(&data, player, cache);
 }
 
 void Object::AddToClientUpdateList()
@@ -2110,12 +2215,13 @@ struct WorldObjectChangeAccumulator
 {
     UpdateDataMapType &i_updateDatas;
     WorldObject &i_object;
+    UpdateValuesBlockCache i_blockCache;                    // values block built once per observer visibility
     WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d) : i_updateDatas(d), i_object(obj)
     {
         // send self fields changes in another way, otherwise
         // with new camera system when player's camera too far from player, camera wouldn't receive packets and changes from player
         if (i_object.isType(TYPEMASK_PLAYER))
-            i_object.BuildUpdateDataForPlayer((Player*)&i_object, i_updateDatas);
+            i_object.BuildUpdateDataForPlayer((Player*)&i_object, i_updateDatas, &i_blockCache);
     }
 
     void Visit(CameraMapType &m)
@@ -2124,7 +2230,7 @@ struct WorldObjectChangeAccumulator
         {
             Player* owner = iter->getSource()->GetOwner();
             if (owner && owner != &i_object && owner->HaveAtClient(i_object.GetObjectGuid()))
-                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas);
+                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas, &i_blockCache);
         }
     }
 
@@ -2260,12 +2366,22 @@ void Object::ForceValuesUpdateAtIndex(uint16 index)
 {
     MANGOS_ASSERT( index < m_valuesCount || PrintIndexError(index, true));
 
-    m_changedValues[index] = true; // makes server think the field changed
+    MarkChangedValue(index); // makes server think the field changed
 
     MarkForClientUpdate();
 }
 // Frozen Mod
 
+void Object::MarkChangedValuesForBuild(uint16 const* indexes, uint32 count, std::vector<uint32>& saved)
+{
+    saved = m_changedValues;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        MANGOS_ASSERT(indexes[i] < m_valuesCount || PrintIndexError(indexes[i], true));
+        MarkChangedValue(indexes[i]);
+    }
+}
+
 bool WorldObject::PrintCoordinatesError(float x, float y, float z, char const* descr) const
 {
     sLog.outError("%s with invalid %s coordinates: mapid = %uu, x = %f, y = %f, z = %f", GetGuidStr().c_str(), descr, GetMapId(), x, y, z);
@@ -23,6 +23,7 @@
 #include "ByteBuffer.h"
 #include "UpdateFieldFlags.h"
 #include "UpdateData.h"
+#include "UpdateMask.h"
 #include "ObjectGuid.h"
 #include "Camera.h"
 #include "ObjectLock.h"
@@ -77,7 +78,6 @@ class Group;
 class Unit;
 class Group;
 class Map;
-class UpdateMask;
 class InstanceData;
 class TerrainInfo;
 class Transport;
@@ -114,10 +114,16 @@ struct UpdateFieldData
         UpdateFieldData(Object const* object, Player* target);
         bool IsUpdateNeeded(uint16 fieldIndex, uint32 fieldNotifyFlags) const { return HasFlags(fieldIndex, fieldNotifyFlags) || (HasFlags(fieldIndex, UF_FLAG_SPECIAL_INFO) && m_hasSpecialInfo); }
         bool IsUpdateFieldVisible(uint16 fieldIndex) const;
+        // same checks as above for all fields at once, bits are added to mask
+        void AddUpdateNeededFields(UpdateMask& mask, uint32 fieldNotifyFlags) const;
+        void AddVisibleFields(UpdateMask& mask) const;
+        // targets with equal key get the same update mask for the object
+        uint8 GetVisibilityKey() const { return uint8(m_isSelf) | uint8(m_isOwner) << 1 | uint8(m_isItemOwner) << 2 | uint8(m_hasSpecialInfo) << 3 | uint8(m_isPartyMember) << 4; }
     private:
         inline bool HasFlags(uint16 fieldIndex, uint32 flags) const { return m_flags[fieldIndex] & flags; }
 
         uint32* m_flags;
+        UpdateMask const* m_flagMasks;                      // fields having flag, indexed by flag bit
         bool m_isSelf;
         bool m_isOwner;
         bool m_isItemOwner;
@@ -125,6 +131,34 @@ struct UpdateFieldData
         bool m_isPartyMember;
 };
 
+// Values update blocks of one object built in one BuildUpdateData call, shared by all
+// observers with the same field visibility. Target dependent fields are patched per observer.
+struct UpdateValuesBlockCache
+{
+    struct Entry
+    {
+        Entry() : key(0), target(NULL) {}
+
+        uint8 key;
+        Player* target;                                     // observer the block values were built for
+        ByteBuffer block;
+        std::vector<std::pair<uint16, uint32> > patches;    // target dependent field index and its offset in block
+    };
+
+    Entry& GetEntry(uint8 key)
+    {
+        for (std::vector<Entry>::iterator itr = entries.begin(); itr != entries.end(); ++itr)
+            if (itr->key == key)
+                return *itr;
+
+        entries.push_back(Entry());
+        entries.back().key = key;
+        return entries.back();
+    }
+
+    std::vector<Entry> entries;
+};
+
 class MANGOS_DLL_SPEC Object
 {
     public:
@@ -186,7 +220,7 @@ class MANGOS_DLL_SPEC Object
         void SetFieldNotifyFlag(uint16 flag) { m_fieldNotifyFlags |= flag; }
         void RemoveFieldNotifyFlag(uint16 flag) { m_fieldNotifyFlags &= ~flag; }
 
-        void BuildValuesUpdateBlockForPlayer( UpdateData *data, Player *target ) const;
+        void BuildValuesUpdateBlockForPlayer( UpdateData *data, Player *target, UpdateValuesBlockCache* cache = NULL ) const;
         void BuildOutOfRangeUpdateBlock( UpdateData *data ) const;
         void BuildMovementUpdateBlock( UpdateData * data, uint16 flags = 0 ) const;
 
@@ -378,6 +412,11 @@ class MANGOS_DLL_SPEC Object
         void ForceValuesUpdateAtIndex(uint16);
         // Frozen Mod
 
+        // mark fields changed only for locally built update blocks (benchmarks), no client update is queued
+        // previous marks are stored in saved and must be put back by RestoreChangedValues before next object update
+        void MarkChangedValuesForBuild(uint16 const* indexes, uint32 count, std::vector<uint32>& saved);
+        void RestoreChangedValues(std::vector<uint32> const& saved) { m_changedValues = saved; }
+
         virtual bool HasQuest(uint32 /* quest_id */) const { return false; }
         virtual bool HasInvolvedQuest(uint32 /* quest_id */) const { return false; }
 
@@ -393,7 +432,11 @@ class MANGOS_DLL_SPEC Object
 
         void BuildMovementUpdate(ByteBuffer * data, uint16 updateFlags) const;
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer *data, UpdateMask *updateMask, Player *target ) const;
-        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players);
+        bool IsTargetDependentUpdateField(uint16 index) const;
+        uint32 GetUpdateFieldValueForTarget(uint16 index, Player* target, bool isActivateToQuest, bool isPerCasterAuraState) const;
+        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, UpdateValuesBlockCache* cache = NULL);
+
+        void MarkChangedValue(uint16 index) { m_changedValues[index >> 5] |= uint32(1) << (index & 31); }
 
         uint16 m_objectType;
 
@@ -407,7 +450,7 @@ class MANGOS_DLL_SPEC Object
             float  *m_floatValues;
         };
 
-        std::vector<bool> m_changedValues;
+        std::vector<uint32> m_changedValues;                // bit per field, in UpdateMask blocks layout
 
         uint16 m_valuesCount;
         uint16 m_fieldNotifyFlags;
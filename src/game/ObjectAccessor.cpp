@@ -85,17 +85,63 @@ Player* ObjectAccessor::FindPlayer(ObjectGuid guid, bool inWorld /*= true*/)
     return plr;
 }
 
+ObjectAccessor::PlayerNameShard ObjectAccessor::i_playerNameShards[PLAYER_NAME_INDEX_SHARDS];
+
+ObjectAccessor::PlayerNameShard& ObjectAccessor::GetPlayerNameShard(std::string const& key)
+{
+    uint32 hash = 2166136261U;                              // FNV-1a
+    for (std::string::const_iterator itr = key.begin(); itr != key.end(); ++itr)
+        hash = (hash ^ uint8(*itr)) * 16777619U;
+
+    return i_playerNameShards[hash % PLAYER_NAME_INDEX_SHARDS];
+}
+
 Player* ObjectAccessor::FindPlayerByName(const char *name)
 {
-    HashMapHolder<Player>::ReadGuard g(HashMapHolder<Player>::GetLock());
-    HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
-    for (HashMapHolder<Player>::MapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-        if (iter->second->IsInWorld() && ( ::strcmp(name, iter->second->GetName()) == 0 ))
-            return iter->second;
+    std::string key;
+    if (!name || !Utf8ToLower(name, key))
+        return NULL;
+
+    PlayerNameShard& shard = GetPlayerNameShard(key);
+    ACE_Read_Guard<ACE_RW_Thread_Mutex> guard(shard.lock);
+
+    PlayerNameMap::const_iterator itr = shard.players.find(key);
+    if (itr != shard.players.end() && itr->second->IsInWorld())
+        return itr->second;
 
     return NULL;
 }
 
+void ObjectAccessor::AddObject(Player* object)
+{
+    HashMapHolder<Player>::Insert(object);
+
+    std::string key;
+    if (!Utf8ToLower(object->GetName(), key))
+        return;
+
+    PlayerNameShard& shard = GetPlayerNameShard(key);
+    ACE_Write_Guard<ACE_RW_Thread_Mutex> guard(shard.lock);
+    shard.players[key] = object;
+}
+
+void ObjectAccessor::RemoveObject(Player* object)
+{
+    HashMapHolder<Player>::Remove(object);
+
+    std::string key;
+    if (!Utf8ToLower(object->GetName(), key))
+        return;
+
+    PlayerNameShard& shard = GetPlayerNameShard(key);
+    ACE_Write_Guard<ACE_RW_Thread_Mutex> guard(shard.lock);
+
+    // a relogged character may be indexed already by the new Player object
+    PlayerNameMap::iterator itr = shard.players.find(key);
+    if (itr != shard.players.end() && itr->second == object)
+        shard.players.erase(itr);
+}
+
 void
 ObjectAccessor::SaveAllPlayers()
 {
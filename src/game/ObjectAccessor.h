@@ -41,6 +41,8 @@ class Unit;
 class WorldObject;
 class Map;
 
+#define PLAYER_NAME_INDEX_SHARDS 16
+
 template <class T>
 class HashMapHolder
 {
@@ -122,13 +124,27 @@ class MANGOS_DLL_DECL ObjectAccessor : public MaNGOS::Singleton<ObjectAccessor,
 
         // For call from Player/Corpse AddToWorld/RemoveFromWorld only
         void AddObject(Corpse *object) { HashMapHolder<Corpse>::Insert(object); }
-        void AddObject(Player *object) { HashMapHolder<Player>::Insert(object); }
+        void AddObject(Player *object);
         void RemoveObject(Corpse *object) { HashMapHolder<Corpse>::Remove(object); }
-        void RemoveObject(Player *object) { HashMapHolder<Player>::Remove(object); }
+        void RemoveObject(Player *object);
 
     private:
 
+        // Online players by lower case name, split in shards with own locks so name lookups
+        // neither scan all players nor wait for the player map lock
+        typedef UNORDERED_MAP<std::string, Player*> PlayerNameMap;
+
+        struct PlayerNameShard
+        {
+            ACE_RW_Thread_Mutex lock;
+            PlayerNameMap players;
+        };
+
+        static PlayerNameShard& GetPlayerNameShard(std::string const& key);
+
         Player2CorpsesMapType   i_player2corpse;
+
+        static PlayerNameShard  i_playerNameShards[PLAYER_NAME_INDEX_SHARDS];
 };
 
 #define sObjectAccessor ObjectAccessor::Instance()
@@ -31,6 +31,7 @@ enum MapLockType
     MAP_LOCK_TYPE_AURAS,
     MAP_LOCK_TYPE_MAPOBJECTS,
     MAP_LOCK_TYPE_MOVEMENT,
+    MAP_LOCK_TYPE_DYNTREE,
     MAP_LOCK_TYPE_MAX,
 };
 
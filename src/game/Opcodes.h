@@ -1363,7 +1363,8 @@ enum PacketProcessing
 {
     PROCESS_INPLACE = 0,                                    //process packet whenever we receive it - mostly for non-handled or non-implemented packets
     PROCESS_THREADUNSAFE,                                   //packet is not thread-safe - process it in World::UpdateSessions()
-    PROCESS_THREADSAFE                                      //packet is thread-safe - process it in Map::Update()
+    PROCESS_THREADSAFE,                                     //packet is thread-safe - process it in Map::Update()
+    PROCESS_AUTHED_THREADSAFE                               //packet touches only session and DB - process it by SessionUpdater threads while no player in world, else in World::UpdateSessions()
 };
 
 class WorldPacket;
@@ -1386,6 +1387,31 @@ inline const char* LookupOpcodeName(uint16 id)
     return opcodeTable[id].name;
 }
 
+/// Packet storage allocations per opcode, collected only while enabled (see .debug packetalloc)
+class OpcodeAllocStats
+{
+    public:
+        struct Entry
+        {
+            uint16 opcode;
+            uint64 packets;
+            uint64 allocations;
+            uint64 bytes;
+        };
+
+        static bool IsEnabled() { return m_enabled; }
+        static void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+        static void Record(uint16 opcode, uint32 allocations, size_t bytes);
+        static void Reset();
+
+        /// Fill `entries` with up to `count` opcodes having most allocations
+        static void GetTop(std::vector<Entry>& entries, size_t count);
+
+    private:
+        static volatile bool m_enabled;
+};
+
 enum OpcodeLoadFlags
 {
     OPCODE_LOAD_FLAGS_NONE           = 0x0,
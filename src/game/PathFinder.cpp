@@ -21,6 +21,7 @@
 #include "Creature.h"
 #include "PathFinder.h"
 #include "Log.h"
+#include "Policies/Singleton.h"
 
 #include "../recastnavigation/Detour/Include/DetourCommon.h"
 
@@ -28,14 +29,18 @@
 PathFinder::PathFinder(const Unit* owner) :
     m_polyLength(0), m_type(PATHFIND_BLANK),
     m_useStraightPath(false), m_forceDestination(false), m_pointPathLimit(MAX_POINT_PATH_LENGTH),
-    m_sourceUnit(owner), m_navMesh(NULL), m_navMeshQuery(NULL)
+    m_sourceUnit(owner), m_sourceGuidLow(owner->GetGUIDLow()), m_sourceEntry(owner->GetEntry()), m_sourceTypeId(owner->GetTypeId()),
+    m_sourceIsCreature(owner->GetTypeId() == TYPEID_UNIT),
+    m_sourceCanSwim(false), m_sourceCanFly(false), m_sourceIsLevitating(false), m_terrain(owner->GetTerrain()),
+    m_asyncRequest(NULL), m_navMesh(NULL), m_navMeshQuery(NULL)
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceUnit->GetGUIDLow());
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceGuidLow);
 
     uint32 mapId = m_sourceUnit->GetMapId();
     if (MMAP::MMapFactory::IsPathfindingEnabled(mapId))
     {
         MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+        ReadGuard Guard(mmap->GetLock(mapId));
         m_navMesh = mmap->GetNavMesh(mapId);
         m_navMeshQuery = mmap->GetNavMeshQuery(mapId, m_sourceUnit->GetInstanceId());
     }
@@ -43,14 +48,27 @@ PathFinder::PathFinder(const Unit* owner) :
     createFilter();
 }
 
+PathFinder::PathFinder(PathFinder const& other) :
+    m_polyLength(other.m_polyLength), m_pathPoints(other.m_pathPoints), m_type(other.m_type),
+    m_useStraightPath(other.m_useStraightPath), m_forceDestination(other.m_forceDestination), m_pointPathLimit(other.m_pointPathLimit),
+    m_startPosition(other.m_startPosition), m_endPosition(other.m_endPosition), m_actualEndPosition(other.m_actualEndPosition),
+    m_sourceUnit(other.m_sourceUnit), m_sourceGuidLow(other.m_sourceGuidLow), m_sourceEntry(other.m_sourceEntry),
+    m_sourceTypeId(other.m_sourceTypeId), m_sourceIsCreature(other.m_sourceIsCreature),
+    m_sourceCanSwim(other.m_sourceCanSwim), m_sourceCanFly(other.m_sourceCanFly), m_sourceIsLevitating(other.m_sourceIsLevitating),
+    m_terrain(other.m_terrain), m_asyncRequest(NULL), m_navMesh(other.m_navMesh), m_navMeshQuery(NULL), m_filter(other.m_filter)
+{
+    memcpy(m_pathPolyRefs, other.m_pathPolyRefs, m_polyLength * sizeof(dtPolyRef));
+}
+
 PathFinder::~PathFinder()
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_sourceUnit->GetGUIDLow());
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_sourceGuidLow);
+
+    cancelAsync();
 }
 
-bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest)
+bool PathFinder::PrepareCalculation(float destX, float destY, float destZ, bool forceDest)
 {
-    Vector3 oldDest = getEndPosition();
     Vector3 dest(destX, destY, destZ);
     setEndPosition(dest);
 
@@ -61,27 +79,101 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
 
     m_forceDestination = forceDest;
 
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_sourceUnit->GetGUIDLow());
+    if (m_sourceIsCreature)
+    {
+        Creature* creature = (Creature*)m_sourceUnit;
+        m_sourceCanSwim = creature->CanSwim();
+        m_sourceCanFly = creature->CanFly();
+        m_sourceIsLevitating = creature->IsLevitating();
+    }
+
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_sourceGuidLow);
 
     // make sure navMesh works - we can run on map w/o mmap
     // check if the start and end point have a .mmtile loaded (can we pass via not loaded tile on the way?)
     if (!m_navMesh || !m_navMeshQuery || m_sourceUnit->hasUnitState(UNIT_STAT_IGNORE_PATHFINDING) ||
-        !HaveTile(start) || !HaveTile(dest) || (m_sourceUnit->GetTypeId() == TYPEID_UNIT && ((Creature*)m_sourceUnit)->IsLevitating()))
+        !HaveTile(start) || !HaveTile(dest) || m_sourceIsLevitating)
     {
         BuildShortcut();
         m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
-        return true;
+        return false;
     }
 
     updateFilter();
+    return true;
+}
+
+bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest)
+{
+    // result of queued calculation would override this one
+    cancelAsync();
+
+    if (!PrepareCalculation(destX, destY, destZ, forceDest))
+        return true;
 
     {
         ReadGuard Guard(MMAP::MMapFactory::createOrGetMMapManager()->GetLock(m_sourceUnit->GetMapId()));
-        BuildPolyPath(start, dest);
+        BuildPolyPath(getStartPosition(), getEndPosition());
     }
     return true;
 }
 
+bool PathFinder::calculateAsync(float destX, float destY, float destZ, bool forceDest)
+{
+    // newest destination wins
+    cancelAsync();
+
+    if (!sPathFinderWorkers.activated())
+    {
+        calculate(destX, destY, destZ, forceDest);
+        return false;
+    }
+
+    if (!PrepareCalculation(destX, destY, destZ, forceDest))
+        return false;
+
+    PathFinderRequest* request = new PathFinderRequest(*this);
+    if (!sPathFinderWorkers.schedule(request))
+    {
+        request->Release();
+
+        ReadGuard Guard(MMAP::MMapFactory::createOrGetMMapManager()->GetLock(m_sourceUnit->GetMapId()));
+        BuildPolyPath(getStartPosition(), getEndPosition());
+        return false;
+    }
+
+    m_asyncRequest = request;
+    return true;
+}
+
+bool PathFinder::updateAsync()
+{
+    if (!m_asyncRequest || !m_asyncRequest->IsDone())
+        return false;
+
+    PathFinder const& result = m_asyncRequest->GetPath();
+    m_polyLength = result.m_polyLength;
+    memcpy(m_pathPolyRefs, result.m_pathPolyRefs, m_polyLength * sizeof(dtPolyRef));
+    m_pathPoints = result.m_pathPoints;
+    m_type = result.m_type;
+    m_startPosition = result.m_startPosition;
+    m_endPosition = result.m_endPosition;
+    m_actualEndPosition = result.m_actualEndPosition;
+
+    cancelAsync();
+    return true;
+}
+
+void PathFinder::cancelAsync()
+{
+    if (!m_asyncRequest)
+        return;
+
+    // worker keeps its own reference until calculation is finished
+    m_asyncRequest->Release();
+    m_asyncRequest = NULL;
+}
+
 dtPolyRef PathFinder::getPathPolyByPosition(const dtPolyRef* polyPath, uint32 polyPathSize, const float* point, float* distance) const
 {
     if (!polyPath || !polyPathSize)
@@ -172,13 +264,13 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         BuildShortcut();
 
         // Check for swimming or flying shortcut
-        if (m_sourceUnit->GetTypeId() == TYPEID_UNIT)
+        if (m_sourceIsCreature)
         {
-            if ((startPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsUnderWater(startPos.x, startPos.y, startPos.z)) ||
-                (endPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsUnderWater(endPos.x, endPos.y, endPos.z)))
-                m_type = ((Creature*)m_sourceUnit)->CanSwim() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+            if ((startPoly == INVALID_POLYREF && m_terrain->IsUnderWater(startPos.x, startPos.y, startPos.z)) ||
+                (endPoly == INVALID_POLYREF && m_terrain->IsUnderWater(endPos.x, endPos.y, endPos.z)))
+                m_type = m_sourceCanSwim ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
             else
-                m_type = ((Creature*)m_sourceUnit)->CanFly() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
+                m_type = m_sourceCanFly ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH;
         }
         else
             m_type = PATHFIND_NOPATH;
@@ -193,21 +285,19 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: farFromPoly distToStartPoly=%.3f distToEndPoly=%.3f\n", distToStartPoly, distToEndPoly);
 
         bool buildShotrcut = false;
-        if (m_sourceUnit->GetTypeId() == TYPEID_UNIT)
+        if (m_sourceIsCreature)
         {
-            Creature* owner = (Creature*)m_sourceUnit;
-
             Vector3 p = (distToStartPoly > 7.0f) ? startPos : endPos;
-            if (m_sourceUnit->GetTerrain()->IsUnderWater(p.x, p.y, p.z))
+            if (m_terrain->IsUnderWater(p.x, p.y, p.z))
             {
                 DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: underWater case\n");
-                if (owner->CanSwim())
+                if (m_sourceCanSwim)
                     buildShotrcut = true;
             }
             else
             {
                 DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: flying case\n");
-                if (owner->IsLevitating())
+                if (m_sourceIsLevitating)
                     buildShotrcut = true;
             }
         }
@@ -262,7 +352,7 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         for (pathStartIndex = 0; pathStartIndex < m_polyLength; ++pathStartIndex)
         {
             // here to catch few bugs
-            MANGOS_ASSERT(m_pathPolyRefs[pathStartIndex] != INVALID_POLYREF || m_sourceUnit->PrintEntryError("PathFinder::BuildPolyPath"));
+            MANGOS_ASSERT(m_pathPolyRefs[pathStartIndex] != INVALID_POLYREF || PrintEntryError("PathFinder::BuildPolyPath"));
 
             if (m_pathPolyRefs[pathStartIndex] == startPoly)
             {
@@ -347,7 +437,7 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
             // this is probably an error state, but we'll leave it
             // and hopefully recover on the next Update
             // we still need to copy our preffix
-            sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
+            sLog.outError("%u's Path Build failed: 0 length path", m_sourceGuidLow);
         }
 
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++  m_polyLength=%u prefixPolyLength=%u suffixPolyLength=%u \n",m_polyLength, prefixPolyLength, suffixPolyLength);
@@ -366,20 +456,12 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         // free and invalidate old path data
         clear();
 
-        dtResult = m_navMeshQuery->findPath(
-                startPoly,          // start polygon
-                endPoly,            // end polygon
-                startPoint,         // start position
-                endPoint,           // end position
-                &m_filter,           // polygon search filter
-                m_pathPolyRefs,     // [out] path
-                (int*)&m_polyLength,
-                MAX_PATH_LENGTH);   // max number of polygons in output path
+        m_polyLength = findPolyPath(startPoly, endPoly, startPoint, endPoint, m_pathPolyRefs, MAX_PATH_LENGTH);
 
-        if (!m_polyLength || dtStatusFailed(dtResult))
+        if (!m_polyLength)
         {
             // only happens if we passed bad data to findPath(), or navmesh is messed up
-            sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
+            sLog.outError("%u's Path Build failed: 0 length path", m_sourceGuidLow);
             BuildShortcut();
             m_type = PATHFIND_NOPATH;
             return;
@@ -396,6 +478,53 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
     BuildPointPath(startPoint, endPoint);
 }
 
+bool PathFinder::PrintEntryError(char const* descr) const
+{
+    sLog.outError("Object Type %u, Entry %u (lowguid %u) with invalid call for %s", m_sourceTypeId, m_sourceEntry, m_sourceGuidLow, descr);
+
+    // always false for continue assert fail
+    return false;
+}
+
+uint32 PathFinder::findPolyPath(dtPolyRef startPoly, dtPolyRef endPoly, const float* startPoint, const float* endPoint,
+                                dtPolyRef* path, uint32 maxPathLength)
+{
+    MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+    MMAP::PathCache* cache = mmap->GetPathCache(m_terrain->GetMapId());
+    MMAP::PathCacheKey key(startPoly, endPoly, m_filter.getIncludeFlags(), m_filter.getExcludeFlags());
+
+    uint32 pathLength = 0;
+    if (cache && cache->Find(key, path, pathLength, maxPathLength))
+    {
+        mmap->addPathCacheResult(true);
+        return pathLength;
+    }
+
+    dtStatus dtResult = m_navMeshQuery->findPath(
+            startPoly,          // start polygon
+            endPoly,            // end polygon
+            startPoint,         // start position
+            endPoint,           // end position
+            &m_filter,          // polygon search filter
+            path,               // [out] path
+            (int*)&pathLength,
+            maxPathLength);     // max number of polygons in output path
+
+    if (dtStatusFailed(dtResult))
+        return 0;
+
+    if (cache)
+    {
+        mmap->addPathCacheResult(false);
+
+        // only complete paths can be reused from other positions on same polygons
+        if (pathLength && path[pathLength - 1] == endPoly && !dtStatusDetail(dtResult, DT_PARTIAL_RESULT))
+            cache->Insert(key, path, pathLength);
+    }
+
+    return pathLength;
+}
+
 void PathFinder::BuildPointPath(const float* startPoint, const float* endPoint)
 {
     float pathPoints[MAX_POINT_PATH_LENGTH * VERTEX_SIZE];
@@ -820,3 +949,177 @@ float PathFinder::dist3DSqr(const Vector3 &p1, const Vector3 &p2) const
 {
     return (p1-p2).squaredLength();
 }
+
+////////////////// PathFinderRequest //////////////////
+PathFinderRequest::PathFinderRequest(PathFinder const& path) :
+    m_path(path), m_mapId(path.m_terrain->GetMapId()), m_done(0), m_refs(1)
+{
+    // navmesh is unloaded together with terrain, keep it alive until calculation is done
+    const_cast<TerrainInfo*>(m_path.m_terrain)->AddRef();
+}
+
+PathFinderRequest::~PathFinderRequest()
+{
+    // not unloaded from here, map threads own terrain unloading; it is freed at next unload of its map
+    const_cast<TerrainInfo*>(m_path.m_terrain)->Release();
+}
+
+void PathFinderRequest::Execute(dtNavMeshQuery const* query)
+{
+    if (!query)
+    {
+        // navmesh was unloaded meanwhile
+        m_path.BuildShortcut();
+        m_path.m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+    }
+    else
+    {
+        // caller holds navmesh read lock
+        m_path.m_navMeshQuery = query;
+        m_path.BuildPolyPath(m_path.getStartPosition(), m_path.getEndPosition());
+        m_path.m_navMeshQuery = NULL;
+    }
+
+    m_done = 1;
+}
+
+////////////////// PathFinderWorkers //////////////////
+INSTANTIATE_SINGLETON_1(PathFinderWorkers);
+
+struct WorkerNavMeshQuery
+{
+    WorkerNavMeshQuery() : query(NULL), loadId(0) {}
+
+    dtNavMeshQuery* query;
+    uint32 loadId;                                          // MMapData::loadId of navmesh the query is initialized for
+};
+
+typedef UNORDERED_MAP<uint32, WorkerNavMeshQuery> WorkerNavMeshQueryMap;
+
+// must be called under navmesh read lock, held while returned query is used
+static dtNavMeshQuery const* GetWorkerNavMeshQuery(WorkerNavMeshQueryMap& queries, uint32 mapId)
+{
+    uint32 loadId = 0;
+    dtNavMesh const* navMesh = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMesh(mapId, &loadId);
+    if (!navMesh)
+        return NULL;
+
+    WorkerNavMeshQuery& worker = queries[mapId];
+    if (worker.query && worker.loadId == loadId)
+        return worker.query;
+
+    // first request for map at this thread, or map navmesh was reloaded
+    if (!worker.query)
+        worker.query = dtAllocNavMeshQuery();
+
+    worker.loadId = loadId;
+    if (!worker.query || dtStatusFailed(worker.query->init(navMesh, 1024)))
+    {
+        sLog.outError("PathFinderWorkers: Failed to initialize dtNavMeshQuery for mapId %03u", mapId);
+        dtFreeNavMeshQuery(worker.query);
+        worker.query = NULL;
+    }
+
+    return worker.query;
+}
+
+PathFinderWorkers::PathFinderWorkers() :
+    m_condition(m_mutex), m_calculated(0), m_activated(false), m_stopping(false)
+{
+}
+
+PathFinderWorkers::~PathFinderWorkers()
+{
+    deactivate();
+}
+
+int PathFinderWorkers::activate(size_t num_threads)
+{
+    if (activated() || num_threads < 1)
+        return -1;
+
+    m_stopping = false;
+
+    if (ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, (int)num_threads) == -1)
+        return -1;
+
+    m_activated = true;
+    return 0;
+}
+
+int PathFinderWorkers::deactivate()
+{
+    if (!activated())
+        return -1;
+
+    PathFinderRequestQueue dropped;
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+        m_stopping = true;
+        m_activated = false;
+        dropped.swap(m_queue);
+        m_condition.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+
+    // owners never get result of dropped requests, next update recalculates their path
+    for (PathFinderRequestQueue::iterator itr = dropped.begin(); itr != dropped.end(); ++itr)
+        (*itr)->Release();
+
+    return 0;
+}
+
+bool PathFinderWorkers::schedule(PathFinderRequest* request)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, false);
+    if (m_stopping || !m_activated)
+        return false;
+
+    request->AddRef();
+    m_queue.push_back(request);
+    m_condition.signal();
+    return true;
+}
+
+uint32 PathFinderWorkers::GetQueuedCount()
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, 0);
+    return m_queue.size();
+}
+
+int PathFinderWorkers::svc()
+{
+    // dtNavMeshQuery is not thread safe, every worker keeps own one per map
+    WorkerNavMeshQueryMap queries;
+
+    for (;;)
+    {
+        PathFinderRequest* request = NULL;
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+
+            while (m_queue.empty() && !m_stopping)
+                m_condition.wait();
+
+            if (m_stopping)
+                break;
+
+            request = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        {
+            // navmesh can't be unloaded or changed while the path is built
+            ReadGuard Guard(MMAP::MMapFactory::createOrGetMMapManager()->GetLock(request->GetMapId()));
+            request->Execute(GetWorkerNavMeshQuery(queries, request->GetMapId()));
+        }
+        request->Release();
+        ++m_calculated;
+    }
+
+    for (WorkerNavMeshQueryMap::iterator itr = queries.begin(); itr != queries.end(); ++itr)
+        dtFreeNavMeshQuery(itr->second.query);
+
+    return 0;
+}
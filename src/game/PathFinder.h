@@ -24,11 +24,19 @@
 #include "../recastnavigation/Detour/Include/DetourNavMeshQuery.h"
 
 #include "movement/MoveSplineInitArgs.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+#include <ace/Atomic_Op.h>
 
 using Movement::Vector3;
 using Movement::PointsArray;
 
 class Unit;
+class TerrainInfo;
+class PathFinderRequest;
 
 // 74*4.0f=296y  number_of_points*interval = max_path_len
 // this is way more than actual evade range
@@ -67,6 +75,14 @@ class PathFinder
         // return: true if new path was calculated, false otherwise (no change needed)
         bool calculate(float destX, float destY, float destZ, bool forceDest = false);
 
+        // Queue the path calculation to path worker threads, result is taken by updateAsync() at later update
+        // return: false if workers are disabled, path is calculated at once then like by calculate()
+        bool calculateAsync(float destX, float destY, float destZ, bool forceDest = false);
+        // Take result of queued calculation
+        // return: true if new path is available, false if there is no finished request
+        bool updateAsync();
+        bool isAsyncPending() const { return m_asyncRequest != NULL; }
+
         // option setters - use optional
         void setUseStrightPath(bool useStraightPath) { m_useStraightPath = useStraightPath; };
         void setPathLengthLimit(float distance) { m_pointPathLimit = std::min<uint32>(uint32(distance/SMOOTH_PATH_STEP_SIZE), MAX_POINT_PATH_LENGTH); };
@@ -80,6 +96,11 @@ class PathFinder
         PathType getPathType() const { return m_type; }
 
     private:
+        friend class PathFinderRequest;
+
+        // copy calculating queued request, detached from owner's async state
+        PathFinder(PathFinder const& other);
+        PathFinder& operator=(PathFinder const&);
 
         dtPolyRef      m_pathPolyRefs[MAX_PATH_LENGTH];   // array of detour polygon references
         uint32         m_polyLength;                      // number of polygons in the path
@@ -96,6 +117,18 @@ class PathFinder
         Vector3        m_actualEndPosition;// {x, y, z} of the closest possible point to given destination
 
         const Unit* const       m_sourceUnit;       // the unit that is moving
+
+        // owner data used while building path, copied at calculate() so path can be built outside of owner's map update
+        uint32                  m_sourceGuidLow;
+        uint32                  m_sourceEntry;
+        uint8                   m_sourceTypeId;
+        bool                    m_sourceIsCreature;
+        bool                    m_sourceCanSwim;
+        bool                    m_sourceCanFly;
+        bool                    m_sourceIsLevitating;
+        TerrainInfo const*      m_terrain;
+
+        PathFinderRequest*      m_asyncRequest;     // queued calculation, if any
         const dtNavMesh*        m_navMesh;          // the nav mesh
         const dtNavMeshQuery*   m_navMeshQuery;     // the nav mesh query used to find the path
 
@@ -119,7 +152,16 @@ class PathFinder
         dtPolyRef getPolyByLocation(const float* point, float *distance) const;
         bool HaveTile(const Vector3 &p) const;
 
+        // return: true if path has to be built from navmesh, false if result is already known
+        bool PrepareCalculation(float destX, float destY, float destZ, bool forceDest);
+        void cancelAsync();
+
+        // Object::PrintEntryError for owner data copy, owner itself isn't safe to access while building path
+        bool PrintEntryError(char const* descr) const;
+
         void BuildPolyPath(const Vector3 &startPos, const Vector3 &endPos);
+        uint32 findPolyPath(dtPolyRef startPoly, dtPolyRef endPoly, const float* startPoint, const float* endPoint,
+                            dtPolyRef* path, uint32 maxPathLength);
         void BuildPointPath(const float *startPoint, const float *endPoint);
         void BuildShortcut();
 
@@ -138,4 +180,65 @@ class PathFinder
                               float* smoothPath, int* smoothPathSize, uint32 smoothPathMaxSize);
 };
 
+// Path calculation queued to PathFinderWorkers, shared by requesting PathFinder and worker thread
+class PathFinderRequest
+{
+    public:
+        explicit PathFinderRequest(PathFinder const& path);
+        ~PathFinderRequest();
+
+        // worker side, query belongs to calling thread
+        void Execute(dtNavMeshQuery const* query);
+        uint32 GetMapId() const { return m_mapId; }
+
+        // owner side
+        bool IsDone() const { return m_done.value() != 0; }
+        PathFinder const& GetPath() const { return m_path; }
+
+        void AddRef() { ++m_refs; }
+        void Release()
+        {
+            if (--m_refs == 0)
+                delete this;
+        }
+
+    private:
+        PathFinder m_path;
+        uint32 m_mapId;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_done;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_refs;         // requesting PathFinder and worker queue
+};
+
+typedef std::deque<PathFinderRequest*> PathFinderRequestQueue;
+
+// Thread pool calculating queued paths, every thread uses its own dtNavMeshQuery per map
+class PathFinderWorkers : protected ACE_Task_Base
+{
+    public:
+        PathFinderWorkers();
+        virtual ~PathFinderWorkers();
+
+        int activate(size_t num_threads);
+        int deactivate();
+        bool activated() const { return m_activated; }
+
+        // return: false if workers are not running, request is not taken then
+        bool schedule(PathFinderRequest* request);
+
+        uint32 GetQueuedCount();
+        uint32 GetCalculatedCount() const { return uint32(m_calculated.value()); }
+
+        virtual int svc();
+
+    private:
+        ACE_Thread_Mutex m_mutex;
+        ACE_Condition_Thread_Mutex m_condition;             // signaled at schedule and deactivate
+        PathFinderRequestQueue m_queue;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_calculated;
+        bool m_activated;
+        bool m_stopping;
+};
+
+#define sPathFinderWorkers MaNGOS::Singleton<PathFinderWorkers>::Instance()
+
 #endif
@@ -383,6 +383,8 @@ void TradeData::SetAccepted(bool state, bool crosssend /*= false*/)
 
 //== Player ====================================================
 
+PlayerSaveStatistics Player::m_saveStatistics;
+
 Player::Player (WorldSession *session): Unit(), m_mover(this), m_camera(NULL), m_achievementMgr(this), m_reputationMgr(this)
 {
     m_speakTime = 0;
@@ -461,6 +463,12 @@ Player::Player (WorldSession *session): Unit(), m_mover(this), m_camera(NULL), m
     m_DailyQuestChanged = false;
     m_WeeklyQuestChanged = false;
 
+    // first save writes everything
+    m_saveDirtySections = PLAYER_SAVE_ALL_SECTIONS;
+    m_savedAurasHash = 0;
+    m_savedCooldownsHash = 0;
+    m_characterRowSaved = false;
+
     m_lastLiquid = NULL;
 
     for (int i=0; i<MAX_TIMERS; ++i)
@@ -1296,6 +1304,7 @@ void Player::Update(uint32 update_diff, uint32 p_time)
             {
                 q_status.m_timer -= update_diff;
                 if (q_status.uState != QUEST_NEW) q_status.uState = QUEST_CHANGED;
+                MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
                 ++iter;
             }
         }
@@ -3248,6 +3257,7 @@ bool Player::addSpell(uint32 spell_id, bool active, bool learning, bool dependen
             itr->second.dependent = dependent;
             if (itr->second.state != PLAYERSPELL_NEW)
                 itr->second.state = PLAYERSPELL_CHANGED;
+            MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
             dependent_set = true;
         }
 
@@ -3259,7 +3269,10 @@ bool Player::addSpell(uint32 spell_id, bool active, bool learning, bool dependen
             if (!IsInWorld() && !learning && !dependent_set) // explicitly load from DB and then exist in it already and set correctly
                 itr->second.state = PLAYERSPELL_UNCHANGED;
             else if (itr->second.state != PLAYERSPELL_NEW)
+            {
                 itr->second.state = PLAYERSPELL_CHANGED;
+                MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
+            }
 
             if (active)
             {
@@ -3291,6 +3304,7 @@ bool Player::addSpell(uint32 spell_id, bool active, bool learning, bool dependen
         {
             if (itr->second.state != PLAYERSPELL_NEW)
                 itr->second.state = PLAYERSPELL_CHANGED;
+            MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
             itr->second.disabled = disabled;
 
             if (disabled)
@@ -3381,6 +3395,7 @@ bool Player::addSpell(uint32 spell_id, bool active, bool learning, bool dependen
                             itr2->second.active = false;
                             if (itr2->second.state != PLAYERSPELL_NEW)
                                 itr2->second.state = PLAYERSPELL_CHANGED;
+                            MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
                             superceded_old = true;          // new spell replace old in action bars and spell book.
                         }
                         else if (sSpellMgr.IsHighRankOfSpell(itr2->first,spell_id))
@@ -3397,6 +3412,7 @@ bool Player::addSpell(uint32 spell_id, bool active, bool learning, bool dependen
                             newspell.active = false;
                             if (newspell.state != PLAYERSPELL_NEW)
                                 newspell.state = PLAYERSPELL_CHANGED;
+                            MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
                         }
                     }
                 }
@@ -3405,6 +3421,9 @@ bool Player::addSpell(uint32 spell_id, bool active, bool learning, bool dependen
 
         m_spells[spell_id] = newspell;
 
+        if (newspell.state != PLAYERSPELL_UNCHANGED)
+            MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
+
         // return false if spell disabled
         if (newspell.disabled)
             return false;
@@ -3423,6 +3442,7 @@ bool Player::addSpell(uint32 spell_id, bool active, bool learning, bool dependen
 
                 if ((*iter).second.state != PLAYERSPELL_NEW)
                     (*iter).second.state = PLAYERSPELL_CHANGED;
+                MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
             }
         }
         else
@@ -3432,6 +3452,9 @@ bool Player::addSpell(uint32 spell_id, bool active, bool learning, bool dependen
             talent.talentEntry = sTalentStore.LookupEntry(talentPos->talent_id);
             talent.state       = IsInWorld() ? PLAYERSPELL_NEW : PLAYERSPELL_UNCHANGED;
             m_talents[m_activeSpec][talentPos->talent_id] = talent;
+
+            if (talent.state != PLAYERSPELL_UNCHANGED)
+                MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
         }
 
         // update used talent points count
@@ -3627,6 +3650,7 @@ void Player::removeSpell(uint32 spell_id, bool disabled, bool learn_low_rank, bo
         itr->second.disabled = disabled;
         if (itr->second.state != PLAYERSPELL_NEW)
             itr->second.state = PLAYERSPELL_CHANGED;
+        MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
     }
     else
     {
@@ -3634,6 +3658,7 @@ void Player::removeSpell(uint32 spell_id, bool disabled, bool learn_low_rank, bo
             m_spells.erase(itr);
         else
             itr->second.state = PLAYERSPELL_REMOVED;
+        MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
     }
 
     RemoveAurasDueToSpell(spell_id);
@@ -3654,6 +3679,7 @@ void Player::removeSpell(uint32 spell_id, bool disabled, bool learn_low_rank, bo
                 (*iter).second.state = PLAYERSPELL_REMOVED;
             else
                 m_talents[m_activeSpec].erase(iter);
+            MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
         }
         else
             sLog.outError("removeSpell: Player (GUID: %u) has talent spell (id: %u) but doesn't have talent",GetGUIDLow(), spell_id);
@@ -3772,6 +3798,7 @@ void Player::removeSpell(uint32 spell_id, bool disabled, bool learn_low_rank, bo
                     prev_itr->second.dependent = cur_dependent;
                     if (prev_itr->second.state != PLAYERSPELL_NEW)
                         prev_itr->second.state = PLAYERSPELL_CHANGED;
+                    MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
                 }
 
                 // now re-learn if need re-activate
@@ -3884,19 +3911,47 @@ void Player::_LoadSpellCooldowns(QueryResult *result)
     }
 }
 
-void Player::_SaveSpellCooldowns()
+// FNV-1a step, used to detect unchanged save data
+static inline void HashSaveValue(uint64& hash, uint64 value)
+{
+    hash = (hash ^ value) * UI64LIT(0x100000001B3);
+}
+
+#define SAVE_HASH_INITIAL UI64LIT(0xCBF29CE484222325)
+
+uint32 Player::_SaveSpellCooldowns(bool force)
 {
     static SqlStatementID deleteSpellCooldown ;
     static SqlStatementID insertSpellCooldown ;
 
-    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteSpellCooldown, "DELETE FROM character_spell_cooldown WHERE guid = ?");
-    stmt.PExecute(GetGUIDLow());
-
     time_t curTime = time(NULL);
     time_t infTime = curTime + infinityCooldownDelayCheck;
 
     // remove outdated and save active
     RemoveOutdatedSpellCooldowns();
+
+    uint32 rows = 0;
+    uint64 hash = SAVE_HASH_INITIAL;
+    for (SpellCooldowns::const_iterator itr = GetSpellCooldownMap()->begin();itr != GetSpellCooldownMap()->end(); ++itr)
+    {
+        if (itr->second.end <= infTime)
+        {
+            HashSaveValue(hash, itr->first);
+            HashSaveValue(hash, itr->second.itemid);
+            HashSaveValue(hash, uint64(itr->second.end));
+            ++rows;
+        }
+    }
+
+    // same cooldowns as already stored, skip DELETE and all INSERTs
+    if (!force && hash == m_savedCooldownsHash)
+        return rows + 1;
+
+    m_savedCooldownsHash = hash;
+
+    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteSpellCooldown, "DELETE FROM character_spell_cooldown WHERE guid = ?");
+    stmt.PExecute(GetGUIDLow());
+
     for (SpellCooldowns::const_iterator itr = GetSpellCooldownMap()->begin();itr != GetSpellCooldownMap()->end(); ++itr)
     {
         if (itr->second.end <= infTime)                 // not save locked cooldowns, it will be reset or set at reload
@@ -3905,6 +3960,8 @@ void Player::_SaveSpellCooldowns()
             stmt.PExecute(GetGUIDLow(), itr->first, itr->second.itemid, uint64(itr->second.end));
         }
     }
+
+    return 0;
 }
 
 uint32 Player::resetTalentsCost() const
@@ -4033,6 +4090,7 @@ bool Player::resetTalents(bool no_cost, bool all_specs)
                     break;
                 default:
                     iter->second.state = PLAYERSPELL_REMOVED;
+                    MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
                     ++iter;
                     break;
                 }
@@ -4363,8 +4421,8 @@ void Player::DeleteFromDB(ObjectGuid playerguid, uint32 accountId, bool updateRe
             // delete char from friends list when selected chars is online (non existing - error)
             QueryResult *resultFriend = CharacterDatabase.PQuery("SELECT DISTINCT guid FROM character_social WHERE friend = '%u'", lowguid);
 
-            // NOW we can finally clear other DB data related to character
-            CharacterDatabase.BeginTransaction();
+            // NOW we can finally clear other DB data related to character, after pending saves of it
+            CharacterDatabase.BeginTransaction(lowguid);
             if (resultPets)
             {
                 do
@@ -14090,6 +14148,7 @@ void Player::AddQuest(Quest const *pQuest, Object *questGiver)
 
     if (questStatusData.uState != QUEST_NEW)
         questStatusData.uState = QUEST_CHANGED;
+    MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
 
     // quest accept scripts
     if (questGiver)
@@ -14319,6 +14378,7 @@ void Player::RewardQuest(Quest const *pQuest, uint32 reward, Object* questGiver,
     q_status.m_rewarded = true;
     if (q_status.uState != QUEST_NEW)
         q_status.uState = QUEST_CHANGED;
+    MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
 
     if (announce)
         SendQuestReward(pQuest, xp, questGiver);
@@ -14892,6 +14952,7 @@ void Player::SetQuestStatus(uint32 quest_id, QuestStatus status)
 
         if (q_status.uState != QUEST_NEW)
             q_status.uState = QUEST_CHANGED;
+        MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
     }
 
     UpdateForQuestWorldObjects();
@@ -14924,6 +14985,7 @@ void Player::AdjustQuestReqItemCount(Quest const* pQuest, QuestStatusData& quest
 
                 questStatusData.m_itemcount[i] = std::min(curitemcount, reqitemcount);
                 if (questStatusData.uState != QUEST_NEW) questStatusData.uState = QUEST_CHANGED;
+                MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
             }
         }
     }
@@ -14955,6 +15017,7 @@ void Player::AreaExploredOrEventHappens(uint32 questId)
 
                 if (q_status.uState != QUEST_NEW)
                     q_status.uState = QUEST_CHANGED;
+                MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
             }
         }
         if (CanCompleteQuest(questId))
@@ -15012,6 +15075,7 @@ void Player::ItemAddedQuestCheck(uint32 entry, uint32 count)
                     q_status.m_itemcount[j] += additemcount;
                     if (q_status.uState != QUEST_NEW)
                         q_status.uState = QUEST_CHANGED;
+                    MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
                 }
                 if (CanCompleteQuest(questid))
                     CompleteQuest(questid);
@@ -15053,6 +15117,7 @@ void Player::ItemRemovedQuestCheck(uint32 entry, uint32 count)
                     uint32 remitemcount = (curitemcount <= reqitemcount ? count : count + reqitemcount - curitemcount);
                     q_status.m_itemcount[j] = curitemcount - remitemcount;
                     if (q_status.uState != QUEST_NEW) q_status.uState = QUEST_CHANGED;
+                    MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
 
                     IncompleteQuest(questid);
                 }
@@ -15114,6 +15179,7 @@ void Player::KilledMonsterCredit(uint32 entry, ObjectGuid guid)
                             q_status.m_creatureOrGOcount[j] = curkillcount + addkillcount;
                             if (q_status.uState != QUEST_NEW)
                                 q_status.uState = QUEST_CHANGED;
+                            MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
 
                             SendQuestUpdateAddCreatureOrGo(qInfo, guid, j, q_status.m_creatureOrGOcount[j]);
                         }
@@ -15190,6 +15256,7 @@ void Player::CastedCreatureOrGO(uint32 entry, ObjectGuid guid, uint32 spell_id,
                 q_status.m_creatureOrGOcount[j] = curCastCount + addCastCount;
                 if (q_status.uState != QUEST_NEW)
                     q_status.uState = QUEST_CHANGED;
+                MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
 
                 SendQuestUpdateAddCreatureOrGo(qInfo, guid, j, q_status.m_creatureOrGOcount[j]);
             }
@@ -15244,6 +15311,7 @@ void Player::TalkedToCreature(uint32 entry, ObjectGuid guid)
                         {
                             q_status.m_creatureOrGOcount[j] = curTalkCount + addTalkCount;
                             if (q_status.uState != QUEST_NEW) q_status.uState = QUEST_CHANGED;
+                            MarkSaveSectionDirty(PLAYER_SAVE_QUESTS);
 
                             SendQuestUpdateAddCreatureOrGo(qInfo, guid, j, q_status.m_creatureOrGOcount[j]);
                         }
@@ -16320,6 +16388,8 @@ bool Player::LoadFromDB(ObjectGuid guid, SqlQueryHolder *holder)
         sLFGMgr.RemoveMemberFromLFDGroup(GetGroup(),GetObjectGuid());
     }
 
+    m_characterRowSaved = true;
+
     return true;
 }
 
@@ -17651,15 +17721,39 @@ void Player::SaveToDB()
     DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_STATS, "The value of player %s at save: ", m_name.c_str());
     outDebugStatsValues();
 
-    CharacterDatabase.BeginTransaction();
+    // logout save writes all sections, other saves only ones changed since previous save
+    bool fullSave = m_session->isLogingOut();
+    uint32 dirtySections = fullSave ? uint32(PLAYER_SAVE_ALL_SECTIONS) : m_saveDirtySections;
+    uint32 avoidedStatements = 0;
+    m_saveDirtySections = 0;
+
+    // keyed by character, so save is ordered with other requests of this character on same async connection
+    CharacterDatabase.BeginTransaction(GetGUIDLow());
 
     static SqlStatementID delChar ;
     static SqlStatementID insChar ;
+    static SqlStatementID updChar ;
 
-    SqlStatement stmt = CharacterDatabase.CreateStatement(delChar, "DELETE FROM characters WHERE guid = ?");
-    stmt.PExecute(GetGUIDLow());
-
-    SqlStatement uberInsert = CharacterDatabase.CreateStatement(insChar, "INSERT INTO characters (guid,account,name,race,class,gender,level,xp,money,playerBytes,playerBytes2,playerFlags,"
+    // existing character row is updated in place, new character row inserted
+    // both statements take same parameters, UPDATE gets guid again for WHERE
+    if (!m_characterRowSaved)
+    {
+        SqlStatement stmt = CharacterDatabase.CreateStatement(delChar, "DELETE FROM characters WHERE guid = ?");
+        stmt.PExecute(GetGUIDLow());
+    }
+    else
+        ++avoidedStatements;
+
+    SqlStatement uberInsert = m_characterRowSaved ?
+        CharacterDatabase.CreateStatement(updChar, "UPDATE characters SET guid = ?, account = ?, name = ?, race = ?, class = ?, gender = ?, level = ?, xp = ?, money = ?, playerBytes = ?, playerBytes2 = ?, playerFlags = ?, "
+        "map = ?, dungeon_difficulty = ?, position_x = ?, position_y = ?, position_z = ?, orientation = ?, "
+        "taximask = ?, online = ?, cinematic = ?, "
+        "totaltime = ?, leveltime = ?, rest_bonus = ?, logout_time = ?, is_logout_resting = ?, resettalents_cost = ?, resettalents_time = ?, "
+        "trans_x = ?, trans_y = ?, trans_z = ?, trans_o = ?, transguid = ?, extra_flags = ?, stable_slots = ?, at_login = ?, zone = ?, "
+        "death_expire_time = ?, taxi_path = ?, arenaPoints = ?, totalHonorPoints = ?, todayHonorPoints = ?, yesterdayHonorPoints = ?, totalKills = ?, "
+        "todayKills = ?, yesterdayKills = ?, chosenTitle = ?, knownCurrencies = ?, watchedFaction = ?, drunk = ?, health = ?, power1 = ?, power2 = ?, power3 = ?, "
+        "power4 = ?, power5 = ?, power6 = ?, power7 = ?, specCount = ?, activeSpec = ?, exploredZones = ?, equipmentCache = ?, ammoId = ?, knownTitles = ?, actionBars = ?, grantableLevels = ? WHERE guid = ?") :
+        CharacterDatabase.CreateStatement(insChar, "INSERT INTO characters (guid,account,name,race,class,gender,level,xp,money,playerBytes,playerBytes2,playerFlags,"
         "map, dungeon_difficulty, position_x, position_y, position_z, orientation, "
         "taximask, online, cinematic, "
         "totaltime, leveltime, rest_bonus, logout_time, is_logout_resting, resettalents_cost, resettalents_time, "
@@ -17804,31 +17898,57 @@ void Player::SaveToDB()
 
     uberInsert.addUInt32(uint32(m_GrantableLevelsCount));
 
+    if (m_characterRowSaved)
+        uberInsert.addUInt32(GetGUIDLow());                 // WHERE guid = ?
+
     uberInsert.Execute();
+    m_characterRowSaved = true;
 
     if (m_mailsUpdated)                                     //save mails only when needed
         _SaveMail();
 
     _SaveBGData();
-    _SaveInventory();
-    _SaveQuestStatus();
+    _SaveInventory();                                       // inventory update queue is own dirty list
+    if (dirtySections & (1 << PLAYER_SAVE_QUESTS))
+        _SaveQuestStatus();
     _SaveDailyQuestStatus();
     _SaveWeeklyQuestStatus();
     _SaveMonthlyQuestStatus();
-    _SaveSpells();
-    _SaveSpellCooldowns();
+    if (dirtySections & (1 << PLAYER_SAVE_SPELLS))
+        _SaveSpells();
+
+    // cooldowns and auras are compared with content written at previous save
+    if (uint32 avoided = _SaveSpellCooldowns(fullSave))
+        avoidedStatements += avoided;
+    else
+        dirtySections |= (1 << PLAYER_SAVE_COOLDOWNS);
+
     _SaveActions();
-    _SaveAuras();
+
+    if (uint32 avoided = _SaveAuras(fullSave))
+        avoidedStatements += avoided;
+    else
+        dirtySections |= (1 << PLAYER_SAVE_AURAS);
+
     _SaveSkills();
-    m_achievementMgr.SaveToDB();
-    m_reputationMgr.SaveToDB();
+    if (dirtySections & (1 << PLAYER_SAVE_ACHIEVEMENTS))
+        m_achievementMgr.SaveToDB();
+    if (dirtySections & (1 << PLAYER_SAVE_REPUTATION))
+        m_reputationMgr.SaveToDB();
     _SaveEquipmentSets();
     GetSession()->SaveTutorialsData();                      // changed only while character in game
     _SaveGlyphs();
-    _SaveTalents();
+    if (dirtySections & (1 << PLAYER_SAVE_SPELLS))
+        _SaveTalents();
 
     CharacterDatabase.CommitTransaction();
 
+    ++m_saveStatistics.saves;
+    m_saveStatistics.statementsAvoided += avoidedStatements;
+    for (uint32 i = 0; i < MAX_PLAYER_SAVE_SECTIONS; ++i)
+        if (!(dirtySections & (1 << i)))
+            ++m_saveStatistics.sectionsSkipped[i];
+
     // check if stats should only be saved on logout
     // save stats can be out of transaction
     if (m_session->isLogingOut() || !sWorld.getConfig(CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT))
@@ -17910,25 +18030,32 @@ void Player::_SaveActions()
     }
 }
 
-void Player::_SaveAuras()
+// rows of character_aura as written by _SaveAuras
+struct PlayerAuraSaveData
+{
+    uint64 casterGuid;
+    uint32 itemGuid;
+    uint32 spellId;
+    uint32 stackAmount;
+    uint8  charges;
+    int32  damage[MAX_EFFECT_INDEX];
+    uint32 periodicTime[MAX_EFFECT_INDEX];
+    int32  maxDuration;
+    int32  duration;
+    uint32 effIndexMask;
+};
+
+uint32 Player::_SaveAuras(bool force)
 {
     static SqlStatementID deleteAuras ;
     static SqlStatementID insertAuras ;
 
     MAPLOCK_READ(this,MAP_LOCK_TYPE_AURAS);
 
-    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM character_aura WHERE guid = ?");
-    stmt.PExecute(GetGUIDLow());
+    std::vector<PlayerAuraSaveData> rows;
+    uint64 hash = SAVE_HASH_INITIAL;
 
     SpellAuraHolderMap const& auraHolders = GetSpellAuraHolderMap();
-
-    if (auraHolders.empty())
-        return;
-
-    stmt = CharacterDatabase.CreateStatement(insertAuras, "INSERT INTO character_aura (guid, caster_guid, item_guid, spell, stackcount, remaincharges, "
-        "basepoints0, basepoints1, basepoints2, periodictime0, periodictime1, periodictime2, maxduration, remaintime, effIndexMask) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-
     for (SpellAuraHolderMap::const_iterator itr = auraHolders.begin(); itr != auraHolders.end(); ++itr)
     {
         // skip all holders from spells that are passive or channeled
@@ -17938,14 +18065,13 @@ void Player::_SaveAuras()
         if (!itr->second->IsPassive() && !IsChanneledSpell(itr->second->GetSpellProto()) &&
                (trackedType == TRACK_AURA_TYPE_NOT_TRACKED || (trackedType == TRACK_AURA_TYPE_SINGLE_TARGET && selfCastHolder)))
         {
-            int32  damage[MAX_EFFECT_INDEX];
-            uint32 periodicTime[MAX_EFFECT_INDEX];
-            uint32 effIndexMask = 0;
+            PlayerAuraSaveData data;
+            data.effIndexMask = 0;
 
             for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
             {
-                damage[i] = 0;
-                periodicTime[i] = 0;
+                data.damage[i] = 0;
+                data.periodicTime[i] = 0;
 
                 if (Aura *aur = itr->second->GetAuraByEffectIndex(SpellEffectIndex(i)))
                 {
@@ -17953,34 +18079,79 @@ void Player::_SaveAuras()
                     if (aur->IsAreaAura() && itr->second->GetCasterGuid() != GetObjectGuid())
                         continue;
 
-                    damage[i] = aur->GetModifier()->m_amount;
-                    periodicTime[i] = aur->GetModifier()->periodictime;
-                    effIndexMask |= (1 << i);
+                    data.damage[i] = aur->GetModifier()->m_amount;
+                    data.periodicTime[i] = aur->GetModifier()->periodictime;
+                    data.effIndexMask |= (1 << i);
                 }
             }
 
-            if (!effIndexMask)
+            if (!data.effIndexMask)
                 continue;
 
-            stmt.addUInt32(GetGUIDLow());
-            stmt.addUInt64(itr->second->GetCasterGuid().GetRawValue());
-            stmt.addUInt32(itr->second->GetCastItemGuid().GetCounter());
-            stmt.addUInt32(itr->second->GetId());
-            stmt.addUInt32(itr->second->GetStackAmount());
-            stmt.addUInt8(itr->second->GetAuraCharges());
-
-            for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
-                stmt.addInt32(damage[i]);
-
+            data.casterGuid = itr->second->GetCasterGuid().GetRawValue();
+            data.itemGuid = itr->second->GetCastItemGuid().GetCounter();
+            data.spellId = itr->second->GetId();
+            data.stackAmount = itr->second->GetStackAmount();
+            data.charges = itr->second->GetAuraCharges();
+            data.maxDuration = itr->second->GetAuraMaxDuration();
+            data.duration = itr->second->GetAuraDuration();
+
+            HashSaveValue(hash, data.casterGuid);
+            HashSaveValue(hash, data.itemGuid);
+            HashSaveValue(hash, data.spellId);
+            HashSaveValue(hash, data.stackAmount);
+            HashSaveValue(hash, data.charges);
             for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
-                stmt.addUInt32(periodicTime[i]);
+            {
+                HashSaveValue(hash, uint32(data.damage[i]));
+                HashSaveValue(hash, data.periodicTime[i]);
+            }
+            HashSaveValue(hash, uint32(data.maxDuration));
+            HashSaveValue(hash, uint32(data.duration));
+            HashSaveValue(hash, data.effIndexMask);
 
-            stmt.addInt32(itr->second->GetAuraMaxDuration());
-            stmt.addInt32(itr->second->GetAuraDuration());
-            stmt.addUInt32(effIndexMask);
-            stmt.Execute();
+            rows.push_back(data);
         }
     }
+
+    // same rows as already stored, skip DELETE and all INSERTs
+    if (!force && hash == m_savedAurasHash)
+        return rows.size() + 1;
+
+    m_savedAurasHash = hash;
+
+    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM character_aura WHERE guid = ?");
+    stmt.PExecute(GetGUIDLow());
+
+    if (rows.empty())
+        return 0;
+
+    stmt = CharacterDatabase.CreateStatement(insertAuras, "INSERT INTO character_aura (guid, caster_guid, item_guid, spell, stackcount, remaincharges, "
+        "basepoints0, basepoints1, basepoints2, periodictime0, periodictime1, periodictime2, maxduration, remaintime, effIndexMask) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+
+    for (std::vector<PlayerAuraSaveData>::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+    {
+        stmt.addUInt32(GetGUIDLow());
+        stmt.addUInt64(itr->casterGuid);
+        stmt.addUInt32(itr->itemGuid);
+        stmt.addUInt32(itr->spellId);
+        stmt.addUInt32(itr->stackAmount);
+        stmt.addUInt8(itr->charges);
+
+        for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+            stmt.addInt32(itr->damage[i]);
+
+        for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+            stmt.addUInt32(itr->periodicTime[i]);
+
+        stmt.addInt32(itr->maxDuration);
+        stmt.addInt32(itr->duration);
+        stmt.addUInt32(itr->effIndexMask);
+        stmt.Execute();
+    }
+
+    return 0;
 }
 
 void Player::_SaveGlyphs()
@@ -18048,7 +18219,10 @@ void Player::_SaveInventory()
 
     // if no changes
     if (m_itemUpdateQueue.empty())
+    {
+        m_saveDirtySections &= ~(1 << PLAYER_SAVE_ITEMS);
         return;
+    }
 
     // do not save if the update queue is corrupt
     bool error = false;
@@ -18130,6 +18304,7 @@ void Player::_SaveInventory()
         item->SaveToDB();                                   // item have unchanged inventory record and can be save standalone
     }
     m_itemUpdateQueue.clear();
+    m_saveDirtySections &= ~(1 << PLAYER_SAVE_ITEMS);
 }
 
 void Player::_SaveMail()
@@ -19182,7 +19357,11 @@ void Player::AddSpellMod(Aura* aura, bool apply)
     if (apply)
         m_spellMods[mod->m_miscvalue].push_back(aura);
     else
+    {
+        // spell mod lists are not iterated at aura remove, so removed entry can be dropped at once
         m_spellMods[mod->m_miscvalue].remove(aura);
+        m_spellMods[mod->m_miscvalue].Compact();
+    }
 }
 
 template <class T> T Player::ApplySpellMod(uint32 spellId, SpellModOp op, T &basevalue)
@@ -23557,6 +23736,7 @@ void Player::ActivateSpec(uint8 specNum)
                 PlayerTalent& talentNew = m_talents[m_activeSpec][tempIter->first];
                 talentNew = talent;
                 talentNew.state = PLAYERSPELL_REMOVED;
+                MarkSaveSectionDirty(PLAYER_SAVE_SPELLS);
             }
         }
     }
@@ -24867,7 +25047,7 @@ void Player::RefundItem(Item* item)
     uint32 moneyRefund = item->GetPaidMoney();  // item-> will be invalidated in DestroyItem
 
     // Save all relevant data to DB to prevent desynchronisation exploits
-    CharacterDatabase.BeginTransaction();
+    CharacterDatabase.BeginTransaction(GetGUIDLow());
 
     // Delete any references to the refund data
     item->SetNotRefundable(this);
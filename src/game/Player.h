@@ -53,7 +53,6 @@ class Channel;
 class DynamicObject;
 class Creature;
 class PlayerMenu;
-class UpdateMask;
 class SpellCastTargets;
 class PlayerSocial;
 class DungeonPersistentState;
@@ -103,6 +102,29 @@ enum PlayerSpellState
     PLAYERSPELL_REMOVED   = 3
 };
 
+// Character data sections saved only if something in them changed since last save
+enum PlayerSaveSection
+{
+    PLAYER_SAVE_ITEMS           = 0,
+    PLAYER_SAVE_SPELLS          = 1,                        // spells and talents
+    PLAYER_SAVE_QUESTS          = 2,
+    PLAYER_SAVE_REPUTATION      = 3,
+    PLAYER_SAVE_ACHIEVEMENTS    = 4,
+    PLAYER_SAVE_AURAS           = 5,
+    PLAYER_SAVE_COOLDOWNS       = 6,
+};
+
+#define MAX_PLAYER_SAVE_SECTIONS 7
+#define PLAYER_SAVE_ALL_SECTIONS ((1 << MAX_PLAYER_SAVE_SECTIONS) - 1)
+
+// Totals for all character saves since server start
+struct PlayerSaveStatistics
+{
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> saves;
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> statementsAvoided;
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> sectionsSkipped[MAX_PLAYER_SAVE_SECTIONS];
+};
+
 struct PlayerSpell
 {
     PlayerSpellState state : 8;
@@ -1500,6 +1522,8 @@ class MANGOS_DLL_SPEC Player : public Unit
         /*********************************************************/
 
         void SaveToDB();
+        void MarkSaveSectionDirty(PlayerSaveSection section) { m_saveDirtySections |= (1 << section); }
+        static PlayerSaveStatistics& GetSaveStatistics() { return m_saveStatistics; }
         void SaveInventoryAndGoldToDB();                    // fast save function for item/money cheating preventing
         void SaveGoldToDB();
         static void SetUInt32ValueInArray(Tokens& data,uint16 index, uint32 value);
@@ -1677,7 +1701,7 @@ class MANGOS_DLL_SPEC Player : public Unit
 
         void RemoveArenaSpellCooldowns();
         void _LoadSpellCooldowns(QueryResult *result);
-        void _SaveSpellCooldowns();
+        uint32 _SaveSpellCooldowns(bool force);
         void SetLastPotionId(uint32 item_id) { m_lastPotionId = item_id; }
         uint32 GetLastPotionId() { return m_lastPotionId; }
         void UpdatePotionCooldown(Spell* spell = NULL);
@@ -2504,7 +2528,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         /*********************************************************/
 
         void _SaveActions();
-        void _SaveAuras();
+        uint32 _SaveAuras(bool force);
         void _SaveInventory();
         void _SaveMail();
         void _SaveQuestStatus();
@@ -2602,6 +2626,12 @@ class MANGOS_DLL_SPEC Player : public Unit
 
         TradeData* m_trade;
 
+        uint32 m_saveDirtySections;                         // PlayerSaveSection bits changed since last save
+        uint64 m_savedAurasHash;                            // content hash of character_aura rows written at last save
+        uint64 m_savedCooldownsHash;                        // same for character_spell_cooldown
+        bool   m_characterRowSaved;                         // characters row exists, can be updated in place
+        static PlayerSaveStatistics m_saveStatistics;
+
         bool   m_DailyQuestChanged;
         bool   m_WeeklyQuestChanged;
         bool   m_MonthlyQuestChanged;
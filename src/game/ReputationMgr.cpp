@@ -220,6 +220,7 @@ void ReputationMgr::Initialize()
             newFaction.Flags = GetDefaultStateFlags(factionEntry);
             newFaction.needSend = true;
             newFaction.needSave = true;
+            m_player->MarkSaveSectionDirty(PLAYER_SAVE_REPUTATION);
 
             if( newFaction.Flags & FACTION_FLAG_VISIBLE )
                 ++m_visibleFactionCount;
@@ -327,6 +328,7 @@ bool ReputationMgr::SetOneFactionReputation(FactionEntry const* factionEntry, in
         itr->second.Standing = standing - BaseRep;
         itr->second.needSend = true;
         itr->second.needSave = true;
+        m_player->MarkSaveSectionDirty(PLAYER_SAVE_REPUTATION);
 
         SetVisible(&itr->second);
 
@@ -382,6 +384,7 @@ void ReputationMgr::SetVisible(FactionState* faction)
     faction->Flags |= FACTION_FLAG_VISIBLE;
     faction->needSend = true;
     faction->needSave = true;
+    m_player->MarkSaveSectionDirty(PLAYER_SAVE_REPUTATION);
 
     ++m_visibleFactionCount;
 
@@ -418,6 +421,7 @@ void ReputationMgr::SetAtWar(FactionState* faction, bool atWar)
 
     faction->needSend = true;
     faction->needSave = true;
+    m_player->MarkSaveSectionDirty(PLAYER_SAVE_REPUTATION);
 }
 
 void ReputationMgr::SetInactive( RepListID repListID, bool on )
@@ -446,6 +450,7 @@ void ReputationMgr::SetInactive(FactionState* faction, bool inactive)
 
     faction->needSend = true;
     faction->needSave = true;
+    m_player->MarkSaveSectionDirty(PLAYER_SAVE_REPUTATION);
 }
 
 void ReputationMgr::LoadFromDB(QueryResult *result)
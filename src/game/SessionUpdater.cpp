@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "SessionUpdater.h"
+#include "WorldSession.h"
+#include "Timer.h"
+#include "Database/DatabaseEnv.h"
+#include <ace/Guard_T.h>
+
+void AuthedSessionUpdateTask::call()
+{
+    AuthedSessionFilter updater(m_session);
+    m_session->Update(updater);
+}
+
+SessionUpdater::SessionUpdater() :
+    m_workCondition(m_mutex), m_doneCondition(m_mutex), m_tasks(NULL), m_next(0), m_done(0), m_threads(0),
+    m_activated(false), m_stopping(false), m_lastBatchSize(0), m_lastBatchTime(0), m_totalTasks(0)
+{
+}
+
+SessionUpdater::~SessionUpdater()
+{
+    deactivate();
+}
+
+int SessionUpdater::activate(size_t num_threads)
+{
+    if (activated() || num_threads < 1)
+        return -1;
+
+    m_stopping = false;
+
+    if (ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, (int)num_threads) == -1)
+        return -1;
+
+    m_threads = num_threads;
+    m_activated = true;
+    return 0;
+}
+
+int SessionUpdater::deactivate()
+{
+    if (!activated())
+        return -1;
+
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+        m_stopping = true;
+        m_workCondition.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+
+    m_threads = 0;
+    m_activated = false;
+    return 0;
+}
+
+bool SessionUpdater::run_next(ACE_Guard<ACE_Thread_Mutex>& guard)
+{
+    if (!m_tasks || m_next >= m_tasks->size())
+        return false;
+
+    SessionUpdateTask* task = (*m_tasks)[m_next++];
+
+    guard.release();
+    task->call();
+    guard.acquire();
+
+    if (++m_done == m_tasks->size())
+        m_doneCondition.broadcast();
+
+    return true;
+}
+
+void SessionUpdater::execute(SessionUpdateTaskList const& tasks)
+{
+    if (tasks.empty())
+        return;
+
+    uint32 startTime = WorldTimer::getMSTime();
+
+    ACE_Guard<ACE_Thread_Mutex> guard(m_mutex);
+
+    m_tasks = &tasks;
+    m_next = 0;
+    m_done = 0;
+    m_workCondition.broadcast();
+
+    // calling thread takes part, then waits for tasks still running on pool threads
+    while (run_next(guard)) {}
+
+    while (m_done < tasks.size())
+        m_doneCondition.wait();
+
+    m_tasks = NULL;
+
+    m_lastBatchSize = tasks.size();
+    m_lastBatchTime = WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime());
+    m_totalTasks += tasks.size();
+}
+
+int SessionUpdater::svc()
+{
+    // handlers run here may do synchronous queries
+    CharacterDatabase.ThreadStart();
+
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(m_mutex);
+
+        while (!m_stopping)
+        {
+            if (!run_next(guard))
+                m_workCondition.wait();
+        }
+    }
+
+    CharacterDatabase.ThreadEnd();
+    return 0;
+}
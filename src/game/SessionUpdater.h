@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _SESSION_UPDATER_H_INCLUDED
+#define _SESSION_UPDATER_H_INCLUDED
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include "Common.h"
+
+class WorldSession;
+
+// Unit of work executed by SessionUpdater threads
+class SessionUpdateTask
+{
+    public:
+        virtual ~SessionUpdateTask() {}
+        virtual void call() = 0;
+};
+
+// Processes PROCESS_AUTHED_THREADSAFE packets of a session without player in world
+class AuthedSessionUpdateTask : public SessionUpdateTask
+{
+    public:
+        explicit AuthedSessionUpdateTask(WorldSession* session) : m_session(session) {}
+
+        virtual void call();
+
+    private:
+        WorldSession* m_session;
+};
+
+typedef std::vector<SessionUpdateTask*> SessionUpdateTaskList;
+
+/**
+ * Thread pool for character screen traffic of sessions without a player in world.
+ *
+ * World::UpdateSessions() hands a batch of tasks to execute(); the calling thread takes part in the work
+ * and returns when all tasks are done, so handlers run here only concurrently with each other and never
+ * with the world or map updates. Which opcodes are allowed is declared per opcode in opcodeTable.
+ */
+class SessionUpdater : protected ACE_Task_Base
+{
+    public:
+
+        SessionUpdater();
+        virtual ~SessionUpdater();
+
+        int activate(size_t num_threads);
+
+        int deactivate();
+
+        bool activated() const { return m_activated; }
+
+        size_t threads() const { return m_threads; }
+
+        // executes all tasks, tasks stay owned by caller
+        void execute(SessionUpdateTaskList const& tasks);
+
+        virtual int svc();
+
+        // statistics
+        uint32 GetLastBatchSize() const { return m_lastBatchSize; }
+        uint32 GetLastBatchTime() const { return m_lastBatchTime; }
+        uint64 GetTotalTasks() const { return m_totalTasks; }
+
+    private:
+
+        // claims and runs next task of current batch, false if all are claimed; m_mutex must be held
+        bool run_next(ACE_Guard<ACE_Thread_Mutex>& guard);
+
+        ACE_Thread_Mutex m_mutex;
+        ACE_Condition_Thread_Mutex m_workCondition;         // signaled at new batch and deactivate
+        ACE_Condition_Thread_Mutex m_doneCondition;         // signaled when last task of batch finished
+
+        SessionUpdateTaskList const* m_tasks;
+        size_t m_next;
+        size_t m_done;
+        size_t m_threads;
+        bool m_activated;
+        bool m_stopping;
+
+        uint32 m_lastBatchSize;
+        uint32 m_lastBatchTime;
+        uint64 m_totalTasks;
+};
+
+#endif //_SESSION_UPDATER_H_INCLUDED
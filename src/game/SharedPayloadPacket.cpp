@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "SharedPayloadPacket.h"
+#include "WorldPacket.h"
+#include <ace/Message_Block.h>
+#include <ace/Lock_Adapter_T.h>
+#include <ace/Thread_Mutex.h>
+
+// Shared payloads are released by the network threads, so their reference counts need a lock.
+// Each payload owns its lock, sockets releasing different payloads don't contend then.
+class SharedPayloadDataBlock : public ACE_Data_Block
+{
+    public:
+        explicit SharedPayloadDataBlock(size_t size)
+            : ACE_Data_Block(size, ACE_Message_Block::MB_DATA, NULL, NULL, &m_lock, 0, NULL) {}
+
+    private:
+        // freed by ACE_Data_Block::release only after the guard on it is left
+        ACE_Lock_Adapter<ACE_Thread_Mutex> m_lock;
+};
+
+SharedPayloadPacket::~SharedPayloadPacket()
+{
+    if (m_payload)
+        m_payload->release();
+}
+
+ACE_Message_Block* SharedPayloadPacket::GetPayload() const
+{
+    if (!m_payload && m_packet.size() >= SHARED_PAYLOAD_MIN_SIZE)
+    {
+        // ACE frees data blocks with their allocator, so the block must come from it too
+        ACE_Allocator* allocator = ACE_Allocator::instance();
+        SharedPayloadDataBlock* block = NULL;
+        ACE_NEW_MALLOC_RETURN(block, static_cast<SharedPayloadDataBlock*>(allocator->malloc(sizeof(SharedPayloadDataBlock))),
+                              SharedPayloadDataBlock(m_packet.size()), NULL);
+
+        // exactly sized, so no socket ever appends other output to it
+        ACE_NEW_NORETURN(m_payload, ACE_Message_Block(block));
+        if (!m_payload)
+        {
+            ACE_DES_FREE(block, allocator->free, SharedPayloadDataBlock);
+            return NULL;
+        }
+
+        if (!m_payload->base())
+        {
+            m_payload->release();
+            m_payload = NULL;
+            return NULL;
+        }
+
+        m_payload->copy((char const*)m_packet.contents(), m_packet.size());
+    }
+
+    return m_payload;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _SHARED_PAYLOAD_PACKET_H_INCLUDED
+#define _SHARED_PAYLOAD_PACKET_H_INCLUDED
+
+#include "Common.h"
+
+class ACE_Message_Block;
+class WorldPacket;
+
+#define SHARED_PAYLOAD_MIN_SIZE 256                         // smaller payloads are copied, a reference costs about as much
+
+/**
+ * Packet sent to many sessions.
+ *
+ * The payload is serialized once into an immutable reference counted block at the first send to a socket.
+ * Each WorldSocket then queues only its own encrypted header followed by a reference to that block,
+ * instead of copying the whole payload into its output buffer. The block is freed when the last socket
+ * has sent it, the SharedPayloadPacket itself is meant to live only for the broadcast loop.
+ */
+class SharedPayloadPacket
+{
+    public:
+        explicit SharedPayloadPacket(WorldPacket const& packet) : m_packet(packet), m_payload(NULL) {}
+        ~SharedPayloadPacket();
+
+        WorldPacket const& GetPacket() const { return m_packet; }
+
+        // shared payload block, NULL if the packet is too small to be shared or at allocation failure
+        ACE_Message_Block* GetPayload() const;
+
+    private:
+        SharedPayloadPacket(SharedPayloadPacket const&);
+        SharedPayloadPacket& operator=(SharedPayloadPacket const&);
+
+        WorldPacket const& m_packet;
+        mutable ACE_Message_Block* m_payload;
+};
+
+#endif //_SHARED_PAYLOAD_PACKET_H_INCLUDED
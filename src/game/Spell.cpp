@@ -8145,6 +8145,53 @@ void Spell::FillAreaTargets(UnitList &targetUnitMap, float radius, SpellNotifyPu
 {
     MaNGOS::SpellNotifierCreatureAndPlayer notifier(*this, targetUnitMap, radius, pushType, spellTargets, originalCaster);
     Cell::VisitAllObjects(notifier.GetCenterX(), notifier.GetCenterY(), m_caster->GetMap(), notifier, radius);
+    notifier.CheckPendingTargets();
+}
+
+void MaNGOS::SpellNotifierCreatureAndPlayer::CheckPendingTargets()
+{
+    if (i_pending.empty())
+        return;
+
+    std::vector<VMAP::LineOfSightQuery> queries;
+    std::vector<uint32> queryTargets;
+    std::vector<uint8> results;
+    queries.reserve(i_pending.size());
+    queryTargets.reserve(i_pending.size());
+
+    // dynamic objects are phased, so batches are done per phase mask of targets, mostly only one
+    std::vector<bool> visible(i_pending.size(), true);
+    std::vector<bool> checked(i_pending.size(), false);
+    for (uint32 first = 0; first < i_pending.size(); ++first)
+    {
+        if (!i_pending[first].checkLOS || checked[first])
+            continue;
+
+        uint32 phaseMask = i_pending[first].target->GetPhaseMask();
+
+        queries.clear();
+        queryTargets.clear();
+        for (uint32 i = first; i < i_pending.size(); ++i)
+        {
+            if (!i_pending[i].checkLOS || checked[i] || i_pending[i].target->GetPhaseMask() != phaseMask)
+                continue;
+
+            queries.push_back(i_pending[i].los);
+            queryTargets.push_back(i);
+            checked[i] = true;
+        }
+
+        results.resize(queries.size());
+        i_spell.m_caster->GetMap()->IsInLineOfSight(&queries[0], queries.size(), phaseMask, &results[0]);
+        for (uint32 i = 0; i < queryTargets.size(); ++i)
+            visible[queryTargets[i]] = results[i] != 0;
+    }
+
+    for (uint32 i = 0; i < i_pending.size(); ++i)
+        if (visible[i])
+            i_data->push_back(i_pending[i].target);
+
+    i_pending.clear();
 }
 
 void Spell::FillRaidOrPartyTargets(UnitList &targetUnitMap, Unit* member, Unit* center, float radius, bool raid, bool withPets, bool withcaster)
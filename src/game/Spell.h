@@ -27,6 +27,7 @@
 #include "LootMgr.h"
 #include "Unit.h"
 #include "Player.h"
+#include "IVMapManager.h"
 
 class WorldSession;
 class WorldPacket;
@@ -758,6 +759,15 @@ namespace MaNGOS
         bool i_playerControlled;
         WorldLocation i_center;
 
+        // found targets waiting for line of sight check, with the ones after them to keep visit order
+        struct PendingTarget
+        {
+            Unit* target;
+            bool checkLOS;
+            VMAP::LineOfSightQuery los;
+        };
+        std::vector<PendingTarget> i_pending;
+
         WorldLocation const& GetCenter() const { return i_center; }
 
         float GetCenterX() const { return i_center.x; }
@@ -808,6 +818,25 @@ namespace MaNGOS
             }
         }
 
+        void PushTarget(Unit* target, VMAP::LineOfSightQuery const* los)
+        {
+            if (!los && i_pending.empty())
+            {
+                i_data->push_back(target);
+                return;
+            }
+
+            PendingTarget pending;
+            pending.target = target;
+            pending.checkLOS = los != NULL;
+            if (los)
+                pending.los = *los;
+            i_pending.push_back(pending);
+        }
+
+        // line of sight of AoE damage targets is checked in batches after the visit, must be called after it
+        void CheckPendingTargets();
+
         template<class T> inline void Visit(GridRefManager<T>  &m)
         {
             MANGOS_ASSERT(i_data);
@@ -817,6 +846,9 @@ namespace MaNGOS
 
             for(typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
             {
+                VMAP::LineOfSightQuery los;
+                VMAP::LineOfSightQuery const* pLOS = NULL;
+
                 // there are still more spells which can be casted on dead, but
                 // they are no AOE and don't have such a nice SPELL_ATTR flag
                 if ((i_TargetType != SPELL_TARGETS_ALL && !itr->getSource()->isTargetableForAttack(i_spell.m_spellInfo->HasAttribute(SPELL_ATTR_EX3_CAST_ON_DEAD)))
@@ -858,8 +890,16 @@ namespace MaNGOS
                                 continue;
                         }
 
-                        if (!itr->getSource()->IsVisibleTargetForSpell(i_originalCaster, i_spell.m_spellInfo, &i_center))
-                            continue;
+                        switch (itr->getSource()->GetSpellTargetVisibility(i_originalCaster, i_spell.m_spellInfo, &i_center, los))
+                        {
+                            case SPELL_TARGET_NOT_VISIBLE:
+                                continue;
+                            case SPELL_TARGET_VISIBLE_IF_IN_LOS:
+                                pLOS = &los;        // checked in CheckPendingTargets() for targets in radius only
+                                break;
+                            default:
+                                break;
+                        }
                         break;
                     }
                     case SPELL_TARGETS_ALL:
@@ -872,49 +912,49 @@ namespace MaNGOS
                 {
                     case PUSH_IN_FRONT:
                         if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, 2*M_PI_F/3 ))
-                            i_data->push_back(itr->getSource());
+                            PushTarget(itr->getSource(), pLOS);
                         break;
                     case PUSH_IN_FRONT_90:
                         if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, M_PI_F/2 ))
-                            i_data->push_back(itr->getSource());
+                            PushTarget(itr->getSource(), pLOS);
                         break;
                     case PUSH_IN_FRONT_30:
                         if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, M_PI_F/6 ))
-                            i_data->push_back(itr->getSource());
+                            PushTarget(itr->getSource(), pLOS);
                         break;
                     case PUSH_IN_FRONT_15:
                         if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, M_PI_F/12 ))
-                            i_data->push_back(itr->getSource());
+                            PushTarget(itr->getSource(), pLOS);
                         break;
                     case PUSH_IN_BACK:
                         if (i_castingObject->isInBack((Unit*)(itr->getSource()), i_radius, 2*M_PI_F/3 ))
-                            i_data->push_back(itr->getSource());
+                            PushTarget(itr->getSource(), pLOS);
                         break;
                     case PUSH_SELF_CENTER:
                         if (i_castingObject->IsWithinDist((Unit*)(itr->getSource()), i_radius))
-                            i_data->push_back(itr->getSource());
+                            PushTarget(itr->getSource(), pLOS);
                         break;
                     case PUSH_DEST_CENTER:
                         if (itr->getSource()->IsWithinDist3d(GetCenter(), i_radius))
-                            i_data->push_back(itr->getSource());
+                            PushTarget(itr->getSource(), pLOS);
                         break;
                     case PUSH_INHERITED_CENTER:
                     {
                         if ((i_spell.m_targets.m_targetMask & TARGET_FLAG_DEST_LOCATION) || (i_spell.m_targets.m_targetMask & TARGET_FLAG_UNIT))
                         {
                             if (itr->getSource()->IsWithinDist3d(i_spell.m_targets.getDestination(), i_radius))
-                                i_data->push_back(itr->getSource());
+                                PushTarget(itr->getSource(), pLOS);
                         }
                         else if (i_spell.m_targets.m_targetMask & TARGET_FLAG_SOURCE_LOCATION)
                         {
                             if (itr->getSource()->IsWithinDist3d(i_spell.m_targets.getSource(), i_radius))
-                                i_data->push_back(itr->getSource());
+                                PushTarget(itr->getSource(), pLOS);
                         }
                         break;
                     }
                     case PUSH_TARGET_CENTER:
                         if (i_spell.m_targets.getUnitTarget() && i_spell.m_targets.getUnitTarget()->IsWithinDist((Unit*)(itr->getSource()), i_radius))
-                            i_data->push_back(itr->getSource());
+                            PushTarget(itr->getSource(), pLOS);
                         break;
                 }
             }
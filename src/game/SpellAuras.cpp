@@ -587,17 +587,89 @@ Aura* SpellAuraHolder::CreateAura(SpellEntry const* spellproto, SpellEffectIndex
 
 Aura* SpellAuraHolder::CreateAura(AuraClassType type, SpellEffectIndex eff, int32* currentBasePoints, SpellAuraHolderPtr holder, Unit* target, Unit* caster, Item* castItem)
 {
-    AddAura(Aura(type, m_spellProto, eff, currentBasePoints, holder, target, caster, castItem),eff);
+    AddAura(new (*m_auraPool) Aura(type, m_spellProto, eff, currentBasePoints, holder, target, caster, castItem), eff);
 
     return GetAuraByEffectIndex(eff);
 }
 
 SpellAuraHolderPtr CreateSpellAuraHolder(SpellEntry const* spellproto, Unit *target, WorldObject *caster, Item *castItem)
 {
-     SpellAuraHolderPtr holderPtr = SpellAuraHolderPtr(new SpellAuraHolder(spellproto, target, caster, castItem));
+     MANGOS_ASSERT(target);
+     SpellAuraHolderPtr holderPtr = SpellAuraHolderPtr(new (SpellAuraPool::ForMap(target->GetMapId())) SpellAuraHolder(spellproto, target, caster, castItem));
      return holderPtr;
 }
 
+// Pools are never released: holders and auras can outlive their map (at teleport, for example)
+#define SPELL_AURA_POOL_COUNT 1024                          // more than max map id, other maps share pools
+
+static SpellAuraPool* s_spellAuraPools[SPELL_AURA_POOL_COUNT];
+static ACE_Thread_Mutex s_spellAuraPoolsLock;
+
+SpellAuraPool::SpellAuraPool() : holders(sizeof(SpellAuraHolder)), auras(sizeof(Aura), 4 * MAX_EFFECT_INDEX * 64)
+{
+}
+
+SpellAuraPool& SpellAuraPool::ForMap(uint32 mapId)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(s_spellAuraPoolsLock);
+
+    SpellAuraPool*& pool = s_spellAuraPools[mapId % SPELL_AURA_POOL_COUNT];
+    if (!pool)
+        pool = new SpellAuraPool;
+
+    return *pool;
+}
+
+void SpellAuraPool::GetStatistics(uint32& pools, uint32& usedHolders, uint32& usedAuras, uint32& reservedBytes)
+{
+    pools = usedHolders = usedAuras = reservedBytes = 0;
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, s_spellAuraPoolsLock);
+
+    for (uint32 i = 0; i < SPELL_AURA_POOL_COUNT; ++i)
+    {
+        if (SpellAuraPool const* pool = s_spellAuraPools[i])
+        {
+            ++pools;
+            usedHolders += pool->holders.GetUsedCount();
+            usedAuras += pool->auras.GetUsedCount();
+            reservedBytes += pool->holders.GetReservedSize() + pool->auras.GetReservedSize();
+        }
+    }
+}
+
+void* SpellAuraHolder::operator new(size_t size, SpellAuraPool& pool)
+{
+    MANGOS_ASSERT(size <= sizeof(SpellAuraHolder));
+    return pool.holders.Allocate();
+}
+
+void SpellAuraHolder::operator delete(void* p, SpellAuraPool& /*pool*/)
+{
+    SpellAuraObjectPool::Deallocate(p);
+}
+
+void SpellAuraHolder::operator delete(void* p)
+{
+    SpellAuraObjectPool::Deallocate(p);
+}
+
+void* Aura::operator new(size_t size, SpellAuraPool& pool)
+{
+    MANGOS_ASSERT(size <= sizeof(Aura));
+    return pool.auras.Allocate();
+}
+
+void Aura::operator delete(void* p, SpellAuraPool& /*pool*/)
+{
+    SpellAuraObjectPool::Deallocate(p);
+}
+
+void Aura::operator delete(void* p)
+{
+    SpellAuraObjectPool::Deallocate(p);
+}
+
 void Aura::SetModifier(AuraType t, int32 a, uint32 pt, int32 miscValue)
 {
     m_modifier.m_auraname = t;
@@ -10579,7 +10651,9 @@ m_permanent(false), m_isRemovedOnShapeLost(true), m_deleted(false)
 {
     MANGOS_ASSERT(target);
     MANGOS_ASSERT(spellproto && spellproto == sSpellStore.LookupEntry( spellproto->Id ) && "`info` must be pointer to sSpellStore element");
-    m_aurasStorage.clear();
+    m_auraPool = &SpellAuraPool::ForMap(target->GetMapId());
+    for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        m_auras[i] = NULL;
 
     if (!caster)
         m_casterGuid = target->GetObjectGuid();
@@ -10647,24 +10721,21 @@ m_permanent(false), m_isRemovedOnShapeLost(true), m_deleted(false)
     }
 }
 
-void SpellAuraHolder::AddAura(Aura const& aura, SpellEffectIndex index)
+void SpellAuraHolder::AddAura(Aura* aura, SpellEffectIndex index)
 {
     if (/*Aura* _aura = */GetAuraByEffectIndex(index))
     {
         DEBUG_LOG("SpellAuraHolder::AddAura attempt to add aura (effect %u) to holder of spell %u, but holder already have active aura!", index, GetId());
         RemoveAura(index);
     }
-    if (!m_aurasStorage.empty())
+    if (Aura* oldAura = m_auras[index])
     {
-        AuraStorage::iterator itr = m_aurasStorage.find(index);
-        if (itr != m_aurasStorage.end())
-        {
-            MAPLOCK_WRITE(m_target, MAP_LOCK_TYPE_AURAS);
-            m_aurasStorage.erase(itr);
-        }
+        MAPLOCK_WRITE(m_target, MAP_LOCK_TYPE_AURAS);
+        m_auras[index] = NULL;
+        delete oldAura;
     }
 
-    m_aurasStorage.insert(AuraStorage::value_type(index,aura));
+    m_auras[index] = aura;
     m_auraFlags |= (1 << index);
 }
 
@@ -10678,29 +10749,27 @@ void SpellAuraHolder::CleanupsBeforeDelete()
     for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
         RemoveAura(SpellEffectIndex(i));
 
-    if (!m_aurasStorage.empty())
-        m_aurasStorage.clear();
+    for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+    {
+        if (Aura* aura = m_auras[i])
+        {
+            m_auras[i] = NULL;
+            delete aura;
+        }
+    }
 }
 
 Aura* SpellAuraHolder::GetAuraByEffectIndex(SpellEffectIndex index)
 {
-    if ((m_auraFlags & (1 << index)) && !m_aurasStorage.empty())
-    {
-        AuraStorage::iterator itr = m_aurasStorage.find(index);
-        if (itr != m_aurasStorage.end())
-            return &itr->second;
-    }
+    if (m_auraFlags & (1 << index))
+        return m_auras[index];
     return (Aura*)NULL;
 }
 
 Aura const* SpellAuraHolder::GetAura(SpellEffectIndex index) const
 {
-    if ((m_auraFlags & (1 << index)) && !m_aurasStorage.empty())
-    {
-        AuraStorage::const_iterator itr = m_aurasStorage.find(index);
-        if (itr != m_aurasStorage.end())
-            return &itr->second;
-    }
+    if (m_auraFlags & (1 << index))
+        return m_auras[index];
     return (Aura*)NULL;
 }
 
@@ -11216,7 +11285,8 @@ void SpellAuraHolder::BuildUpdatePacket(WorldPacket& data) const
 
 void SpellAuraHolder::SendAuraUpdate(bool remove) const
 {
-    WorldPacket data(SMSG_AURA_UPDATE);
+    // guid, slot, spell, flags, level, stack, caster guid, durations
+    WorldPacket data(SMSG_AURA_UPDATE, 9 + 1 + 4 + 1 + 1 + 1 + 9 + 4 + 4);
     data << m_target->GetPackGUID();
 
     if (remove)
@@ -12407,6 +12477,8 @@ void SpellAuraHolder::HandleSpellSpecificBoostsForward(bool apply)
 SpellAuraHolder::~SpellAuraHolder()
 {
 //    DEBUG_LOG("SpellAuraHolder:: destructor for SpellAuraHolder of spell %u called.", GetId());
+    for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        delete m_auras[i];
 }
 
 void SpellAuraHolder::Update(uint32 diff)
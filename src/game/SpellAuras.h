@@ -63,16 +63,33 @@ struct DamageInfo;
 // forward decl
 class Aura;
 
-typedef std::map<SpellEffectIndex,Aura> AuraStorage;
+typedef ObjectPool<ACE_Thread_Mutex> SpellAuraObjectPool;
+
+// Storage of holders and auras applied to units of one map; blocks can be freed from any map thread
+struct SpellAuraPool
+{
+    SpellAuraPool();
+
+    SpellAuraObjectPool holders;
+    SpellAuraObjectPool auras;
+
+    static SpellAuraPool& ForMap(uint32 mapId);
+    static void GetStatistics(uint32& pools, uint32& usedHolders, uint32& usedAuras, uint32& reservedBytes);
+};
 
 // internal helper
 struct ReapplyAffectedPassiveAurasHelper;
 
-class MANGOS_DLL_SPEC SpellAuraHolder
+class MANGOS_DLL_SPEC SpellAuraHolder : public CountedObject
 {
     public:
         SpellAuraHolder (SpellEntry const* spellproto, Unit *target, WorldObject *caster, Item *castItem);
 
+        // must be created only in pool of target's map, see CreateSpellAuraHolder
+        static void* operator new(size_t size, SpellAuraPool& pool);
+        static void operator delete(void* p, SpellAuraPool& pool);
+        static void operator delete(void* p);
+
         Aura* CreateAura(SpellEntry const* spellproto, SpellEffectIndex eff, int32* currentBasePoints, SpellAuraHolderPtr holder, Unit *target, Unit *caster = NULL, Item* castItem = NULL);
         Aura* CreateAura(AuraClassType type, SpellEffectIndex eff, int32* currentBasePoints, SpellAuraHolderPtr holder, Unit *target, Unit *caster = NULL, Item* castItem = NULL);
 
@@ -185,7 +202,7 @@ class MANGOS_DLL_SPEC SpellAuraHolder
         ~SpellAuraHolder();
 
     private:
-        void AddAura(Aura const& aura, SpellEffectIndex index);
+        void AddAura(Aura* aura, SpellEffectIndex index);
 
         SpellEntry const* m_spellProto;
 
@@ -208,7 +225,8 @@ class MANGOS_DLL_SPEC SpellAuraHolder
         DiminishingGroup m_AuraDRGroup:8;                   // Diminishing
         TrackedAuraType m_trackedAuraType: 8;               // store if the caster tracks the aura - can change at spell steal for example
 
-        AuraStorage       m_aurasStorage;                   // Auras storage
+        SpellAuraPool*    m_auraPool;                       // Pool of auras created by this holder
+        Aura*             m_auras[MAX_EFFECT_INDEX];        // Auras storage
 
         bool m_permanent:1;
         bool m_isPassive:1;
@@ -413,6 +431,11 @@ class MANGOS_DLL_SPEC Aura
 
         virtual ~Aura();
 
+        // allocated only by owner holder, from its aura pool
+        static void* operator new(size_t size, SpellAuraPool& pool);
+        static void operator delete(void* p, SpellAuraPool& pool);
+        static void operator delete(void* p);
+
         void SetModifier(AuraType t, int32 a, uint32 pt, int32 miscValue);
         Modifier*       GetModifier()       { return &m_modifier; }
         Modifier const* GetModifier() const { return &m_modifier; }
@@ -580,6 +603,7 @@ class MANGOS_DLL_SPEC AuraPair
         SpellAuraHolderPtr GetHolder()         { return m_holder; };
         SpellAuraHolderPtr GetHolder()   const { return m_holder; };
         SpellEffectIndex   GetEffIndex() const { return m_index; };
+        bool               HasHolder()   const { return m_holder; };
 
         bool IsEmpty(bool withDeleted = true) const
         {
@@ -597,5 +621,143 @@ class MANGOS_DLL_SPEC AuraPair
         SpellEffectIndex   m_index;
 };
 
+// Auras of one modifier type with std::list like interface, stored contiguous for fast iteration.
+// Removed entries are only cleared (holder reset) and skipped by iterators, and iterators keep positions
+// instead of pointers, so auras can be added and removed while list is iterated. Cleared entries are
+// dropped by Compact() at points where no iteration can be in progress.
+class MANGOS_DLL_SPEC AuraPairList
+{
+    public:
+        typedef std::vector<AuraPair> Storage;
+
+        template<class LIST, class VALUE>
+        class Iterator
+        {
+            public:
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef AuraPair value_type;
+                typedef ptrdiff_t difference_type;
+                typedef VALUE* pointer;
+                typedef VALUE& reference;
+
+                Iterator() : m_list(NULL), m_pos(0) {}
+                Iterator(LIST* list, size_t pos) : m_list(list), m_pos(pos) {}
+                template<class OTHER_LIST, class OTHER_VALUE>
+                Iterator(Iterator<OTHER_LIST, OTHER_VALUE> const& other) : m_list(other.GetList()), m_pos(other.GetPos()) {}
+
+                reference operator*() const { return m_list->m_storage[m_pos]; }
+                pointer operator->() const { return &m_list->m_storage[m_pos]; }
+
+                Iterator& operator++() { m_pos = m_list->NextUsed(m_pos + 1); return *this; }
+                Iterator operator++(int) { Iterator tmp(*this); ++(*this); return tmp; }
+                Iterator& operator--() { m_pos = m_list->PrevUsed(m_pos); return *this; }
+                Iterator operator--(int) { Iterator tmp(*this); --(*this); return tmp; }
+
+                // all positions past storage end are end(), storage can be shrunk while iterated
+                bool operator==(Iterator const& other) const { return IsEnd() ? other.IsEnd() : (!other.IsEnd() && m_pos == other.m_pos); }
+                bool operator!=(Iterator const& other) const { return !(*this == other); }
+
+                LIST* GetList() const { return m_list; }
+                size_t GetPos() const { return m_pos; }
+
+            private:
+                bool IsEnd() const { return !m_list || m_pos >= m_list->m_storage.size(); }
+
+                LIST* m_list;
+                size_t m_pos;
+        };
+
+        typedef Iterator<AuraPairList, AuraPair> iterator;
+        typedef Iterator<AuraPairList const, AuraPair const> const_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+        AuraPairList() : m_removed(0) {}
+
+        iterator begin() { return iterator(this, NextUsed(0)); }
+        iterator end() { return iterator(this, m_storage.size()); }
+        const_iterator begin() const { return const_iterator(this, NextUsed(0)); }
+        const_iterator end() const { return const_iterator(this, m_storage.size()); }
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        bool empty() const { return m_storage.size() == m_removed; }
+        size_t size() const { return m_storage.size() - m_removed; }
+
+        AuraPair& front() { return *begin(); }
+        AuraPair const& front() const { return *begin(); }
+
+        void push_back(AuraPair const& pair) { m_storage.push_back(pair); }
+
+        // clears all entries equal to pair, as std::list::remove
+        void remove(AuraPair const& pair)
+        {
+            for (Storage::iterator itr = m_storage.begin(); itr != m_storage.end(); ++itr)
+                if (itr->HasHolder() && *itr == pair)
+                    Clear(*itr);
+
+            // nothing left, storage can be released without moving of used entries
+            if (m_removed == m_storage.size())
+                clear();
+        }
+
+        iterator erase(iterator itr)
+        {
+            Clear(*itr);
+            return ++itr;
+        }
+
+        void clear()
+        {
+            m_storage.clear();
+            m_removed = 0;
+        }
+
+        bool NeedCompact() const { return m_removed != 0; }
+
+        // drop cleared entries, must not be called while list is iterated
+        void Compact()
+        {
+            if (!m_removed)
+                return;
+
+            Storage::iterator last = m_storage.begin();
+            for (Storage::iterator itr = m_storage.begin(); itr != m_storage.end(); ++itr)
+                if (itr->HasHolder())
+                    *last++ = *itr;
+
+            m_storage.erase(last, m_storage.end());
+            m_removed = 0;
+        }
+
+    private:
+        void Clear(AuraPair& pair)
+        {
+            pair = AuraPair();
+            ++m_removed;
+        }
+
+        size_t NextUsed(size_t pos) const
+        {
+            while (pos < m_storage.size() && !m_storage[pos].HasHolder())
+                ++pos;
+            return pos;
+        }
+
+        size_t PrevUsed(size_t pos) const
+        {
+            if (pos > m_storage.size())
+                pos = m_storage.size();
+
+            while (pos > 0 && !m_storage[--pos].HasHolder()) {}
+            return pos;
+        }
+
+        Storage m_storage;
+        size_t m_removed;
+};
+
 
 #endif
@@ -102,13 +102,29 @@ void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T& owner, bool up
     // allow pets following their master to cheat while generating paths
     bool forceDest = (owner.GetTypeId() == TYPEID_UNIT && ((Creature*)&owner)->IsPet()
                       && owner.hasUnitState(UNIT_STAT_FOLLOW));
-    i_path->calculate(x, y, z, forceDest);
+
+    // standing unit needs its path at once, moving one can continue on old path until path workers finish new one
+    if (owner.movespline->Finalized())
+        i_path->calculate(x, y, z, forceDest);
+    else if (i_path->calculateAsync(x, y, z, forceDest))
+    {
+        m_speedChanged = false;
+        return;                                             // launched by Update() when calculated
+    }
+
+    _launchPath(owner);
+}
+
+template<class T, typename D>
+void TargetedMovementGeneratorMedium<T, D>::_launchPath(T& owner)
+{
     if (i_path->getPathType() & PATHFIND_NOPATH)
     {
+        G3D::Vector3 end = i_path->getEndPosition();
         DEBUG_FILTER_LOG(LOG_FILTER_AI_AND_MOVEGENSS,"TargetedMovementGeneratorMedium::  unit %s cannot find path to %s (%f, %f, %f),  gained PATHFIND_NOPATH! Owerride used.",
             owner.GetObjectGuid().GetString().c_str(),
             i_target.isValid() ? i_target->GetObjectGuid().GetString().c_str() : "<none>",
-            x,y,z);
+            end.x, end.y, end.z);
         //return;
     }
 
@@ -227,6 +243,10 @@ bool TargetedMovementGeneratorMedium<T, D>::Update(T& owner, const uint32& time_
             i_targetSearchingTimer = 0;
     }
 
+    // path queued by _setTargetLocation calculated meanwhile
+    if (i_path && i_path->updateAsync())
+        _launchPath(owner);
+
     if (m_speedChanged || targetMoved)
         _setTargetLocation(owner, true);
 
@@ -65,6 +65,7 @@ class MANGOS_DLL_SPEC TargetedMovementGeneratorMedium
 
     protected:
         void _setTargetLocation(T&, bool updateDestination);
+        void _launchPath(T&);
 
         ShortTimeTracker i_recheckDistance;
         uint32 i_targetSearchingTimer;
@@ -491,7 +491,7 @@ void WorldSession::HandleAcceptTradeOpcode(WorldPacket& recvPacket)
         trader->m_trade = NULL;
 
         // desynchronized with the other saves here (SaveInventoryAndGoldToDB() not have own transaction guards)
-        CharacterDatabase.BeginTransaction();
+        CharacterDatabase.BeginTransaction(SQL_SERIAL_ALL);  // both players data
         _player->SaveInventoryAndGoldToDB();
         trader->SaveInventoryAndGoldToDB();
         CharacterDatabase.CommitTransaction();
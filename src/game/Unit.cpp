@@ -238,6 +238,9 @@ Unit::Unit() :
     m_transform = 0;
     m_canModifyStats = false;
 
+    memset(m_modAuraTypeMask, 0, sizeof(m_modAuraTypeMask));
+    memset(m_modAuraCompactMask, 0, sizeof(m_modAuraCompactMask));
+
     for (int i = 0; i < MAX_SPELL_IMMUNITY; ++i)
         m_spellImmune[i].clear();
     for (int i = 0; i < UNIT_MOD_END; ++i)
@@ -356,6 +359,7 @@ void Unit::Update( uint32 update_diff, uint32 p_time )
     {
         MAPLOCK_WRITE(this,MAP_LOCK_TYPE_AURAS);
         CleanupDeletedHolders(false);
+        CompactModAuraLists();
     }
 
     if (m_lastManaUseTimer)
@@ -5198,7 +5202,40 @@ void Unit::AddAuraToModList(Aura* aura)
 {
     MAPLOCK_WRITE(this,MAP_LOCK_TYPE_AURAS);
     if (aura && aura->GetModifier()->m_auraname < TOTAL_AURAS)
-        m_modAuras[aura->GetModifier()->m_auraname].push_back(AuraPair(aura));
+        AddToModAuraList(aura->GetModifier()->m_auraname, AuraPair(aura));
+}
+
+void Unit::AddToModAuraList(AuraType type, AuraPair const& pair)
+{
+    m_modAuras[type].push_back(pair);
+    m_modAuraTypeMask[type >> 5] |= (1 << (type & 31));
+}
+
+void Unit::RemoveFromModAuraList(AuraType type, AuraPair const& pair)
+{
+    AuraList& auras = m_modAuras[type];
+    auras.remove(pair);
+
+    if (auras.empty())
+        m_modAuraTypeMask[type >> 5] &= ~(1 << (type & 31));
+    else if (auras.NeedCompact())
+        m_modAuraCompactMask[type >> 5] |= (1 << (type & 31));
+}
+
+// removed entries stay in lists while they can be iterated, drop them at unit update
+void Unit::CompactModAuraLists()
+{
+    for (uint32 i = 0; i < (TOTAL_AURAS + 31) / 32; ++i)
+    {
+        if (!m_modAuraCompactMask[i])
+            continue;
+
+        for (uint32 bit = 0; bit < 32; ++bit)
+            if (m_modAuraCompactMask[i] & (1 << bit))
+                m_modAuras[i * 32 + bit].Compact();
+
+        m_modAuraCompactMask[i] = 0;
+    }
 }
 
 void Unit::RemoveRankAurasDueToSpell(uint32 spellId)
@@ -5978,7 +6015,7 @@ void Unit::RemoveAura(Aura* aura, AuraRemoveMode mode)
     if (aura->GetModifier()->m_auraname < TOTAL_AURAS)
     {
         MAPLOCK_WRITE(this,MAP_LOCK_TYPE_AURAS);
-        m_modAuras[aura->GetModifier()->m_auraname].remove(AuraPair(aura));
+        RemoveFromModAuraList(aura->GetModifier()->m_auraname, AuraPair(aura));
 
         // aura _MUST_ be remove from holder before unapply.
         // un-apply code expected that aura not find by diff searches
@@ -6179,11 +6216,6 @@ void Unit::_ApplyAllAuraMods()
     }
 }
 
-bool Unit::HasAuraType(AuraType auraType) const
-{
-    return !GetAurasByType(auraType).empty();
-}
-
 bool Unit::HasAuraTypeWithCaster(AuraType auraType, ObjectGuid casterGuid) const
 {
     AuraList const& mTotalAuraList = GetAurasByType(auraType);
@@ -11544,11 +11576,10 @@ void Unit::ApplyMaxPowerMod(Powers power, uint32 val, bool apply)
 void Unit::ApplyAuraProcTriggerDamage( Aura* aura, bool apply )
 {
     MAPLOCK_WRITE(this,MAP_LOCK_TYPE_AURAS);
-    AuraList& tAuraProcTriggerDamage = m_modAuras[SPELL_AURA_PROC_TRIGGER_DAMAGE];
     if (apply)
-        tAuraProcTriggerDamage.push_back(aura);
+        AddToModAuraList(SPELL_AURA_PROC_TRIGGER_DAMAGE, AuraPair(aura));
     else
-        tAuraProcTriggerDamage.remove(aura);
+        RemoveFromModAuraList(SPELL_AURA_PROC_TRIGGER_DAMAGE, AuraPair(aura));
 }
 
 uint32 Unit::GetCreatePowers( Powers power ) const
@@ -14078,6 +14109,20 @@ uint32 Unit::CalculateSpellDurationWithHaste(SpellEntry const* spellProto, uint3
 }
 
 bool Unit::IsVisibleTargetForSpell(WorldObject const* caster, SpellEntry const* spellInfo, WorldLocation const* location) const
+{
+    VMAP::LineOfSightQuery los;
+    switch (GetSpellTargetVisibility(caster, spellInfo, location, los))
+    {
+        case SPELL_TARGET_VISIBLE:
+            return true;
+        case SPELL_TARGET_VISIBLE_IF_IN_LOS:
+            return GetMap()->IsInLineOfSight(los.x1, los.y1, los.z1, los.x2, los.y2, los.z2, GetPhaseMask());
+        default:
+            return false;
+    }
+}
+
+SpellTargetVisibility Unit::GetSpellTargetVisibility(WorldObject const* caster, SpellEntry const* spellInfo, WorldLocation const* location, VMAP::LineOfSightQuery& los) const
 {
     bool no_stealth = false;
     switch (spellInfo->SpellFamilyName)
@@ -14095,34 +14140,50 @@ bool Unit::IsVisibleTargetForSpell(WorldObject const* caster, SpellEntry const*
 
     // spell can hit all targets in some cases:
     if (!VMAP::VMapFactory::checkSpellForLoS(spellInfo->Id))
-        return true;
+        return SPELL_TARGET_VISIBLE;
 
     if (spellInfo->HasAttribute(SPELL_ATTR_EX6_IGNORE_DETECTION))
-        return true;
+        return SPELL_TARGET_VISIBLE;
 
     // some totem spells must ignore LOS, only visibility/detect checks applied
     if (caster->GetTypeId() == TYPEID_UNIT && ((Creature*)caster)->IsTotem())
-        return isVisibleForOrDetect(static_cast<Unit const*>(caster), caster, true, false, true);
+        return isVisibleForOrDetect(static_cast<Unit const*>(caster), caster, true, false, true) ? SPELL_TARGET_VISIBLE : SPELL_TARGET_NOT_VISIBLE;
 
     // spell can't hit stealth/invisible targets
     if (no_stealth && caster->isType(TYPEMASK_UNIT) && !isVisibleForOrDetect(static_cast<Unit const*>(caster), caster, false, false, true, true))
-        return false;
+        return SPELL_TARGET_NOT_VISIBLE;
 
     if (spellInfo->HasAttribute(SPELL_ATTR_EX2_IGNORE_LOS))
-        return true;
+        return SPELL_TARGET_VISIBLE;
 
     if (location && location->HasMap()) // check only for fully initialized WorldLocation
     {
         DEBUG_FILTER_LOG(LOG_FILTER_SPELL_CAST, "Unit::IsVisibleTargetForSpell check LOS for spell %u, caster %s, location %f %f %f, target %s",
             spellInfo->Id, caster->GetObjectGuid().GetString().c_str(), location->x, location->y, location->z, GetObjectGuid().GetString().c_str());
-        return ((GetMapId() == location->GetMapId()) && IsWithinLOS(location->x, location->y, location->z));
+        if (GetMapId() != location->GetMapId())
+            return SPELL_TARGET_NOT_VISIBLE;
+
+        los.x2 = location->x;
+        los.y2 = location->y;
+        los.z2 = location->z + 2.0f;
     }
     else
     {
         DEBUG_FILTER_LOG(LOG_FILTER_SPELL_CAST, "Unit::IsVisibleTargetForSpell check LOS for spell %u, caster %s, target %s",
             spellInfo->Id, caster->GetObjectGuid().GetString().c_str(), GetObjectGuid().GetString().c_str());
-        return IsWithinLOSInMap(caster);
+        if (!IsInMap(caster))
+            return SPELL_TARGET_NOT_VISIBLE;
+
+        los.x2 = caster->GetPositionX();
+        los.y2 = caster->GetPositionY();
+        los.z2 = caster->GetPositionZ() + 2.0f;
     }
+
+    // same segment as WorldObject::IsWithinLOS
+    los.x1 = GetPositionX();
+    los.y1 = GetPositionY();
+    los.z1 = GetPositionZ() + 2.0f;
+    return SPELL_TARGET_VISIBLE_IF_IN_LOS;
 }
 
 uint32 Unit::GetModelForForm(SpellShapeshiftFormEntry const* ssEntry) const
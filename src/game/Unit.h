@@ -1268,6 +1268,14 @@ enum IgnoreUnitState
     IGNORE_UNIT_TARGET_NON_FROZEN = 126,                    // ignore absent of frozen state
 };
 
+// Result of Unit::GetSpellTargetVisibility
+enum SpellTargetVisibility
+{
+    SPELL_TARGET_NOT_VISIBLE        = 0,
+    SPELL_TARGET_VISIBLE            = 1,
+    SPELL_TARGET_VISIBLE_IF_IN_LOS  = 2,                    // visible if returned line of sight segment isn't blocked
+};
+
 struct SpellCooldown
 {
     time_t end;
@@ -1302,7 +1310,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         typedef std::pair<SpellAuraHolderMap::iterator, SpellAuraHolderMap::iterator> SpellAuraHolderBounds;
         typedef std::pair<SpellAuraHolderMap::const_iterator, SpellAuraHolderMap::const_iterator> SpellAuraHolderConstBounds;
         typedef std::queue<SpellAuraHolderPtr> SpellAuraHolderQueue;
-        typedef std::list<AuraPair> AuraList;
+        typedef AuraPairList AuraList;
         typedef std::list<DiminishingReturn> Diminishing;
         typedef UNORDERED_SET<ObjectGuid> ComboPointHolderSet;
         typedef std::vector<SpellAuraHolderPtr> VisibleAuraMap;
@@ -1577,7 +1585,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
             return m_spellAuraHolders.equal_range(spell_id);
         }
 
-        bool HasAuraType(AuraType auraType) const;
+        bool HasAuraType(AuraType auraType) const { return m_modAuraTypeMask[auraType >> 5] & (1 << (auraType & 31)); }
         bool HasAuraTypeWithCaster(AuraType auraType, ObjectGuid casterGuid) const;
         bool HasNegativeAuraType(AuraType auraType) const;
         bool HasAffectedAura(AuraType auraType, SpellEntry const* spellProto) const;
@@ -1926,6 +1934,8 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         bool canDetectInvisibilityOf(Unit const* u) const;
         void SetPhaseMask(uint32 newPhaseMask, bool update);// overwrite WorldObject::SetPhaseMask
         bool IsVisibleTargetForSpell(WorldObject const* caster, SpellEntry const* spellInfo, WorldLocation const* location = NULL) const;
+        // same as above with line of sight check left to caller, for checking many targets in one batch
+        SpellTargetVisibility GetSpellTargetVisibility(WorldObject const* caster, SpellEntry const* spellInfo, WorldLocation const* location, VMAP::LineOfSightQuery& los) const;
 
         // virtual functions for all world objects types
         bool isVisibleForInState(Player const* u, WorldObject const* viewPoint, bool inVisibleList) const;
@@ -2293,6 +2303,8 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         uint32 m_transform;
 
         AuraList m_modAuras[TOTAL_AURAS];
+        uint32 m_modAuraTypeMask[(TOTAL_AURAS + 31) / 32];  // bit set for aura types with not empty m_modAuras list
+        uint32 m_modAuraCompactMask[(TOTAL_AURAS + 31) / 32];  // bit set for m_modAuras lists with removed entries
         float m_auraModifiersGroup[UNIT_MOD_END][MODIFIER_TYPE_END];
         float m_weaponDamage[MAX_ATTACK][2];
         bool m_canModifyStats;
@@ -2324,6 +2336,9 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
 
     private:
         void CleanupDeletedHolders(bool force = false);
+        void AddToModAuraList(AuraType type, AuraPair const& pair);
+        void RemoveFromModAuraList(AuraType type, AuraPair const& pair);
+        void CompactModAuraLists();
         void UpdateSplineMovement(uint32 t_diff);
 
         // player or player's pet
@@ -26,7 +26,80 @@
 #include "ObjectGuid.h"
 #include <zlib/zlib.h>
 
-UpdateData::UpdateData() : m_blockCount(0)
+UpdateDataCompressor::UpdateDataCompressor() : m_stream(NULL), m_level(0)
+{
+}
+
+UpdateDataCompressor::~UpdateDataCompressor()
+{
+    if (m_stream)
+    {
+        deflateEnd(m_stream);
+        delete m_stream;
+    }
+}
+
+bool UpdateDataCompressor::Init()
+{
+    int level = sWorld.getConfig(CONFIG_UINT32_COMPRESSION);
+
+    if (m_stream)
+    {
+        // compression level can be changed at config reload
+        if (m_level == level)
+            return deflateReset(m_stream) == Z_OK;
+
+        deflateEnd(m_stream);
+    }
+    else
+        m_stream = new z_stream;
+
+    m_stream->zalloc = (alloc_func)0;
+    m_stream->zfree = (free_func)0;
+    m_stream->opaque = (voidpf)0;
+
+    // default Z_BEST_SPEED (1)
+    int z_res = deflateInit(m_stream, level);
+    if (z_res != Z_OK)
+    {
+        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)",z_res,zError(z_res));
+        delete m_stream;
+        m_stream = NULL;
+        return false;
+    }
+
+    m_level = level;
+    return true;
+}
+
+void UpdateDataCompressor::Compress(void* dst, uint32 *dst_size, void* src, int src_size)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    if (!Init())
+    {
+        *dst_size = 0;
+        return;
+    }
+
+    m_stream->next_out = (Bytef*)dst;
+    m_stream->avail_out = *dst_size;
+    m_stream->next_in = (Bytef*)src;
+    m_stream->avail_in = (uInt)src_size;
+
+    // whole packet is available at once, so finish it in a single call
+    int z_res = deflate(m_stream, Z_FINISH);
+    if (z_res != Z_STREAM_END)
+    {
+        sLog.outError("Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)",z_res,zError(z_res));
+        *dst_size = 0;
+        return;
+    }
+
+    *dst_size = m_stream->total_out;
+}
+
+UpdateData::UpdateData() : m_blockCount(0), m_idleCount(0)
 {
 }
 
@@ -42,10 +115,21 @@ void UpdateData::AddOutOfRangeGUID(ObjectGuid const &guid)
 
 void UpdateData::AddUpdateBlock(const ByteBuffer &block)
 {
+    // most update data collects several blocks, skip the first few regrowths
+    if (!m_blockCount)
+        m_data.reserve(std::max(block.wpos(), size_t(UPDATE_DATA_INITIAL_RESERVE)));
+
     m_data.append(block);
     ++m_blockCount;
 }
 
+size_t UpdateData::AddSharedUpdateBlock(const ByteBuffer &block)
+{
+    size_t pos = m_data.wpos();
+    AddUpdateBlock(block);
+    return pos;
+}
+
 void UpdateData::Compress(void* dst, uint32 *dst_size, void* src, int src_size)
 {
     z_stream c_stream;
@@ -102,7 +186,7 @@ void UpdateData::Compress(void* dst, uint32 *dst_size, void* src, int src_size)
     *dst_size = c_stream.total_out;
 }
 
-bool UpdateData::BuildPacket(WorldPacket *packet)
+bool UpdateData::BuildPacket(WorldPacket *packet, UpdateDataCompressor* compressor /*= NULL*/)
 {
     MANGOS_ASSERT(packet->empty());                         // shouldn't happen
 
@@ -129,7 +213,10 @@ bool UpdateData::BuildPacket(WorldPacket *packet)
         packet->resize( destsize + sizeof(uint32) );
 
         packet->put<uint32>(0, pSize);
-        Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, (void*)buf.contents(), pSize);
+        if (compressor)
+            compressor->Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, (void*)buf.contents(), pSize);
+        else
+            Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, (void*)buf.contents(), pSize);
         if (destsize == 0)
             return false;
 
@@ -138,6 +225,7 @@ bool UpdateData::BuildPacket(WorldPacket *packet)
     }
     else                                                    // send small packets without compression
     {
+        packet->reserve( pSize );
         packet->append( buf );
         packet->SetOpcode( SMSG_UPDATE_OBJECT );
     }
@@ -22,7 +22,13 @@
 #include "ByteBuffer.h"
 #include "ObjectGuid.h"
 
+#include <ace/Thread_Mutex.h>
+
 class WorldPacket;
+struct z_stream_s;
+
+#define UPDATE_DATA_INITIAL_RESERVE 512
+#define UPDATE_DATA_MAX_IDLE_SENDS  30                      // map ticks a receiver buffer is kept without updates
 
 enum ObjectUpdateType
 {
@@ -49,6 +55,31 @@ enum ObjectUpdateFlags
     UPDATEFLAG_ROTATION             = 0x0200
 };
 
+/**
+ * Deflate stream kept alive between update packets of one receiver.
+ * Stream is initialized on first use and only reset (deflateReset) for
+ * next packets, so zlib internal state is not allocated again per packet.
+ */
+class UpdateDataCompressor
+{
+    public:
+        UpdateDataCompressor();
+        ~UpdateDataCompressor();
+
+        // compress src into dst, dst_size is in/out; 0 in dst_size at fail
+        void Compress(void* dst, uint32* dst_size, void* src, int src_size);
+
+    private:
+        UpdateDataCompressor(UpdateDataCompressor const&);
+        UpdateDataCompressor& operator=(UpdateDataCompressor const&);
+
+        bool Init();
+
+        z_stream_s* m_stream;
+        int m_level;
+        ACE_Thread_Mutex m_lock;                            // packets for one session can be built from different map threads
+};
+
 class UpdateData
 {
     public:
@@ -57,17 +88,26 @@ class UpdateData
         void AddOutOfRangeGUID(GuidSet& guids);
         void AddOutOfRangeGUID(ObjectGuid const &guid);
         void AddUpdateBlock(const ByteBuffer &block);
-        bool BuildPacket(WorldPacket *packet);
+        // append block and return its start position, for later patching of shared blocks
+        size_t AddSharedUpdateBlock(const ByteBuffer &block);
+        void PutUpdateBlockValue(size_t pos, uint32 value) { m_data.put<uint32>(pos, value); }
+        bool BuildPacket(WorldPacket *packet, UpdateDataCompressor* compressor = NULL);
         bool HasData() { return m_blockCount > 0 || !m_outOfRangeGUIDs.empty(); }
         void Clear();
 
+        // consecutive sends without data, used by owner to release buffers of idle receivers
+        uint32 IncreaseIdleCount() { return ++m_idleCount; }
+        void ResetIdleCount() { m_idleCount = 0; }
+
         GuidSet const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
+        ByteBuffer const& GetBlocksData() const { return m_data; }
 
     protected:
         uint32 m_blockCount;
+        uint32 m_idleCount;
         GuidSet m_outOfRangeGUIDs;
         ByteBuffer m_data;
 
-        void Compress(void* dst, uint32 *dst_size, void* src, int src_size);
+        static void Compress(void* dst, uint32 *dst_size, void* src, int src_size);
 };
 #endif
@@ -19,107 +19,172 @@
 #ifndef __UPDATEMASK_H
 #define __UPDATEMASK_H
 
+#include "Common.h"
 #include "UpdateFields.h"
 #include "Errors.h"
 
-class UpdateMask
+#if COMPILER == COMPILER_MICROSOFT
+#  include <intrin.h>
+#endif
+
+// index of lowest set bit, value must not be 0
+inline uint32 UpdateMaskLowestBit(uint32 value)
+{
+#if COMPILER == COMPILER_GNU
+    return __builtin_ctz(value);
+#elif COMPILER == COMPILER_MICROSOFT
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return index;
+#else
+    uint32 index = 0;
+    while (!(value & 1))
+    {
+        value >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/**
+ * Bit mask of update fields with inline storage for up to MAX_COUNT fields,
+ * so masks can live on stack without heap allocation. Bits are kept in 32 bit
+ * blocks, block operations only touch blocks used by current count.
+ */
+template<uint32 MAX_COUNT>
+class UpdateMaskBase
 {
     public:
-        UpdateMask() : m_Count(0), m_Blocks(0), m_UpdateMask(0) {}
-        UpdateMask(UpdateMask const& mask) : m_UpdateMask(0) { *this = mask; }
+        enum { MAX_BLOCKS = (MAX_COUNT + 31) / 32 };
 
-        ~UpdateMask()
-        {
-            if (m_UpdateMask)
-                delete[] m_UpdateMask;
-        }
+        UpdateMaskBase() : m_Count(0), m_Blocks(0) {}
+        UpdateMaskBase(UpdateMaskBase const& mask) { *this = mask; }
 
         void SetBit(uint32 index)
         {
-            ((uint8*)m_UpdateMask)[index >> 3] |= 1 << (index & 0x7);
+            m_UpdateMask[index >> 5] |= uint32(1) << (index & 31);
         }
 
         void UnsetBit(uint32 index)
         {
-            ((uint8*)m_UpdateMask)[index >> 3] &= (0xff ^ (1 << (index & 0x7)));
+            m_UpdateMask[index >> 5] &= ~(uint32(1) << (index & 31));
         }
 
         bool GetBit(uint32 index) const
         {
-            return (((uint8*)m_UpdateMask)[index >> 3] & (1 << (index & 0x7))) != 0;
+            return (m_UpdateMask[index >> 5] & (uint32(1) << (index & 31))) != 0;
+        }
+
+        // first set bit at index or after it, GetCount() if no more bits set
+        uint32 GetNextSetBit(uint32 index) const
+        {
+            if (index >= m_Count)
+                return m_Count;
+
+            uint32 block = index >> 5;
+            uint32 bits = m_UpdateMask[block] & (uint32(0xFFFFFFFF) << (index & 31));
+
+            while (!bits)
+            {
+                if (++block >= m_Blocks)
+                    return m_Count;
+                bits = m_UpdateMask[block];
+            }
+
+            return (block << 5) + UpdateMaskLowestBit(bits);
         }
 
         uint32 GetBlockCount() const { return m_Blocks; }
         uint32 GetLength() const { return m_Blocks << 2; }
         uint32 GetCount() const { return m_Count; }
+        uint32 GetBlock(uint32 block) const { return m_UpdateMask[block]; }
         uint8* GetMask() { return (uint8*)m_UpdateMask; }
 
         void SetCount(uint32 valuesCount)
         {
-            if (m_UpdateMask)
-                delete[] m_UpdateMask;
+            MANGOS_ASSERT(valuesCount <= MAX_COUNT);
 
             m_Count = valuesCount;
             m_Blocks = (valuesCount + 31) / 32;
 
-            m_UpdateMask = new uint32[m_Blocks];
-            memset(m_UpdateMask, 0, m_Blocks << 2);
+            Clear();
         }
 
         void Clear()
         {
-            if (m_UpdateMask)
-                memset(m_UpdateMask, 0, m_Blocks << 2);
+            memset(m_UpdateMask, 0, m_Blocks << 2);
         }
 
-        UpdateMask& operator = (UpdateMask const& mask)
+        UpdateMaskBase& operator = (UpdateMaskBase const& mask)
         {
-            SetCount(mask.m_Count);
+            m_Count = mask.m_Count;
+            m_Blocks = mask.m_Blocks;
             memcpy(m_UpdateMask, mask.m_UpdateMask, m_Blocks << 2);
 
             return *this;
         }
 
-        void operator &= (UpdateMask const& mask)
+        // masks of other count/capacity are accepted, bits above own count are dropped
+        template<uint32 N>
+        void operator &= (UpdateMaskBase<N> const& mask)
         {
-            MANGOS_ASSERT(mask.m_Count <= m_Count);
-            for (uint32 i = 0; i < m_Blocks; ++i)
-                m_UpdateMask[i] &= mask.m_UpdateMask[i];
+            uint32 blocks = std::min(m_Blocks, mask.GetBlockCount());
+            for (uint32 i = 0; i < blocks; ++i)
+                m_UpdateMask[i] &= mask.GetBlock(i);
+            for (uint32 i = blocks; i < m_Blocks; ++i)
+                m_UpdateMask[i] = 0;
         }
 
-        void operator |= (UpdateMask const& mask)
+        template<uint32 N>
+        void operator |= (UpdateMaskBase<N> const& mask)
         {
-            MANGOS_ASSERT(mask.m_Count <= m_Count);
-            for (uint32 i = 0; i < m_Blocks; ++i)
-                m_UpdateMask[i] |= mask.m_UpdateMask[i];
+            uint32 blocks = std::min(m_Blocks, mask.GetBlockCount());
+            for (uint32 i = 0; i < blocks; ++i)
+                m_UpdateMask[i] |= mask.GetBlock(i);
+            ClearUnusedBits();
         }
 
-        UpdateMask operator & (UpdateMask const& mask) const
+        // this |= (blocks & filter), blocks must have at least GetBlockCount() elements
+        template<uint32 N>
+        void OrMasked(uint32 const* blocks, UpdateMaskBase<N> const& filter)
         {
-            MANGOS_ASSERT(mask.m_Count <= m_Count);
+            uint32 count = std::min(m_Blocks, filter.GetBlockCount());
+            for (uint32 i = 0; i < count; ++i)
+                m_UpdateMask[i] |= blocks[i] & filter.GetBlock(i);
+            ClearUnusedBits();
+        }
 
-            UpdateMask newmask;
-            newmask = *this;
+        UpdateMaskBase operator & (UpdateMaskBase const& mask) const
+        {
+            UpdateMaskBase newmask = *this;
             newmask &= mask;
 
             return newmask;
         }
 
-        UpdateMask operator | (UpdateMask const& mask) const
+        UpdateMaskBase operator | (UpdateMaskBase const& mask) const
         {
-            MANGOS_ASSERT(mask.m_Count <= m_Count);
-
-            UpdateMask newmask;
-            newmask = *this;
+            UpdateMaskBase newmask = *this;
             newmask |= mask;
 
             return newmask;
         }
 
     private:
+        // last block can contain bits of fields not existing for this count
+        void ClearUnusedBits()
+        {
+            if (m_Count & 31)
+                m_UpdateMask[m_Blocks - 1] &= (uint32(1) << (m_Count & 31)) - 1;
+        }
+
         uint32 m_Count;
         uint32 m_Blocks;
-        uint32 *m_UpdateMask;
+        uint32 m_UpdateMask[MAX_BLOCKS];
 };
 
+// player has the largest fields set, so this mask fits fields of any object type
+typedef UpdateMaskBase<PLAYER_END> UpdateMask;
+
 #endif
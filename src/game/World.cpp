@@ -44,6 +44,7 @@
 #include "MassMailMgr.h"
 #include "LootMgr.h"
 #include "ItemEnchantmentMgr.h"
+#include "WorldLoadGraph.h"
 #include "MapManager.h"
 #include "ScriptMgr.h"
 #include "CreatureAIRegistry.h"
@@ -57,6 +58,7 @@
 #include "GameEventMgr.h"
 #include "PoolManager.h"
 #include "Database/DatabaseImpl.h"
+#include "Database/SQLStorage.h"
 #include "GridNotifiersImpl.h"
 #include "CellImpl.h"
 #include "MapPersistentStateMgr.h"
@@ -149,6 +151,7 @@ void World::CleanupsBeforeStop()
 {
     KickAll();                                       // save and kick all players
     UpdateSessions(1);                               // real players unload required UpdateSessions call
+    m_sessionUpdater.deactivate();
     sBattleGroundMgr.DeleteAllBattleGrounds();       // unload battleground templates before different singletons destroyed
 }
 
@@ -566,6 +569,7 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_ADDON_CHANNEL, "AddonChannel", true);
     setConfig(CONFIG_BOOL_CLEAN_CHARACTER_DB, "CleanCharacterDB", true);
     setConfig(CONFIG_BOOL_GRID_UNLOAD, "GridUnload", true);
+    setConfig(CONFIG_BOOL_GRID_MAP_MEMORY_MAPPED, "GridMap.MemoryMapped", true);
     setConfig(CONFIG_UINT32_INTERVAL_SAVE, "PlayerSave.Interval", 15 * MINUTE * IN_MILLISECONDS);
     setConfigMinMax(CONFIG_UINT32_MIN_LEVEL_STAT_SAVE, "PlayerSave.Stats.MinLevel", 0, 0, MAX_LEVEL);
     setConfig(CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT, "PlayerSave.Stats.SaveOnlyOnLogout", true);
@@ -576,6 +580,13 @@ void World::LoadConfigSettings(bool reload)
 
     setConfig(CONFIG_UINT32_NUMTHREADS, "MapUpdate.Threads", 3);
     setConfig(CONFIG_BOOL_THREADS_DYNAMIC,"MapUpdate.DynamicThreadsCount", false);
+    setConfig(CONFIG_BOOL_MAPUPDATE_PARALLEL_ISLANDS, "MapUpdate.ParallelIslands", false);
+
+    if (configNoReload(reload, CONFIG_UINT32_SESSION_UPDATE_THREADS, "SessionUpdate.Threads", 0))
+        setConfigMinMax(CONFIG_UINT32_SESSION_UPDATE_THREADS, "SessionUpdate.Threads", 0, 0, 16);
+
+    if (configNoReload(reload, CONFIG_UINT32_WORLD_LOAD_THREADS, "WorldLoad.Threads", 0))
+        setConfigMinMax(CONFIG_UINT32_WORLD_LOAD_THREADS, "WorldLoad.Threads", 0, 0, 16);
 
 #ifdef MANGOSR2_SINGLE_THREAD
     if (getConfig(CONFIG_UINT32_NUMTHREADS) > 1)
@@ -583,6 +594,18 @@ void World::LoadConfigSettings(bool reload)
         sLog.outError(" Your OS (%s) not support set MapUpdate.Threads > 1! Resetted to 1", MANGOSR2_SINGLE_THREAD);
         setConfig(CONFIG_UINT32_NUMTHREADS, "fakeString", 1);
     }
+
+    if (getConfig(CONFIG_UINT32_SESSION_UPDATE_THREADS) > 0)
+    {
+        sLog.outError(" Your OS (%s) not support set SessionUpdate.Threads > 0! Resetted to 0", MANGOSR2_SINGLE_THREAD);
+        setConfig(CONFIG_UINT32_SESSION_UPDATE_THREADS, "fakeString", 0);
+    }
+
+    if (getConfig(CONFIG_UINT32_WORLD_LOAD_THREADS) > 0)
+    {
+        sLog.outError(" Your OS (%s) not support set WorldLoad.Threads > 0! Resetted to 0", MANGOSR2_SINGLE_THREAD);
+        setConfig(CONFIG_UINT32_WORLD_LOAD_THREADS, "fakeString", 0);
+    }
 #endif
 
     setConfigMinMax(CONFIG_FLOAT_LOADBALANCE_HIGHVALUE, "MapUpdate.LoadBalanceHighValue", 0.8f, 0.5f, 1.0f);
@@ -1022,6 +1045,15 @@ void World::LoadConfigSettings(bool reload)
         sLog.outString("Using DataDir %s", m_dataPath.c_str());
     }
 
+    ///- Read the world data snapshot directory, empty string disables snapshots
+    std::string snapshotPath = sConfig.GetStringDefault("WorldDataSnapshotDir", "");
+
+    // normalize dir path to path/ or path\ form
+    if (!snapshotPath.empty() && snapshotPath.at(snapshotPath.length()-1) != '/' && snapshotPath.at(snapshotPath.length()-1) != '\\')
+        snapshotPath.append("/");
+
+    SQLStorageSnapshot::SetDirectory(snapshotPath);
+
     setConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK, "vmap.enableIndoorCheck", true);
     bool enableLOS = true;
     bool enableHeight = true;
@@ -1040,6 +1072,11 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_MMAP_ENABLED, "mmap.enabled", true);
     std::string ignoreMapIds = sConfig.GetStringDefault("mmap.ignoreMapIds", "");
     MMAP::MMapFactory::preventPathfindingOnMaps(ignoreMapIds.c_str());
+    setConfig(CONFIG_UINT32_MMAP_PATH_CACHE_SIZE, "mmap.pathCacheSize", 256);
+    setConfig(CONFIG_UINT32_MMAP_ASYNC_THREADS, "mmap.asyncThreads", 0);
+#ifdef MANGOSR2_SINGLE_THREAD
+    setConfig(CONFIG_UINT32_MMAP_ASYNC_THREADS, "fakeString", 0);
+#endif
     sLog.outString("WORLD: mmap pathfinding %sabled", getConfig(CONFIG_BOOL_MMAP_ENABLED) ? "en" : "dis");
 
     // reset duel system
@@ -1121,6 +1158,79 @@ void World::LoadConfigSettings(bool reload)
 
 extern void LoadGameObjectModelList();
 
+// Stages of World::SetInitialWorldSettings() run by WorldLoadGraph
+static void LoadPageTextsStage()            { sLog.outString("Loading Page Texts..."); sObjectMgr.LoadPageTexts(); }
+static void LoadGameobjectInfoStage()       { sLog.outString("Loading Game Object Templates..."); sObjectMgr.LoadGameobjectInfo(); }
+static void LoadSpellChainsStage()          { sLog.outString("Loading Spell Chain Data..."); sSpellMgr.LoadSpellChains(); }
+static void LoadSpellElixirsStage()         { sLog.outString("Loading Spell Elixir types..."); sSpellMgr.LoadSpellElixirs(); }
+static void LoadSpellLearnSkillsStage()     { sLog.outString("Loading Spell Learn Skills..."); sSpellMgr.LoadSpellLearnSkills(); }
+static void LoadSpellLearnSpellsStage()     { sLog.outString("Loading Spell Learn Spells..."); sSpellMgr.LoadSpellLearnSpells(); }
+static void LoadSpellProcEventsStage()      { sLog.outString("Loading Spell Proc Event conditions..."); sSpellMgr.LoadSpellProcEvents(); }
+static void LoadSpellBonusesStage()         { sLog.outString("Loading Spell Bonus Data..."); sSpellMgr.LoadSpellBonuses(); }
+static void LoadSpellProcItemEnchantStage() { sLog.outString("Loading Spell Proc Item Enchant..."); sSpellMgr.LoadSpellProcItemEnchant(); }
+static void LoadSpellLinkedStage()          { sLog.outString("Loading Spell Linked definitions..."); sSpellMgr.LoadSpellLinked(); }
+static void LoadSpellThreatsStage()         { sLog.outString("Loading Aggro Spells Definitions..."); sSpellMgr.LoadSpellThreats(); }
+static void LoadGossipTextStage()           { sLog.outString("Loading NPC Texts..."); sObjectMgr.LoadGossipText(); }
+static void LoadRandomEnchantmentsStage()   { sLog.outString("Loading Item Random Enchantments Table..."); LoadRandomEnchantmentsTable(); }
+static void LoadItemPrototypesStage()       { sLog.outString("Loading Items..."); sObjectMgr.LoadItemPrototypes(); }
+static void LoadItemConvertsStage()         { sLog.outString("Loading Item converts..."); sObjectMgr.LoadItemConverts(); }
+static void LoadItemExpireConvertsStage()   { sLog.outString("Loading Item expire converts..."); sObjectMgr.LoadItemExpireConverts(); }
+static void LoadCreatureModelInfoStage()    { sLog.outString("Loading Creature Model Based Info Data..."); sObjectMgr.LoadCreatureModelInfo(); }
+static void LoadEquipmentTemplatesStage()   { sLog.outString("Loading Equipment templates..."); sObjectMgr.LoadEquipmentTemplates(); }
+static void LoadCreatureSpellsStage()       { sLog.outString("Loading Creature spells..."); sObjectMgr.LoadCreatureSpells(); }
+static void LoadCreatureTemplatesStage()    { sLog.outString("Loading Creature templates..."); sObjectMgr.LoadCreatureTemplates(); }
+static void LoadCreatureModelRaceStage()    { sLog.outString("Loading Creature Model for race..."); sObjectMgr.LoadCreatureModelRace(); }
+static void LoadSpellScriptTargetStage()    { sLog.outString("Loading SpellsScriptTarget..."); sSpellMgr.LoadSpellScriptTarget(); }
+static void LoadVehicleAccessoryStage()     { sLog.outString("Loading Vehicle Accessory..."); sObjectMgr.LoadVehicleAccessory(); }
+static void LoadItemRequiredTargetStage()   { sLog.outString("Loading ItemRequiredTarget..."); sObjectMgr.LoadItemRequiredTarget(); }
+static void LoadReputationRewardRateStage() { sLog.outString("Loading Reputation Reward Rates..."); sObjectMgr.LoadReputationRewardRate(); }
+static void LoadReputationOnKillStage()     { sLog.outString("Loading Creature Reputation OnKill Data..."); sObjectMgr.LoadReputationOnKill(); }
+static void LoadReputationSpilloverStage()  { sLog.outString("Loading Reputation Spillover Data..."); sObjectMgr.LoadReputationSpilloverTemplate(); }
+static void LoadPointsOfInterestStage()     { sLog.outString("Loading Points Of Interest Data..."); sObjectMgr.LoadPointsOfInterest(); }
+
+/**
+ * Declares template and spell data loading. Stages only fill their own containers and read data of the stages
+ * they depend on or of the DBC stores and tables loaded before. ObjectMgr template tables are kept chained in
+ * their old order, because their consistency checks cross reference each other.
+ */
+static void AddTemplateLoadStages(WorldLoadGraph& graph)
+{
+    uint32 pageTexts     = graph.AddStage("PageTexts", &LoadPageTextsStage);
+    uint32 goInfo        = graph.AddStage("GameobjectInfo", &LoadGameobjectInfoStage, pageTexts);
+
+    // spell data stages read spell chains and fill separate SpellMgr maps
+    uint32 spellChains   = graph.AddStage("SpellChains", &LoadSpellChainsStage);
+    graph.AddStage("SpellElixirs", &LoadSpellElixirsStage, spellChains);
+    graph.AddStage("SpellLearnSkills", &LoadSpellLearnSkillsStage, spellChains);
+    graph.AddStage("SpellLearnSpells", &LoadSpellLearnSpellsStage, spellChains);
+    graph.AddStage("SpellProcEvents", &LoadSpellProcEventsStage, spellChains);
+    graph.AddStage("SpellBonuses", &LoadSpellBonusesStage, spellChains);
+    graph.AddStage("SpellProcItemEnchant", &LoadSpellProcItemEnchantStage, spellChains);
+    graph.AddStage("SpellLinked", &LoadSpellLinkedStage, spellChains);
+    graph.AddStage("SpellThreats", &LoadSpellThreatsStage, spellChains);
+
+    graph.AddStage("GossipText", &LoadGossipTextStage);
+
+    uint32 randomEnchant = graph.AddStage("RandomEnchantments", &LoadRandomEnchantmentsStage);
+    uint32 items         = graph.AddStage("ItemPrototypes", &LoadItemPrototypesStage, goInfo, randomEnchant);
+    uint32 itemConverts  = graph.AddStage("ItemConverts", &LoadItemConvertsStage, items);
+    uint32 itemExpire    = graph.AddStage("ItemExpireConverts", &LoadItemExpireConvertsStage, itemConverts);
+    uint32 modelInfo     = graph.AddStage("CreatureModelInfo", &LoadCreatureModelInfoStage, itemExpire);
+    uint32 equipment     = graph.AddStage("EquipmentTemplates", &LoadEquipmentTemplatesStage, modelInfo);
+    // FIXME! currently spells must be loaded _before_ templates for correct detection.
+    uint32 creatureSpell = graph.AddStage("CreatureSpells", &LoadCreatureSpellsStage, equipment);
+    uint32 creatures     = graph.AddStage("CreatureTemplates", &LoadCreatureTemplatesStage, creatureSpell);
+    uint32 modelRace     = graph.AddStage("CreatureModelRace", &LoadCreatureModelRaceStage, creatures);
+    graph.AddStage("SpellScriptTarget", &LoadSpellScriptTargetStage, creatures, goInfo);
+    uint32 vehicle       = graph.AddStage("VehicleAccessory", &LoadVehicleAccessoryStage, modelRace);
+    graph.AddStage("ItemRequiredTarget", &LoadItemRequiredTargetStage, vehicle);
+
+    graph.AddStage("ReputationRewardRate", &LoadReputationRewardRateStage);
+    graph.AddStage("ReputationOnKill", &LoadReputationOnKillStage, creatures);
+    graph.AddStage("ReputationSpillover", &LoadReputationSpilloverStage);
+    graph.AddStage("PointsOfInterest", &LoadPointsOfInterestStage);
+}
+
 /// Initialize the World
 void World::SetInitialWorldSettings()
 {
@@ -1221,90 +1331,11 @@ void World::SetInitialWorldSettings()
     sObjectMgr.SetHighestGuids();                           // must be after PackInstances() and PackGroupIds()
     sLog.outString();
 
-    sLog.outString( "Loading Page Texts..." );
-    sObjectMgr.LoadPageTexts();
-
-    sLog.outString( "Loading Game Object Templates..." );   // must be after LoadPageTexts
-    sObjectMgr.LoadGameobjectInfo();
-
-    sLog.outString( "Loading Spell Chain Data..." );
-    sSpellMgr.LoadSpellChains();
-
-    sLog.outString( "Loading Spell Elixir types..." );
-    sSpellMgr.LoadSpellElixirs();
-
-    sLog.outString( "Loading Spell Learn Skills..." );
-    sSpellMgr.LoadSpellLearnSkills();                       // must be after LoadSpellChains
-
-    sLog.outString( "Loading Spell Learn Spells..." );
-    sSpellMgr.LoadSpellLearnSpells();
-
-    sLog.outString( "Loading Spell Proc Event conditions..." );
-    sSpellMgr.LoadSpellProcEvents();
-
-    sLog.outString( "Loading Spell Bonus Data..." );
-    sSpellMgr.LoadSpellBonuses();                           // must be after LoadSpellChains
-
-    sLog.outString( "Loading Spell Proc Item Enchant..." );
-    sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
-
-    sLog.outString( "Loading Spell Linked definitions..." );
-    sSpellMgr.LoadSpellLinked();                            // must be after LoadSpellChains
-
-    sLog.outString( "Loading Aggro Spells Definitions...");
-    sSpellMgr.LoadSpellThreats();
-
-    sLog.outString( "Loading NPC Texts..." );
-    sObjectMgr.LoadGossipText();
-
-    sLog.outString( "Loading Item Random Enchantments Table..." );
-    LoadRandomEnchantmentsTable();
-
-    sLog.outString("Loading Items...");                     // must be after LoadRandomEnchantmentsTable and LoadPageTexts
-    sObjectMgr.LoadItemPrototypes();
-
-    sLog.outString("Loading Item converts...");             // must be after LoadItemPrototypes
-    sObjectMgr.LoadItemConverts();
-
-    sLog.outString("Loading Item expire converts...");      // must be after LoadItemPrototypes
-    sObjectMgr.LoadItemExpireConverts();
-
-    sLog.outString( "Loading Creature Model Based Info Data..." );
-    sObjectMgr.LoadCreatureModelInfo();
-
-    sLog.outString( "Loading Equipment templates...");
-    sObjectMgr.LoadEquipmentTemplates();
-
-    // FIXME! currently spells must be loaded _before_ templates for correct detection.
-    sLog.outString( "Loading Creature spells..." );
-    sObjectMgr.LoadCreatureSpells();
-
-    sLog.outString( "Loading Creature templates..." );
-    sObjectMgr.LoadCreatureTemplates();
-
-    sLog.outString( "Loading Creature Model for race..." ); // must be after creature templates
-    sObjectMgr.LoadCreatureModelRace();
-
-    sLog.outString( "Loading SpellsScriptTarget...");
-    sSpellMgr.LoadSpellScriptTarget();                      // must be after LoadCreatureTemplates and LoadGameobjectInfo
-
-    sLog.outString("Loading Vehicle Accessory...");         // must be after creature templates
-    sObjectMgr.LoadVehicleAccessory();
-
-    sLog.outString( "Loading ItemRequiredTarget...");
-    sObjectMgr.LoadItemRequiredTarget();
-
-    sLog.outString( "Loading Reputation Reward Rates...");
-    sObjectMgr.LoadReputationRewardRate();
-
-    sLog.outString( "Loading Creature Reputation OnKill Data..." );
-    sObjectMgr.LoadReputationOnKill();
-
-    sLog.outString( "Loading Reputation Spillover Data..." );
-    sObjectMgr.LoadReputationSpilloverTemplate();
-
-    sLog.outString( "Loading Points Of Interest Data..." );
-    sObjectMgr.LoadPointsOfInterest();
+    ///- Load templates and spell data, independent stages are loaded in parallel with WorldLoad.Threads
+    WorldLoadGraph loadGraph;
+    AddTemplateLoadStages(loadGraph);
+    loadGraph.Execute(getConfig(CONFIG_UINT32_WORLD_LOAD_THREADS));
+    loadGraph.LogReport();
 
     sLog.outString( "Loading Creature Data..." );
     sObjectMgr.LoadCreatures();
@@ -1630,6 +1661,15 @@ void World::SetInitialWorldSettings()
     sLog.outString( "Starting Map System" );
     sMapMgr.Initialize();
 
+    ///- Start threads for character screen traffic
+    if (uint32 threads = getConfig(CONFIG_UINT32_SESSION_UPDATE_THREADS))
+    {
+        if (m_sessionUpdater.activate(threads) == -1)
+            sLog.outError("World: can't start %u session update threads, character screen packets processed in world thread", threads);
+        else
+            sLog.outString("World: started %u session update threads", threads);
+    }
+
     ///- Initialize Battlegrounds
     sLog.outString( "Starting BattleGround System" );
     sBattleGroundMgr.CreateInitialBattleGrounds();
@@ -2295,6 +2335,10 @@ void World::UpdateSessions(uint32 diff)
     while(addSessQueue.next(sess))
         AddSession_ (sess);
 
+    ///- Process thread-safe character screen packets in parallel first
+    if (m_sessionUpdater.activated())
+        UpdateAuthedSessions();
+
     ///- Then send an update signal to remaining ones
     for (SessionMap::iterator itr = m_sessions.begin(), next; itr != m_sessions.end(); itr = next)
     {
@@ -2313,6 +2357,27 @@ void World::UpdateSessions(uint32 diff)
     }
 }
 
+void World::UpdateAuthedSessions()
+{
+    m_authedSessionTasks.clear();
+    for (SessionMap::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+    {
+        WorldSession* pSession = itr->second;
+        if (!pSession->GetPlayer() && !pSession->PlayerLoading() && pSession->HasPendingPackets())
+            m_authedSessionTasks.push_back(AuthedSessionUpdateTask(pSession));
+    }
+
+    // not worth a thread switch
+    if (m_authedSessionTasks.size() < 2)
+        return;
+
+    m_authedSessionTaskList.clear();
+    for (std::vector<AuthedSessionUpdateTask>::iterator itr = m_authedSessionTasks.begin(); itr != m_authedSessionTasks.end(); ++itr)
+        m_authedSessionTaskList.push_back(&*itr);
+
+    m_sessionUpdater.execute(m_authedSessionTaskList);
+}
+
 // This handles the issued and queued CLI/RA commands
 void World::ProcessCliCommands()
 {
@@ -30,6 +30,7 @@
 #include "SharedDefines.h"
 #include "ObjectLock.h"
 #include "Util.h"
+#include "SessionUpdater.h"
 
 #include <map>
 #include <set>
@@ -199,6 +200,8 @@ enum eConfigUInt32Values
     CONFIG_UINT32_ANTICHEAT_GMLEVEL,
     CONFIG_UINT32_ANTICHEAT_ACTION_DELAY,
     CONFIG_UINT32_NUMTHREADS,
+    CONFIG_UINT32_SESSION_UPDATE_THREADS,
+    CONFIG_UINT32_WORLD_LOAD_THREADS,
     CONFIG_UINT32_RANDOM_BG_RESET_HOUR,
     CONFIG_UINT32_LOSERNOCHANGE,
     CONFIG_UINT32_LOSERHALFCHANGE,
@@ -222,6 +225,8 @@ enum eConfigUInt32Values
     CONFIG_UINT32_OBJECTLOADINGSPLITTER_ALLOWEDTIME,
     CONFIG_UINT32_POSITION_UPDATE_DELAY,
     CONFIG_UINT32_RESIST_CALC_METHOD,
+    CONFIG_UINT32_MMAP_PATH_CACHE_SIZE,
+    CONFIG_UINT32_MMAP_ASYNC_THREADS,
     CONFIG_UINT32_VALUE_COUNT
 };
 
@@ -323,6 +328,7 @@ enum eConfigFloatValues
 enum eConfigBoolValues
 {
     CONFIG_BOOL_GRID_UNLOAD = 0,
+    CONFIG_BOOL_GRID_MAP_MEMORY_MAPPED,
     CONFIG_BOOL_SAVE_RESPAWN_TIME_IMMEDIATELY,
     CONFIG_BOOL_OFFHAND_CHECK_AT_TALENTS_RESET,
     CONFIG_BOOL_ALLOW_TWO_SIDE_ACCOUNTS,
@@ -402,6 +408,7 @@ enum eConfigBoolValues
     CONFIG_BOOL_ALLOW_HONOR_KILLS_TITLES,
     CONFIG_BOOL_PET_SAVE_ALL,
     CONFIG_BOOL_THREADS_DYNAMIC,
+    CONFIG_BOOL_MAPUPDATE_PARALLEL_ISLANDS,
     CONFIG_BOOL_VMSS_ENABLE,
     CONFIG_BOOL_VMSS_TRYSKIPFIRST,
     CONFIG_BOOL_PLAYERBOT_ALLOW_SUMMON_OPPOSITE_FACTION,
@@ -537,6 +544,7 @@ class World
         void UpdateMaxSessionCounters();
         uint32 GetActiveAndQueuedSessionCount() const { return m_sessions.size(); }
         uint32 GetActiveSessionCount() const { return m_sessions.size() - m_QueuedSessions.size(); }
+        SessionUpdater& GetSessionUpdater() { return m_sessionUpdater; }
         uint32 GetQueuedSessionCount() const { return m_QueuedSessions.size(); }
         /// Get the maximum number of parallel sessions on the server since last reboot
         uint32 GetMaxQueuedSessionCount() const { return m_maxQueuedSessionCount; }
@@ -778,6 +786,12 @@ class World
         void AddSession_(WorldSession* s);
         ACE_Based::LockedQueue<WorldSession*, ACE_Thread_Mutex> addSessQueue;
 
+        // character screen traffic of sessions without player
+        void UpdateAuthedSessions();
+        SessionUpdater m_sessionUpdater;
+        std::vector<AuthedSessionUpdateTask> m_authedSessionTasks;
+        SessionUpdateTaskList m_authedSessionTaskList;
+
         //used versions
         std::string m_DBVersion;
         std::string m_CreatureEventAIVersion;
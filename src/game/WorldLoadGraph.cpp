@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "WorldLoadGraph.h"
+#include "Timer.h"
+#include "Log.h"
+#include "ProgressBar.h"
+#include "Database/DatabaseEnv.h"
+#include <ace/Guard_T.h>
+
+const uint32 WorldLoadGraph::NO_STAGE;
+
+WorldLoadGraph::WorldLoadGraph() :
+    m_done(0), m_startTime(0), m_totalTime(0), m_workerCount(0), m_condition(m_mutex)
+{
+}
+
+uint32 WorldLoadGraph::AddStage(char const* name, WorldLoadFunc func, uint32 dep1 /*= NO_STAGE*/, uint32 dep2 /*= NO_STAGE*/, uint32 dep3 /*= NO_STAGE*/)
+{
+    uint32 id = m_stages.size();
+    m_stages.push_back(Stage(name, func));
+
+    if (dep1 != NO_STAGE)
+        AddDependency(id, dep1);
+    if (dep2 != NO_STAGE)
+        AddDependency(id, dep2);
+    if (dep3 != NO_STAGE)
+        AddDependency(id, dep3);
+
+    return id;
+}
+
+void WorldLoadGraph::AddDependency(uint32 stage, uint32 dependsOn)
+{
+    // declaration order is a valid execution order, so the graph can't have cycles
+    MANGOS_ASSERT(dependsOn < stage && stage < m_stages.size());
+
+    m_stages[stage].dependencies.push_back(dependsOn);
+    m_stages[dependsOn].dependents.push_back(stage);
+}
+
+bool WorldLoadGraph::RunNext(ACE_Guard<ACE_Thread_Mutex>& guard)
+{
+    if (m_ready.empty())
+        return false;
+
+    uint32 id = *m_ready.begin();
+    m_ready.erase(m_ready.begin());
+
+    Stage& stage = m_stages[id];
+    stage.startTime = WorldTimer::getMSTimeDiff(m_startTime, WorldTimer::getMSTime());
+
+    guard.release();
+    stage.func();
+    guard.acquire();
+
+    stage.duration = WorldTimer::getMSTimeDiff(m_startTime, WorldTimer::getMSTime()) - stage.startTime;
+
+    for (std::vector<uint32>::const_iterator itr = stage.dependents.begin(); itr != stage.dependents.end(); ++itr)
+        if (--m_stages[*itr].waitCount == 0)
+            m_ready.insert(*itr);
+
+    ++m_done;
+    m_condition.broadcast();
+    return true;
+}
+
+void WorldLoadGraph::Work()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(m_mutex);
+
+    while (m_done < m_stages.size())
+    {
+        if (!RunNext(guard))
+            m_condition.wait();
+    }
+}
+
+void WorldLoadGraph::Execute(size_t num_threads)
+{
+    if (m_stages.empty())
+        return;
+
+    m_startTime = WorldTimer::getMSTime();
+    m_done = 0;
+    m_ready.clear();
+
+    for (uint32 id = 0; id < m_stages.size(); ++id)
+    {
+        m_stages[id].waitCount = m_stages[id].dependencies.size();
+        if (!m_stages[id].waitCount)
+            m_ready.insert(id);
+    }
+
+    bool showProgress = BarGoLink::GetOutputState();
+
+    if (num_threads)
+    {
+        m_workerCount = 0;
+
+        // progress bars of parallel stages would overwrite each other,
+        // output state is a plain flag so it is changed only while no load thread runs
+        BarGoLink::SetOutputState(false);
+
+        if (ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, (int)num_threads) == -1)
+        {
+            sLog.outError("WorldLoadGraph: can't start %u load threads, loading in world thread", uint32(num_threads));
+            BarGoLink::SetOutputState(showProgress);
+            num_threads = 0;
+        }
+        else
+            WorldDatabase.SetThreadQueryConnection(0);
+    }
+
+    Work();
+
+    if (num_threads)
+    {
+        ACE_Task_Base::wait();
+        WorldDatabase.SetThreadQueryConnection(-1);
+        BarGoLink::SetOutputState(showProgress);
+    }
+
+    m_totalTime = WorldTimer::getMSTimeDiff(m_startTime, WorldTimer::getMSTime());
+}
+
+int WorldLoadGraph::svc()
+{
+    int index;
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+        index = ++m_workerCount;                            // connection 0 is used by the calling thread
+    }
+
+    WorldDatabase.ThreadStart();
+    WorldDatabase.SetThreadQueryConnection(index);
+
+    Work();
+
+    WorldDatabase.SetThreadQueryConnection(-1);
+    WorldDatabase.ThreadEnd();
+    return 0;
+}
+
+void WorldLoadGraph::LogReport() const
+{
+    if (m_stages.empty())
+        return;
+
+    // longest chain of dependent stages ending at each stage, dependencies always have lower ids
+    std::vector<uint32> pathTime(m_stages.size(), 0);
+    std::vector<uint32> pathPrev(m_stages.size(), NO_STAGE);
+    uint32 pathEnd = 0;
+    uint32 stageTimeSum = 0;
+
+    for (uint32 id = 0; id < m_stages.size(); ++id)
+    {
+        Stage const& stage = m_stages[id];
+
+        for (std::vector<uint32>::const_iterator itr = stage.dependencies.begin(); itr != stage.dependencies.end(); ++itr)
+        {
+            if (pathPrev[id] == NO_STAGE || pathTime[*itr] > pathTime[pathPrev[id]])
+                pathPrev[id] = *itr;
+        }
+
+        pathTime[id] = stage.duration + (pathPrev[id] != NO_STAGE ? pathTime[pathPrev[id]] : 0);
+        stageTimeSum += stage.duration;
+
+        if (pathTime[id] > pathTime[pathEnd])
+            pathEnd = id;
+    }
+
+    std::vector<bool> onPath(m_stages.size(), false);
+    for (uint32 id = pathEnd; id != NO_STAGE; id = pathPrev[id])
+        onPath[id] = true;
+
+    sLog.outString();
+    sLog.outString("World load stages: %u ms wall time, %u ms summed stage time, %u ms critical path",
+        m_totalTime, stageTimeSum, pathTime[pathEnd]);
+
+    for (uint32 id = 0; id < m_stages.size(); ++id)
+        sLog.outString("  %c %-32s start %6u ms, took %6u ms", onPath[id] ? '*' : ' ', m_stages[id].name, m_stages[id].startTime, m_stages[id].duration);
+
+    sLog.outString("  (* - stage on critical path)");
+    sLog.outString();
+}
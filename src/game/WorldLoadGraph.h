@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _WORLD_LOAD_GRAPH_H_INCLUDED
+#define _WORLD_LOAD_GRAPH_H_INCLUDED
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include "Common.h"
+
+typedef void (*WorldLoadFunc)();
+
+/**
+ * Startup load stages with declared dependencies.
+ *
+ * World::SetInitialWorldSettings() declares the stages in their sequential order, a stage can only depend on
+ * stages declared before it. Execute() starts a stage when all its dependencies are finished, ready stages are
+ * taken in declaration order, so without pool threads the stages run exactly in declaration order. Each pool
+ * thread binds its own WorldDatabase query connection, see Database::SetThreadQueryConnection.
+ */
+class WorldLoadGraph : protected ACE_Task_Base
+{
+    public:
+        static const uint32 NO_STAGE = 0xFFFFFFFF;
+
+        WorldLoadGraph();
+        virtual ~WorldLoadGraph() {}
+
+        // declares stage running func after up to three other stages, returns the stage id
+        uint32 AddStage(char const* name, WorldLoadFunc func, uint32 dep1 = NO_STAGE, uint32 dep2 = NO_STAGE, uint32 dep3 = NO_STAGE);
+
+        // declares additional dependency of stage
+        void AddDependency(uint32 stage, uint32 dependsOn);
+
+        // runs all stages, calling thread takes part and returns when all stages are done
+        void Execute(size_t num_threads);
+
+        // outputs wall time of every stage and the critical path of last Execute()
+        void LogReport() const;
+
+        virtual int svc();
+
+    private:
+        struct Stage
+        {
+            Stage(char const* _name, WorldLoadFunc _func) : name(_name), func(_func), waitCount(0), startTime(0), duration(0) {}
+
+            char const* name;
+            WorldLoadFunc func;
+            std::vector<uint32> dependencies;
+            std::vector<uint32> dependents;
+            uint32 waitCount;                                   // unfinished dependencies
+            uint32 startTime;                                   // ms since start of Execute()
+            uint32 duration;                                    // ms
+        };
+
+        // claims and runs first ready stage, false if none is ready; m_mutex must be held
+        bool RunNext(ACE_Guard<ACE_Thread_Mutex>& guard);
+
+        // runs stages until all are done
+        void Work();
+
+        std::vector<Stage> m_stages;
+        std::set<uint32> m_ready;                               // ordered by stage id = declaration order
+        uint32 m_done;
+        uint32 m_startTime;
+        uint32 m_totalTime;
+        int m_workerCount;                                      // pool threads started, for connection binding
+
+        ACE_Thread_Mutex m_mutex;
+        ACE_Condition_Thread_Mutex m_condition;                 // signaled when a stage finished
+};
+
+#endif //_WORLD_LOAD_GRAPH_H_INCLUDED
@@ -77,7 +77,7 @@ void WorldObjectEventProcessor::RenewEvents()
                     bool needInsert = true;
                     for (EventList::const_iterator i = m_events.begin(); i != m_events.end(); ++i)
                     {
-                        if (i->second->GetType() == WORLDOBJECT_EVENT_TYPE_UNIQUE)
+                        if ((*i)->GetType() == WORLDOBJECT_EVENT_TYPE_UNIQUE)
                         {
                             BasicEvent* event = m_queue.front().second;
                             delete event;
@@ -86,14 +86,14 @@ void WorldObjectEventProcessor::RenewEvents()
                         }
                     }
                     if (needInsert)
-                        m_events.insert(m_queue.front());
+                        InsertEvent(m_queue.front().second);
                     break;
                 }
                 case WORLDOBJECT_EVENT_TYPE_REPEATABLE:
                 case WORLDOBJECT_EVENT_TYPE_DEATH:
                 case WORLDOBJECT_EVENT_TYPE_COMMON:
                 default:
-                    m_events.insert(m_queue.front());
+                    InsertEvent(m_queue.front().second);
                     break;
             }
         }
@@ -22,6 +22,7 @@
 
 #include "WorldSocket.h"                                   // must be first to make ACE happy with ACE includes in it
 #include "Common.h"
+#include "SharedPayloadPacket.h"
 #include "Database/DatabaseEnv.h"
 #include "Log.h"
 #include "Opcodes.h"
@@ -51,7 +52,7 @@
 static bool MapSessionFilterHelper(WorldSession* session, OpcodeHandler const& opHandle)
 {
     // we do not process thread-unsafe packets
-    if (opHandle.packetProcessing == PROCESS_THREADUNSAFE)
+    if (opHandle.packetProcessing == PROCESS_THREADUNSAFE || opHandle.packetProcessing == PROCESS_AUTHED_THREADSAFE)
         return false;
 
     // we do not process not loggined player packets
@@ -87,6 +88,12 @@ bool WorldSessionFilter::Process(WorldPacket* packet)
     return !MapSessionFilterHelper(m_pSession, opHandle);
 }
 
+// only session local handlers, player must not be loaded - see World::UpdateSessions()
+bool AuthedSessionFilter::Process(WorldPacket* packet)
+{
+    return opcodeTable[packet->GetOpcode()].packetProcessing == PROCESS_AUTHED_THREADSAFE && !m_pSession->GetPlayer();
+}
+
 /// WorldSession constructor
 WorldSession::WorldSession(uint32 id, WorldSocket *sock, AccountTypes sec, uint8 expansion, time_t mute_time, LocaleConstant locale) :
 m_muteTime(mute_time), _player(NULL), m_Socket(sock),_security(sec), _accountId(id), m_expansion(expansion), _logoutTime(0),
@@ -139,6 +146,17 @@ char const* WorldSession::GetPlayerName() const
 
 /// Send a packet to the client
 void WorldSession::SendPacket(WorldPacket const* packet)
+{
+    SendPacket(*packet, NULL);
+}
+
+/// Send a packet also sent to other sessions, the socket queues a reference to the shared payload
+void WorldSession::SendPacket(SharedPayloadPacket const& packet)
+{
+    SendPacket(packet.GetPacket(), &packet);
+}
+
+void WorldSession::SendPacket(WorldPacket const& packet, SharedPayloadPacket const* broadcast)
 {
     // Playerbot mod: send packet to bot AI
     if (!sWorld.getConfig(CONFIG_BOOL_PLAYERBOT_DISABLE))
@@ -146,9 +164,9 @@ void WorldSession::SendPacket(WorldPacket const* packet)
         if (GetPlayer() && GetPlayer()->IsInWorld())
         {
             if (GetPlayer()->GetPlayerbotAI())
-                GetPlayer()->GetPlayerbotAI()->HandleBotOutgoingPacket(*packet);
+                GetPlayer()->GetPlayerbotAI()->HandleBotOutgoingPacket(packet);
             else if (GetPlayer()->GetPlayerbotMgr())
-                GetPlayer()->GetPlayerbotMgr()->HandleMasterOutgoingPacket(*packet);
+                GetPlayer()->GetPlayerbotMgr()->HandleMasterOutgoingPacket(packet);
         }
     }
 
@@ -172,10 +190,10 @@ void WorldSession::SendPacket(WorldPacket const* packet)
     if((cur_time - lastTime) < 60)
     {
         sendPacketCount+=1;
-        sendPacketBytes+=packet->size();
+        sendPacketBytes+=packet.size();
 
         sendLastPacketCount+=1;
-        sendLastPacketBytes+=packet->size();
+        sendLastPacketBytes+=packet.size();
     }
     else
     {
@@ -186,12 +204,12 @@ void WorldSession::SendPacket(WorldPacket const* packet)
 
         lastTime = cur_time;
         sendLastPacketCount = 1;
-        sendLastPacketBytes = packet->wpos();               // wpos is real written size
+        sendLastPacketBytes = packet.wpos();                // wpos is real written size
     }
 
     #endif                                                  // !MANGOS_DEBUG
 
-    if (m_Socket->SendPacket (*packet) == -1)
+    if ((broadcast ? m_Socket->SendPacket(*broadcast) : m_Socket->SendPacket(packet)) == -1)
         m_Socket->CloseSocket ();
 }
 
@@ -220,6 +238,15 @@ void WorldSession::LogUnprocessedTail(WorldPacket *packet)
 }
 
 /// Update the WorldSession (triggered by World update)
+bool WorldSession::GetSocketSendStatistics(size_t& queuedBytes, uint32& sendCalls, uint32& sentBytes) const
+{
+    if (!m_Socket || m_Socket->IsClosed())
+        return false;
+
+    m_Socket->GetSendStatistics(queuedBytes, sendCalls, sentBytes);
+    return true;
+}
+
 bool WorldSession::Update(PacketFilter& updater)
 {
     ///- Retrieve packets from the receive queue and call the appropriate handlers
@@ -31,6 +31,7 @@
 #include "LFGMgr.h"
 #include "AuctionHouseMgr.h"
 #include "Item.h"
+#include "UpdateData.h"
 #include "warden/WardenBase.h"
 
 struct ItemPrototype;
@@ -46,6 +47,7 @@ class Player;
 class Unit;
 class WorldPacket;
 class WorldSocket;
+class SharedPayloadPacket;
 class QueryResult;
 class LoginQueryHolder;
 class CharacterHandler;
@@ -189,6 +191,18 @@ class WorldSessionFilter : public PacketFilter
         virtual bool Process(WorldPacket* packet);
 };
 
+//process only PROCESS_AUTHED_THREADSAFE packets of sessions without player by SessionUpdater threads
+class AuthedSessionFilter : public PacketFilter
+{
+    public:
+        explicit AuthedSessionFilter(WorldSession * pSession) : PacketFilter(pSession) {}
+        ~AuthedSessionFilter() {}
+
+        virtual bool Process(WorldPacket* packet);
+        //logout and session removal are left to World::UpdateSessions()
+        virtual bool ProcessLogout() const { return false; }
+};
+
 /// Player session in the World
 class MANGOS_DLL_SPEC WorldSession
 {
@@ -208,6 +222,7 @@ class MANGOS_DLL_SPEC WorldSession
         void SendAddonsInfo();
 
         void SendPacket(WorldPacket const* packet);
+        void SendPacket(SharedPayloadPacket const& packet);
         void SendNotification(const char *format,...) ATTR_PRINTF(2,3);
         void SendNotification(int32 string_id,...);
         void SendPetNameInvalid(uint32 error, const std::string& name, DeclinedName *declinedName);
@@ -252,6 +267,7 @@ class MANGOS_DLL_SPEC WorldSession
         void KickPlayer();
 
         void QueuePacket(WorldPacket* new_packet);
+        bool HasPendingPackets() { return !_recvQueue.empty(); }
 
         bool Update(PacketFilter& updater);
 
@@ -324,8 +340,7 @@ class MANGOS_DLL_SPEC WorldSession
         void SendAuctionRemovedNotification(AuctionEntry* auction);
         static void SendAuctionOutbiddedMail(AuctionEntry *auction);
         void SendAuctionCancelledToBidderMail(AuctionEntry *auction);
-        void BuildListAuctionItems(std::vector<AuctionEntry*> const& auctions, WorldPacket& data, std::wstring const& searchedname, uint32 listfrom, uint32 levelmin,
-            uint32 levelmax, uint32 usable, uint32 inventoryType, uint32 itemClass, uint32 itemSubClass, uint32 quality, uint32& count, uint32& totalcount, bool isFull);
+        void BuildListAuctionItems(std::vector<AuctionEntry*> const& auctions, WorldPacket& data, uint32 listfrom, uint32 usable, uint32& count, uint32& totalcount, bool isFull);
 
         AuctionHouseEntry const* GetCheckedAuctionHouseForAuctioneer(ObjectGuid guid);
 
@@ -361,6 +376,12 @@ class MANGOS_DLL_SPEC WorldSession
 
         uint32 GetLatency() const { return m_latency; }
         void SetLatency(uint32 latency) { m_latency = latency; }
+
+        // output of session socket: bytes waiting for send, send calls and sent bytes in last second
+        bool GetSocketSendStatistics(size_t& queuedBytes, uint32& sendCalls, uint32& sentBytes) const;
+
+        // persistent deflate stream for object update packets sent to this session
+        UpdateDataCompressor* GetUpdateDataCompressor() { return &m_updateCompressor; }
         uint32 getDialogStatus(Player *pPlayer, Object* questgiver, uint32 defstatus);
 
         // LFG
@@ -891,6 +912,9 @@ class MANGOS_DLL_SPEC WorldSession
 
         void ExecuteOpcode( OpcodeHandler const& opHandle, WorldPacket* packet );
 
+        // common part of SendPacket, broadcast is NULL for packets sent to this session only
+        void SendPacket(WorldPacket const& packet, SharedPayloadPacket const* broadcast);
+
         // logging helper
         void LogUnexpectedOpcode(WorldPacket *packet, const char * reason);
         void LogUnprocessedTail(WorldPacket *packet);
@@ -918,6 +942,7 @@ class MANGOS_DLL_SPEC WorldSession
         TutorialDataState m_tutorialState;
         AddonsList m_addonsList;
         ACE_Based::LockedQueue<WorldPacket*, ACE_Thread_Mutex> _recvQueue;
+        UpdateDataCompressor m_updateCompressor;
 
         // Warden
         WardenBase *m_Warden;
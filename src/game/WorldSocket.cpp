@@ -26,9 +26,12 @@
 #include <ace/OS_NS_string.h>
 #include <ace/Reactor.h>
 #include <ace/Auto_Ptr.h>
+#include <ace/OS_NS_sys_socket.h>
+#include <ace/OS_NS_sys_uio.h>
 
 #include "WorldSocket.h"
 #include "Common.h"
+#include "SharedPayloadPacket.h"
 
 #include "Util.h"
 #include "World.h"
@@ -97,6 +100,12 @@ struct ClientPktHeader
 #pragma pack(pop)
 #endif
 
+#define WORLD_SOCKET_OUT_CHUNK_SIZE     16384               // size of queued output chunks
+#define WORLD_SOCKET_OUT_FREE_CHUNKS    4                   // freed chunks kept for reuse
+#define WORLD_SOCKET_OUT_HIGH_WATER     (8*1024*1024)       // max queued output, packets are refused above it
+#define WORLD_SOCKET_OUT_SLOW_CLIENT    (2*1024*1024)       // queued output reported as slow client
+#define WORLD_SOCKET_MAX_IOV            64                  // buffers per send call
+
 WorldSocket::WorldSocket(void) :
 WorldHandler(),
 m_LastPingTime(ACE_Time_Value::zero),
@@ -108,12 +117,16 @@ m_Header(sizeof(ClientPktHeader)),
 m_OutBuffer(0),
 m_OutBufferSize(65536),
 m_OutActive(false),
+m_OutChunksBytes(0),
+m_OutSlowReported(false),
+m_SendStatsTime(ACE_OS::gettimeofday()),
+m_SendCalls(0),
+m_SentBytes(0),
+m_SendCallsRate(0),
+m_SentBytesRate(0),
 m_Seed(static_cast<uint32>(rand32()))
 {
     reference_counting_policy().value(ACE_Event_Handler::Reference_Counting_Policy::ENABLED);
-
-    msg_queue()->high_water_mark(8*1024*1024);
-    msg_queue()->low_water_mark(8*1024*1024);
 }
 
 WorldSocket::~WorldSocket(void)
@@ -124,6 +137,12 @@ WorldSocket::~WorldSocket(void)
     if (m_OutBuffer)
         m_OutBuffer->release();
 
+    for (std::deque<ACE_Message_Block*>::const_iterator itr = m_OutChunks.begin(); itr != m_OutChunks.end(); ++itr)
+        (*itr)->release();
+
+    for (std::vector<ACE_Message_Block*>::const_iterator itr = m_FreeOutChunks.begin(); itr != m_FreeOutChunks.end(); ++itr)
+        (*itr)->release();
+
     closing_ = true;
 
     peer().close();
@@ -159,6 +178,16 @@ const std::string& WorldSocket::GetRemoteAddress(void) const
 }
 
 int WorldSocket::SendPacket(const WorldPacket& pct)
+{
+    return QueuePacket(pct, NULL);
+}
+
+int WorldSocket::SendPacket(const SharedPayloadPacket& pct)
+{
+    return QueuePacket(pct.GetPacket(), pct.GetPayload());
+}
+
+int WorldSocket::QueuePacket(const WorldPacket& pct, ACE_Message_Block* payload)
 {
     ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
 
@@ -175,42 +204,149 @@ int WorldSocket::SendPacket(const WorldPacket& pct)
     // Dump outgoing packet.
     sLog.outWorldPacketDump(uint32(get_handle()), pct.GetOpcode(), LookupOpcodeName(pct.GetOpcode()), &pct, false);
 
+    if (OpcodeAllocStats::IsEnabled())
+        OpcodeAllocStats::Record(pct.GetOpcode(), pct.GetStorageAllocations(), pct.size());
+
     ServerPktHeader header(pct.size()+2, realOpcode);
     m_Crypt.EncryptSend((uint8*)header.header, header.getHeaderLength());
 
-    if (m_OutBuffer->space() >= pct.size() + header.getHeaderLength() && msg_queue()->is_empty())
-    {
-        // Put the packet on the buffer.
-        if (m_OutBuffer->copy((char*)header.header, header.getHeaderLength()) == -1)
-            MANGOS_ASSERT(false);
+    // A shared payload is queued as own chunk after the header, only the header is copied then.
+    const size_t copySize = payload ? header.getHeaderLength() : pct.size() + header.getHeaderLength();
+    const bool copyToChunk = !m_OutChunks.empty() || m_OutBuffer->space() < copySize;
+    const size_t chunksSize = (copyToChunk ? copySize : 0) + (payload ? pct.size() : 0);
 
-        if (!pct.empty())
-            if (m_OutBuffer->copy((char*)pct.contents(), pct.size()) == -1)
-                MANGOS_ASSERT(false);
-    }
-    else
+    ACE_Message_Block* mb = m_OutBuffer;
+    ACE_Message_Block* payloadRef = NULL;
+    if (chunksSize)
     {
-        // Enqueue the packet.
-        ACE_Message_Block* mb;
+        if (m_OutChunksBytes + chunksSize > WORLD_SOCKET_OUT_HIGH_WATER)
+        {
+            sLog.outError("WorldSocket::SendPacket output queue of %s is full (" SIZEFMTD " bytes)", GetRemoteAddress().c_str(), m_OutChunksBytes);
+            return -1;
+        }
+
+        if (payload)
+        {
+            payloadRef = payload->duplicate();
+            if (!payloadRef)
+                return -1;
+        }
 
-        ACE_NEW_RETURN(mb, ACE_Message_Block(pct.size () + header.getHeaderLength()), -1);
+        // Append to last queued chunk, start new one only if the packet does not fit.
+        // Shared payload chunks have no space left, so nothing is ever appended to them.
+        if (copyToChunk)
+        {
+            mb = m_OutChunks.empty() ? NULL : m_OutChunks.back();
+            if (!mb || mb->space() < copySize)
+            {
+                mb = AllocateOutChunk(copySize);
+                if (!mb)
+                {
+                    if (payloadRef)
+                        payloadRef->release();
+                    return -1;
+                }
 
-        mb->copy((char*)header.header, header.getHeaderLength());
+                m_OutChunks.push_back(mb);
+            }
+        }
 
-        if (!pct.empty())
-            mb->copy((const char*)pct.contents(), pct.size());
+        m_OutChunksBytes += chunksSize;
 
-        if(msg_queue()->enqueue_tail(mb, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
+        if (!m_OutSlowReported && m_OutChunksBytes > WORLD_SOCKET_OUT_SLOW_CLIENT)
         {
-            sLog.outError("WorldSocket::SendPacket enqueue_tail");
-            mb->release();
-            return -1;
+            m_OutSlowReported = true;
+            sLog.outDetail("WorldSocket::SendPacket slow client %s, " SIZEFMTD " bytes queued for output", GetRemoteAddress().c_str(), m_OutChunksBytes);
         }
     }
 
+    // Put the packet on the buffer.
+    if (mb->copy((char*)header.header, header.getHeaderLength()) == -1)
+        MANGOS_ASSERT(false);
+
+    if (payloadRef)
+        m_OutChunks.push_back(payloadRef);
+    else if (!pct.empty())
+        if (mb->copy((char*)pct.contents(), pct.size()) == -1)
+            MANGOS_ASSERT(false);
+
     return 0;
 }
 
+ACE_Message_Block* WorldSocket::AllocateOutChunk(size_t size)
+{
+    if (size <= WORLD_SOCKET_OUT_CHUNK_SIZE && !m_FreeOutChunks.empty())
+    {
+        ACE_Message_Block* mb = m_FreeOutChunks.back();
+        m_FreeOutChunks.pop_back();
+        return mb;
+    }
+
+    ACE_Message_Block* mb;
+    ACE_NEW_RETURN(mb, ACE_Message_Block(std::max(size, size_t(WORLD_SOCKET_OUT_CHUNK_SIZE))), NULL);
+    return mb;
+}
+
+void WorldSocket::ReleaseOutChunk(ACE_Message_Block* mb)
+{
+    // big packets chunks and shared payloads are not reused
+    if (mb->size() == WORLD_SOCKET_OUT_CHUNK_SIZE && !mb->locking_strategy() && m_FreeOutChunks.size() < WORLD_SOCKET_OUT_FREE_CHUNKS)
+    {
+        mb->reset();
+        m_FreeOutChunks.push_back(mb);
+    }
+    else
+        mb->release();
+}
+
+ssize_t WorldSocket::SendBuffers(iovec* iov, int iovcnt)
+{
+    ++m_SendCalls;
+
+#ifdef MSG_NOSIGNAL
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    return ACE_OS::sendmsg(get_handle(), &msg, MSG_NOSIGNAL);
+#else
+    return peer().sendv(iov, iovcnt);
+#endif // MSG_NOSIGNAL
+}
+
+void WorldSocket::UpdateSendStatistics(void)
+{
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    ACE_Time_Value passed = now - m_SendStatsTime;
+    if (passed.sec() < 1)
+        return;
+
+    // no sends in later seconds
+    if (passed.sec() > 1)
+    {
+        m_SendCalls = 0;
+        m_SentBytes = 0;
+    }
+
+    m_SendCallsRate = m_SendCalls;
+    m_SentBytesRate = m_SentBytes;
+    m_SendCalls = 0;
+    m_SentBytes = 0;
+    m_SendStatsTime = now;
+}
+
+void WorldSocket::GetSendStatistics(size_t& queuedBytes, uint32& sendCalls, uint32& sentBytes)
+{
+    ACE_GUARD(LockType, Guard, m_OutBufferLock);
+
+    UpdateSendStatistics();
+
+    queuedBytes = (m_OutBuffer ? m_OutBuffer->length() : 0) + m_OutChunksBytes;
+    sendCalls = m_SendCallsRate;
+    sentBytes = m_SentBytesRate;
+}
+
 long WorldSocket::AddReference(void)
 {
     return static_cast<long>(add_reference());
@@ -333,16 +469,33 @@ int WorldSocket::handle_output(ACE_HANDLE)
     if (closing_)
         return -1;
 
-    const size_t send_len = m_OutBuffer->length();
+    UpdateSendStatistics();
+
+    // Gather the buffer and queued chunks for one send call.
+    iovec iov[WORLD_SOCKET_MAX_IOV];
+    int iovcnt = 0;
+    size_t send_len = 0;
+
+    if (m_OutBuffer->length() > 0)
+    {
+        iov[iovcnt].iov_base = m_OutBuffer->rd_ptr();
+        iov[iovcnt].iov_len = m_OutBuffer->length();
+        send_len += m_OutBuffer->length();
+        ++iovcnt;
+    }
+
+    for (std::deque<ACE_Message_Block*>::const_iterator itr = m_OutChunks.begin(); itr != m_OutChunks.end() && iovcnt < WORLD_SOCKET_MAX_IOV; ++itr)
+    {
+        iov[iovcnt].iov_base = (*itr)->rd_ptr();
+        iov[iovcnt].iov_len = (*itr)->length();
+        send_len += (*itr)->length();
+        ++iovcnt;
+    }
 
     if (send_len == 0)
-        return handle_output_queue(Guard);
+        return cancel_wakeup_output(Guard);
 
-#ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len, MSG_NOSIGNAL);
-#else
-    ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len);
-#endif // MSG_NOSIGNAL
+    ssize_t n = SendBuffers(iov, iovcnt);
 
     if (n == 0)
         return -1;
@@ -353,84 +506,55 @@ int WorldSocket::handle_output(ACE_HANDLE)
 
         return -1;
     }
-    else if (n < (ssize_t)send_len) //now n > 0
-    {
-        m_OutBuffer->rd_ptr(static_cast<size_t>(n));
 
-        // move the data to the base of the buffer
-        m_OutBuffer->crunch();
-
-        return schedule_wakeup_output(Guard);
-    }
-    else //now n == send_len
-    {
-        m_OutBuffer->reset();
+    m_SentBytes += uint32(n);
 
-        return handle_output_queue(Guard);
-    }
+    // Remove the sent data, now n > 0
+    size_t sent = static_cast<size_t>(n);
 
-    ACE_NOTREACHED(return 0);
-}
+    if (m_OutBuffer->length() > 0)
+    {
+        const size_t part = std::min(sent, m_OutBuffer->length());
+        m_OutBuffer->rd_ptr(part);
+        sent -= part;
 
-int WorldSocket::handle_output_queue(GuardType& g)
-{
-    if (msg_queue()->is_empty())
-        return cancel_wakeup_output(g);
+        if (m_OutBuffer->length() > 0)
+        {
+            // move the data to the base of the buffer
+            m_OutBuffer->crunch();
 
-    ACE_Message_Block *mblk;
+            return schedule_wakeup_output(Guard);
+        }
 
-    if (msg_queue()->dequeue_head(mblk, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
-    {
-        sLog.outError("WorldSocket::handle_output_queue dequeue_head");
-        return -1;
+        m_OutBuffer->reset();
     }
 
-    const size_t send_len = mblk->length();
-
-#ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send (mblk->rd_ptr(), send_len, MSG_NOSIGNAL);
-#else
-    ssize_t n = peer().send (mblk->rd_ptr(), send_len);
-#endif // MSG_NOSIGNAL
-
-    if (n == 0)
+    while (sent > 0)
     {
-        mblk->release();
+        ACE_Message_Block* mb = m_OutChunks.front();
+        const size_t part = std::min(sent, mb->length());
+        mb->rd_ptr(part);
+        sent -= part;
+        m_OutChunksBytes -= part;
 
-        return -1;
-    }
-    else if (n == -1)
-    {
-        if (errno == EWOULDBLOCK || errno == EAGAIN)
+        if (mb->length() == 0)
         {
-            msg_queue()->enqueue_head(mblk, (ACE_Time_Value*)&ACE_Time_Value::zero);
-            return schedule_wakeup_output(g);
+            m_OutChunks.pop_front();
+            ReleaseOutChunk(mb);
         }
-
-        mblk->release();
-        return -1;
     }
-    else if (n < (ssize_t)send_len) //now n > 0
-    {
-        mblk->rd_ptr (static_cast<size_t> (n));
 
-        if (msg_queue()->enqueue_head(mblk, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
-        {
-            sLog.outError("WorldSocket::handle_output_queue enqueue_head");
-            mblk->release();
-            return -1;
-        }
+    if (static_cast<size_t>(n) < send_len)
+        return schedule_wakeup_output(Guard);
 
-        return schedule_wakeup_output(g);
-    }
-    else //now n == send_len
+    if (m_OutChunks.empty())
     {
-        mblk->release();
-
-        return msg_queue()->is_empty() ? cancel_wakeup_output(g) : ACE_Event_Handler::WRITE_MASK;
+        m_OutSlowReported = false;
+        return cancel_wakeup_output(Guard);
     }
 
-    ACE_NOTREACHED(return -1);
+    // more chunks than one call can send
+    return ACE_Event_Handler::WRITE_MASK;
 }
 
 int WorldSocket::handle_close(ACE_HANDLE h, ACE_Reactor_Mask)
@@ -461,7 +585,7 @@ int WorldSocket::Update (void)
     if (closing_)
         return -1;
 
-    if (m_OutActive || (m_OutBuffer->length() == 0 && msg_queue()->is_empty()))
+    if (m_OutActive || (m_OutBuffer->length() == 0 && m_OutChunks.empty()))
         return 0;
 
     int ret;
@@ -682,6 +806,9 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
     // Dump received packet.
     sLog.outWorldPacketDump(uint32(get_handle()), new_pct->GetOpcode(), LookupOpcodeName(new_pct->GetOpcode()), new_pct, true);
 
+    if (OpcodeAllocStats::IsEnabled())
+        OpcodeAllocStats::Record(opcode, new_pct->GetStorageAllocations(), new_pct->size());
+
     try
     {
         switch(opcode)
@@ -35,6 +35,7 @@
 #include <ace/Guard_T.h>
 #include <ace/Unbounded_Queue.h>
 #include <ace/Message_Block.h>
+#include <ace/os_include/sys/os_uio.h>
 
 #if !defined (ACE_LACKS_PRAGMA_ONCE)
 #pragma once
@@ -44,9 +45,12 @@
 #include "Auth/AuthCrypt.h"
 #include "Auth/BigNumber.h"
 
+#include <deque>
+
 class ACE_Message_Block;
 class WorldPacket;
 class WorldSession;
+class SharedPayloadPacket;
 
 /// Handler that can communicate over stream sockets.
 typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
@@ -60,10 +64,13 @@ typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
  * The class uses reference counting.
  *
  * For output the class uses one buffer (64K usually) and
- * a queue where it stores packet if there is no place on
- * the queue. The reason this is done, is because the server
+ * a queue of 16K chunks where packets are stored if there is
+ * no place in the buffer. The reason this is done, is because the server
  * does really a lot of small-size writes to it, and it doesn't
- * scale well to allocate memory for every. When something is
+ * scale well to allocate memory for every. Packets are appended to
+ * the last queued chunk while they fit, and freed chunks are reused.
+ * Buffer and all queued chunks are sent by one gathering
+ * write (sendmsg/writev) per output event. When something is
  * written to the output buffer the socket is not immediately
  * activated for output (again for the same reason), there
  * is 10ms celling (thats why there is Update() method).
@@ -116,6 +123,11 @@ class WorldSocket : protected WorldHandler
         /// @return -1 of failure
         int SendPacket (const WorldPacket& pct);
 
+        /// Send a packet with payload shared by other sockets, only the header is queued as copy.
+        /// @param pct packet to send
+        /// @return -1 of failure
+        int SendPacket (const SharedPayloadPacket& pct);
+
         /// Add reference to this object.
         long AddReference (void);
 
@@ -125,6 +137,12 @@ class WorldSocket : protected WorldHandler
         /// Return the session key
         BigNumber& GetSessionKey() { return m_s; }
 
+        /// Output statistics for detecting slow clients.
+        /// @param queuedBytes bytes not yet accepted by the kernel
+        /// @param sendCalls send system calls in last second
+        /// @param sentBytes bytes sent in last second
+        void GetSendStatistics (size_t& queuedBytes, uint32& sendCalls, uint32& sentBytes);
+
     protected:
         /// things called by ACE framework.
         WorldSocket (void);
@@ -150,6 +168,9 @@ class WorldSocket : protected WorldHandler
         int Update (void);
 
     private:
+        /// Queue packet for output, the payload is referenced instead of copied if given.
+        int QueuePacket (const WorldPacket& pct, ACE_Message_Block* payload);
+
         /// Helper functions for processing incoming data.
         int handle_input_header (void);
         int handle_input_payload (void);
@@ -160,8 +181,17 @@ class WorldSocket : protected WorldHandler
         int cancel_wakeup_output (GuardType& g);
         int schedule_wakeup_output (GuardType& g);
 
-        /// Drain the queue if its not empty.
-        int handle_output_queue (GuardType& g);
+        /// Get output chunk for at least size bytes, reuses freed chunks.
+        ACE_Message_Block* AllocateOutChunk (size_t size);
+
+        /// Return sent chunk for reuse.
+        void ReleaseOutChunk (ACE_Message_Block* mb);
+
+        /// Send the iovecs with one system call.
+        ssize_t SendBuffers (iovec* iov, int iovcnt);
+
+        /// Move counters of finished second to rates, needs m_OutBufferLock.
+        void UpdateSendStatistics (void);
 
         /// process one incoming packet.
         /// @param new_pct received packet ,note that you need to delete it.
@@ -215,6 +245,25 @@ class WorldSocket : protected WorldHandler
         /// True if the socket is registered with the reactor for output
         bool m_OutActive;
 
+        /// Output waiting after m_OutBuffer, packets are appended to the last chunk.
+        std::deque<ACE_Message_Block*> m_OutChunks;
+
+        /// Data length in m_OutChunks.
+        size_t m_OutChunksBytes;
+
+        /// Sent chunks kept for reuse.
+        std::vector<ACE_Message_Block*> m_FreeOutChunks;
+
+        /// True after slow client warning, reset when output queue is drained.
+        bool m_OutSlowReported;
+
+        /// Send statistics of current second and rates of the previous one.
+        ACE_Time_Value m_SendStatsTime;
+        uint32 m_SendCalls;
+        uint32 m_SentBytes;
+        uint32 m_SendCallsRate;
+        uint32 m_SentBytesRate;
+
         uint32 m_Seed;
 
         BigNumber m_s;
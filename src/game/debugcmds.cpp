@@ -31,6 +31,11 @@
 #include "ObjectMgr.h"
 #include "ObjectGuid.h"
 #include "SpellMgr.h"
+#include "GridMap.h"
+#include "vmap/IVMapManager.h"
+#include "ChatLog.h"
+#include "SharedPayloadPacket.h"
+#include <ace/Message_Block.h>
 
 bool ChatHandler::HandleDebugSendSpellFailCommand(char* args)
 {
@@ -1173,3 +1178,608 @@ bool ChatHandler::HandleDebugEnterVehicleCommand(char* args)
     m_session->GetPlayer()->EnterVehicle(target->GetVehicleKit(), seat);
     return true;
 }
+
+static uint64 TimeDiffUsec(ACE_Time_Value const& start)
+{
+    ACE_UINT64 usec;
+    (ACE_OS::gettimeofday() - start).to_usec(usec);
+    return uint64(usec);
+}
+
+// compare single and batched terrain queries on random points around the player
+bool ChatHandler::HandleDebugTerrainBenchCommand(char* args)
+{
+    uint32 count;
+    if (!ExtractOptUInt32(&args, count, 1000))
+        return false;
+
+    if (!count || count > 10000)
+        return false;
+
+    Player* player = m_session->GetPlayer();
+    Map* map = player->GetMap();
+    TerrainInfo const* terrain = map->GetTerrain();
+    uint32 phaseMask = player->GetPhaseMask();
+
+    std::vector<VMAP::HeightQuery> points(count);
+    std::vector<VMAP::LineOfSightQuery> segments(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        VMAP::HeightQuery& point = points[i];
+        point.x = player->GetPositionX() + frand(-SIZE_OF_GRID_CELL, SIZE_OF_GRID_CELL);
+        point.y = player->GetPositionY() + frand(-SIZE_OF_GRID_CELL, SIZE_OF_GRID_CELL);
+        point.z = player->GetPositionZ() + frand(-5.0f, 5.0f);
+        point.maxSearchDist = DEFAULT_HEIGHT_SEARCH;
+
+        VMAP::LineOfSightQuery& segment = segments[i];
+        segment.x1 = player->GetPositionX();
+        segment.y1 = player->GetPositionY();
+        segment.z1 = player->GetPositionZ() + 2.0f;
+        segment.x2 = point.x;
+        segment.y2 = point.y;
+        segment.z2 = point.z + 2.0f;
+    }
+
+    std::vector<float> heights(count);
+    std::vector<float> batchHeights(count);
+    // std::vector<bool> has no contiguous storage for the batched call
+    std::vector<uint8> los(count);
+    std::vector<uint8> batchLos(count);
+
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    for (uint32 i = 0; i < count; ++i)
+        heights[i] = terrain->GetHeightStatic(points[i].x, points[i].y, points[i].z, true, points[i].maxSearchDist);
+    uint64 heightTime = TimeDiffUsec(start);
+
+    start = ACE_OS::gettimeofday();
+    terrain->GetHeightStatic(&points[0], count, &batchHeights[0]);
+    uint64 batchHeightTime = TimeDiffUsec(start);
+
+    start = ACE_OS::gettimeofday();
+    for (uint32 i = 0; i < count; ++i)
+        los[i] = map->IsInLineOfSight(segments[i].x1, segments[i].y1, segments[i].z1, segments[i].x2, segments[i].y2, segments[i].z2, phaseMask);
+    uint64 losTime = TimeDiffUsec(start);
+
+    start = ACE_OS::gettimeofday();
+    map->IsInLineOfSight(&segments[0], count, phaseMask, &batchLos[0]);
+    uint64 batchLosTime = TimeDiffUsec(start);
+
+    uint32 heightMismatch = 0;
+    uint32 losMismatch = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (heights[i] != batchHeights[i])
+            ++heightMismatch;
+        if (!los[i] != !batchLos[i])
+            ++losMismatch;
+    }
+
+    PSendSysMessage("Terrain queries: %u points on map %u", count, map->GetId());
+    PSendSysMessage("Height: single " UI64FMTD " us, batched " UI64FMTD " us, mismatches %u", heightTime, batchHeightTime, heightMismatch);
+    PSendSysMessage("Line of sight: single " UI64FMTD " us, batched " UI64FMTD " us, mismatches %u", losTime, batchLosTime, losMismatch);
+    return true;
+}
+
+// time creation and destruction of aura holders of the spell for the player and copying of holder handlers
+bool ChatHandler::HandleDebugAuraBenchCommand(char* args)
+{
+    uint32 spellId = ExtractSpellIdFromLink(&args);
+    if (!spellId)
+        return false;
+
+    uint32 count;
+    if (!ExtractOptUInt32(&args, count, 1000))
+        return false;
+
+    if (!count || count > 10000)
+        return false;
+
+    SpellEntry const* spellInfo = sSpellStore.LookupEntry(spellId);
+    if (!spellInfo || !IsSpellAppliesAura(spellInfo))
+    {
+        PSendSysMessage(LANG_COMMAND_NOSPELLFOUND);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    Player* player = m_session->GetPlayer();
+
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    for (uint32 i = 0; i < count; ++i)
+    {
+        SpellAuraHolderPtr holder = CreateSpellAuraHolder(spellInfo, player, player);
+        for (uint32 j = 0; j < MAX_EFFECT_INDEX; ++j)
+        {
+            SpellEffectIndex eff = SpellEffectIndex(j);
+            if (IsAuraApplyEffect(spellInfo, eff))
+                holder->CreateAura(spellInfo, eff, NULL, holder, player, player, NULL);
+        }
+        holder->CleanupsBeforeDelete();
+    }
+    uint64 createTime = TimeDiffUsec(start);
+
+    SpellAuraHolderPtr holder = CreateSpellAuraHolder(spellInfo, player, player);
+    start = ACE_OS::gettimeofday();
+    for (uint32 i = 0; i < count; ++i)
+    {
+        SpellAuraHolderPtr copy = holder;
+        SpellAuraHolderPtr copy2(copy);
+    }
+    uint64 copyTime = TimeDiffUsec(start);
+    holder->CleanupsBeforeDelete();
+
+    uint32 pools, usedHolders, usedAuras, reservedBytes;
+    SpellAuraPool::GetStatistics(pools, usedHolders, usedAuras, reservedBytes);
+
+    PSendSysMessage("Aura holders of spell %u: %u create/delete cycles " UI64FMTD " us, %u handler copies " UI64FMTD " us", spellId, count, createTime, count * 2, copyTime);
+    PSendSysMessage("Aura pools: %u, used holders %u, used auras %u, reserved %u bytes", pools, usedHolders, usedAuras, reservedBytes);
+    return true;
+}
+
+// show output queue and send rate of player's connection, for finding slow clients
+bool ChatHandler::HandleDebugNetStatsCommand(char* args)
+{
+    Player* target;
+    if (!ExtractPlayerTarget(&args, &target))
+        return false;
+
+    size_t queuedBytes;
+    uint32 sendCalls, sentBytes;
+    if (!target->GetSession()->GetSocketSendStatistics(queuedBytes, sendCalls, sentBytes))
+    {
+        PSendSysMessage("Player %s is not connected", GetNameLink(target).c_str());
+        return true;
+    }
+
+    PSendSysMessage("Player %s: queued output " SIZEFMTD " bytes, %u send calls/s, %u bytes/s, latency %u ms",
+        GetNameLink(target).c_str(), queuedBytes, sendCalls, sentBytes, target->GetSession()->GetLatency());
+    return true;
+}
+
+bool ChatHandler::HandleDebugPacketAllocCommand(char* args)
+{
+    if (*args)
+    {
+        if (ExtractLiteralArg(&args, "reset"))
+        {
+            OpcodeAllocStats::Reset();
+            SendSysMessage("Packet allocation counters reset");
+            return true;
+        }
+
+        bool value;
+        if (!ExtractOnOff(&args, value))
+            return false;
+
+        OpcodeAllocStats::SetEnabled(value);
+        PSendSysMessage("Packet allocation counters %s", value ? "enabled" : "disabled");
+        return true;
+    }
+
+    uint64 heapAllocs, cacheRefills, largeAllocs;
+    size_t sharedBytes;
+    ByteBufferStoragePool::GetStatistics(heapAllocs, cacheRefills, largeAllocs, sharedBytes);
+
+    PSendSysMessage("Packet storage pool: " UI64FMTD " heap blocks, " UI64FMTD " cache refills, " UI64FMTD " large allocations, " SIZEFMTD " bytes in shared lists",
+        heapAllocs, cacheRefills, largeAllocs, sharedBytes);
+
+    if (!OpcodeAllocStats::IsEnabled())
+        SendSysMessage("Per opcode counters are disabled (.debug packetalloc on)");
+
+    std::vector<OpcodeAllocStats::Entry> entries;
+    OpcodeAllocStats::GetTop(entries, 15);
+
+    for (std::vector<OpcodeAllocStats::Entry>::const_iterator itr = entries.begin(); itr != entries.end(); ++itr)
+        PSendSysMessage("%s: " UI64FMTD " packets, " UI64FMTD " allocations, " UI64FMTD " bytes",
+            LookupOpcodeName(itr->opcode), itr->packets, itr->allocations, itr->bytes);
+
+    return true;
+}
+
+// character screen work of one synthetic session, as sent by client after auth
+class LoginBenchTask : public SessionUpdateTask
+{
+    public:
+        explicit LoginBenchTask(WorldSession* session) : m_session(session) {}
+
+        virtual void call()
+        {
+            m_session->LoadGlobalAccountData();
+            m_session->LoadTutorialsData();
+
+            Replay(CMSG_READY_FOR_ACCOUNT_DATA_TIMES, NULL);
+
+            for (uint32 type = 0; type < NUM_ACCOUNT_DATA_TYPES; ++type)
+                if (GLOBAL_CACHE_MASK & (1 << type))
+                    Replay(CMSG_REQUEST_ACCOUNT_DATA, &type);
+
+            uint32 unk = 0;
+            Replay(CMSG_REALM_SPLIT, &unk);
+        }
+
+    private:
+        void Replay(Opcodes opcode, uint32 const* value)
+        {
+            WorldPacket packet(opcode, 4);
+            if (value)
+                packet << *value;
+            (m_session->*opcodeTable[opcode].handler)(packet);
+        }
+
+        WorldSession* m_session;
+};
+
+// replay character screen traffic of synthetic sessions (own account, no socket) serially and by session update threads
+bool ChatHandler::HandleDebugLoginBenchCommand(char* args)
+{
+    // each session loads its account data by blocking queries
+    uint32 count;
+    if (!ExtractOptUInt32(&args, count, 100))
+        return false;
+
+    if (!count || count > 1000)
+    {
+        SendSysMessage(LANG_BAD_VALUE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    WorldSession* session = m_session;
+
+    std::vector<WorldSession*> sessions;
+    std::vector<LoginBenchTask> tasks;
+    SessionUpdateTaskList taskList;
+
+    sessions.reserve(count);
+    tasks.reserve(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        sessions.push_back(new WorldSession(session->GetAccountId(), NULL, session->GetSecurity(), session->Expansion(), 0, session->GetSessionDbcLocale()));
+        tasks.push_back(LoginBenchTask(sessions.back()));
+        taskList.push_back(&tasks.back());
+    }
+
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    for (SessionUpdateTaskList::const_iterator itr = taskList.begin(); itr != taskList.end(); ++itr)
+        (*itr)->call();
+    uint64 serialTime = TimeDiffUsec(start);
+
+    PSendSysMessage("Login bench of %u sessions: world thread " UI64FMTD " us", count, serialTime);
+
+    SessionUpdater& updater = sWorld.GetSessionUpdater();
+    if (updater.activated())
+    {
+        start = ACE_OS::gettimeofday();
+        updater.execute(taskList);
+        uint64 parallelTime = TimeDiffUsec(start);
+
+        PSendSysMessage("Login bench of %u sessions: " SIZEFMTD " session update threads " UI64FMTD " us", count, updater.threads() + 1, parallelTime);
+    }
+    else
+        SendSysMessage("Session update threads are disabled (SessionUpdate.Threads)");
+
+    for (std::vector<WorldSession*>::const_iterator itr = sessions.begin(); itr != sessions.end(); ++itr)
+        delete *itr;
+
+    return true;
+}
+
+// compare lexics cutter word automaton with per position word compare on chat lines from file
+bool ChatHandler::HandleDebugLexicsBenchCommand(char* args)
+{
+    char* fileName = ExtractQuotedOrLiteralArg(&args);
+    if (!fileName)
+        return false;
+
+    uint32 repeats;
+    if (!ExtractOptUInt32(&args, repeats, 1) || !repeats || repeats > 100)
+    {
+        SendSysMessage(LANG_BAD_VALUE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+    LexicsCutter const* lexics = sChatLog.GetLexicsCutter();
+    if (!lexics)
+    {
+        SendSysMessage("Chat lexics cutter is disabled (LexicsCutterEnable)");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    std::ifstream corpus(fileName);
+    if (!corpus)
+    {
+        PSendSysMessage("Can't open file %s", fileName);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    // lines after the first 100000 are ignored, to bound the run time
+    std::vector<std::string> lines;
+    std::string line;
+    while (lines.size() < 100000 && std::getline(corpus, line))
+    {
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+        if (!line.empty())
+            lines.push_back(line);
+    }
+
+    uint32 found = 0;
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    for (uint32 r = 0; r < repeats; ++r)
+        for (std::vector<std::string>::iterator itr = lines.begin(); itr != lines.end(); ++itr)
+            if (lexics->Check_Lexics(*itr))
+                ++found;
+    uint64 automatonTime = TimeDiffUsec(start);
+
+    uint32 foundSimple = 0;
+    start = ACE_OS::gettimeofday();
+    for (uint32 r = 0; r < repeats; ++r)
+        for (std::vector<std::string>::iterator itr = lines.begin(); itr != lines.end(); ++itr)
+            if (lexics->Check_Lexics_Simple(*itr))
+                ++foundSimple;
+    uint64 simpleTime = TimeDiffUsec(start);
+
+    uint32 mismatches = 0;
+    for (std::vector<std::string>::iterator itr = lines.begin(); itr != lines.end(); ++itr)
+        if (lexics->Check_Lexics(*itr) != lexics->Check_Lexics_Simple(*itr))
+            ++mismatches;
+
+    PSendSysMessage("Lexics bench of " SIZEFMTD " lines x %u: automaton " UI64FMTD " us (%u found), word compare " UI64FMTD " us (%u found), %u lines differ",
+                    lines.size(), repeats, automatonTime, found, simpleTime, foundSimple, mismatches);
+    return true;
+}
+
+namespace
+{
+    class EventBenchEvent : public BasicEvent
+    {
+        public:
+            EventBenchEvent(uint32& executed, uint32& aborted) : BasicEvent(0), m_executed(executed), m_aborted(aborted) {}
+
+            bool Execute(uint64 /*e_time*/, uint32 /*p_time*/) { ++m_executed; return true; }
+            void Abort(uint64 /*e_time*/) { ++m_aborted; }
+
+        private:
+            uint32& m_executed;
+            uint32& m_aborted;
+    };
+}
+
+// insert/expire/abort throughput of EventProcessor
+bool ChatHandler::HandleDebugEventBenchCommand(char* args)
+{
+    uint32 count;
+    if (!ExtractOptUInt32(&args, count, 100000) || !count || count > 1000000)
+    {
+        SendSysMessage(LANG_BAD_VALUE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    uint32 const maxDelay = 10000;                          // ms
+    uint32 const updateDiff = 50;
+
+    std::vector<uint32> delays(count);
+    for (uint32 i = 0; i < count; ++i)
+        delays[i] = urand(1, maxDelay);
+
+    uint32 executed = 0;
+    uint32 aborted = 0;
+
+    EventProcessor events;
+
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    for (uint32 i = 0; i < count; ++i)
+        events.AddEvent(new EventBenchEvent(executed, aborted), events.CalculateTime(delays[i]));
+    uint64 insertTime = TimeDiffUsec(start);
+
+    start = ACE_OS::gettimeofday();
+    for (uint32 t = 0; t <= maxDelay; t += updateDiff)
+        events.Update(updateDiff);
+    uint64 expireTime = TimeDiffUsec(start);
+
+    std::vector<EventBenchEvent*> abortEvents(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        abortEvents[i] = new EventBenchEvent(executed, aborted);
+        events.AddEvent(abortEvents[i], events.CalculateTime(delays[i]));
+    }
+
+    start = ACE_OS::gettimeofday();
+    for (uint32 i = 0; i < count; i += 2)
+        abortEvents[i]->to_Abort = true;
+    for (uint32 t = 0; t <= maxDelay; t += updateDiff)
+        events.Update(updateDiff);
+    uint64 abortTime = TimeDiffUsec(start);
+
+    PSendSysMessage("Event bench of %u events: insert " UI64FMTD " us, expire " UI64FMTD " us, expire with half aborted " UI64FMTD " us (%u executed, %u aborted)",
+                    count, insertTime, expireTime, abortTime, executed, aborted);
+    return true;
+}
+
+/// Compares queueing a broadcast to recipients by payload copy and by shared payload reference, as done by WorldSocket
+bool ChatHandler::HandleDebugBroadcastBenchCommand(char* args)
+{
+    // runs at world thread, buffers of at most 1000 recipients keep it within a few MB
+    uint32 recipients;
+    if (!ExtractOptUInt32(&args, recipients, 1000) || !recipients || recipients > 1000)
+    {
+        SendSysMessage(LANG_BAD_VALUE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    uint32 payloadSize;
+    if (!ExtractOptUInt32(&args, payloadSize, 1024) || payloadSize > 16000)
+    {
+        SendSysMessage(LANG_BAD_VALUE);
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    uint32 const repeats = 100;
+    char const header[4] = { 0, 0, 0, 0 };
+
+    WorldPacket packet(SMSG_MESSAGECHAT, payloadSize);
+    for (uint32 i = 0; i < payloadSize; ++i)
+        packet << uint8(i);
+
+    // output buffers of the recipients
+    std::vector<ACE_Message_Block*> buffers(recipients);
+    for (uint32 i = 0; i < recipients; ++i)
+        buffers[i] = new ACE_Message_Block(payloadSize + sizeof(header));
+
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    for (uint32 r = 0; r < repeats; ++r)
+    {
+        for (uint32 i = 0; i < recipients; ++i)
+        {
+            buffers[i]->reset();
+            buffers[i]->copy(header, sizeof(header));
+            buffers[i]->copy((char const*)packet.contents(), packet.size());
+        }
+    }
+    uint64 copyTime = TimeDiffUsec(start);
+
+    std::vector<ACE_Message_Block*> refs(recipients);
+    uint32 shared = 0;
+
+    start = ACE_OS::gettimeofday();
+    for (uint32 r = 0; r < repeats; ++r)
+    {
+        SharedPayloadPacket broadcast(packet);
+        for (uint32 i = 0; i < recipients; ++i)
+        {
+            buffers[i]->reset();
+            buffers[i]->copy(header, sizeof(header));
+
+            if (ACE_Message_Block* payload = broadcast.GetPayload())
+                refs[i] = payload->duplicate();
+            else
+            {
+                refs[i] = NULL;
+                buffers[i]->copy((char const*)packet.contents(), packet.size());
+            }
+        }
+
+        // sent by the network threads
+        for (uint32 i = 0; i < recipients; ++i)
+        {
+            if (refs[i])
+            {
+                refs[i]->release();
+                ++shared;
+            }
+        }
+    }
+    uint64 sharedTime = TimeDiffUsec(start);
+
+    for (uint32 i = 0; i < recipients; ++i)
+        buffers[i]->release();
+
+    PSendSysMessage("Broadcast bench of %u byte payload to %u recipients, %u times: copy " UI64FMTD " us, shared " UI64FMTD " us (%u of %u sends by reference, sharing from %u bytes)",
+                    payloadSize, recipients, repeats, copyTime, sharedTime, shared, recipients * repeats, SHARED_PAYLOAD_MIN_SIZE);
+    return true;
+}
+
+/// Compares values update blocks built per observer with one shared block patched per observer, as done by WorldObject::BuildUpdateData
+bool ChatHandler::HandleDebugValuesBenchCommand(char* args)
+{
+    uint32 observers;
+    if (!ExtractOptUInt32(&args, observers, 100))
+        return false;
+
+    uint32 repeats;
+    if (!ExtractOptUInt32(&args, repeats, 100))
+        return false;
+
+    // every pass builds the blocks twice for each observer
+    if (!observers || observers > 5000 || !repeats || repeats > 10000 || observers * repeats > 1000000)
+        return false;
+
+    Player* player = m_session->GetPlayer();
+    Unit* target = getSelectedUnit();
+    if (!target)
+        target = player;
+
+    // real observers of the target, cycled up to the requested crowd size
+    std::vector<Player*> viewers;
+    Map::PlayerList const& players = player->GetMap()->GetPlayers();
+    for (Map::PlayerList::const_iterator itr = players.begin(); itr != players.end(); ++itr)
+    {
+        Player* viewer = itr->getSource();
+        if (viewer == target || viewer->HaveAtClient(target->GetObjectGuid()))
+            viewers.push_back(viewer);
+    }
+
+    if (viewers.empty())
+        viewers.push_back(player);
+
+    // typical crowd changes, including observer dependent fields
+    static uint16 const changedFields[] =
+    {
+        UNIT_FIELD_HEALTH, UNIT_FIELD_POWER1, UNIT_FIELD_FACTIONTEMPLATE, UNIT_FIELD_FLAGS,
+        UNIT_FIELD_AURASTATE, UNIT_DYNAMIC_FLAGS, UNIT_NPC_FLAGS, UNIT_FIELD_BYTES_2
+    };
+    // marks are put back after the bench, so observers get no packets from it
+    std::vector<uint32> savedChanges;
+    target->MarkChangedValuesForBuild(changedFields, countof(changedFields), savedChanges);
+
+    std::vector<UpdateData> perObserver(observers);
+    std::vector<UpdateData> shared(observers);
+    UpdateValuesBlockCache cache;
+
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    for (uint32 n = 0; n < repeats; ++n)
+    {
+        for (uint32 i = 0; i < observers; ++i)
+        {
+            perObserver[i].Clear();
+            target->BuildValuesUpdateBlockForPlayer(&perObserver[i], viewers[i % viewers.size()]);
+        }
+    }
+    uint64 perObserverTime = TimeDiffUsec(start);
+
+    start = ACE_OS::gettimeofday();
+    for (uint32 n = 0; n < repeats; ++n)
+    {
+        cache.entries.clear();
+        for (uint32 i = 0; i < observers; ++i)
+        {
+            shared[i].Clear();
+            target->BuildValuesUpdateBlockForPlayer(&shared[i], viewers[i % viewers.size()], &cache);
+        }
+    }
+    uint64 sharedTime = TimeDiffUsec(start);
+
+    target->RestoreChangedValues(savedChanges);
+
+    uint64 sentBytes = 0;
+    uint32 mismatches = 0;
+    for (uint32 i = 0; i < observers; ++i)
+    {
+        ByteBuffer const& a = perObserver[i].GetBlocksData();
+        ByteBuffer const& b = shared[i].GetBlocksData();
+        sentBytes += a.wpos();
+        if (a.wpos() != b.wpos() || (a.wpos() && memcmp(a.contents(), b.contents(), a.wpos()) != 0))
+            ++mismatches;
+    }
+
+    uint64 sharedBuiltBytes = 0;
+    uint32 patches = 0;
+    for (std::vector<UpdateValuesBlockCache::Entry>::const_iterator itr = cache.entries.begin(); itr != cache.entries.end(); ++itr)
+    {
+        sharedBuiltBytes += itr->block.wpos();
+        patches += itr->patches.size();
+    }
+
+    PSendSysMessage("Values update of %s for %u observers (%u distinct players), %u times",
+                    target->GetGuidStr().c_str(), observers, uint32(viewers.size()), repeats);
+    PSendSysMessage("Per observer: " UI64FMTD " us, " UI64FMTD " bytes serialized per pass",
+                    perObserverTime, sentBytes);
+    PSendSysMessage("Shared: " UI64FMTD " us, " UI64FMTD " bytes serialized in %u blocks per pass (%u observer dependent fields patched), mismatches %u",
+                    sharedTime, sharedBuiltBytes, uint32(cache.entries.size()), patches, mismatches);
+    return true;
+}
@@ -109,7 +109,8 @@ namespace Movement
         unit.m_movementInfo.SetMovementFlags((MovementFlags)moveFlags);
         move_spline.Initialize(args);
 
-        WorldPacket data(SMSG_MONSTER_MOVE, 64);
+        // fixed part plus at most one full vector per path point
+        WorldPacket data(SMSG_MONSTER_MOVE, 64 + args.path.size() * 3 * sizeof(float));
         data << unit.GetPackGUID();
 
         if (transportInfo)
@@ -41,6 +41,20 @@ namespace VMAP
 #define VMAP_INVALID_HEIGHT       -100000.0f            // for check
 #define VMAP_INVALID_HEIGHT_VALUE -200000.0f            // real assigned value in unknown height case
 
+    // single segment of a batched line of sight request
+    struct LineOfSightQuery
+    {
+        float x1, y1, z1;
+        float x2, y2, z2;
+    };
+
+    // single point of a batched height request
+    struct HeightQuery
+    {
+        float x, y, z;
+        float maxSearchDist;
+    };
+
     //===========================================================
     class IVMapManager
     {
@@ -63,6 +77,12 @@ namespace VMAP
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) = 0;
             /**
+            batched versions of the two calls above, the map tree and the calc settings are resolved once for the whole set
+            pResults / pHeights must hold pCount entries, a result is non-zero if the segment is in line of sight
+            */
+            virtual void isInLineOfSight(unsigned int pMapId, LineOfSightQuery const* pQueries, uint32 pCount, uint8* pResults) = 0;
+            virtual void getHeight(unsigned int pMapId, HeightQuery const* pQueries, uint32 pCount, float* pHeights) = 0;
+            /**
             test if we hit an object. return true if we hit one. rx,ry,rz will hold the hit position or the dest position, if no intersection was found
             return a position, that is pReduceDist closer to the origin
             */
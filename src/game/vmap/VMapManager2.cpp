@@ -216,6 +216,82 @@ namespace VMAP
         return height;
     }
 
+    //=========================================================
+    /**
+    batched isInLineOfSight, tree lookup is done once and origin conversion
+    is reused while consecutive segments start from the same point
+    */
+    void VMapManager2::isInLineOfSight(unsigned int pMapId, LineOfSightQuery const* pQueries, uint32 pCount, uint8* pResults)
+    {
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
+        if (!isLineOfSightCalcEnabled() || instanceTree == iInstanceMapTrees.end())
+        {
+            for (uint32 i = 0; i < pCount; ++i)
+                pResults[i] = true;
+            return;
+        }
+
+        StaticMapTree const* tree = instanceTree->second;
+        Vector3 pos1;
+        LineOfSightQuery const* pos1Query = NULL;           // query pos1 was converted for, skipped ones don't convert
+        for (uint32 i = 0; i < pCount; ++i)
+        {
+            LineOfSightQuery const& query = pQueries[i];
+
+            // Don't calculate hit position, if wrong src/dest points provided!
+            if (!VMAP::CheckPosition(query.x1, query.y1, query.z1) || !VMAP::CheckPosition(query.x2, query.y2, query.z2))
+            {
+                pResults[i] = false;
+                continue;
+            }
+
+            if (i > 0)
+            {
+                LineOfSightQuery const& prev = pQueries[i - 1];
+
+                // repeated segment, reuse last result
+                if (prev.x1 == query.x1 && prev.y1 == query.y1 && prev.z1 == query.z1 &&
+                    prev.x2 == query.x2 && prev.y2 == query.y2 && prev.z2 == query.z2)
+                {
+                    pResults[i] = pResults[i - 1];
+                    continue;
+                }
+            }
+
+            if (!pos1Query || pos1Query->x1 != query.x1 || pos1Query->y1 != query.y1 || pos1Query->z1 != query.z1)
+            {
+                pos1 = convertPositionToInternalRep(query.x1, query.y1, query.z1);
+                pos1Query = &query;
+            }
+            Vector3 pos2 = convertPositionToInternalRep(query.x2, query.y2, query.z2);
+            pResults[i] = pos1 == pos2 || tree->isInLineOfSight(pos1, pos2);
+        }
+    }
+
+    //=========================================================
+    /**
+    batched getHeight, entries without height get VMAP_INVALID_HEIGHT_VALUE
+    */
+    void VMapManager2::getHeight(unsigned int pMapId, HeightQuery const* pQueries, uint32 pCount, float* pHeights)
+    {
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
+        if (!isHeightCalcEnabled() || instanceTree == iInstanceMapTrees.end())
+        {
+            for (uint32 i = 0; i < pCount; ++i)
+                pHeights[i] = VMAP_INVALID_HEIGHT_VALUE;
+            return;
+        }
+
+        StaticMapTree const* tree = instanceTree->second;
+        for (uint32 i = 0; i < pCount; ++i)
+        {
+            HeightQuery const& query = pQueries[i];
+            Vector3 pos = convertPositionToInternalRep(query.x, query.y, query.z);
+            float height = tree->getHeight(pos, query.maxSearchDist);
+            pHeights[i] = height < G3D::inf() ? height : VMAP_INVALID_HEIGHT_VALUE;
+        }
+    }
+
     //=========================================================
 
     bool VMapManager2::getAreaInfo(unsigned int pMapId, float x, float y, float& z, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const
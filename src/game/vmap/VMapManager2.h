@@ -91,6 +91,9 @@ namespace VMAP
             bool getObjectHitPos(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float &ry, float& rz, float pModifyDist);
             float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist);
 
+            void isInLineOfSight(unsigned int pMapId, LineOfSightQuery const* pQueries, uint32 pCount, uint8* pResults);
+            void getHeight(unsigned int pMapId, HeightQuery const* pQueries, uint32 pCount, float* pHeights);
+
             bool processCommand(char *pCommand) { return false; }      // for debug and extensions
 
             bool getAreaInfo(unsigned int pMapId, float x, float y, float &z, uint32 &flags, int32 &adtId, int32 &rootId, int32 &groupId) const;
@@ -575,6 +575,19 @@ bool ChatHandler::HandleServerLogLevelCommand(char *args)
     return true;
 }
 
+bool ChatHandler::HandleServerLogStatsCommand(char* /*args*/)
+{
+    uint64 written, dropped, blocked;
+    if (!sLog.GetAsyncStatistics(written, dropped, blocked))
+    {
+        SendSysMessage("Log output is written synchronously (LogAsync = 0)");
+        return true;
+    }
+
+    PSendSysMessage("Async log records: written " UI64FMTD ", dropped " UI64FMTD ", producer waits " UI64FMTD, written, dropped, blocked);
+    return true;
+}
+
 /// @}
 
 #ifdef linux
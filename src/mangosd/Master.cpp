@@ -431,12 +431,13 @@ bool Master::_StartDB()
     ///- Get world database info from configuration file
     std::string dbstring = sConfig.GetStringDefault("WorldDatabaseInfo", "");
     int nConnections = sConfig.GetIntDefault("WorldDatabaseConnections", 1);
+    int nAsyncConnections = sConfig.GetIntDefault("WorldDatabaseAsyncConnections", 1);
     if(dbstring.empty())
     {
         sLog.outError("Database not specified in configuration file");
         return false;
     }
-    sLog.outString("World Database total connections: %i", nConnections + 1);
+    sLog.outString("World Database total connections: %i", nConnections + nAsyncConnections);
 
 #ifdef MANGOSR2_SINGLE_THREAD
     if (nConnections > 1)
@@ -444,10 +445,16 @@ bool Master::_StartDB()
         sLog.outError(" Your OS (%s) not support set WorldDatabaseConnections > 1! Resetted to 1", MANGOSR2_SINGLE_THREAD);
         nConnections = 1;
     }
+
+    if (nAsyncConnections > 1)
+    {
+        sLog.outError(" Your OS (%s) not support set WorldDatabaseAsyncConnections > 1! Resetted to 1", MANGOSR2_SINGLE_THREAD);
+        nAsyncConnections = 1;
+    }
 #endif
 
     ///- Initialise the world database
-    if(!WorldDatabase.Initialize(dbstring.c_str(), nConnections))
+    if(!WorldDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Cannot connect to world database %s",dbstring.c_str());
         return false;
@@ -462,6 +469,7 @@ bool Master::_StartDB()
 
     dbstring = sConfig.GetStringDefault("CharacterDatabaseInfo", "");
     nConnections = sConfig.GetIntDefault("CharacterDatabaseConnections", 1);
+    nAsyncConnections = sConfig.GetIntDefault("CharacterDatabaseAsyncConnections", 1);
     if(dbstring.empty())
     {
         sLog.outError("Character Database not specified in configuration file");
@@ -470,7 +478,7 @@ bool Master::_StartDB()
         WorldDatabase.HaltDelayThread();
         return false;
     }
-    sLog.outString("Character Database total connections: %i", nConnections + 1);
+    sLog.outString("Character Database total connections: %i", nConnections + nAsyncConnections);
 
 #ifdef MANGOSR2_SINGLE_THREAD
     if (nConnections > 1)
@@ -478,10 +486,16 @@ bool Master::_StartDB()
         sLog.outError(" Your OS (%s) not support set CharacterDatabaseConnections > 1! Resetted to 1", MANGOSR2_SINGLE_THREAD);
         nConnections = 1;
     }
+
+    if (nAsyncConnections > 1)
+    {
+        sLog.outError(" Your OS (%s) not support set CharacterDatabaseAsyncConnections > 1! Resetted to 1", MANGOSR2_SINGLE_THREAD);
+        nAsyncConnections = 1;
+    }
 #endif
 
     ///- Initialise the Character database
-    if(!CharacterDatabase.Initialize(dbstring.c_str(), nConnections))
+    if(!CharacterDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Cannot connect to Character database %s",dbstring.c_str());
 
@@ -501,6 +515,7 @@ bool Master::_StartDB()
     ///- Get login database info from configuration file
     dbstring = sConfig.GetStringDefault("LoginDatabaseInfo", "");
     nConnections = sConfig.GetIntDefault("LoginDatabaseConnections", 1);
+    nAsyncConnections = sConfig.GetIntDefault("LoginDatabaseAsyncConnections", 1);
     if(dbstring.empty())
     {
         sLog.outError("Login database not specified in configuration file");
@@ -512,7 +527,7 @@ bool Master::_StartDB()
     }
 
     ///- Initialise the login database
-    sLog.outString("Login Database total connections: %i", nConnections + 1);
+    sLog.outString("Login Database total connections: %i", nConnections + nAsyncConnections);
 
 #ifdef MANGOSR2_SINGLE_THREAD
     if (nConnections > 1)
@@ -520,9 +535,15 @@ bool Master::_StartDB()
         sLog.outError(" Your OS (%s) not support set LoginDatabaseConnections > 1! Resetted to 1", MANGOSR2_SINGLE_THREAD);
         nConnections = 1;
     }
+
+    if (nAsyncConnections > 1)
+    {
+        sLog.outError(" Your OS (%s) not support set LoginDatabaseAsyncConnections > 1! Resetted to 1", MANGOSR2_SINGLE_THREAD);
+        nAsyncConnections = 1;
+    }
 #endif
 
-    if(!LoginDatabase.Initialize(dbstring.c_str(), nConnections))
+    if(!LoginDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Cannot connect to login database %s",dbstring.c_str());
 
@@ -669,6 +690,8 @@ void Master::_OnSignal(int s)
             }
             else
             {
+                // assertion output is written directly, queued log output must be written before it is lost
+                sLog.FlushAsync();
                 signal(s, SIG_DFL);
                 ACE_OS::kill(getpid(), s);
             }
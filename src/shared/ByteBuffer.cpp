@@ -19,6 +19,233 @@
 #include "ByteBuffer.h"
 #include "Log.h"
 
+#include <ace/TSS_T.h>
+
+namespace
+{
+    const size_t BLOCK_CLASSES      = 11;                   // 64 bytes .. 64K
+    const size_t THREAD_CACHE_BYTES = 64 * 1024;            // per block class and thread
+    const size_t SHARED_CACHE_BYTES = 4 * 1024 * 1024;      // per block class
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    inline size_t BlockClass(size_t size)
+    {
+        size_t idx = 0;
+        for (size_t block = ByteBufferStoragePool::MIN_BLOCK_SIZE; block < size; block <<= 1)
+            ++idx;
+        return idx;
+    }
+
+    inline size_t ClassBlockSize(size_t idx) { return ByteBufferStoragePool::MIN_BLOCK_SIZE << idx; }
+    inline uint32 ThreadCacheLimit(size_t idx) { return uint32(std::max(size_t(4), THREAD_CACHE_BYTES / ClassBlockSize(idx))); }
+
+    struct SharedFreeLists
+    {
+        SharedFreeLists() : bytes(0), heapAllocs(0), cacheRefills(0), largeAllocs(0)
+        {
+            memset(head, 0, sizeof(head));
+            memset(count, 0, sizeof(count));
+        }
+
+        ACE_Thread_Mutex lock;
+        FreeBlock* head[BLOCK_CLASSES];
+        uint32 count[BLOCK_CLASSES];
+        size_t bytes;
+
+        uint64 heapAllocs;
+        uint64 cacheRefills;
+        uint64 largeAllocs;
+    };
+
+    // Never destroyed: thread caches hand their blocks back on thread exit, which may run after static destruction.
+    // Created on first use since packets can be built during static initialization of other units.
+    SharedFreeLists& GetSharedFreeLists()
+    {
+        static SharedFreeLists* lists = new SharedFreeLists;
+        return *lists;
+    }
+
+    struct ThreadCache
+    {
+        ThreadCache()
+        {
+            memset(head, 0, sizeof(head));
+            memset(count, 0, sizeof(count));
+        }
+
+        ~ThreadCache()
+        {
+            for (size_t idx = 0; idx < BLOCK_CLASSES; ++idx)
+                Release(idx, count[idx]);
+        }
+
+        void* Pop(size_t idx)
+        {
+            if (!head[idx])
+                Refill(idx);
+
+            FreeBlock* block = head[idx];
+            head[idx] = block->next;
+            --count[idx];
+            return block;
+        }
+
+        void Push(size_t idx, void* ptr)
+        {
+            FreeBlock* block = static_cast<FreeBlock*>(ptr);
+            block->next = head[idx];
+            head[idx] = block;
+
+            uint32 limit = ThreadCacheLimit(idx);
+            if (++count[idx] > limit)
+                Release(idx, limit / 2);
+        }
+
+        // take half a cache worth of blocks from the shared list, or a single fresh block if it is empty
+        void Refill(size_t idx)
+        {
+            SharedFreeLists& shared = GetSharedFreeLists();
+            uint32 batch = ThreadCacheLimit(idx) / 2;
+            bool fromHeap = false;
+            {
+                ACE_Guard<ACE_Thread_Mutex> guard(shared.lock);
+
+                ++shared.cacheRefills;
+                for (; batch && shared.head[idx]; --batch)
+                {
+                    FreeBlock* block = shared.head[idx];
+                    shared.head[idx] = block->next;
+                    --shared.count[idx];
+                    shared.bytes -= ClassBlockSize(idx);
+
+                    block->next = head[idx];
+                    head[idx] = block;
+                    ++count[idx];
+                }
+
+                if (!head[idx])
+                {
+                    ++shared.heapAllocs;
+                    fromHeap = true;
+                }
+            }
+
+            if (fromHeap)
+            {
+                FreeBlock* block = static_cast<FreeBlock*>(::operator new(ClassBlockSize(idx)));
+                block->next = NULL;
+                head[idx] = block;
+                count[idx] = 1;
+            }
+        }
+
+        // move `num` blocks to the shared list, blocks above its cap go back to the heap
+        void Release(size_t idx, uint32 num)
+        {
+            if (!num)
+                return;
+
+            SharedFreeLists& shared = GetSharedFreeLists();
+            uint32 sharedLimit = uint32(SHARED_CACHE_BYTES / ClassBlockSize(idx));
+            FreeBlock* excess = NULL;
+            {
+                ACE_Guard<ACE_Thread_Mutex> guard(shared.lock);
+
+                for (; num && head[idx]; --num)
+                {
+                    FreeBlock* block = head[idx];
+                    head[idx] = block->next;
+                    --count[idx];
+
+                    if (shared.count[idx] < sharedLimit)
+                    {
+                        block->next = shared.head[idx];
+                        shared.head[idx] = block;
+                        ++shared.count[idx];
+                        shared.bytes += ClassBlockSize(idx);
+                    }
+                    else
+                    {
+                        block->next = excess;
+                        excess = block;
+                    }
+                }
+            }
+
+            while (excess)
+            {
+                FreeBlock* block = excess;
+                excess = block->next;
+                ::operator delete(block);
+            }
+        }
+
+        FreeBlock* head[BLOCK_CLASSES];
+        uint32 count[BLOCK_CLASSES];
+    };
+
+    ThreadCache* GetThreadCache()
+    {
+        static ACE_TSS<ThreadCache>* caches = new ACE_TSS<ThreadCache>;
+        return *caches;
+    }
+}
+
+void* ByteBufferStoragePool::Allocate(size_t size)
+{
+    if (!size)
+        return NULL;
+
+    if (size > MAX_BLOCK_SIZE)
+    {
+        SharedFreeLists& shared = GetSharedFreeLists();
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(shared.lock);
+            ++shared.largeAllocs;
+        }
+        return ::operator new(size);
+    }
+
+    return GetThreadCache()->Pop(BlockClass(size));
+}
+
+void ByteBufferStoragePool::Deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (size > MAX_BLOCK_SIZE)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    GetThreadCache()->Push(BlockClass(size), ptr);
+}
+
+size_t ByteBufferStoragePool::GetBlockSize(size_t size)
+{
+    if (size > MAX_BLOCK_SIZE)
+        return size;
+
+    return ClassBlockSize(BlockClass(size));
+}
+
+void ByteBufferStoragePool::GetStatistics(uint64& heapAllocs, uint64& cacheRefills, uint64& largeAllocs, size_t& sharedBytes)
+{
+    SharedFreeLists& shared = GetSharedFreeLists();
+    ACE_Guard<ACE_Thread_Mutex> guard(shared.lock);
+
+    heapAllocs = shared.heapAllocs;
+    cacheRefills = shared.cacheRefills;
+    largeAllocs = shared.largeAllocs;
+    sharedBytes = shared.bytes;
+}
+
 void ByteBufferException::PrintPosError() const
 {
     char const* traceStr;
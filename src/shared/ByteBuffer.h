@@ -46,24 +46,78 @@ struct Unused
     Unused() {}
 };
 
+/// Size-classed free lists for ByteBuffer storage, with per-thread caches in front of the shared lists
+class ByteBufferStoragePool
+{
+    public:
+        static const size_t MIN_BLOCK_SIZE = 64;
+        static const size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+        static void* Allocate(size_t size);
+        static void Deallocate(void* ptr, size_t size);
+
+        /// Size of the block actually handed out for a request of `size` bytes
+        static size_t GetBlockSize(size_t size);
+
+        static void GetStatistics(uint64& heapAllocs, uint64& cacheRefills, uint64& largeAllocs, size_t& sharedBytes);
+};
+
+template<class T>
+class ByteBufferAllocator
+{
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef T const* const_pointer;
+        typedef T& reference;
+        typedef T const& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template<class U> struct rebind { typedef ByteBufferAllocator<U> other; };
+
+        ByteBufferAllocator() {}
+        ByteBufferAllocator(ByteBufferAllocator const&) {}
+        template<class U> ByteBufferAllocator(ByteBufferAllocator<U> const&) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, void const* = 0) { return static_cast<pointer>(ByteBufferStoragePool::Allocate(n * sizeof(T))); }
+        void deallocate(pointer p, size_type n) { ByteBufferStoragePool::Deallocate(p, n * sizeof(T)); }
+
+        size_type max_size() const { return size_t(-1) / sizeof(T); }
+
+        void construct(pointer p, T const& val) { new((void*)p) T(val); }
+        void destroy(pointer p) { p->~T(); }
+};
+
+template<class T, class U>
+inline bool operator==(ByteBufferAllocator<T> const&, ByteBufferAllocator<U> const&) { return true; }
+template<class T, class U>
+inline bool operator!=(ByteBufferAllocator<T> const&, ByteBufferAllocator<U> const&) { return false; }
+
 class ByteBuffer
 {
     public:
         const static size_t DEFAULT_SIZE = 64;
 
+        typedef std::vector<uint8, ByteBufferAllocator<uint8> > Storage;
+
         // constructor
-        ByteBuffer(): _rpos(0), _wpos(0)
+        ByteBuffer(): _rpos(0), _wpos(0), _storageAllocs(0)
         {
         }
 
         // constructor
-        ByteBuffer(size_t res): _rpos(0), _wpos(0)
+        ByteBuffer(size_t res): _rpos(0), _wpos(0), _storageAllocs(0)
         {
-            _storage.reserve(res);
+            GrowStorage(res);
         }
 
         // copy constructor
-        ByteBuffer(const ByteBuffer &buf): _rpos(buf._rpos), _wpos(buf._wpos), _storage(buf._storage) { }
+        ByteBuffer(const ByteBuffer &buf): _rpos(buf._rpos), _wpos(buf._wpos), _storage(buf._storage),
+            _storageAllocs(buf._storage.empty() ? 0 : 1) { }
 
         void clear()
         {
@@ -337,6 +391,7 @@ class ByteBuffer
 
         void resize(size_t newsize)
         {
+            GrowStorage(newsize);
             _storage.resize(newsize);
             _rpos = 0;
             _wpos = size();
@@ -345,9 +400,12 @@ class ByteBuffer
         void reserve(size_t ressize)
         {
             if (ressize > size())
-                _storage.reserve(ressize);
+                GrowStorage(ressize);
         }
 
+        /// Number of times the storage had to be (re)allocated since construction
+        uint32 GetStorageAllocations() const { return _storageAllocs; }
+
         ByteBuffer& append(const std::string& str)
         {
             return append((uint8 const*)str.c_str(), str.size() + 1);
@@ -371,7 +429,11 @@ class ByteBuffer
             MANGOS_ASSERT(size() < 10000000);
 
             if (_storage.size() < _wpos + cnt)
+            {
+                if (_storage.capacity() < _wpos + cnt)
+                    GrowStorage(std::max(_wpos + cnt, _storage.capacity() * 2));
                 _storage.resize(_wpos + cnt);
+            }
             memcpy(&_storage[_wpos], src, cnt);
             _wpos += cnt;
 
@@ -440,8 +502,19 @@ class ByteBuffer
         }
 
     protected:
+        // storage is always reserved in whole pool blocks, so the vector never regrows on its own
+        void GrowStorage(size_t newsize)
+        {
+            if (newsize <= _storage.capacity())
+                return;
+
+            _storage.reserve(ByteBufferStoragePool::GetBlockSize(newsize));
+            ++_storageAllocs;
+        }
+
         size_t _rpos, _wpos;
-        std::vector<uint8> _storage;
+        Storage _storage;
+        uint32 _storageAllocs;
 };
 
 template <typename T>
@@ -24,6 +24,7 @@
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <algorithm>
 
 #define MIN_CONNECTION_POOL_SIZE 1
 #define MAX_CONNECTION_POOL_SIZE 16
@@ -96,7 +97,7 @@ Database::~Database()
     StopServer();
 }
 
-bool Database::Initialize(const char * infoString, int nConns /*= 1*/)
+bool Database::Initialize(const char * infoString, int nConns /*= 1*/, int nAsyncConns /*= 1*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -133,10 +134,28 @@ bool Database::Initialize(const char * infoString, int nConns /*= 1*/)
         m_pQueryConnections.push_back(pConn);
     }
 
-    //create and initialize connection for async requests
-    m_pAsyncConn = CreateConnection();
-    if(!m_pAsyncConn->Initialize(infoString))
-        return false;
+    //setup async connection pool size, every connection gets own delay thread
+    if(nAsyncConns < MIN_CONNECTION_POOL_SIZE)
+        m_nAsyncConnPoolSize = MIN_CONNECTION_POOL_SIZE;
+    else if(nAsyncConns > MAX_CONNECTION_POOL_SIZE)
+        m_nAsyncConnPoolSize = MAX_CONNECTION_POOL_SIZE;
+    else
+        m_nAsyncConnPoolSize = nAsyncConns;
+
+    //create and initialize connections for async requests
+    for (int i = 0; i < m_nAsyncConnPoolSize; ++i)
+    {
+        SqlConnection * pConn = CreateConnection();
+        if(!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_pAsyncConns.push_back(pConn);
+    }
+
+    m_pAsyncConn = m_pAsyncConns[0];
 
     m_pResultQueue = new SqlResultQueue;
 
@@ -154,11 +173,11 @@ void Database::StopServer()
         m_pResultQueue = NULL;
     }
 
-    if(m_pAsyncConn)
-    {
-        delete m_pAsyncConn;
-        m_pAsyncConn = NULL;
-    }
+    for (size_t i = 0; i < m_pAsyncConns.size(); ++i)
+        delete m_pAsyncConns[i];
+
+    m_pAsyncConns.clear();
+    m_pAsyncConn = NULL;
 
     for (size_t i = 0; i < m_pQueryConnections.size(); ++i)
         delete m_pQueryConnections[i];
@@ -167,30 +186,102 @@ void Database::StopServer()
 
 }
 
-SqlDelayThread * Database::CreateDelayThread()
+SqlDelayThread * Database::CreateDelayThread(SqlConnection * conn, bool pingDatabase)
 {
-    assert(m_pAsyncConn);
-    return new SqlDelayThread(this, m_pAsyncConn);
+    assert(conn);
+    return new SqlDelayThread(this, conn, pingDatabase);
 }
 
 void Database::InitDelayThread()
 {
-    assert(!m_delayThread);
+    assert(m_delayThreads.empty());
 
-    //New delay thread for delay execute
-    m_threadBody = CreateDelayThread();              // will deleted at m_delayThread delete
-    m_delayThread = new ACE_Based::Thread(m_threadBody);
+    //New delay thread for delay execute, per async connection
+    for (size_t i = 0; i < m_pAsyncConns.size(); ++i)
+    {
+        SqlDelayThread * threadBody = CreateDelayThread(m_pAsyncConns[i], i == 0);  // will deleted at thread delete
+        m_threadBodies.push_back(threadBody);
+        m_delayThreads.push_back(new ACE_Based::Thread(threadBody));
+    }
 }
 
 void Database::HaltDelayThread()
 {
-    if (!m_threadBody || !m_delayThread) return;
+    if (m_threadBodies.empty() || m_delayThreads.empty()) return;
+
+    //Stop event for all lanes first, they can wait for each other at barriers while flushing
+    for (size_t i = 0; i < m_threadBodies.size(); ++i)
+        m_threadBodies[i]->Stop();
+
+    for (size_t i = 0; i < m_delayThreads.size(); ++i)
+    {
+        m_delayThreads[i]->wait();                          //Wait for flush to DB
+        delete m_delayThreads[i];                           //This also deletes thread body
+    }
+
+    m_delayThreads.clear();
+    m_threadBodies.clear();
+}
+
+bool Database::DelayAsyncOperation(SqlOperation * op, uint32 serialId /*= 0*/)
+{
+    if (m_threadBodies.size() == 1)
+        return m_threadBodies[0]->Delay(op);
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_laneGuard, false);
+
+    if (serialId == SQL_SERIAL_ALL)
+        return DelayBarrierOperation(op);
+
+    // un-keyed requests stay in first lane, ordering against keyed ones is requested by AsyncFence
+    size_t lane = serialId % m_threadBodies.size();
+    if (lane != 0)
+        m_bLaneFenceNeeded = true;
+
+    return m_threadBodies[lane]->Delay(op);
+}
+
+void Database::AsyncFence()
+{
+    if (m_threadBodies.size() < 2)
+        return;
 
-    m_threadBody->Stop();                                   //Stop event
-    m_delayThread->wait();                                  //Wait for flush to DB
-    delete m_delayThread;                                   //This also deletes m_threadBody
-    m_delayThread = NULL;
-    m_threadBody = NULL;
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_laneGuard);
+
+    // nothing could overtake later requests in first lane if other lanes got nothing since last barrier
+    if (!m_bLaneFenceNeeded)
+        return;
+
+    DelayBarrierOperation(NULL);
+}
+
+bool Database::DelayBarrierOperation(SqlOperation * op)
+{
+    // other lanes wait at the barrier until op is done, so it is ordered with requests queued before and after it
+    m_bLaneFenceNeeded = false;
+
+    SqlLaneBarrier * barrier = new SqlLaneBarrier(m_threadBodies.size() - 1);
+    barrier->AddRef();                                      // hold barrier until all parts are queued
+
+    for (size_t i = 1; i < m_threadBodies.size(); ++i)
+        m_threadBodies[i]->Delay(new SqlLaneFence(barrier));
+
+    bool result = m_threadBodies[0]->Delay(new SqlBarrierOperation(barrier, op));
+    barrier->Release();
+
+    return result;
+}
+
+void Database::GetAsyncStats(SqlDelayStats& stats, bool reset /*= false*/)
+{
+    stats = SqlDelayStats();
+
+    for (size_t i = 0; i < m_threadBodies.size(); ++i)
+    {
+        SqlDelayStats laneStats;
+        m_threadBodies[i]->GetStats(laneStats, reset);
+        stats.Add(laneStats);
+    }
 }
 
 void Database::ThreadStart()
@@ -219,8 +310,16 @@ void Database::escape_string(std::string& str)
     delete[] buf;
 }
 
+void Database::SetThreadQueryConnection(int index)
+{
+    m_QueryConnStorage->m_pConn = index < 0 ? NULL : m_pQueryConnections[index % m_nQueryConnPoolSize];
+}
+
 SqlConnection * Database::getQueryConnection()
 {
+    if (SqlConnection * pConn = m_QueryConnStorage->m_pConn)
+        return pConn;
+
     int nCount = 0;
 
     if(m_nQueryCounter == long(1 << 31))
@@ -235,8 +334,9 @@ void Database::Ping()
 {
     const char * sql = "SELECT 1";
 
+    for (size_t i = 0; i < m_pAsyncConns.size(); ++i)
     {
-        SqlConnection::Lock guard(m_pAsyncConn);
+        SqlConnection::Lock guard(m_pAsyncConns[i]);
         delete guard->Query(sql);
     }
 
@@ -347,7 +447,7 @@ bool Database::Execute(const char *sql)
             return DirectExecute(sql);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPlainRequest(sql));
+        DelayAsyncOperation(new SqlPlainRequest(sql));
     }
 
     return true;
@@ -393,14 +493,14 @@ bool Database::DirectPExecute(const char * format,...)
     return DirectExecute(szQuery);
 }
 
-bool Database::BeginTransaction()
+bool Database::BeginTransaction(uint32 serialId /*= 0*/)
 {
     if (!m_pAsyncConn)
         return false;
 
     //initiate transaction on current thread
     //currently we do not support queued transactions
-    m_TransStorage->init();
+    m_TransStorage->init(serialId);
     return true;
 }
 
@@ -418,8 +518,8 @@ bool Database::CommitTransaction()
         return CommitTransactionDirect();
 
     //add SqlTransaction to the async queue
-    m_threadBody->Delay(m_TransStorage->detach());
-    return true;
+    SqlTransaction * pTrans = m_TransStorage->detach();
+    return DelayAsyncOperation(pTrans, pTrans->GetSerialId());
 }
 
 bool Database::CommitTransactionDirect()
@@ -559,7 +659,7 @@ bool Database::ExecuteStmt( const SqlStatementID& id, SqlStmtParameters * params
             return DirectExecuteStmt(id, params);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPreparedRequest(id.ID(), params));
+        DelayAsyncOperation(new SqlPreparedRequest(id.ID(), params));
     }
 
     return true;
@@ -591,6 +691,8 @@ SqlStatement Database::CreateStatement(SqlStatementID& index, const char * fmt )
         {
             nId = ++m_iStmtIndex;
             m_stmtRegistry[szFmt] = nId;
+            m_stmtRowTemplates.push_back(SqlStmtRowTemplate());
+            ParseStmtRowTemplate(szFmt, m_stmtRowTemplates.back());
         }
         else
             nId = iter->second;
@@ -602,6 +704,134 @@ SqlStatement Database::CreateStatement(SqlStatementID& index, const char * fmt )
     return SqlStatement(index, *this);
 }
 
+int Database::GetCoalescedStmtIndex(int nIndex, uint32 nRows)
+{
+    uint64 key = (uint64(nIndex) << 32) | nRows;
+
+    {
+        LOCK_GUARD _guard(m_coalescedGuard);
+
+        CoalescedStmtRegistry::const_iterator iter = m_coalescedStmts.find(key);
+        if (iter != m_coalescedStmts.end())
+            return iter->second;
+    }
+
+    int nResult = -1;
+
+    SqlStmtRowTemplate tmpl;
+    {
+        LOCK_GUARD _guard(m_stmtGuard);
+        if (nIndex >= 0 && nIndex <= m_iStmtIndex)
+            tmpl = m_stmtRowTemplates[nIndex];
+    }
+
+    if (!tmpl.row.empty())
+    {
+        std::string szMultiFmt = tmpl.head;
+        for (uint32 i = 1; i < nRows; ++i)
+            szMultiFmt += "," + tmpl.row;
+
+        SqlStatementID multiIndex;
+        CreateStatement(multiIndex, szMultiFmt.c_str());
+        nResult = multiIndex.ID();
+    }
+
+    LOCK_GUARD _guard(m_coalescedGuard);
+    m_coalescedStmts[key] = nResult;
+    return nResult;
+}
+
+static bool IsSqlIdentChar(char c)
+{
+    return isalnum((unsigned char)c) || c == '_' || c == '$';
+}
+
+static bool IsSqlKeywordAt(std::string const& str, size_t pos, char const* keyword)
+{
+    size_t len = strlen(keyword);
+    if (pos + len > str.size() || (pos > 0 && IsSqlIdentChar(str[pos - 1])))
+        return false;
+
+    for (size_t i = 0; i < len; ++i)
+        if (toupper((unsigned char)str[pos + i]) != keyword[i])
+            return false;
+
+    return pos + len == str.size() || !IsSqlIdentChar(str[pos + len]);
+}
+
+//only "INSERT/REPLACE ... VALUES (...)" with nothing after the single row can be extended by more rows
+void Database::ParseStmtRowTemplate(std::string const& fmt, SqlStmtRowTemplate& tmpl)
+{
+    size_t nStart = fmt.find_first_not_of(" \t\r\n");
+    if (nStart == std::string::npos || (!IsSqlKeywordAt(fmt, nStart, "INSERT") && !IsSqlKeywordAt(fmt, nStart, "REPLACE")))
+        return;
+
+    size_t nRowStart = std::string::npos;
+    size_t nRowEnd = std::string::npos;
+    bool bValues = false;
+    char quote = 0;
+    int depth = 0;
+
+    for (size_t i = nStart; i < fmt.size(); ++i)
+    {
+        char c = fmt[i];
+
+        if (quote)
+        {
+            if (c == '\\' && quote != '`')
+                ++i;
+            else if (c == quote)
+                quote = 0;
+            continue;
+        }
+
+        //only whitespace and statement terminator allowed after the row
+        if (nRowEnd != std::string::npos)
+        {
+            if (!isspace((unsigned char)c) && c != ';')
+                return;
+            continue;
+        }
+
+        switch (c)
+        {
+            case '\'':
+            case '"':
+            case '`':
+                quote = c;
+                break;
+            case '(':
+                if (depth == 0 && bValues)
+                    nRowStart = i;
+                ++depth;
+                break;
+            case ')':
+                if (depth == 0)
+                    return;
+                if (--depth == 0 && nRowStart != std::string::npos)
+                    nRowEnd = i;
+                break;
+            default:
+                if (depth != 0)
+                    break;
+                if (!bValues && IsSqlKeywordAt(fmt, i, "VALUES"))
+                {
+                    bValues = true;
+                    i += 5;
+                }
+                else if (bValues && !isspace((unsigned char)c))
+                    return;                                 // "VALUES" followed by something else than row
+                break;
+        }
+    }
+
+    if (nRowEnd == std::string::npos || quote)
+        return;
+
+    tmpl.head = fmt.substr(0, nRowEnd + 1);
+    tmpl.row = fmt.substr(nRowStart, nRowEnd - nRowStart + 1);
+}
+
 std::string Database::GetStmtString(const int stmtId) const
 {
     LOCK_GUARD _guard(m_stmtGuard);
@@ -625,10 +855,10 @@ Database::TransHelper::~TransHelper()
     reset();
 }
 
-SqlTransaction * Database::TransHelper::init()
+SqlTransaction * Database::TransHelper::init(uint32 serialId)
 {
     MANGOS_ASSERT(!m_pTrans);   //if we will get a nested transaction request - we MUST fix code!!!
-    m_pTrans = new SqlTransaction;
+    m_pTrans = new SqlTransaction(serialId);
     return m_pTrans;
 }
 
@@ -36,6 +36,7 @@ class SqlParamBinder;
 class Database;
 
 #define MAX_QUERY_LEN   (32*1024)
+#define MAX_COALESCED_INSERT_ROWS 32                        // rows of one multi-row INSERT built from transaction statements
 
 //
 class MANGOS_DLL_SPEC SqlConnection
@@ -100,15 +101,26 @@ class MANGOS_DLL_SPEC SqlConnection
         StmtHolder m_holder;
 };
 
+// single-row INSERT statement split for building its multi-row variants: head + ("," + row) * (rows - 1)
+// serial id of async requests ordered with requests of all serial ids, see Database::BeginTransaction
+#define SQL_SERIAL_ALL 0xFFFFFFFF
+
+struct SqlStmtRowTemplate
+{
+    std::string head;                                       // statement up to end of its row
+    std::string row;                                        // "(...)" row, empty if statement can't be coalesced
+};
+
 class MANGOS_DLL_SPEC Database
 {
     public:
         virtual ~Database();
 
-        virtual bool Initialize(const char *infoString, int nConns = 1);
-        //start worker thread for async DB request execution
+        // nConns connections for sync queries, nAsyncConns connections (each with own thread) for async requests
+        virtual bool Initialize(const char *infoString, int nConns = 1, int nAsyncConns = 1);
+        //start worker threads for async DB request execution
         virtual void InitDelayThread();
-        //stop worker thread
+        //stop worker threads
         virtual void HaltDelayThread();
 
         /// Synchronous DB queries
@@ -184,12 +196,19 @@ class MANGOS_DLL_SPEC Database
         // Writes SQL commands to a LOG file (see mangosd.conf "LogSQL")
         bool PExecuteLog(const char *format,...) ATTR_PRINTF(2,3);
 
-        bool BeginTransaction();
+        // transactions with same serialId are executed in order on one async connection,
+        // possibly in parallel with other serial ids; serialId 0 requests share the first connection,
+        // SQL_SERIAL_ALL transactions are executed in order with all async requests (data of several serial ids)
+        bool BeginTransaction(uint32 serialId = 0);
         bool CommitTransaction();
         bool RollbackTransaction();
         //for sync transaction execution
         bool CommitTransactionDirect();
 
+        // later async requests with serialId 0 are executed only after all async requests queued before,
+        // use where un-keyed request depends on keyed ones (e.g. reads data saved under other serial ids)
+        void AsyncFence();
+
         //PREPARED STATEMENT API
 
         //allocate index for prepared statement with SQL request 'fmt'
@@ -207,6 +226,9 @@ class MANGOS_DLL_SPEC Database
         // must be called before finish thread run (one time for thread using one from existing Database objects)
         virtual void ThreadEnd();
 
+        // binds sync queries of calling thread to query connection index % pool size, -1 restores round-robin selection
+        void SetThreadQueryConnection(int index);
+
         // set database-wide result queue. also we should use object-bases and not thread-based result queues
         void ProcessResultQueue();
 
@@ -216,16 +238,26 @@ class MANGOS_DLL_SPEC Database
         //function to ping database connections
         void Ping();
 
+        // async queues statistics summed over all async connections
+        void GetAsyncStats(SqlDelayStats& stats, bool reset = false);
+        uint32 GetAsyncConnectionsCount() const { return m_threadBodies.size(); }
+        uint64 GetCoalescedRows() const { return uint64(m_nCoalescedRows.value()); }
+
+        // statement index of nRows-row variant of single-row INSERT statement nIndex, -1 if statement can't be coalesced
+        int GetCoalescedStmtIndex(int nIndex, uint32 nRows);
+        void AddCoalescedRows(uint32 nRows) { m_nCoalescedRows += nRows; }
+
         //set this to allow async transactions
         //you should call it explicitly after your server successfully started up
         //NO ASYNC TRANSACTIONS DURING SERVER STARTUP - ONLY DURING RUNTIME!!!
         void AllowAsyncTransactions() { m_bAllowAsyncTransactions = true; }
 
     protected:
-        Database(): m_nQueryConnPoolSize(1), m_pAsyncConn(NULL), m_pResultQueue(NULL), m_threadBody(NULL), m_delayThread(NULL),
+        Database(): m_nQueryConnPoolSize(1), m_nAsyncConnPoolSize(1), m_pAsyncConn(NULL), m_pResultQueue(NULL), m_bLaneFenceNeeded(false),
             m_bAllowAsyncTransactions(false), m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
         {
             m_nQueryCounter = -1;
+            m_nCoalescedRows = 0;
         }
 
         void StopServer();
@@ -233,7 +265,7 @@ class MANGOS_DLL_SPEC Database
         //factory method to create SqlConnection objects
         virtual SqlConnection * CreateConnection() = 0;
         //factory method to create SqlDelayThread objects
-        virtual SqlDelayThread * CreateDelayThread();
+        virtual SqlDelayThread * CreateDelayThread(SqlConnection * conn, bool pingDatabase);
 
         class MANGOS_DLL_SPEC TransHelper
         {
@@ -242,7 +274,7 @@ class MANGOS_DLL_SPEC Database
                 ~TransHelper();
 
                 //initializes new SqlTransaction object
-                SqlTransaction * init();
+                SqlTransaction * init(uint32 serialId);
                 //gets pointer on current transaction object. Returns NULL if transaction was not initiated
                 SqlTransaction * get() const { return m_pTrans; }
                 //detaches SqlTransaction object allocated by init() function
@@ -260,14 +292,35 @@ class MANGOS_DLL_SPEC Database
         typedef ACE_TSS<Database::TransHelper> DBTransHelperTSS;
         Database::DBTransHelperTSS m_TransStorage;
 
+        class MANGOS_DLL_SPEC QueryConnHelper
+        {
+            public:
+                QueryConnHelper() : m_pConn(NULL) {}
+
+                SqlConnection * m_pConn;
+        };
+
+        //per-thread query connection binding, see SetThreadQueryConnection
+        typedef ACE_TSS<Database::QueryConnHelper> DBQueryConnHelperTSS;
+        Database::DBQueryConnHelperTSS m_QueryConnStorage;
+
         ///< DB connections
 
-        //round-robin connection selection
+        //round-robin connection selection, unless calling thread is bound to a connection
         SqlConnection * getQueryConnection();
-        //for now return one single connection for async requests
+        //connection of first async lane, also used for direct execution
         SqlConnection * getAsyncConnection() const { return m_pAsyncConn; }
 
+        //put request to async lane selected by serialId, see BeginTransaction
+        bool DelayAsyncOperation(SqlOperation * op, uint32 serialId = 0);
+        //queue op (may be NULL) in first lane behind a barrier of all lanes, m_laneGuard must be held
+        bool DelayBarrierOperation(SqlOperation * op);
+
+        //fill multi-row template of statement format, left empty if statement can't be extended by more rows
+        static void ParseStmtRowTemplate(std::string const& fmt, SqlStmtRowTemplate& tmpl);
+
         friend class SqlStatement;
+        friend class SqlQueryHolder;
         //PREPARED STATEMENT API
         //query function for prepared statements
         bool ExecuteStmt(const SqlStatementID& id, SqlStmtParameters * params);
@@ -281,12 +334,20 @@ class MANGOS_DLL_SPEC Database
         typedef std::vector< SqlConnection * > SqlConnectionContainer;
         SqlConnectionContainer m_pQueryConnections;
 
-        //only one single DB connection for transactions
-        SqlConnection * m_pAsyncConn;
+        //DB connections for async requests and transactions, one per lane
+        int m_nAsyncConnPoolSize;
+        SqlConnectionContainer m_pAsyncConns;
+        SqlConnection * m_pAsyncConn;                        ///< first async connection
 
         SqlResultQueue *    m_pResultQueue;                  ///< Transaction queues from diff. threads
-        SqlDelayThread *    m_threadBody;                    ///< Pointer to delay sql executer (owned by m_delayThread)
-        ACE_Based::Thread * m_delayThread;                   ///< Pointer to executer thread
+
+        typedef std::vector<SqlDelayThread*> SqlDelayThreadContainer;
+        typedef std::vector<ACE_Based::Thread*> DelayThreadContainer;
+        SqlDelayThreadContainer m_threadBodies;              ///< Delay sql executers (owned by m_delayThreads)
+        DelayThreadContainer m_delayThreads;                 ///< Executer threads, one per async connection
+
+        ACE_Thread_Mutex m_laneGuard;                        ///< Serializes dispatch to lanes
+        bool m_bLaneFenceNeeded;                             ///< lanes except first got requests since last barrier
 
         bool m_bAllowAsyncTransactions;                      ///< flag which specifies if async transactions are enabled
 
@@ -301,6 +362,14 @@ class MANGOS_DLL_SPEC Database
 
         int m_iStmtIndex;
 
+        typedef std::vector<SqlStmtRowTemplate> StmtRowTemplates;
+        StmtRowTemplates m_stmtRowTemplates;                 ///< multi-row templates by stmt index
+
+        typedef UNORDERED_MAP<uint64, int> CoalescedStmtRegistry;
+        CoalescedStmtRegistry m_coalescedStmts;              ///< (stmt index, rows) -> multi-row stmt index
+        LOCK_TYPE m_coalescedGuard;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_nCoalescedRows;
+
     private:
 
         bool m_logSQL;
@@ -17,6 +17,8 @@
  */
 
 #include "SQLStorage.h"
+#include <ace/Mem_Map.h>
+#include <ace/OS_NS_stdio.h>
 
 // -----------------------------------  SQLStorageBase  ---------------------------------------- //
 
@@ -235,3 +237,247 @@ SQLMultiStorage::SQLMultiStorage(const char* src_fmt, const char* dst_fmt, const
 {
     Initialize(sqlname, _entry_field, src_fmt, dst_fmt);
 }
+
+// -----------------------------------  SQLStorageSnapshot  ------------------------------------ //
+
+#define SQL_STORAGE_SNAPSHOT_VERSION    1
+
+struct SQLStorageSnapshotHeader
+{
+    char magic[4];                                          // "SQLS"
+    uint32 version;
+    uint64 checksum;                                        // CHECKSUM TABLE of the source table
+    uint32 maxEntry;
+    uint32 recordCount;
+    uint32 formatLength;                                    // source format string follows the header, then the rows
+};
+
+std::string SQLStorageSnapshot::m_directory;
+
+SQLStorageSnapshot::SQLStorageSnapshot(char const* tableName, char const* srcFormat) :
+    m_tableName(tableName),
+    m_srcFormat(srcFormat),
+    m_checksum(0),
+    m_mappedFile(NULL),
+    m_readPos(NULL),
+    m_readEnd(NULL),
+    m_maxEntry(0),
+    m_recordCount(0),
+    m_rowsRead(0),
+    m_rowCount(0)
+{
+}
+
+SQLStorageSnapshot::~SQLStorageSnapshot()
+{
+    Close();
+}
+
+std::string SQLStorageSnapshot::GetFileName() const
+{
+    return m_directory + m_tableName + ".snapshot";
+}
+
+void SQLStorageSnapshot::Close()
+{
+    if (m_mappedFile)
+    {
+        m_mappedFile->close();
+        delete m_mappedFile;
+        m_mappedFile = NULL;
+    }
+
+    m_readPos = NULL;
+    m_readEnd = NULL;
+}
+
+bool SQLStorageSnapshot::Open(uint32 maxEntry, uint32 recordCount)
+{
+    if (!IsEnabled())
+        return false;
+
+    QueryResult* result = WorldDatabase.PQuery("CHECKSUM TABLE %s", m_tableName);
+    if (!result)
+        return false;
+
+    // NULL checksum for not existing table
+    m_checksum = result->GetFieldCount() > 1 ? (*result)[1].GetUInt64() : 0;
+    delete result;
+
+    if (!m_checksum)
+        return false;
+
+    m_mappedFile = new ACE_Mem_Map();
+    if (m_mappedFile->map(GetFileName().c_str(), static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ, ACE_MAP_PRIVATE) != 0 ||
+        m_mappedFile->addr() == MAP_FAILED || m_mappedFile->size() < sizeof(SQLStorageSnapshotHeader))
+    {
+        Close();
+        return false;
+    }
+
+    m_readPos = static_cast<char const*>(m_mappedFile->addr());
+    m_readEnd = m_readPos + m_mappedFile->size();
+
+    SQLStorageSnapshotHeader header;
+    memcpy(&header, m_readPos, sizeof(header));
+    m_readPos += sizeof(header);
+
+    uint32 formatLength = strlen(m_srcFormat);
+    if (memcmp(header.magic, "SQLS", 4) != 0 || header.version != SQL_STORAGE_SNAPSHOT_VERSION || header.checksum != m_checksum ||
+        header.maxEntry != maxEntry || header.recordCount != recordCount || header.formatLength != formatLength ||
+        uint32(m_readEnd - m_readPos) < formatLength || memcmp(m_readPos, m_srcFormat, formatLength) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    m_readPos += formatLength;
+    m_maxEntry = maxEntry;
+    m_recordCount = recordCount;
+    m_rowsRead = 0;
+    m_values.resize(formatLength);
+    return true;
+}
+
+bool SQLStorageSnapshot::NextRow()
+{
+    if (!m_readPos || m_rowsRead >= m_recordCount)
+        return false;
+
+    for (uint32 y = 0; m_srcFormat[y]; ++y)
+    {
+        switch (m_srcFormat[y])
+        {
+            case FT_LOGIC:
+            case FT_INT:
+                if (uint32(m_readEnd - m_readPos) < sizeof(uint32))
+                    return false;
+                memcpy(&m_values[y].u, m_readPos, sizeof(uint32));
+                m_readPos += sizeof(uint32);
+                break;
+            case FT_BYTE:
+                if (m_readPos == m_readEnd)
+                    return false;
+                m_values[y].u = uint8(*m_readPos);
+                ++m_readPos;
+                break;
+            case FT_FLOAT:
+                if (uint32(m_readEnd - m_readPos) < sizeof(float))
+                    return false;
+                memcpy(&m_values[y].f, m_readPos, sizeof(float));
+                m_readPos += sizeof(float);
+                break;
+            case FT_STRING:
+            {
+                // not NULL flag, then zero terminated string
+                if (m_readPos == m_readEnd)
+                    return false;
+
+                if (!*m_readPos++)
+                {
+                    m_values[y].s = NULL;
+                    break;
+                }
+
+                char const* end = static_cast<char const*>(memchr(m_readPos, 0, m_readEnd - m_readPos));
+                if (!end)
+                    return false;
+
+                m_values[y].s = m_readPos;
+                m_readPos = end + 1;
+                break;
+            }
+            default:                                        // not loaded source fields are not stored
+                break;
+        }
+    }
+
+    // checksum covers table content only, damaged file could index outside of the storage
+    if (m_values[0].u >= m_maxEntry)
+        return false;
+
+    ++m_rowsRead;
+    return true;
+}
+
+void SQLStorageSnapshot::AddRow(Field const* fields)
+{
+    if (!m_checksum)
+        return;
+
+    for (uint32 y = 0; m_srcFormat[y]; ++y)
+    {
+        switch (m_srcFormat[y])
+        {
+            case FT_LOGIC:
+            case FT_INT:
+            {
+                uint32 value = fields[y].GetUInt32();
+                m_rows.insert(m_rows.end(), (char const*)&value, (char const*)&value + sizeof(value));
+                break;
+            }
+            case FT_BYTE:
+                m_rows.push_back(char(fields[y].GetUInt8()));
+                break;
+            case FT_FLOAT:
+            {
+                float value = fields[y].GetFloat();
+                m_rows.insert(m_rows.end(), (char const*)&value, (char const*)&value + sizeof(value));
+                break;
+            }
+            case FT_STRING:
+            {
+                char const* value = fields[y].GetString();
+                m_rows.push_back(value ? 1 : 0);
+                if (value)
+                    m_rows.insert(m_rows.end(), value, value + strlen(value) + 1);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    ++m_rowCount;
+}
+
+void SQLStorageSnapshot::Save(uint32 maxEntry, uint32 recordCount)
+{
+    if (!m_checksum || m_rowCount != recordCount)
+        return;
+
+    Close();
+
+    SQLStorageSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "SQLS", 4);
+    header.version = SQL_STORAGE_SNAPSHOT_VERSION;
+    header.checksum = m_checksum;
+    header.maxEntry = maxEntry;
+    header.recordCount = recordCount;
+    header.formatLength = strlen(m_srcFormat);
+
+    // write to temporary file, so a crash never leaves a partial snapshot under the final name
+    std::string fileName = GetFileName();
+    std::string tmpName = fileName + ".tmp";
+
+    FILE* out = fopen(tmpName.c_str(), "wb");
+    if (!out)
+    {
+        sLog.outError("SQLStorageSnapshot: can't create snapshot file %s", tmpName.c_str());
+        return;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                   fwrite(m_srcFormat, 1, header.formatLength, out) == header.formatLength &&
+                   (m_rows.empty() || fwrite(&m_rows[0], 1, m_rows.size(), out) == m_rows.size());
+    written = fclose(out) == 0 && written;
+
+    if (!written || ACE_OS::rename(tmpName.c_str(), fileName.c_str()) != 0)
+    {
+        sLog.outError("SQLStorageSnapshot: can't write snapshot file %s", fileName.c_str());
+        remove(tmpName.c_str());
+    }
+
+    std::vector<char>().swap(m_rows);
+}
@@ -23,6 +23,8 @@
 #include "Database/DatabaseEnv.h"
 #include "DBCFileLoader.h"
 
+class ACE_Mem_Map;
+
 class SQLStorageBase
 {
     template<class DerivedLoader, class StorageClass> friend class SQLStorageLoaderBase;
@@ -240,6 +242,87 @@ class SQLMultiStorage : public SQLStorageBase
         RecordMultiMap m_indexMultiMap;
 };
 
+/// Source values of a row of the storage table query
+class SQLStorageQueryRow
+{
+    public:
+        explicit SQLStorageQueryRow(Field const* fields) : m_fields(fields) {}
+
+        uint32 GetUInt32(uint32 idx) const { return m_fields[idx].GetUInt32(); }
+        uint8 GetUInt8(uint32 idx) const { return m_fields[idx].GetUInt8(); }
+        float GetFloat(uint32 idx) const { return m_fields[idx].GetFloat(); }
+        char const* GetString(uint32 idx) const { return m_fields[idx].GetString(); }
+
+    private:
+        Field const* m_fields;
+};
+
+/**
+ * Binary on-disk copy of the source rows of a storage table.
+ *
+ * The file is keyed by CHECKSUM TABLE of the source table and by the source format, so it is used instead of
+ * the text protocol query only while the table is unchanged. Rows are kept as source values, the loader
+ * converts them as if read from the query, so loader specific conversions (script names etc.) stay current.
+ * Snapshots are disabled while no directory is set.
+ */
+class SQLStorageSnapshot
+{
+    public:
+        static void SetDirectory(std::string const& dir) { m_directory = dir; }
+        static bool IsEnabled() { return !m_directory.empty(); }
+
+        SQLStorageSnapshot(char const* tableName, char const* srcFormat);
+        ~SQLStorageSnapshot();
+
+        /// Get the table checksum and map an up-to-date snapshot file, false if the table has to be queried
+        bool Open(uint32 maxEntry, uint32 recordCount);
+
+        /// Advance to next row of the opened snapshot, false at end or at corrupted data (including entry out of range)
+        bool NextRow();
+        bool IsAllRead() const { return m_rowsRead == m_recordCount; }
+
+        uint32 GetUInt32(uint32 idx) const { return m_values[idx].u; }
+        uint8 GetUInt8(uint32 idx) const { return uint8(m_values[idx].u); }
+        float GetFloat(uint32 idx) const { return m_values[idx].f; }
+        char const* GetString(uint32 idx) const { return m_values[idx].s; }
+
+        /// Collect a row of the table query for saving, only when the checksum is known
+        void AddRow(Field const* fields);
+
+        /// Write the collected rows as new snapshot file
+        void Save(uint32 maxEntry, uint32 recordCount);
+
+    private:
+        union Value
+        {
+            uint32 u;
+            float f;
+            char const* s;
+        };
+
+        std::string GetFileName() const;
+        void Close();
+
+        static std::string m_directory;
+
+        char const* m_tableName;
+        char const* m_srcFormat;
+        uint64 m_checksum;                                  // 0 if not known
+
+        // reading
+        ACE_Mem_Map* m_mappedFile;
+        char const* m_readPos;
+        char const* m_readEnd;
+        uint32 m_maxEntry;                                  // entries of read rows must be below, they index the storage
+        uint32 m_recordCount;
+        uint32 m_rowsRead;
+        std::vector<Value> m_values;
+
+        // writing
+        std::vector<char> m_rows;
+        uint32 m_rowCount;
+};
+
 template <class DerivedLoader, class StorageClass>
 class SQLStorageLoaderBase
 {
@@ -263,6 +346,9 @@ class SQLStorageLoaderBase
         void convert_str_to_str(uint32 field_pos, char* src, char*& dst);
 
     private:
+        template<class R>
+        void storeRecord(StorageClass& store, R const& row);
+
         template<class V>
         void storeValue(V value, StorageClass& store, char* record, uint32 field_pos, uint32& offset);
         void storeValue(char const* value, StorageClass& store, char* record, uint32 field_pos, uint32& offset);
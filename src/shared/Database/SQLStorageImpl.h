@@ -189,30 +189,7 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
         delete result;
     }
 
-    result = WorldDatabase.PQuery("SELECT * FROM %s", store.GetTableName());
-
-    if(!result)
-    {
-        if (error_at_empty)
-            sLog.outError("%s table is empty!\n", store.GetTableName());
-        else
-            sLog.outString("%s table is empty!\n", store.GetTableName());
-
-        recordCount = 0;
-        return;
-    }
-
-    if (store.GetSrcFieldCount() != result->GetFieldCount())
-    {
-        recordCount = 0;
-        sLog.outError("Error in %s table, probably sql file format was updated (there should be %d fields in sql).\n", store.GetTableName(), store.GetSrcFieldCount());
-        delete result;
-        Log::WaitBeforeContinueIfNeed();
-        exit(1);                                            // Stop server at loading broken or non-compatible table.
-    }
-
     // get struct size
-    uint32 offset = 0;
     for (uint32 x = 0; x < store.GetDstFieldCount(); ++x)
     {
         switch (store.GetDstFormat(x))
@@ -245,6 +222,50 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
         }
     }
 
+    // Unchanged table can be read from snapshot, fall back to the query at any snapshot problem
+    SQLStorageSnapshot snapshot(store.GetTableName(), store.GetSrcFormat());
+    if (recordCount && snapshot.Open(maxRecordId, recordCount))
+    {
+        store.prepareToLoad(maxRecordId, recordCount, recordsize);
+
+        BarGoLink bar(recordCount);
+        while (snapshot.NextRow())
+        {
+            bar.step();
+            storeRecord(store, snapshot);
+        }
+
+        if (snapshot.IsAllRead())
+        {
+            sLog.outDetail("Loaded %s from snapshot", store.GetTableName());
+            return;
+        }
+
+        sLog.outError("Snapshot of %s table is corrupted, loading from database", store.GetTableName());
+    }
+
+    result = WorldDatabase.PQuery("SELECT * FROM %s", store.GetTableName());
+
+    if(!result)
+    {
+        if (error_at_empty)
+            sLog.outError("%s table is empty!\n", store.GetTableName());
+        else
+            sLog.outString("%s table is empty!\n", store.GetTableName());
+
+        recordCount = 0;
+        return;
+    }
+
+    if (store.GetSrcFieldCount() != result->GetFieldCount())
+    {
+        recordCount = 0;
+        sLog.outError("Error in %s table, probably sql file format was updated (there should be %d fields in sql).\n", store.GetTableName(), store.GetSrcFieldCount());
+        delete result;
+        Log::WaitBeforeContinueIfNeed();
+        exit(1);                                            // Stop server at loading broken or non-compatible table.
+    }
+
     // Prepare data storage and lookup storage
     store.prepareToLoad(maxRecordId, recordCount, recordsize);
 
@@ -254,57 +275,67 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
         fields = result->Fetch();
         bar.step();
 
-        char* record = store.createRecord(fields[0].GetUInt32());
-        offset = 0;
-
-        // dependend on dest-size
-        // iterate two indexes: x over dest, y over source
-        //                      y++ If and only If x != FT_NA*
-        //                      x++ If and only If a value is stored
-        for (uint32 x = 0, y = 0; x < store.GetDstFieldCount();)
-        {
-            switch (store.GetDstFormat(x))
-            {
-                    // For default fill continue and do not increase y
-                case FT_NA:         storeValue((uint32)0, store, record, x, offset);         ++x; continue;
-                case FT_NA_BYTE:    storeValue((char)0, store, record, x, offset);           ++x; continue;
-                case FT_NA_FLOAT:   storeValue((float)0.0f, store, record, x, offset);       ++x; continue;
-                case FT_NA_POINTER: storeValue((char const*)NULL, store, record, x, offset); ++x; continue;
-                default:
-                    break;
-            }
-
-            // It is required that the input has at least as many columns set as the output requires
-            if (y >= store.GetSrcFieldCount())
-                assert(false && "SQL storage has too few columns!");
-
-            switch (store.GetSrcFormat(y))
-            {
-                case FT_LOGIC:  storeValue((bool)(fields[y].GetUInt32() > 0), store, record, x, offset);  ++x; break;
-                case FT_BYTE:   storeValue((char)fields[y].GetUInt8(), store, record, x, offset);         ++x; break;
-                case FT_INT:    storeValue((uint32)fields[y].GetUInt32(), store, record, x, offset);      ++x; break;
-                case FT_FLOAT:  storeValue((float)fields[y].GetFloat(), store, record, x, offset);        ++x; break;
-                case FT_STRING: storeValue((char const*)fields[y].GetString(), store, record, x, offset); ++x; break;
-                case FT_NA:
-                case FT_NA_BYTE:
-                case FT_NA_FLOAT:
-                    // Do Not increase x
-                    break;
-                case FT_IND:
-                case FT_SORT:
-                case FT_NA_POINTER:
-                    assert(false && "SQL storage not have sort or pointer field types");
-                    break;
-                default:
-                    assert(false && "unknown format character");
-                    break;
-            }
-            ++y;
-        }
+        storeRecord(store, SQLStorageQueryRow(fields));
+        snapshot.AddRow(fields);
     }
     while (result->NextRow());
 
     delete result;
+
+    snapshot.Save(maxRecordId, recordCount);
+}
+
+template<class DerivedLoader, class StorageClass>
+template<class R>                                           // R row-type, SQLStorageQueryRow or SQLStorageSnapshot
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeRecord(StorageClass& store, R const& row)
+{
+    char* record = store.createRecord(row.GetUInt32(0));
+    uint32 offset = 0;
+
+    // dependend on dest-size
+    // iterate two indexes: x over dest, y over source
+    //                      y++ If and only If x != FT_NA*
+    //                      x++ If and only If a value is stored
+    for (uint32 x = 0, y = 0; x < store.GetDstFieldCount();)
+    {
+        switch (store.GetDstFormat(x))
+        {
+                // For default fill continue and do not increase y
+            case FT_NA:         storeValue((uint32)0, store, record, x, offset);         ++x; continue;
+            case FT_NA_BYTE:    storeValue((char)0, store, record, x, offset);           ++x; continue;
+            case FT_NA_FLOAT:   storeValue((float)0.0f, store, record, x, offset);       ++x; continue;
+            case FT_NA_POINTER: storeValue((char const*)NULL, store, record, x, offset); ++x; continue;
+            default:
+                break;
+        }
+
+        // It is required that the input has at least as many columns set as the output requires
+        if (y >= store.GetSrcFieldCount())
+            assert(false && "SQL storage has too few columns!");
+
+        switch (store.GetSrcFormat(y))
+        {
+            case FT_LOGIC:  storeValue((bool)(row.GetUInt32(y) > 0), store, record, x, offset);  ++x; break;
+            case FT_BYTE:   storeValue((char)row.GetUInt8(y), store, record, x, offset);         ++x; break;
+            case FT_INT:    storeValue((uint32)row.GetUInt32(y), store, record, x, offset);      ++x; break;
+            case FT_FLOAT:  storeValue((float)row.GetFloat(y), store, record, x, offset);        ++x; break;
+            case FT_STRING: storeValue((char const*)row.GetString(y), store, record, x, offset); ++x; break;
+            case FT_NA:
+            case FT_NA_BYTE:
+            case FT_NA_FLOAT:
+                // Do Not increase x
+                break;
+            case FT_IND:
+            case FT_SORT:
+            case FT_NA_POINTER:
+                assert(false && "SQL storage not have sort or pointer field types");
+                break;
+            default:
+                assert(false && "unknown format character");
+                break;
+        }
+        ++y;
+    }
 }
 
 #endif
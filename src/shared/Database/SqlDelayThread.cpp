@@ -19,8 +19,22 @@
 #include "Database/SqlDelayThread.h"
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
+#include "Timer.h"
 
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+#include <ace/OS_NS_sys_time.h>
+
+void SqlDelayStats::Add(SqlDelayStats const& stats)
+{
+    queueDepth += stats.queueDepth;
+    maxQueueDepth = std::max(maxQueueDepth, stats.maxQueueDepth);
+    executed += stats.executed;
+    totalWaitTime += stats.totalWaitTime;
+    maxWaitTime = std::max(maxWaitTime, stats.maxWaitTime);
+    totalExecTime += stats.totalExecTime;
+}
+
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn, bool pingDatabase /*= true*/) :
+    m_queueCondition(m_queueLock), m_dbEngine(db), m_dbConnection(conn), m_running(true), m_pingDatabase(pingDatabase)
 {
 }
 
@@ -30,32 +44,72 @@ SqlDelayThread::~SqlDelayThread()
     ProcessRequests();
 }
 
+bool SqlDelayThread::Delay(SqlOperation* sql)
+{
+    sql->SetQueueTime(WorldTimer::getMSTime());
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_queueLock, false);
+
+    m_sqlQueue.push_back(sql);
+
+    if (m_sqlQueue.size() > m_stats.maxQueueDepth)
+        m_stats.maxQueueDepth = m_sqlQueue.size();
+
+    // thread sleeps only with empty queue
+    if (m_sqlQueue.size() == 1)
+        m_queueCondition.signal();
+
+    return true;
+}
+
+void SqlDelayThread::GetStats(SqlDelayStats& stats, bool reset)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_queueLock);
+
+    stats = m_stats;
+    stats.queueDepth = m_sqlQueue.size();
+
+    if (reset)
+    {
+        m_stats = SqlDelayStats();
+        m_stats.maxQueueDepth = stats.queueDepth;
+    }
+}
+
 void SqlDelayThread::run()
 {
     #ifndef DO_POSTGRESQL
     mysql_thread_init();
     #endif
 
-    const uint32 loopSleepms = 10;
-
-    const uint32 pingEveryLoop = m_dbEngine->GetPingIntervall() / loopSleepms;
+    uint32 pingTime = WorldTimer::getMSTime();
 
-    uint32 loopCounter = 0;
+    // if the running state gets turned off while waiting
+    // empty the queue before exiting, other lanes can wait for requests in it
     while (m_running)
     {
-        // if the running state gets turned off while sleeping
-        // empty the queue before exiting
-        ACE_Based::Thread::Sleep(loopSleepms);
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_queueLock);
+
+            if (m_sqlQueue.empty() && m_running)
+            {
+                uint32 waitTime = m_pingDatabase ? m_dbEngine->GetPingIntervall() : 1000;
+                ACE_Time_Value timeout = ACE_OS::gettimeofday() + ACE_Time_Value(waitTime / 1000, (waitTime % 1000) * 1000);
+                m_queueCondition.wait(&timeout);
+            }
+        }
 
         ProcessRequests();
 
-        if((loopCounter++) >= pingEveryLoop)
+        if (m_pingDatabase && WorldTimer::getMSTimeDiff(pingTime, WorldTimer::getMSTime()) >= m_dbEngine->GetPingIntervall())
         {
-            loopCounter = 0;
+            pingTime = WorldTimer::getMSTime();
             m_dbEngine->Ping();
         }
     }
 
+    ProcessRequests();
+
     #ifndef DO_POSTGRESQL
     mysql_thread_end();
     #endif
@@ -63,15 +117,44 @@ void SqlDelayThread::run()
 
 void SqlDelayThread::Stop()
 {
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_queueLock);
+
     m_running = false;
+    m_queueCondition.signal();
 }
 
 void SqlDelayThread::ProcessRequests()
 {
-    SqlOperation* s = NULL;
-    while (m_sqlQueue.next(s))
+    SqlQueue queue;
+
     {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_queueLock);
+        queue.swap(m_sqlQueue);
+    }
+
+    if (queue.empty())
+        return;
+
+    SqlDelayStats stats;
+
+    for (SqlQueue::const_iterator itr = queue.begin(); itr != queue.end(); ++itr)
+    {
+        SqlOperation* s = *itr;
+
+        uint32 startTime = WorldTimer::getMSTime();
+        uint32 waitTime = WorldTimer::getMSTimeDiff(s->GetQueueTime(), startTime);
+
         s->Execute(m_dbConnection);
         delete s;
+
+        stats.totalExecTime += WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime());
+        stats.totalWaitTime += waitTime;
+        stats.maxWaitTime = std::max(stats.maxWaitTime, waitTime);
+        ++stats.executed;
     }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_queueLock);
+    stats.queueDepth = 0;
+    stats.maxQueueDepth = 0;
+    m_stats.Add(stats);
 }
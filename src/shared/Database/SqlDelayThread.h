@@ -20,33 +20,57 @@
 #define __SQLDELAYTHREAD_H
 
 #include "ace/Thread_Mutex.h"
-#include "LockedQueue.h"
+#include "ace/Condition_Thread_Mutex.h"
 #include "Threading.h"
+#include "Platform/Define.h"
 
+#include <deque>
 
 class Database;
 class SqlOperation;
 class SqlConnection;
 
+/// Async queue statistics, times in milliseconds
+struct SqlDelayStats
+{
+    SqlDelayStats() : queueDepth(0), maxQueueDepth(0), executed(0), totalWaitTime(0), maxWaitTime(0), totalExecTime(0) {}
+
+    void Add(SqlDelayStats const& stats);
+
+    uint32 queueDepth;                                      ///< requests waiting now
+    uint32 maxQueueDepth;                                   ///< max waiting requests since last reset
+    uint64 executed;                                        ///< executed requests since last reset
+    uint64 totalWaitTime;                                   ///< sum of time from Delay() to execution start
+    uint32 maxWaitTime;
+    uint64 totalExecTime;
+};
+
 class SqlDelayThread : public ACE_Based::Runnable
 {
-    typedef ACE_Based::LockedQueue<SqlOperation*, ACE_Thread_Mutex> SqlQueue;
+    typedef std::deque<SqlOperation*> SqlQueue;
 
     private:
         SqlQueue m_sqlQueue;                                ///< Queue of SQL statements
+        ACE_Thread_Mutex m_queueLock;                       ///< Guards queue and stats
+        ACE_Condition_Thread_Mutex m_queueCondition;        ///< Signaled at new statement and stop
         Database* m_dbEngine;                               ///< Pointer to used Database engine
         SqlConnection * m_dbConnection;                     ///< Pointer to DB connection
         volatile bool m_running;
+        bool m_pingDatabase;                                ///< only one thread per Database keeps connections alive
+        SqlDelayStats m_stats;
 
         //process all enqueued requests
         void ProcessRequests();
 
     public:
-        SqlDelayThread(Database* db, SqlConnection* conn);
+        SqlDelayThread(Database* db, SqlConnection* conn, bool pingDatabase = true);
         ~SqlDelayThread();
 
         ///< Put sql statement to delay queue
-        bool Delay(SqlOperation* sql) { m_sqlQueue.add(sql); return true; }
+        bool Delay(SqlOperation* sql);
+
+        ///< Get queue statistics, optionally starting new measurement period
+        void GetStats(SqlDelayStats& stats, bool reset);
 
         virtual void Stop();                                ///< Stop event
         virtual void run();                                 ///< Main Thread loop
@@ -50,21 +50,75 @@ bool SqlTransaction::Execute(SqlConnection *conn)
 
     conn->BeginTransaction();
 
-    const int nItems = m_queue.size();
-    for (int i = 0; i < nItems; ++i)
+    const size_t nItems = m_queue.size();
+    for (size_t i = 0; i < nItems;)
     {
         SqlOperation * pStmt = m_queue[i];
 
-        if(!pStmt->Execute(conn))
+        // find run of the same prepared statement, row INSERTs from it can be sent at once
+        size_t nRun = 1;
+        if (SqlPreparedRequest const* pReq = pStmt->AsPreparedRequest())
+        {
+            while (i + nRun < nItems && m_queue[i + nRun]->AsPreparedRequest() &&
+                m_queue[i + nRun]->AsPreparedRequest()->GetIndex() == pReq->GetIndex())
+                ++nRun;
+        }
+
+        bool result = nRun > 1 ? ExecuteCoalesced(conn, i, nRun) : pStmt->Execute(conn);
+        if (!result)
         {
             conn->RollbackTransaction();
             return false;
         }
+
+        i += nRun;
     }
 
     return conn->CommitTransaction();
 }
 
+bool SqlTransaction::ExecuteCoalesced(SqlConnection *conn, size_t first, size_t count)
+{
+    int nIndex = m_queue[first]->AsPreparedRequest()->GetIndex();
+
+    while (count > 0)
+    {
+        // power of 2 row counts only, to limit amount of prepared statements per connection
+        uint32 nRows = 1;
+        while (nRows * 2 <= count && nRows * 2 <= MAX_COALESCED_INSERT_ROWS)
+            nRows *= 2;
+
+        int nCoalescedIndex = nRows > 1 ? conn->DB().GetCoalescedStmtIndex(nIndex, nRows) : -1;
+        if (nCoalescedIndex == -1)
+        {
+            // not a plain single-row INSERT (or last row), execute one by one
+            for (; count > 0; ++first, --count)
+                if (!m_queue[first]->Execute(conn))
+                    return false;
+
+            break;
+        }
+
+        SqlStmtParameters params(nRows * m_queue[first]->AsPreparedRequest()->GetParams().boundParams());
+        for (uint32 i = 0; i < nRows; ++i)
+        {
+            SqlStmtParameters::ParameterContainer const& rowParams = m_queue[first + i]->AsPreparedRequest()->GetParams().params();
+            for (SqlStmtParameters::ParameterContainer::const_iterator itr = rowParams.begin(); itr != rowParams.end(); ++itr)
+                params.addParam(*itr);
+        }
+
+        if (!conn->ExecuteStmt(nCoalescedIndex, params))
+            return false;
+
+        conn->DB().AddCoalescedRows(nRows);
+
+        first += nRows;
+        count -= nRows;
+    }
+
+    return true;
+}
+
 SqlPreparedRequest::SqlPreparedRequest(int nIndex, SqlStmtParameters * arg ) : m_nIndex(nIndex), m_param(arg)
 {
 }
@@ -107,16 +161,15 @@ void SqlResultQueue::Update()
     }
 }
 
-bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback * callback, SqlDelayThread *thread, SqlResultQueue *queue)
+bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback * callback, Database *db, SqlResultQueue *queue)
 {
-    if(!callback || !thread || !queue)
+    if(!callback || !db || !queue)
         return false;
 
     /// delay the execution of the queries, sync them with the delay thread
     /// which will in turn resync on execution (via the queue) and call back
     SqlQueryHolderEx *holderEx = new SqlQueryHolderEx(this, callback, queue);
-    thread->Delay(holderEx);
-    return true;
+    return db->DelayAsyncOperation(holderEx, m_serialId);
 }
 
 bool SqlQueryHolder::SetQuery(size_t index, const char *sql)
@@ -227,3 +280,46 @@ bool SqlQueryHolderEx::Execute(SqlConnection *conn)
 
     return true;
 }
+
+/// ---- ASYNC LANES ----
+
+SqlLaneBarrier::SqlLaneBarrier(uint32 fences) : m_condition(m_lock), m_waitFences(fences), m_done(false)
+{
+    m_refs = 0;
+}
+
+void SqlLaneBarrier::ArriveAndWait()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    if (--m_waitFences == 0)
+        m_condition.broadcast();
+
+    while (!m_done)
+        m_condition.wait();
+}
+
+void SqlLaneBarrier::WaitArrived()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    while (m_waitFences > 0)
+        m_condition.wait();
+}
+
+void SqlLaneBarrier::Done()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    m_done = true;
+    m_condition.broadcast();
+}
+
+bool SqlBarrierOperation::Execute(SqlConnection *conn)
+{
+    m_barrier->WaitArrived();
+    bool result = m_op ? m_op->Execute(conn) : true;
+    m_barrier->Done();
+
+    return result;
+}
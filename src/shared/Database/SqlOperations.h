@@ -22,6 +22,8 @@
 #include "Common.h"
 
 #include "ace/Thread_Mutex.h"
+#include "ace/Condition_Thread_Mutex.h"
+#include "ace/Atomic_Op.h"
 #include "LockedQueue.h"
 #include <queue>
 #include "Utilities/Callback.h"
@@ -32,13 +34,25 @@ class Database;
 class SqlConnection;
 class SqlDelayThread;
 class SqlStmtParameters;
+class SqlPreparedRequest;
 
 class SqlOperation
 {
     public:
+        SqlOperation() : m_queueTime(0) {}
         virtual void OnRemove() { delete this; }
         virtual bool Execute(SqlConnection *conn) = 0;
         virtual ~SqlOperation() {}
+
+        // used for multi-row INSERT coalescing inside transactions
+        virtual SqlPreparedRequest const* AsPreparedRequest() const { return NULL; }
+
+        // time when operation was put into async queue, for latency stats
+        void SetQueueTime(uint32 msTime) { m_queueTime = msTime; }
+        uint32 GetQueueTime() const { return m_queueTime; }
+
+    private:
+        uint32 m_queueTime;
 };
 
 /// ---- ASYNC STATEMENTS / TRANSACTIONS ----
@@ -57,12 +71,17 @@ class SqlTransaction : public SqlOperation
 {
     private:
         std::vector<SqlOperation * > m_queue;
+        uint32 m_serialId;                                  // async lane selector, see Database::BeginTransaction
+
+        // execute run of same single-row INSERT statements [first, first + count) as multi-row INSERTs
+        bool ExecuteCoalesced(SqlConnection *conn, size_t first, size_t count);
 
     public:
-        SqlTransaction() {}
+        explicit SqlTransaction(uint32 serialId = 0) : m_serialId(serialId) {}
         ~SqlTransaction();
 
         void DelayExecute(SqlOperation * sql)   {   m_queue.push_back(sql); }
+        uint32 GetSerialId() const { return m_serialId; }
 
         bool Execute(SqlConnection *conn);
 };
@@ -75,6 +94,10 @@ class SqlPreparedRequest : public SqlOperation
 
         bool Execute(SqlConnection *conn);
 
+        SqlPreparedRequest const* AsPreparedRequest() const { return this; }
+        int GetIndex() const { return m_nIndex; }
+        SqlStmtParameters const& GetParams() const { return *m_param; }
+
     private:
         const int m_nIndex;
         SqlStmtParameters * m_param;
@@ -114,15 +137,18 @@ class SqlQueryHolder
     private:
         typedef std::pair<const char*, QueryResult*> SqlResultPair;
         std::vector<SqlResultPair> m_queries;
+        uint32 m_serialId;
     public:
-        SqlQueryHolder() {}
+        SqlQueryHolder() : m_serialId(0) {}
         ~SqlQueryHolder();
         bool SetQuery(size_t index, const char *sql);
         bool SetPQuery(size_t index, const char *format, ...) ATTR_PRINTF(3,4);
         void SetSize(size_t size);
+        // queries will be executed in order with async requests of the same serial id (see Database::BeginTransaction)
+        void SetSerialId(uint32 serialId) { m_serialId = serialId; }
         QueryResult* GetResult(size_t index);
         void SetResult(size_t index, QueryResult *result);
-        bool Execute(MaNGOS::IQueryCallback * callback, SqlDelayThread *thread, SqlResultQueue *queue);
+        bool Execute(MaNGOS::IQueryCallback * callback, Database *db, SqlResultQueue *queue);
 };
 
 class SqlQueryHolderEx : public SqlOperation
@@ -136,4 +162,51 @@ class SqlQueryHolderEx : public SqlOperation
             : m_holder(holder), m_callback(callback), m_queue(queue) {}
         bool Execute(SqlConnection *conn);
 };
+
+/// ---- ASYNC LANES ----
+
+/// Ordering point between async lanes: request without serial id waits in lane 0 until
+/// all other lanes reach their fence, other lanes continue when the request is done.
+class SqlLaneBarrier
+{
+    public:
+        explicit SqlLaneBarrier(uint32 fences);
+
+        void AddRef() { ++m_refs; }
+        void Release() { if (--m_refs == 0) delete this; }
+
+        void ArriveAndWait();                               // called by fence in other lanes
+        void WaitArrived();                                 // called in lane 0 before the request
+        void Done();                                        // called in lane 0 after the request
+
+    private:
+        ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_condition;
+        uint32 m_waitFences;
+        bool m_done;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_refs;
+};
+
+class SqlLaneFence : public SqlOperation
+{
+    public:
+        explicit SqlLaneFence(SqlLaneBarrier* barrier) : m_barrier(barrier) { m_barrier->AddRef(); }
+        ~SqlLaneFence() { m_barrier->Release(); }
+        bool Execute(SqlConnection * /*conn*/) { m_barrier->ArriveAndWait(); return true; }
+
+    private:
+        SqlLaneBarrier* m_barrier;
+};
+
+class SqlBarrierOperation : public SqlOperation
+{
+    public:
+        SqlBarrierOperation(SqlLaneBarrier* barrier, SqlOperation* op) : m_barrier(barrier), m_op(op) { m_barrier->AddRef(); }
+        ~SqlBarrierOperation() { delete m_op; m_barrier->Release(); }
+        bool Execute(SqlConnection *conn);
+
+    private:
+        SqlLaneBarrier* m_barrier;
+        SqlOperation* m_op;
+};
 #endif                                                      //__SQLOPERATIONS_H
@@ -29,6 +29,10 @@
 #include <iostream>
 
 #include "ace/OS_NS_unistd.h"
+#include "ace/OS_NS_time.h"
+#include "ace/Task.h"
+#include "ace/TSS_T.h"
+#include "ace/Atomic_Op.h"
 
 INSTANTIATE_SINGLETON_1( Log );
 
@@ -66,9 +70,357 @@ enum LogType
 
 const int LogType_count = int(LogError) +1;
 
+// outputs of async mode
+enum LogSink
+{
+    LOG_SINK_STDOUT,
+    LOG_SINK_STDERR,
+    LOG_SINK_SERVER,                                        // LogFile
+    LOG_SINK_GM,                                            // GMLogFile (not per account)
+    LOG_SINK_CHAR,                                          // CharLogFile
+    LOG_SINK_DB_ERROR,                                      // DBErrorLogFile
+    LOG_SINK_EVENT_AI_ERROR,                                // EventAIErrorLogFile
+    LOG_SINK_SCRIPT_ERROR,                                  // script library error file
+    LOG_SINK_RA,                                            // RaLogFile
+    LOG_SINK_WORLD_PACKET,                                  // WorldLogFile
+    LOG_SINK_COUNT
+};
+
+#define LOG_SINK_MASK(S) (1 << (S))
+#define LOG_SINK_MASK_CONSOLE (LOG_SINK_MASK(LOG_SINK_STDOUT) | LOG_SINK_MASK(LOG_SINK_STDERR))
+
+#define LOG_ASYNC_FORMAT_SIZE 16384                         // longer messages are truncated in async mode
+#define LOG_CHUNK_TEXT_SIZE   244
+
+typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> LogCounter;
+
+// Part of one log record, long records use several consecutive chunks
+struct LogChunk
+{
+    uint8 sink;
+    uint8 color;                                            // Color_count for not colored output
+    uint8 last;                                             // last chunk of record
+    uint8 unused;
+    uint32 length;
+    char text[LOG_CHUNK_TEXT_SIZE];
+};
+
+// Single producer (owner thread) single consumer (holder of LogWriter write lock) chunk queue.
+// Chunks are published by head update after whole record written, so log thread never sees partial records.
+class LogRing
+{
+    public:
+        explicit LogRing(size_t capacity) : m_chunks(new LogChunk[capacity]), m_capacity(capacity), m_head(0), m_tail(0), m_owned(1) {}
+        ~LogRing() { delete[] m_chunks; }
+
+        size_t GetCapacity() const { return m_capacity - 1; }
+        size_t GetFree() const { return (size_t(m_tail.value()) + m_capacity - size_t(m_head.value()) - 1) % m_capacity; }
+        bool IsEmpty() const { return m_head.value() == m_tail.value(); }
+
+        bool IsOwned() const { return m_owned.value() != 0; }
+        void SetOwned(bool owned) { m_owned = owned ? 1 : 0; }
+
+        // producer side
+        LogChunk& GetChunk(size_t pos) { return m_chunks[pos % m_capacity]; }
+        size_t GetHead() const { return size_t(m_head.value()); }
+        void Publish(size_t head) { m_head = long(head % m_capacity); }
+
+        // consumer side
+        size_t GetTail() const { return size_t(m_tail.value()); }
+        void Consume(size_t tail) { m_tail = long(tail % m_capacity); }
+        size_t GetNext(size_t pos) const { return (pos + 1) % m_capacity; }
+
+    private:
+        LogRing(LogRing const&);
+        LogRing& operator=(LogRing const&);
+
+        LogChunk* m_chunks;
+        size_t const m_capacity;
+        LogCounter m_head;                                  // next chunk to write, changed only by owner thread
+        LogCounter m_tail;                                  // next chunk to read, changed only under LogWriter write lock
+        LogCounter m_owned;                                 // ring of finished thread can be reused by new thread
+};
+
+// Thread local reference to thread's ring, ring itself owned by LogWriter
+struct LogRingOwner
+{
+    LogRingOwner() : ring(NULL) {}
+    ~LogRingOwner()
+    {
+        if (ring)
+            ring->SetOwned(false);
+    }
+
+    LogRing* ring;
+};
+
+class LogWriter : public ACE_Task_Base
+{
+    public:
+        LogWriter(Log& log, size_t ringSize, bool blockOnOverflow) :
+            m_log(log), m_ringSize(ringSize), m_blockOnOverflow(blockOnOverflow), m_stop(0), m_written(0), m_dropped(0), m_blocked(0)
+        {
+        }
+
+        ~LogWriter()
+        {
+            for (std::vector<LogRing*>::const_iterator itr = m_rings.begin(); itr != m_rings.end(); ++itr)
+                delete *itr;
+        }
+
+        bool Start() { return activate(THR_NEW_LWP | THR_JOINABLE, 1) == 0; }
+
+        void Stop()
+        {
+            m_stop = 1;
+            wait();
+        }
+
+        void Push(uint8 sink, uint8 color, char const* text, size_t length);
+        // write all published records in caller thread, without waiting for log thread if wait is false
+        void Flush(bool wait) { Drain(wait); }
+
+        ACE_Thread_Mutex& GetWriteLock() { return m_writeLock; }
+
+        uint64 GetWrittenCount() const { return uint64(m_written.value()); }
+        uint64 GetDroppedCount() const { return uint64(m_dropped.value()); }
+        uint64 GetBlockedCount() const { return uint64(m_blocked.value()); }
+
+        int svc();
+
+    private:
+        LogRing* GetThreadRing();
+        bool Drain(bool wait = true);
+        void WriteConsole(uint8 sink, uint8 color);
+
+        Log& m_log;
+        size_t const m_ringSize;
+        bool const m_blockOnOverflow;
+
+        ACE_TSS<LogRingOwner> m_threadRing;
+        std::vector<LogRing*> m_rings;
+        ACE_Thread_Mutex m_ringsLock;
+
+        ACE_Thread_Mutex m_writeLock;                       // held while files are written
+        std::string m_batch[LOG_SINK_COUNT];                // data collected for each sink in current drain
+        std::string m_consoleRecord;
+
+        LogCounter m_stop;
+        LogCounter m_written;
+        LogCounter m_dropped;
+        LogCounter m_blocked;
+};
+
+LogRing* LogWriter::GetThreadRing()
+{
+    LogRingOwner* owner = m_threadRing.ts_object();
+    if (!owner)
+        return NULL;
+
+    if (!owner->ring)
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_ringsLock, NULL);
+
+        // reuse drained ring of finished thread
+        for (std::vector<LogRing*>::const_iterator itr = m_rings.begin(); itr != m_rings.end(); ++itr)
+        {
+            if (!(*itr)->IsOwned() && (*itr)->IsEmpty())
+            {
+                owner->ring = *itr;
+                owner->ring->SetOwned(true);
+                return owner->ring;
+            }
+        }
+
+        owner->ring = new LogRing(m_ringSize);
+        m_rings.push_back(owner->ring);
+    }
+
+    return owner->ring;
+}
+
+void LogWriter::Push(uint8 sink, uint8 color, char const* text, size_t length)
+{
+    LogRing* ring = GetThreadRing();
+    if (!ring)
+    {
+        ++m_dropped;
+        return;
+    }
+
+    size_t chunks = length ? (length + LOG_CHUNK_TEXT_SIZE - 1) / LOG_CHUNK_TEXT_SIZE : 1;
+    if (chunks > ring->GetCapacity())
+    {
+        ++m_dropped;
+        return;
+    }
+
+    if (ring->GetFree() < chunks)
+    {
+        if (!m_blockOnOverflow)
+        {
+            ++m_dropped;
+            return;
+        }
+
+        ++m_blocked;
+        while (ring->GetFree() < chunks)
+        {
+            if (m_stop.value())
+            {
+                ++m_dropped;
+                return;
+            }
+            ACE_OS::sleep(ACE_Time_Value(0, 1000));
+        }
+    }
+
+    size_t head = ring->GetHead();
+    for (size_t i = 0; i < chunks; ++i)
+    {
+        LogChunk& chunk = ring->GetChunk(head++);
+        size_t part = length > LOG_CHUNK_TEXT_SIZE ? LOG_CHUNK_TEXT_SIZE : length;
+
+        chunk.sink = sink;
+        chunk.color = color;
+        chunk.last = i + 1 == chunks;
+        chunk.length = part;
+        memcpy(chunk.text, text, part);
+
+        text += part;
+        length -= part;
+    }
+
+    ring->Publish(head);
+}
+
+void LogWriter::WriteConsole(uint8 sink, uint8 color)
+{
+    bool stdout_stream = sink == LOG_SINK_STDOUT;
+    FILE* out = stdout_stream ? stdout : stderr;
+
+    if (color < Color_count)
+        m_log.SetColor(stdout_stream, Color(color));
+
+    utf8printf(out, "%s", m_consoleRecord.c_str());
+
+    if (color < Color_count)
+        m_log.ResetColor(stdout_stream);
+
+    fprintf(out, "\n");
+    m_consoleRecord.clear();
+}
+
+// move all published records to sink batches and write each sink once
+bool LogWriter::Drain(bool wait /*= true*/)
+{
+    std::vector<LogRing*> rings;
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_ringsLock, false);
+        rings = m_rings;
+    }
+
+    ACE_Guard<ACE_Thread_Mutex> guard(m_writeLock, wait ? 1 : 0);
+    if (!guard.locked())
+        return false;
+
+    bool consoleUsed[2] = { false, false };
+    uint32 records = 0;
+    for (std::vector<LogRing*>::const_iterator itr = rings.begin(); itr != rings.end(); ++itr)
+    {
+        LogRing* ring = *itr;
+        size_t tail = ring->GetTail();
+        size_t head = ring->GetHead();
+        if (tail == head)
+            continue;
+
+        for (; tail != head; tail = ring->GetNext(tail))
+        {
+            LogChunk const& chunk = ring->GetChunk(tail);
+            if (chunk.sink == LOG_SINK_STDOUT || chunk.sink == LOG_SINK_STDERR)
+            {
+                m_consoleRecord.append(chunk.text, chunk.length);
+                if (chunk.last)
+                {
+                    WriteConsole(chunk.sink, chunk.color);
+                    consoleUsed[chunk.sink] = true;
+                }
+            }
+            else
+                m_batch[chunk.sink].append(chunk.text, chunk.length);
+
+            if (chunk.last)
+                ++records;
+        }
+
+        ring->Consume(tail);
+    }
+
+    if (!records)
+        return false;
+
+    for (int i = LOG_SINK_SERVER; i < LOG_SINK_COUNT; ++i)
+    {
+        if (m_batch[i].empty())
+            continue;
+
+        if (FILE* file = m_log.GetSinkFile(i))
+        {
+            fwrite(m_batch[i].c_str(), 1, m_batch[i].size(), file);
+            fflush(file);
+        }
+        m_batch[i].clear();
+    }
+
+    if (consoleUsed[LOG_SINK_STDOUT])
+        fflush(stdout);
+    if (consoleUsed[LOG_SINK_STDERR])
+        fflush(stderr);
+
+    m_written += long(records);
+    return true;
+}
+
+int LogWriter::svc()
+{
+    while (!m_stop.value())
+    {
+        if (!Drain())
+            ACE_OS::sleep(ACE_Time_Value(0, 10000));
+    }
+
+    // records pushed before stop
+    Drain();
+    return 0;
+}
+
+// holds write lock of log thread in async mode, nothing to lock in sync mode
+class LogWriteGuard
+{
+    public:
+        explicit LogWriteGuard(LogWriter* writer) : m_lock(writer ? &writer->GetWriteLock() : NULL)
+        {
+            if (m_lock)
+                m_lock->acquire();
+        }
+
+        ~LogWriteGuard()
+        {
+            if (m_lock)
+                m_lock->release();
+        }
+
+    private:
+        LogWriteGuard(LogWriteGuard const&);
+        LogWriteGuard& operator=(LogWriteGuard const&);
+
+        ACE_Thread_Mutex* m_lock;
+};
+
 Log::Log() :
     raLogfile(NULL), logfile(NULL), gmLogfile(NULL), charLogfile(NULL),
-    dberLogfile(NULL), eventAiErLogfile(NULL), scriptErrLogFile(NULL), worldLogfile(NULL), m_colored(false), m_includeTime(false), m_gmlog_per_account(false), m_scriptLibName(NULL)
+    dberLogfile(NULL), eventAiErLogfile(NULL), scriptErrLogFile(NULL), worldLogfile(NULL), m_colored(false), m_includeTime(false), m_gmlog_per_account(false), m_scriptLibName(NULL),
+    m_asyncWriter(NULL)
 {
     Initialize();
 }
@@ -270,6 +622,127 @@ void Log::Initialize()
 
     ReloadConfigDefaults();
 
+    if (!m_asyncWriter && sConfig.GetBoolDefault("LogAsync", false))
+        StartAsyncWriter();
+}
+
+void Log::StartAsyncWriter()
+{
+    int ringSize = sConfig.GetIntDefault("LogAsyncBufferSize", 1024);
+    if (ringSize < 16)
+        ringSize = 16;
+
+    LogWriter* writer = new LogWriter(*this, size_t(ringSize), sConfig.GetIntDefault("LogAsyncOverflow", 1) != 0);
+    if (!writer->Start())
+    {
+        delete writer;
+        return;
+    }
+
+    m_asyncWriter = writer;
+}
+
+void Log::StopAsyncWriter()
+{
+    if (!m_asyncWriter)
+        return;
+
+    LogWriter* writer = m_asyncWriter;
+    m_asyncWriter = NULL;                                   // later output is written directly
+    writer->Stop();
+    delete writer;
+}
+
+void Log::FlushAsync()
+{
+    // can be called from signal handler of crashed log thread, don't wait for its lock then
+    if (LogWriter* writer = m_asyncWriter)
+        writer->Flush(false);
+}
+
+bool Log::GetAsyncStatistics(uint64& written, uint64& dropped, uint64& blocked) const
+{
+    if (!m_asyncWriter)
+        return false;
+
+    written = m_asyncWriter->GetWrittenCount();
+    dropped = m_asyncWriter->GetDroppedCount();
+    blocked = m_asyncWriter->GetBlockedCount();
+    return true;
+}
+
+FILE* Log::GetSinkFile(uint32 sink) const
+{
+    switch (sink)
+    {
+        case LOG_SINK_STDOUT:           return stdout;
+        case LOG_SINK_STDERR:           return stderr;
+        case LOG_SINK_SERVER:           return logfile;
+        case LOG_SINK_GM:               return gmLogfile;
+        case LOG_SINK_CHAR:             return charLogfile;
+        case LOG_SINK_DB_ERROR:         return dberLogfile;
+        case LOG_SINK_EVENT_AI_ERROR:   return eventAiErLogfile;
+        case LOG_SINK_SCRIPT_ERROR:     return scriptErrLogFile;
+        case LOG_SINK_RA:               return raLogfile;
+        case LOG_SINK_WORLD_PACKET:     return worldLogfile;
+        default:                        return NULL;
+    }
+}
+
+void Log::AsyncWrite(uint32 sinks, int logType, char const* filePrefix, char const* str, va_list ap)
+{
+    char text[LOG_ASYNC_FORMAT_SIZE];
+    vsnprintf(text, LOG_ASYNC_FORMAT_SIZE, str, ap);
+    AsyncWriteText(sinks, logType, filePrefix, text);
+}
+
+// format records for all requested sinks in caller thread, log thread only writes them
+void Log::AsyncWriteText(uint32 sinks, int logType, char const* filePrefix, char const* text)
+{
+    time_t t = time(NULL);
+    tm aTm;
+    ACE_OS::localtime_r(&t, &aTm);
+
+    if (sinks & LOG_SINK_MASK_CONSOLE)
+    {
+        std::string record;
+        if (m_includeTime)
+        {
+            char timeStr[16];
+            snprintf(timeStr, 16, "%02d:%02d:%02d ", aTm.tm_hour, aTm.tm_min, aTm.tm_sec);
+            record = timeStr;
+        }
+        record += text;
+
+        uint8 sink = (sinks & LOG_SINK_MASK(LOG_SINK_STDOUT)) ? LOG_SINK_STDOUT : LOG_SINK_STDERR;
+        uint8 color = m_colored ? uint8(m_colors[logType]) : uint8(Color_count);
+        m_asyncWriter->Push(sink, color, record.c_str(), record.size());
+    }
+
+    if (sinks & ~LOG_SINK_MASK_CONSOLE)
+    {
+        // same format as outTimestamp
+        char timestamp[32];
+        snprintf(timestamp, 32, "%-4d-%02d-%02d %02d:%02d:%02d ", aTm.tm_year + 1900, aTm.tm_mon + 1, aTm.tm_mday, aTm.tm_hour, aTm.tm_min, aTm.tm_sec);
+
+        for (int i = LOG_SINK_SERVER; i < LOG_SINK_COUNT; ++i)
+        {
+            if (!(sinks & LOG_SINK_MASK(i)) || !GetSinkFile(i))
+                continue;
+
+            std::string record = timestamp;
+            if (i == LOG_SINK_SERVER && filePrefix)
+                record += filePrefix;
+            record += text;
+            record += "\n";
+
+            m_asyncWriter->Push(uint8(i), uint8(Color_count), record.c_str(), record.size());
+        }
+    }
+
+    // errors often precede a crash or abort, they must not stay queued
+    if (logType == LogError)
+        m_asyncWriter->Flush(true);
 }
 
 void Log::ReloadConfigDefaults()
@@ -367,6 +840,12 @@ std::string Log::GetTimestampStr()
 
 void Log::outString()
 {
+    if (m_asyncWriter)
+    {
+        AsyncWriteText(LOG_SINK_MASK(LOG_SINK_STDOUT) | LOG_SINK_MASK(LOG_SINK_SERVER), LogNormal, NULL, "");
+        return;
+    }
+
     if (m_includeTime)
         outTime();
     printf( "\n" );
@@ -385,6 +864,15 @@ void Log::outString( const char * str, ... )
     if (!str)
         return;
 
+    if (m_asyncWriter)
+    {
+        va_list ap;
+        va_start(ap, str);
+        AsyncWrite(LOG_SINK_MASK(LOG_SINK_STDOUT) | LOG_SINK_MASK(LOG_SINK_SERVER), LogNormal, NULL, str, ap);
+        va_end(ap);
+        return;
+    }
+
     if (m_colored)
         SetColor(true,m_colors[LogNormal]);
 
@@ -422,6 +910,15 @@ void Log::outError( const char * err, ... )
     if (!err)
         return;
 
+    if (m_asyncWriter)
+    {
+        va_list ap;
+        va_start(ap, err);
+        AsyncWrite(LOG_SINK_MASK(LOG_SINK_STDERR) | LOG_SINK_MASK(LOG_SINK_SERVER), LogError, "ERROR:", err, ap);
+        va_end(ap);
+        return;
+    }
+
     if (m_colored)
         SetColor(false,m_colors[LogError]);
 
@@ -456,6 +953,12 @@ void Log::outError( const char * err, ... )
 
 void Log::outErrorDb()
 {
+    if (m_asyncWriter)
+    {
+        AsyncWriteText(LOG_SINK_MASK(LOG_SINK_STDERR) | LOG_SINK_MASK(LOG_SINK_SERVER) | LOG_SINK_MASK(LOG_SINK_DB_ERROR), LogError, "ERROR:", "");
+        return;
+    }
+
     if (m_includeTime)
         outTime();
 
@@ -483,6 +986,15 @@ void Log::outErrorDb( const char * err, ... )
     if (!err)
         return;
 
+    if (m_asyncWriter)
+    {
+        va_list ap;
+        va_start(ap, err);
+        AsyncWrite(LOG_SINK_MASK(LOG_SINK_STDERR) | LOG_SINK_MASK(LOG_SINK_SERVER) | LOG_SINK_MASK(LOG_SINK_DB_ERROR), LogError, "ERROR:", err, ap);
+        va_end(ap);
+        return;
+    }
+
     if (m_colored)
         SetColor(false,m_colors[LogError]);
 
@@ -531,6 +1043,12 @@ void Log::outErrorDb( const char * err, ... )
 
 void Log::outErrorEventAI()
 {
+    if (m_asyncWriter)
+    {
+        AsyncWriteText(LOG_SINK_MASK(LOG_SINK_STDERR) | LOG_SINK_MASK(LOG_SINK_SERVER) | LOG_SINK_MASK(LOG_SINK_EVENT_AI_ERROR), LogError, "ERROR CreatureEventAI", "");
+        return;
+    }
+
     if (m_includeTime)
         outTime();
 
@@ -558,6 +1076,15 @@ void Log::outErrorEventAI(const char* err, ...)
     if (!err)
         return;
 
+    if (m_asyncWriter)
+    {
+        va_list ap;
+        va_start(ap, err);
+        AsyncWrite(LOG_SINK_MASK(LOG_SINK_STDERR) | LOG_SINK_MASK(LOG_SINK_SERVER) | LOG_SINK_MASK(LOG_SINK_EVENT_AI_ERROR), LogError, "ERROR CreatureEventAI: ", err, ap);
+        va_end(ap);
+        return;
+    }
+
     if (m_colored)
         SetColor(false, m_colors[LogError]);
 
@@ -609,6 +1136,21 @@ void Log::outBasic(const char* str, ...)
     if (!str)
         return;
 
+    if (m_asyncWriter)
+    {
+        uint32 sinks = 0;
+        if (m_logLevel >= LOG_LVL_BASIC)
+            sinks |= LOG_SINK_MASK(LOG_SINK_STDOUT);
+        if (m_logFileLevel >= LOG_LVL_BASIC)
+            sinks |= LOG_SINK_MASK(LOG_SINK_SERVER);
+
+        va_list ap;
+        va_start(ap, str);
+        AsyncWrite(sinks, LogDetails, NULL, str, ap);
+        va_end(ap);
+        return;
+    }
+
     if (m_logLevel >= LOG_LVL_BASIC)
     {
         if (m_colored)
@@ -647,6 +1189,21 @@ void Log::outDetail( const char * str, ... )
     if (!str)
         return;
 
+    if (m_asyncWriter)
+    {
+        uint32 sinks = 0;
+        if (m_logLevel >= LOG_LVL_DETAIL)
+            sinks |= LOG_SINK_MASK(LOG_SINK_STDOUT);
+        if (m_logFileLevel >= LOG_LVL_DETAIL)
+            sinks |= LOG_SINK_MASK(LOG_SINK_SERVER);
+
+        va_list ap;
+        va_start(ap, str);
+        AsyncWrite(sinks, LogDetails, NULL, str, ap);
+        va_end(ap);
+        return;
+    }
+
     if (m_logLevel >= LOG_LVL_DETAIL)
     {
 
@@ -688,6 +1245,21 @@ void Log::outDebug( const char * str, ... )
     if (!str)
         return;
 
+    if (m_asyncWriter)
+    {
+        uint32 sinks = 0;
+        if (m_logLevel >= LOG_LVL_DEBUG)
+            sinks |= LOG_SINK_MASK(LOG_SINK_STDOUT);
+        if (m_logFileLevel >= LOG_LVL_DEBUG)
+            sinks |= LOG_SINK_MASK(LOG_SINK_SERVER);
+
+        va_list ap;
+        va_start(ap, str);
+        AsyncWrite(sinks, LogDebug, NULL, str, ap);
+        va_end(ap);
+        return;
+    }
+
     if (m_logLevel >= LOG_LVL_DEBUG)
     {
         if (m_colored)
@@ -728,6 +1300,22 @@ void Log::outCommand( uint32 account, const char * str, ... )
     if (!str)
         return;
 
+    // per account GM log files are opened for each command, so only single GM log file is written by log thread
+    if (m_asyncWriter && !m_gmlog_per_account)
+    {
+        uint32 sinks = LOG_SINK_MASK(LOG_SINK_GM);
+        if (m_logLevel >= LOG_LVL_DETAIL)
+            sinks |= LOG_SINK_MASK(LOG_SINK_STDOUT);
+        if (m_logFileLevel >= LOG_LVL_DETAIL)
+            sinks |= LOG_SINK_MASK(LOG_SINK_SERVER);
+
+        va_list ap;
+        va_start(ap, str);
+        AsyncWrite(sinks, LogDetails, NULL, str, ap);
+        va_end(ap);
+        return;
+    }
+
     if (m_logLevel >= LOG_LVL_DETAIL)
     {
         if (m_colored)
@@ -791,6 +1379,15 @@ void Log::outChar(const char * str, ... )
     if (!str)
         return;
 
+    if (m_asyncWriter)
+    {
+        va_list ap;
+        va_start(ap, str);
+        AsyncWrite(LOG_SINK_MASK(LOG_SINK_CHAR), LogNormal, NULL, str, ap);
+        va_end(ap);
+        return;
+    }
+
     if (charLogfile)
     {
         va_list ap;
@@ -805,6 +1402,12 @@ void Log::outChar(const char * str, ... )
 
 void Log::outErrorScriptLib()
 {
+    if (m_asyncWriter)
+    {
+        AsyncWriteText(LOG_SINK_MASK(LOG_SINK_STDERR) | LOG_SINK_MASK(LOG_SINK_SERVER) | LOG_SINK_MASK(LOG_SINK_SCRIPT_ERROR), LogError, "<Scripting Library ERROR>: ", "");
+        return;
+    }
+
     if (m_includeTime)
         outTime();
 
@@ -835,6 +1438,17 @@ void Log::outErrorScriptLib(const char* err, ...)
     if (!err)
         return;
 
+    if (m_asyncWriter)
+    {
+        std::string prefix = m_scriptLibName ? std::string("<") + m_scriptLibName + " ERROR>: " : std::string("<Scripting Library ERROR>: ");
+
+        va_list ap;
+        va_start(ap, err);
+        AsyncWrite(LOG_SINK_MASK(LOG_SINK_STDERR) | LOG_SINK_MASK(LOG_SINK_SERVER) | LOG_SINK_MASK(LOG_SINK_SCRIPT_ERROR), LogError, prefix.c_str(), err, ap);
+        va_end(ap);
+        return;
+    }
+
     if (m_colored)
         SetColor(false, m_colors[LogError]);
 
@@ -889,6 +1503,29 @@ void Log::outWorldPacketDump(uint32 socket, uint32 opcode, char const* opcodeNam
     if (!worldLogfile)
         return;
 
+    if (m_asyncWriter)
+    {
+        char buf[256];
+        snprintf(buf, 256, "\n%s:\nSOCKET: %u\nLENGTH: " SIZEFMTD "\nOPCODE: %s (0x%.4X)\nDATA:",
+            incoming ? "CLIENT" : "SERVER",
+            socket, packet->size(), opcodeName, opcode);
+
+        std::string text = buf;
+        text.reserve(text.size() + packet->size() * 3 + packet->size() / 16 + 4);
+
+        for (size_t p = 0; p < packet->size(); ++p)
+        {
+            if (p % 16 == 0)
+                text += "\n";
+            snprintf(buf, 256, "%.2X ", (*packet)[p]);
+            text += buf;
+        }
+
+        text += "\n\n";
+        AsyncWriteText(LOG_SINK_MASK(LOG_SINK_WORLD_PACKET), LogNormal, NULL, text.c_str());
+        return;
+    }
+
     ACE_GUARD(ACE_Thread_Mutex, GuardObj, m_worldLogMtx);
 
     outTimestamp(worldLogfile);
@@ -912,6 +1549,18 @@ void Log::outWorldPacketDump(uint32 socket, uint32 opcode, char const* opcodeNam
 
 void Log::outCharDump( const char * str, uint32 account_id, uint32 guid, const char * name )
 {
+    if (charLogfile && m_asyncWriter)
+    {
+        char buf[256];
+        snprintf(buf, 256, "== START DUMP == (account: %u guid: %u name: %s )\n", account_id, guid, name);
+
+        std::string text = buf;
+        text += str;
+        text += "\n== END DUMP ==\n";
+        m_asyncWriter->Push(LOG_SINK_CHAR, Color_count, text.c_str(), text.size());
+        return;
+    }
+
     if (charLogfile)
     {
         fprintf(charLogfile, "== START DUMP == (account: %u guid: %u name: %s )\n%s\n== END DUMP ==\n",account_id,guid,name,str );
@@ -924,6 +1573,15 @@ void Log::outRALog(    const char * str, ... )
     if (!str)
         return;
 
+    if (m_asyncWriter)
+    {
+        va_list ap;
+        va_start(ap, str);
+        AsyncWrite(LOG_SINK_MASK(LOG_SINK_RA), LogNormal, NULL, str, ap);
+        va_end(ap);
+        return;
+    }
+
     if (raLogfile)
     {
         va_list ap;
@@ -963,6 +1621,9 @@ void Log::WaitBeforeContinueIfNeed()
 
 void Log::setScriptLibraryErrorFile(char const* fname, char const* libName)
 {
+    // log thread can write to current file
+    LogWriteGuard guard(m_asyncWriter);
+
     m_scriptLibName = libName;
 
     if (scriptErrLogFile)
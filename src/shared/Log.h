@@ -24,6 +24,7 @@
 
 class Config;
 class ByteBuffer;
+class LogWriter;
 
 enum LogLevel
 {
@@ -93,12 +94,15 @@ const int Color_count = int(WHITE)+1;
 class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Thread_Mutex> >
 {
         friend class MaNGOS::OperatorNew<Log>;
+        friend class LogWriter;
 
     public:
         Log();
 
         ~Log()
         {
+            StopAsyncWriter();
+
             if (logfile != NULL)
                 fclose(logfile);
             logfile = NULL;
@@ -185,6 +189,12 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
 
         static void WaitBeforeContinueIfNeed();
 
+        // async mode (LogAsync): output is formatted in caller thread and written by separate log thread
+        bool IsAsync() const { return m_asyncWriter != NULL; }
+        // write queued async output now, errors are flushed at once already
+        void FlushAsync();
+        bool GetAsyncStatistics(uint64& written, uint64& dropped, uint64& blocked) const;
+
         // Set filename for scriptlibrary error output
         void setScriptLibraryErrorFile(char const* fname, char const* libName);
 
@@ -192,6 +202,12 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
         FILE* openLogFile(char const* configFileName,char const* configTimeStampFlag, char const* mode);
         FILE* openGmlogPerAccount(uint32 account);
 
+        void StartAsyncWriter();
+        void StopAsyncWriter();
+        void AsyncWrite(uint32 sinks, int logType, char const* filePrefix, char const* str, va_list ap);
+        void AsyncWriteText(uint32 sinks, int logType, char const* filePrefix, char const* text);
+        FILE* GetSinkFile(uint32 sink) const;
+
         FILE* raLogfile;
         FILE* logfile;
         FILE* gmLogfile;
@@ -222,6 +238,8 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
         std::string m_gmlog_filename_format;
 
         char const* m_scriptLibName;
+
+        LogWriter* m_asyncWriter;
 };
 
 #define sLog MaNGOS::Singleton<Log>::Instance()
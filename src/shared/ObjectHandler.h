@@ -21,6 +21,9 @@
 
 #include "Common.h"
 
+#include <ace/Atomic_Op.h>
+#include <vector>
+
 #ifndef OBJECT_HANDLER
 #  define OBJECT_HANDLER(TYPE,NAME) typedef ACE_Refcounted_Auto_Ptr<TYPE,ACE_Null_Mutex> NAME;
 #endif
@@ -29,18 +32,188 @@
 #  define OBJECT_SAFE_HANDLER(TYPE,NAME) typedef ACE_Refcounted_Auto_Ptr<TYPE,ACE_Thread_Mutex> NAME;
 #endif
 
+#ifndef OBJECT_COUNTED_HANDLER
+#  define OBJECT_COUNTED_HANDLER(TYPE,NAME) typedef CountedHandler<TYPE> NAME;
+#endif
+
+#ifndef NOTSAFE_SEMAPHORE_OVERHANDLING
+typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> CountedObjectCounter;
+#else
+typedef ACE_Atomic_Op<ACE_Null_Mutex, long> CountedObjectCounter;
+#endif
+
+// Base of objects owned by CountedHandler. Reference counter is part of the object,
+// so copying a handler is a single atomic increment and needs no separate counter allocation.
+class CountedObject
+{
+    public:
+        CountedObject() : m_handlerRefs(0) {}
+
+        void AddHandlerRef() { ++m_handlerRefs; }
+        bool RemoveHandlerRef() { return --m_handlerRefs == 0; }  // true if last handler released
+        long GetHandlerRefs() const { return m_handlerRefs.value(); }
+
+    protected:
+        ~CountedObject() {}
+
+    private:
+        CountedObject(CountedObject const&);
+        CountedObject& operator=(CountedObject const&);
+
+        CountedObjectCounter m_handlerRefs;
+};
+
+// Shared ownership handler of CountedObject based classes, same interface as ACE_Refcounted_Auto_Ptr
+template<class T>
+class CountedHandler
+{
+    public:
+        explicit CountedHandler(T* p = NULL) : m_ptr(p)
+        {
+            if (m_ptr)
+                m_ptr->AddHandlerRef();
+        }
+
+        CountedHandler(CountedHandler const& other) : m_ptr(other.m_ptr)
+        {
+            if (m_ptr)
+                m_ptr->AddHandlerRef();
+        }
+
+        ~CountedHandler() { Release(m_ptr); }
+
+        CountedHandler& operator=(CountedHandler const& other)
+        {
+            if (other.m_ptr)
+                other.m_ptr->AddHandlerRef();
+
+            T* old = m_ptr;
+            m_ptr = other.m_ptr;
+            Release(old);
+            return *this;
+        }
+
+        bool operator==(CountedHandler const& other) const { return m_ptr == other.m_ptr; }
+        bool operator!=(CountedHandler const& other) const { return m_ptr != other.m_ptr; }
+
+        T* operator->() const { return m_ptr; }
+        T& operator*() const { return *m_ptr; }
+        bool operator!() const { return m_ptr == NULL; }
+        operator bool() const { return m_ptr != NULL; }
+
+        T* get() const { return m_ptr; }
+        long count() const { return m_ptr ? m_ptr->GetHandlerRefs() : 0; }
+        bool null() const { return m_ptr == NULL; }
+        void reset(T* p = NULL) { *this = CountedHandler(p); }
+
+    private:
+        static void Release(T* p)
+        {
+            if (p && p->RemoveHandlerRef())
+                delete p;
+        }
+
+        T* m_ptr;
+};
+
+// Free list of fixed size blocks cut from larger slabs. Each block remembers its pool,
+// so it can be freed from any thread by Deallocate(). Slabs are kept for reuse until pool destruction.
+template<class LOCK>
+class ObjectPool
+{
+    public:
+        explicit ObjectPool(size_t objectSize, size_t blocksPerSlab = 64) :
+            m_blockSize(HeaderSize() + ((objectSize + HeaderSize() - 1) / HeaderSize()) * HeaderSize()),
+            m_blocksPerSlab(blocksPerSlab), m_freeBlocks(NULL), m_usedBlocks(0)
+        {
+        }
+
+        ~ObjectPool()
+        {
+            for (std::vector<char*>::const_iterator itr = m_slabs.begin(); itr != m_slabs.end(); ++itr)
+                delete[] *itr;
+        }
+
+        void* Allocate()
+        {
+            ACE_GUARD_RETURN(LOCK, guard, m_lock, NULL);
+
+            if (!m_freeBlocks)
+                AddSlab();
+
+            BlockHeader* block = m_freeBlocks;
+            m_freeBlocks = block->nextFree;
+            block->pool = this;
+            ++m_usedBlocks;
+            return reinterpret_cast<char*>(block) + HeaderSize();
+        }
+
+        static void Deallocate(void* p)
+        {
+            if (!p)
+                return;
+
+            BlockHeader* block = reinterpret_cast<BlockHeader*>(static_cast<char*>(p) - HeaderSize());
+            block->pool->Free(block);
+        }
+
+        size_t GetUsedCount() const { return m_usedBlocks; }
+        size_t GetReservedSize() const { return m_slabs.size() * m_blocksPerSlab * m_blockSize; }
+
+    private:
+        union BlockHeader
+        {
+            ObjectPool* pool;                               // while allocated
+            BlockHeader* nextFree;                          // while in free list
+            double align;
+            void* alignPtr;
+        };
+
+        static size_t HeaderSize() { return sizeof(BlockHeader); }
+
+        void AddSlab()
+        {
+            char* slab = new char[m_blocksPerSlab * m_blockSize];
+            m_slabs.push_back(slab);
+
+            for (size_t i = 0; i < m_blocksPerSlab; ++i)
+            {
+                BlockHeader* block = reinterpret_cast<BlockHeader*>(slab + i * m_blockSize);
+                block->nextFree = m_freeBlocks;
+                m_freeBlocks = block;
+            }
+        }
+
+        void Free(BlockHeader* block)
+        {
+            ACE_GUARD(LOCK, guard, m_lock);
+            block->nextFree = m_freeBlocks;
+            m_freeBlocks = block;
+            --m_usedBlocks;
+        }
+
+        ObjectPool(ObjectPool const&);
+        ObjectPool& operator=(ObjectPool const&);
+
+        LOCK m_lock;
+        size_t const m_blockSize;
+        size_t const m_blocksPerSlab;
+        BlockHeader* m_freeBlocks;
+        size_t m_usedBlocks;
+        std::vector<char*> m_slabs;
+};
+
 class SpellAuraHolder;
 class UnitAction;
 class VehicleKit;
 
 #ifndef NOTSAFE_SEMAPHORE_OVERHANDLING
-    OBJECT_SAFE_HANDLER(SpellAuraHolder,SpellAuraHolderPtr);
     OBJECT_SAFE_HANDLER(UnitAction,UnitActionPtr);
     OBJECT_SAFE_HANDLER(VehicleKit,VehicleKitPtr);
 #else
-    OBJECT_HANDLER(SpellAuraHolder,SpellAuraHolderPtr);
     OBJECT_HANDLER(UnitAction,UnitActionPtr);
     OBJECT_HANDLER(VehicleKit,VehicleKitPtr);
 #endif
+    OBJECT_COUNTED_HANDLER(SpellAuraHolder,SpellAuraHolderPtr);
 
 #endif
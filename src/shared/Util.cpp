@@ -393,6 +393,37 @@ bool WStrToUtf8(std::wstring wstr, std::string& utf8str)
     return true;
 }
 
+bool Utf8ToLower(const std::string& utf8str, std::string& lowerStr)
+{
+    // most names are plain latin, skip the wide string conversion for them
+    bool ascii = true;
+    for (std::string::const_iterator itr = utf8str.begin(); itr != utf8str.end(); ++itr)
+    {
+        if (uint8(*itr) & 0x80)
+        {
+            ascii = false;
+            break;
+        }
+    }
+
+    if (ascii)
+    {
+        lowerStr = utf8str;
+        std::transform(lowerStr.begin(), lowerStr.end(), lowerStr.begin(), ::tolower);
+        return true;
+    }
+
+    std::wstring wstr;
+    if (!Utf8toWStr(utf8str, wstr))
+    {
+        lowerStr = "";
+        return false;
+    }
+
+    wstrToLower(wstr);
+    return WStrToUtf8(wstr, lowerStr);
+}
+
 typedef wchar_t const* const* wstrlist;
 
 std::wstring GetMainPartOfName(std::wstring wname, uint32 declension)
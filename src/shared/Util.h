@@ -117,6 +117,9 @@ bool WStrToUtf8(std::wstring wstr, std::string& utf8str);
 // size==real string size
 bool WStrToUtf8(wchar_t* wstr, size_t size, std::string& utf8str);
 
+// lower case copy for case insensitive name lookups, false (and empty result) at invalid utf8 sequence
+bool Utf8ToLower(const std::string& utf8str, std::string& lowerStr);
+
 size_t utf8length(std::string& utf8str);                    // set string to "" if invalid utf8 sequence
 void utf8truncate(std::string& utf8str,size_t len);
 
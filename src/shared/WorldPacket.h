@@ -41,13 +41,23 @@ class WorldPacket : public ByteBuffer
         void Initialize(Opcodes opcode, size_t newres=200)
         {
             clear();
-            _storage.reserve(newres);
+            reserve(newres);
             m_opcode = opcode;
         }
 
         Opcodes GetOpcode() const { return m_opcode; }
         void SetOpcode(Opcodes opcode) { m_opcode = opcode; }
 
+        // heap allocated packets (incoming queue, delayed sends) share the storage pool blocks
+        static void* operator new(size_t size) { return ByteBufferStoragePool::Allocate(size); }
+        static void* operator new(size_t size, std::nothrow_t const&) throw()
+        {
+            try { return ByteBufferStoragePool::Allocate(size); }
+            catch (std::bad_alloc const&) { return NULL; }
+        }
+        static void operator delete(void* ptr, size_t size) { ByteBufferStoragePool::Deallocate(ptr, size); }
+        static void operator delete(void* ptr, std::nothrow_t const&) throw() { ByteBufferStoragePool::Deallocate(ptr, sizeof(WorldPacket)); }
+
     protected:
         Opcodes m_opcode;
 };
@@ -1,6 +1,6 @@
 #ifndef __REVISION_SQL_H__
 #define __REVISION_SQL_H__
  #define REVISION_DB_CHARACTERS "required_12487_01_characters_characters"
- #define REVISION_DB_MANGOS "required_12522_01_mangos_db_script_string"
+ #define REVISION_DB_MANGOS "required_12530_01_mangos_command"
  #define REVISION_DB_REALMD "required_12112_01_realmd_account_access"
 #endif // __REVISION_SQL_H__